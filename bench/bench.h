@@ -0,0 +1,50 @@
+/*****************************************************************************
+ * bench.h: helpers shared by the benchmarks
+ *****************************************************************************/
+
+#ifndef ZSF_BENCH_H
+#define ZSF_BENCH_H
+
+#include <math.h>
+
+#include "timer.h"
+
+/* bench_uniform:
+ *      a uniform random number in [lo, hi) from a 64-bit LCG, such that every
+ *      benchmark run gets the same inputs */
+static inline double bench_uniform(unsigned long long *seed, double lo, double hi) {
+  *seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+  return lo + (hi - lo) * (double)(*seed >> 11) / 9007199254740992.0;
+}
+
+/* BENCH_BEST_OF:
+ *      run the statements num_runs times, and set best to the shortest run in
+ *      seconds, to reduce the influence of other processes */
+#define BENCH_BEST_OF(best, num_runs, ...)                                                         \
+  do {                                                                                             \
+    (best) = HUGE_VAL;                                                                             \
+    for (int bench_run_ = 0; bench_run_ < (num_runs); bench_run_++) {                              \
+      double bench_t0_ = timer_now();                                                              \
+      __VA_ARGS__;                                                                                 \
+      (best) = fmin((best), timer_now() - bench_t0_);                                              \
+    }                                                                                              \
+  } while (0)
+
+/* BENCH_UNTIL:
+ *      run the statements n = n0, 2 * n0, 4 * n0, ... times (the statements
+ *      loop over n themselves) until a run takes at least min_time seconds,
+ *      and set best to the shortest time in seconds per n */
+#define BENCH_UNTIL(best, min_time, n, n0, ...)                                                    \
+  do {                                                                                             \
+    (best) = HUGE_VAL;                                                                             \
+    for (long long n = (n0);; n *= 2) {                                                            \
+      double bench_t0_ = timer_now();                                                              \
+      __VA_ARGS__;                                                                                 \
+      double bench_elapsed_ = timer_now() - bench_t0_;                                             \
+      (best) = fmin((best), bench_elapsed_ / n);                                                   \
+      if (bench_elapsed_ >= (min_time))                                                            \
+        break;                                                                                     \
+    }                                                                                              \
+  } while (0)
+
+#endif
@@ -0,0 +1,101 @@
+/*****************************************************************************
+ * bench_calibration.c: fitting the calibration coefficient and the density
+ *                      current factor to synthetic observations
+ *****************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "zsf.h"
+
+#define NUM_FIT 2
+
+int main(int argc, char *argv[]) {
+  int n = (argc > 1) ? atoi(argv[1]) : 1000;
+  int max_threads = (argc > 2) ? atoi(argv[2]) : 4;
+
+  zsf_param_t base;
+  zsf_param_default(&base);
+  base.lock_length = 240.0;
+  base.lock_width = 12.0;
+  base.lock_bottom = -4.0;
+  base.salinity_lake = 5.0;
+  base.rtol = 1E-8;
+  base.atol = 1E-10;
+
+  // Observations at random tides and sea salinities, of which the salt loads
+  // are modelled with known coefficients
+  double *head_sea = (double *)malloc(n * sizeof(double));
+  double *salinity_sea = (double *)malloc(n * sizeof(double));
+  double *ship_volume = (double *)malloc(n * sizeof(double));
+  double *observed = (double *)malloc(n * sizeof(double));
+  double *residuals = (double *)malloc(n * sizeof(double));
+
+  unsigned long long seed = 42;
+  for (int i = 0; i < n; i++) {
+    head_sea[i] = bench_uniform(&seed, -1.5, 1.5);
+    salinity_sea[i] = bench_uniform(&seed, 20.0, 30.0);
+    ship_volume[i] = (bench_uniform(&seed, 0.0, 1.0) < 0.5) ? 0.0 : 2000.0;
+  }
+
+  zsf_param_columns_t params = {0};
+  params.head_sea = head_sea;
+  params.salinity_sea = salinity_sea;
+  params.ship_volume_sea_to_lake = ship_volume;
+
+  zsf_param_t truth = base;
+  truth.calibration_coefficient = 0.8;
+  truth.density_current_factor_sea = 0.6;
+
+  zsf_results_columns_t results = {0};
+  results.salt_load_lake = observed;
+
+  double t0 = timer_now();
+  zsf_calc_steady_batch(&truth, &params, 1, &results, 1, NULL, n, NULL);
+  double t_batch = timer_now() - t0;
+
+  printf("%d observations, a single batch takes %.3f s\n\n", n, t_batch);
+  printf("%-8s %10s %10s %12s %14s %14s %12s\n", "threads", "time (s)", "iterations",
+         "evaluations", "calibration", "density", "rms");
+
+  for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+    zsf_calibration_param_t fit[NUM_FIT] = {
+        {.param = zsf_param_index("calibration_coefficient"),
+         .value = 1.0,
+         .lower = 0.0,
+         .upper = HUGE_VAL},
+        {.param = zsf_param_index("density_current_factor_sea"),
+         .value = 1.0,
+         .lower = 0.0,
+         .upper = 1.0},
+    };
+
+    zsf_options_t options;
+    zsf_options_default(&options);
+    options.num_threads = num_threads;
+
+    zsf_calibration_stats_t stats;
+    t0 = timer_now();
+    int err = zsf_calibrate(&base, &params, 1, observed, NULL, n, fit, NUM_FIT, 100, &options,
+                            residuals, &stats);
+    double t_calibrate = timer_now() - t0;
+    if (err) {
+      fprintf(stderr, "%s\n", zsf_error_msg(err));
+      return 1;
+    }
+
+    printf("%-8d %10.3f %10d %12d %14.8f %14.8f %12.2e\n", num_threads, t_calibrate,
+           stats.num_iterations, stats.num_evaluations, fit[0].value, fit[1].value,
+           stats.rms_residual);
+  }
+
+  free(head_sea);
+  free(salinity_sea);
+  free(ship_volume);
+  free(observed);
+  free(residuals);
+
+  return 0;
+}
@@ -0,0 +1,147 @@
+/*****************************************************************************
+ * bench_complex.c: a lock complex of chambers on a shared lake and sea, with
+ *                  zsf_complex_run and with a zsf_run_lockages per chamber
+ *****************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "timer.h"
+#include "zsf.h"
+
+#define CYCLE_LENGTH 4
+
+int main(int argc, char *argv[]) {
+  int num_chambers = (argc > 1) ? atoi(argv[1]) : 8;
+  int num_steps = (argc > 2) ? atoi(argv[2]) : 20000;
+  int max_threads = (argc > 3) ? atoi(argv[3]) : 4;
+
+  // Chambers of different sizes, of which every other one is busy half the time
+  zsf_param_t *chambers = (zsf_param_t *)malloc(num_chambers * sizeof(zsf_param_t));
+  for (int j = 0; j < num_chambers; j++) {
+    zsf_param_default(&chambers[j]);
+    chambers[j].lock_length = 240.0 - 20.0 * (j % 6);
+    chambers[j].lock_width = 12.0 - (j % 3);
+    chambers[j].lock_bottom = -4.0;
+    chambers[j].salinity_sea = 25.0;
+    chambers[j].salinity_lake = 5.0;
+    chambers[j].flushing_discharge_high_tide = 0.5 * (j % 2);
+  }
+
+  // The sea level and salinity change between lockages
+  double *head_sea = (double *)malloc(num_steps * sizeof(double));
+  double *salinity_sea = (double *)malloc(num_steps * sizeof(double));
+  for (int i = 0; i < num_steps; i++) {
+    int cycle = i / (2 * CYCLE_LENGTH);
+    head_sea[i] = sin(cycle * 0.5);
+    salinity_sea[i] = 25.0 + 2.0 * cos(cycle * 0.1);
+  }
+  zsf_param_columns_t params = {0};
+  params.head_sea = head_sea;
+  params.salinity_sea = salinity_sea;
+
+  const int cycle[CYCLE_LENGTH] = {ZSF_ROUTINE_LEVEL_TO_LAKE, ZSF_ROUTINE_DOOR_OPEN_LAKE,
+                                   ZSF_ROUTINE_LEVEL_TO_SEA, ZSF_ROUTINE_DOOR_OPEN_SEA};
+  const double durations_cycle[CYCLE_LENGTH] = {300.0, 1800.0, 300.0, 1800.0};
+
+  size_t n = (size_t)num_steps * num_chambers;
+  int *routines = (int *)malloc(n * sizeof(int));
+  double *durations = (double *)malloc(n * sizeof(double));
+  for (int i = 0; i < num_steps; i++) {
+    for (int j = 0; j < num_chambers; j++) {
+      int k = i % (2 * CYCLE_LENGTH);
+      int idle = (j % 2) && k >= CYCLE_LENGTH;
+      routines[i * num_chambers + j] = idle ? ZSF_ROUTINE_IDLE : cycle[k % CYCLE_LENGTH];
+      durations[i * num_chambers + j] = durations_cycle[k % CYCLE_LENGTH];
+    }
+  }
+
+  zsf_phase_transports_t *totals =
+      (zsf_phase_transports_t *)malloc(num_steps * sizeof(zsf_phase_transports_t));
+  zsf_phase_transports_t *separate =
+      (zsf_phase_transports_t *)malloc(num_steps * sizeof(zsf_phase_transports_t));
+  zsf_phase_transports_t *transports =
+      (zsf_phase_transports_t *)malloc(num_steps * sizeof(zsf_phase_transports_t));
+  int *chamber_routines = (int *)malloc(num_steps * sizeof(int));
+  double *chamber_durations = (double *)malloc(num_steps * sizeof(double));
+
+  // Every chamber through zsf_run_lockages on its own, summing the mass afterwards
+  double t0 = timer_now();
+  for (int i = 0; i < num_steps; i++) {
+    separate[i].mass_transport_lake = 0.0;
+    separate[i].mass_transport_sea = 0.0;
+  }
+  for (int j = 0; j < num_chambers; j++) {
+    for (int i = 0; i < num_steps; i++) {
+      chamber_routines[i] = routines[i * num_chambers + j];
+      chamber_durations[i] = durations[i * num_chambers + j];
+    }
+
+    zsf_phase_state_t state;
+    zsf_initialize_state(&chambers[j], &state, 15.0, chambers[j].head_sea);
+    int err = zsf_run_lockages(&chambers[j], &params, 1, chamber_routines, chamber_durations,
+                               num_steps, &state, transports, NULL, NULL);
+    if (err) {
+      fprintf(stderr, "%s\n", zsf_error_msg(err));
+      return 1;
+    }
+
+    for (int i = 0; i < num_steps; i++) {
+      separate[i].mass_transport_lake += transports[i].mass_transport_lake;
+      separate[i].mass_transport_sea += transports[i].mass_transport_sea;
+    }
+  }
+  double t_separate = timer_now() - t0;
+
+  printf("%d chambers, %d steps\n\n", num_chambers, num_steps);
+  printf("%-8s %12s %12s %10s %12s\n", "threads", "separate (s)", "complex (s)", "speedup",
+         "max abs diff");
+
+  for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+    zsf_options_t options;
+    zsf_options_default(&options);
+    options.num_threads = num_threads;
+
+    zsf_complex_t *complex;
+    zsf_complex_create(chambers, num_chambers, &complex);
+    for (int j = 0; j < num_chambers; j++) {
+      zsf_phase_state_t state;
+      zsf_initialize_state(&chambers[j], &state, 15.0, chambers[j].head_sea);
+      zsf_complex_set_state(complex, j, &state);
+    }
+
+    t0 = timer_now();
+    int err = zsf_complex_run(complex, &params, 1, routines, durations, num_steps, totals, NULL,
+                              NULL, &options);
+    double t_complex = timer_now() - t0;
+    zsf_complex_free(complex);
+    if (err) {
+      fprintf(stderr, "%s\n", zsf_error_msg(err));
+      return 1;
+    }
+
+    double max_diff = 0.0;
+    for (int i = 0; i < num_steps; i++) {
+      double diff_lake = totals[i].mass_transport_lake - separate[i].mass_transport_lake;
+      double diff_sea = totals[i].mass_transport_sea - separate[i].mass_transport_sea;
+      max_diff = fmax(max_diff, fmax(fabs(diff_lake), fabs(diff_sea)));
+    }
+
+    printf("%-8d %12.4f %12.4f %10.2f %12.1e\n", num_threads, t_separate, t_complex,
+           t_separate / t_complex, max_diff);
+  }
+
+  free(chambers);
+  free(head_sea);
+  free(salinity_sea);
+  free(routines);
+  free(durations);
+  free(totals);
+  free(separate);
+  free(transports);
+  free(chamber_routines);
+  free(chamber_durations);
+
+  return 0;
+}
@@ -0,0 +1,167 @@
+/*****************************************************************************
+ * bench_context.c: replaying lockages with and without a zsf_context_t, and
+ *                   with zsf_run_lockages
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "zsf.h"
+
+// A log of lockages, where the durations of the phases differ per lockage,
+// and the boundary conditions change only every so often.
+typedef struct lockage_t {
+  double t_level;
+  double t_open_lake;
+  double t_open_sea;
+  double salinity_lake;
+  double temperature_sea;
+} lockage_t;
+
+static double replay(const zsf_param_t *base, const lockage_t *log, int n, int use_context,
+                     double *salinity_lock) {
+  zsf_param_t p = *base;
+  zsf_context_t *ctx = zsf_context_create(&p);
+
+  zsf_phase_state_t state;
+  zsf_phase_transports_t tp;
+  zsf_initialize_state(&p, &state, 0.5 * (p.salinity_lake + p.salinity_sea), p.head_sea);
+
+  double t0 = timer_now();
+
+  for (int i = 0; i < n; i++) {
+    p.salinity_lake = log[i].salinity_lake;
+    p.temperature_sea = log[i].temperature_sea;
+
+    int err = 0;
+    if (use_context) {
+      zsf_context_set_param(ctx, &p);
+      err |= zsf_context_step_phase_1(ctx, log[i].t_level, &state, &tp);
+      err |= zsf_context_step_phase_2(ctx, log[i].t_open_lake, &state, &tp);
+      err |= zsf_context_step_phase_3(ctx, log[i].t_level, &state, &tp);
+      err |= zsf_context_step_phase_4(ctx, log[i].t_open_sea, &state, &tp);
+    } else {
+      err |= zsf_step_phase_1(&p, log[i].t_level, &state, &tp);
+      err |= zsf_step_phase_2(&p, log[i].t_open_lake, &state, &tp);
+      err |= zsf_step_phase_3(&p, log[i].t_level, &state, &tp);
+      err |= zsf_step_phase_4(&p, log[i].t_open_sea, &state, &tp);
+    }
+    if (err) {
+      fprintf(stderr, "lockage %d failed\n", i);
+      break;
+    }
+  }
+
+  double t = timer_now() - t0;
+
+  zsf_context_free(ctx);
+
+  *salinity_lock = state.salinity_lock;
+  return t;
+}
+
+static double replay_run_lockages(const zsf_param_t *base, const lockage_t *log, int n,
+                                  double *salinity_lock) {
+  int num_events = 4 * n;
+  int *routines = (int *)malloc(num_events * sizeof(int));
+  double *durations = (double *)malloc(num_events * sizeof(double));
+  double *salinity_lake = (double *)malloc(num_events * sizeof(double));
+  double *temperature_sea = (double *)malloc(num_events * sizeof(double));
+  zsf_phase_transports_t *transports =
+      (zsf_phase_transports_t *)malloc(num_events * sizeof(zsf_phase_transports_t));
+
+  for (int i = 0; i < n; i++) {
+    const int lockage_routines[4] = {ZSF_ROUTINE_LEVEL_TO_LAKE, ZSF_ROUTINE_DOOR_OPEN_LAKE,
+                                     ZSF_ROUTINE_LEVEL_TO_SEA, ZSF_ROUTINE_DOOR_OPEN_SEA};
+    const double lockage_durations[4] = {log[i].t_level, log[i].t_open_lake, log[i].t_level,
+                                         log[i].t_open_sea};
+    for (int j = 0; j < 4; j++) {
+      routines[4 * i + j] = lockage_routines[j];
+      durations[4 * i + j] = lockage_durations[j];
+      salinity_lake[4 * i + j] = log[i].salinity_lake;
+      temperature_sea[4 * i + j] = log[i].temperature_sea;
+    }
+  }
+
+  zsf_param_columns_t columns = {0};
+  columns.salinity_lake = salinity_lake;
+  columns.temperature_sea = temperature_sea;
+
+  // Fault in the pages of the output beforehand, like those of the input
+  memset(transports, 0, num_events * sizeof(zsf_phase_transports_t));
+
+  zsf_phase_state_t state;
+  zsf_initialize_state(base, &state, 0.5 * (base->salinity_lake + base->salinity_sea),
+                       base->head_sea);
+
+  double t0 = timer_now();
+  int failed_event;
+  int err = zsf_run_lockages(base, &columns, 1, routines, durations, num_events, &state,
+                             transports, &failed_event, NULL);
+  double t = timer_now() - t0;
+
+  if (err)
+    fprintf(stderr, "event %d: %s\n", failed_event, zsf_error_msg(err));
+
+  free(routines);
+  free(durations);
+  free(salinity_lake);
+  free(temperature_sea);
+  free(transports);
+
+  *salinity_lock = state.salinity_lock;
+  return t;
+}
+
+int main(int argc, char *argv[]) {
+  int n = (argc > 1) ? atoi(argv[1]) : 100000;
+  int lockages_per_change = (argc > 2) ? atoi(argv[2]) : 100;
+  if (n < 1 || lockages_per_change < 1) {
+    fprintf(stderr, "usage: %s [num_lockages] [lockages_per_change]\n", argv[0]);
+    return 1;
+  }
+
+  zsf_param_t base;
+  zsf_param_default(&base);
+
+  lockage_t *lockages = (lockage_t *)calloc(n, sizeof(lockage_t));
+  if (lockages == NULL) {
+    fprintf(stderr, "cannot allocate %d lockages\n", n);
+    return 1;
+  }
+
+  unsigned long long seed = 42;
+  for (int i = 0; i < n; i++) {
+    lockages[i].t_level = bench_uniform(&seed, 200.0, 400.0);
+    lockages[i].t_open_lake = bench_uniform(&seed, 600.0, 3000.0);
+    lockages[i].t_open_sea = bench_uniform(&seed, 600.0, 3000.0);
+
+    if (i % lockages_per_change == 0) {
+      lockages[i].salinity_lake = bench_uniform(&seed, 0.5, 2.0);
+      lockages[i].temperature_sea = bench_uniform(&seed, 5.0, 20.0);
+    } else {
+      lockages[i].salinity_lake = lockages[i - 1].salinity_lake;
+      lockages[i].temperature_sea = lockages[i - 1].temperature_sea;
+    }
+  }
+
+  double sal_without, sal_with, sal_run;
+  double t_without = replay(&base, lockages, n, 0, &sal_without);
+  double t_with = replay(&base, lockages, n, 1, &sal_with);
+  double t_run = replay_run_lockages(&base, lockages, n, &sal_run);
+
+  printf("%d lockages, boundary conditions change every %d lockages\n\n", n, lockages_per_change);
+  printf("%-16s %14s %12s\n", "", "lockages/s", "us/lockage");
+  printf("%-16s %14.0f %12.3f\n", "without context", n / t_without, 1E6 * t_without / n);
+  printf("%-16s %14.0f %12.3f\n", "with context", n / t_with, 1E6 * t_with / n);
+  printf("%-16s %14.0f %12.3f\n", "run_lockages", n / t_run, 1E6 * t_run / n);
+  printf("\nspeedup %.2f, final salinity difference %.1e\n", t_without / t_with,
+         sal_with - sal_without);
+  printf("run_lockages final salinity difference %.1e\n", sal_run - sal_with);
+
+  free(lockages);
+
+  return 0;
+}
@@ -0,0 +1,111 @@
+/*****************************************************************************
+ * bench_density.c: accuracy and throughput of the density calculations
+ *****************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Always compare against the table, independent of how the library is built
+#ifndef ZSF_USE_DENSITY_TABLE
+#  define ZSF_USE_DENSITY_TABLE
+#endif
+
+#include "bench.h"
+#include "util.h"
+
+// The original fixed-point iteration on the density, with pow() calls
+static double sal_psu_2_density_pow(double sal_psu, double temperature) {
+  double a = (8.24493E-1 - 4.0899E-3 * temperature + 7.6438E-5 * pow(temperature, 2.0) -
+              8.2467E-7 * pow(temperature, 3.0) + 5.3875E-9 * pow(temperature, 4.0));
+  double b = -5.72466E-3 + 1.0227E-4 * temperature - 1.6546E-6 * pow(temperature, 2.0);
+  double c = 4.8314E-4;
+
+  double rho_ref = (999.842594 + 6.793952E-2 * temperature - 9.095290E-3 * pow(temperature, 2.0) +
+                    1.001685E-4 * pow(temperature, 3.0) - 1.120083E-6 * pow(temperature, 4.0) +
+                    6.536332E-9 * pow(temperature, 5.0));
+
+  return rho_ref + a * sal_psu + b * pow(sal_psu, 1.5) + c * pow(sal_psu, 2.0);
+}
+
+static double sal_2_density_fixed_point(double sal_kgm3, double temperature, double rtol,
+                                        double atol) {
+  double sal_psu = sal_kgm3;
+  double rho = 1000.0;
+
+  for (int i = 0; i < 100; i++) {
+    double rho_new = sal_psu_2_density_pow(sal_psu, temperature);
+    sal_psu = sal_kgm3 / rho_new * 1000.0;
+
+    if (is_close(rho_new, rho, rtol, atol))
+      return rho_new;
+
+    rho = rho_new;
+  }
+  return ZSF_NAN;
+}
+
+// Keeps the compiler from optimizing away the calculations
+static volatile double sink;
+
+#define METHODS(X)                                                                                 \
+  X(fixed_point, sal_2_density_fixed_point(sal[i], temp[i], rtol, atol))                           \
+  X(newton, sal_2_density(sal[i], temp[i], rtol, atol))                                            \
+  X(table, (sal_2_density_table(sal[i], temp[i], &rho) ? rho : ZSF_NAN))
+
+int main(int argc, char *argv[]) {
+  int n = (argc > 1) ? atoi(argv[1]) : 1000000;
+
+  // Samples within the range of the table, i.e. the validity range of the
+  // UNESCO algorithm
+  double *sal = (double *)malloc(n * sizeof(double));
+  double *temp = (double *)malloc(n * sizeof(double));
+  double *exact = (double *)malloc(n * sizeof(double));
+
+  unsigned long long seed = 42;
+  for (int i = 0; i < n; i++) {
+    sal[i] = bench_uniform(&seed, 0.0, 45.0);
+    temp[i] = bench_uniform(&seed, -2.0, 40.0);
+    exact[i] = sal_2_density(sal[i], temp[i], 1E-15, 0.0);
+  }
+
+  const double tolerances[][2] = {{1E-5, 1E-8}, {1E-12, 1E-14}};
+
+  printf("%d samples, table error bound %.1e kg/m3\n", n, DENSITY_TABLE_MAX_ERROR);
+
+  for (int k = 0; k < 2; k++) {
+    double rtol = tolerances[k][0];
+    double atol = tolerances[k][1];
+
+    printf("\nrtol = %.0e, atol = %.0e\n\n", rtol, atol);
+    printf("%-12s %12s %14s %14s\n", "method", "ns/call", "max abs error", "speedup");
+
+    double t_reference = 0.0;
+    double rho; // Output of the table lookup
+
+#define BENCH_METHOD(NAME, EXPR)                                                                   \
+  {                                                                                                \
+    double max_error = 0.0, sum = 0.0;                                                             \
+    double t0 = timer_now();                                                                       \
+    for (int i = 0; i < n; i++) {                                                                  \
+      sum += (EXPR);                                                                               \
+    }                                                                                              \
+    double t = timer_now() - t0;                                                                   \
+    for (int i = 0; i < n; i++) {                                                                  \
+      max_error = fmax(max_error, fabs((EXPR) - exact[i]));                                        \
+    }                                                                                              \
+    if (t_reference == 0.0)                                                                        \
+      t_reference = t;                                                                             \
+    sink = sum;                                                                                    \
+    printf("%-12s %12.1f %14.1e %14.2f\n", #NAME, 1E9 * t / n, max_error, t_reference / t);        \
+  }
+    METHODS(BENCH_METHOD)
+#undef BENCH_METHOD
+  }
+
+  free(sal);
+  free(temp);
+  free(exact);
+
+  return 0;
+}
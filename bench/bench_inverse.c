@@ -0,0 +1,106 @@
+/*****************************************************************************
+ * bench_inverse.c: the flushing discharge for a target salt load, with the
+ *                  inverse solve versus bisection of full solves
+ *****************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "timer.h"
+#include "zsf.h"
+
+// Bisection with a full solve from scratch per probe, as one would do
+// without zsf_calc_steady_inverse
+static double bisection(const zsf_param_t *p, double lower, double upper, double target,
+                        double xtol, int *num_probes, int *num_cycles) {
+  zsf_param_t q = *p;
+  zsf_results_t results;
+  zsf_steady_stats_t stats;
+
+  q.flushing_discharge_high_tide = lower;
+  zsf_calc_steady_ex(&q, NULL, &results, NULL, &stats);
+  int f_lower_above = results.salt_load_lake > target;
+  *num_probes = 1;
+  *num_cycles = stats.num_cycles;
+
+  while (upper - lower > xtol) {
+    q.flushing_discharge_high_tide = 0.5 * (lower + upper);
+    zsf_calc_steady_ex(&q, NULL, &results, NULL, &stats);
+    (*num_probes)++;
+    *num_cycles += stats.num_cycles;
+
+    if ((results.salt_load_lake > target) == f_lower_above)
+      lower = q.flushing_discharge_high_tide;
+    else
+      upper = q.flushing_discharge_high_tide;
+  }
+  return 0.5 * (lower + upper);
+}
+
+int main(int argc, char *argv[]) {
+  int repeat = (argc > 1) ? atoi(argv[1]) : 20;
+
+  zsf_param_t p;
+  zsf_param_default(&p);
+  p.lock_length = 240.0;
+  p.lock_width = 12.0;
+  p.lock_bottom = -4.0;
+  p.salinity_sea = 25.0;
+  p.salinity_lake = 5.0;
+
+  int param = zsf_param_index("flushing_discharge_high_tide");
+  int result = zsf_result_index("salt_load_lake");
+  double lower = 0.0, upper = 20.0;
+
+  // Targets between the salt loads at the bounds
+  zsf_results_t results;
+  zsf_param_t q = p;
+  q.flushing_discharge_high_tide = lower;
+  zsf_calc_steady(&q, &results, NULL);
+  double load_lower = results.salt_load_lake;
+  q.flushing_discharge_high_tide = upper;
+  zsf_calc_steady(&q, &results, NULL);
+  double load_upper = results.salt_load_lake;
+
+  printf("%-12s %-14s %12s %8s %8s %10s %12s\n", "target", "method", "discharge", "probes",
+         "cycles", "us/call", "residual");
+
+  for (int k = 1; k <= 4; k++) {
+    double target = load_lower + 0.2 * k * (load_upper - load_lower);
+
+    for (int which = 0; which < 3; which++) {
+      double tolerance = (which == 1) ? 1E-3 : 0.0;
+      double value = 0.0;
+      int num_probes = 0, num_cycles = 0;
+
+      double t0 = timer_now();
+      for (int i = 0; i < repeat; i++) {
+        if (which < 2) {
+          zsf_inverse_stats_t stats;
+          int err = zsf_calc_steady_inverse(&p, param, lower, upper, result, target, tolerance,
+                                            NULL, &value, NULL, &stats);
+          if (err) {
+            fprintf(stderr, "%s\n", zsf_error_msg(err));
+            return 1;
+          }
+          num_probes = stats.num_probes;
+          num_cycles = stats.num_cycles;
+        } else {
+          value = bisection(&p, lower, upper, target, 1E-8, &num_probes, &num_cycles);
+        }
+      }
+      double t = (timer_now() - t0) / repeat * 1E6;
+
+      q = p;
+      q.flushing_discharge_high_tide = value;
+      zsf_calc_steady(&q, &results, NULL);
+
+      const char *method = (which == 0) ? "inverse" : (which == 1) ? "inverse-1e-3" : "bisection";
+      printf("%-12.6f %-14s %12.8f %8d %8d %10.1f %12.2e\n", target, method, value, num_probes,
+             num_cycles, t, results.salt_load_lake - target);
+    }
+  }
+
+  return 0;
+}
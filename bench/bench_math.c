@@ -0,0 +1,65 @@
+/*****************************************************************************
+ * bench_math.c: accuracy and throughput of the accuracy tiers of fastmath.h
+ *****************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "fastmath.h"
+
+// Keeps the compiler from optimizing away the calculations
+static volatile double sink;
+
+// Function, exact reference, and the range of arguments as they occur in the
+// phase kernels
+#define FUNCTIONS(X)                                                                               \
+  X(exp, exp, -50.0, 0.0)                                                                          \
+  X(cbrt, cbrt, 0.0, 100.0)                                                                        \
+  X(tanh, tanh, 0.0, 10.0)
+
+static const char *tier_names[] = {"exact", "fast", "fastest"};
+
+int main(int argc, char *argv[]) {
+  int n = (argc > 1) ? atoi(argv[1]) : 1000000;
+
+  double *x = (double *)malloc(n * sizeof(double));
+  double *y = (double *)malloc(n * sizeof(double));
+
+  printf("%d samples\n\n", n);
+  printf("%-6s %-8s %10s %14s %14s\n", "func", "tier", "ns/call", "max abs error",
+         "max rel error");
+
+  unsigned long long seed = 42;
+
+#define BENCH_FUNCTION(NAME, REFERENCE, LO, HI)                                                    \
+  for (int i = 0; i < n; i++) {                                                                    \
+    x[i] = bench_uniform(&seed, LO, HI);                                                           \
+  }                                                                                                \
+  for (int tier = ZSF_ACCURACY_EXACT; tier <= ZSF_ACCURACY_FASTEST; tier++) {                      \
+    double t0 = timer_now();                                                                       \
+    for (int i = 0; i < n; i++) {                                                                  \
+      y[i] = math_##NAME(tier, x[i]);                                                              \
+    }                                                                                              \
+    double t = timer_now() - t0;                                                                   \
+    double max_abs = 0.0, max_rel = 0.0;                                                           \
+    for (int i = 0; i < n; i++) {                                                                  \
+      double exact = REFERENCE(x[i]);                                                              \
+      double error = fabs(y[i] - exact);                                                           \
+      max_abs = fmax(max_abs, error);                                                              \
+      if (exact != 0.0)                                                                            \
+        max_rel = fmax(max_rel, error / fabs(exact));                                              \
+    }                                                                                              \
+    sink = y[n - 1];                                                                               \
+    printf("%-6s %-8s %10.2f %14.1e %14.1e\n", #NAME, tier_names[tier], 1E9 * t / n, max_abs,      \
+           max_rel);                                                                               \
+  }
+  FUNCTIONS(BENCH_FUNCTION)
+#undef BENCH_FUNCTION
+
+  free(x);
+  free(y);
+
+  return 0;
+}
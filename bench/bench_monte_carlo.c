@@ -0,0 +1,98 @@
+/*****************************************************************************
+ * bench_monte_carlo.c: throughput of a Monte Carlo run over uncertain ship
+ *                      volumes, sea salinity, density current factors and
+ *                      number of cycles
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "timer.h"
+#include "zsf.h"
+
+#define NUM_DISTRIBUTIONS 5
+#define NUM_QUANTILES 5
+
+int main(int argc, char *argv[]) {
+  int num_samples = (argc > 1) ? atoi(argv[1]) : 1000000;
+  int max_threads = (argc > 2) ? atoi(argv[2]) : 4;
+
+  zsf_param_t base;
+  zsf_param_default(&base);
+  base.lock_length = 240.0;
+  base.lock_width = 12.0;
+  base.lock_bottom = -4.0;
+  base.salinity_lake = 5.0;
+
+  zsf_distribution_t distributions[NUM_DISTRIBUTIONS] = {
+      {.param = zsf_param_index("ship_volume_sea_to_lake"),
+       .type = ZSF_DISTRIBUTION_UNIFORM,
+       .min = 0.0,
+       .max = 4000.0},
+      {.param = zsf_param_index("ship_volume_lake_to_sea"),
+       .type = ZSF_DISTRIBUTION_TRIANGULAR,
+       .min = 0.0,
+       .max = 4000.0,
+       .center = 1000.0},
+      {.param = zsf_param_index("salinity_sea"),
+       .type = ZSF_DISTRIBUTION_NORMAL,
+       .min = 15.0,
+       .max = 35.0,
+       .center = 25.0,
+       .std_dev = 2.0},
+      {.param = zsf_param_index("density_current_factor_sea"),
+       .type = ZSF_DISTRIBUTION_NORMAL,
+       .min = 0.0,
+       .max = 1.0,
+       .center = 0.8,
+       .std_dev = 0.2},
+      {.param = zsf_param_index("num_cycles"),
+       .type = ZSF_DISTRIBUTION_UNIFORM,
+       .min = 12.0,
+       .max = 36.0},
+  };
+  const double quantiles[NUM_QUANTILES] = {0.01, 0.05, 0.5, 0.95, 0.99};
+
+  printf("%d samples\n\n", num_samples);
+  printf("%-8s %10s %14s %12s %12s %12s\n", "threads", "time (s)", "samples/s", "mean", "p5",
+         "p95");
+
+  for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+    zsf_monte_carlo_t *monte_carlo;
+    zsf_monte_carlo_create(&base, distributions, NUM_DISTRIBUTIONS, 42, &monte_carlo);
+
+    zsf_options_t options;
+    zsf_options_default(&options);
+    options.num_threads = num_threads;
+
+    double t0 = timer_now();
+    int err = zsf_monte_carlo_run(monte_carlo, num_samples, &options);
+    double t = timer_now() - t0;
+    if (err) {
+      fprintf(stderr, "%s\n", zsf_error_msg(err));
+      return 1;
+    }
+
+    zsf_monte_carlo_stats_t stats;
+    zsf_results_t p5, p95;
+    zsf_monte_carlo_get_stats(monte_carlo, &stats);
+    zsf_monte_carlo_quantile(monte_carlo, 0.05, &p5);
+    zsf_monte_carlo_quantile(monte_carlo, 0.95, &p95);
+
+    printf("%-8d %10.3f %14.0f %12.4f %12.4f %12.4f\n", num_threads, t, num_samples / t,
+           stats.mean.salt_load_lake, p5.salt_load_lake, p95.salt_load_lake);
+
+    if (num_threads * 2 > max_threads) {
+      printf("\n%-10s %16s\n", "quantile", "salt_load_lake");
+      for (int i = 0; i < NUM_QUANTILES; i++) {
+        zsf_results_t q;
+        zsf_monte_carlo_quantile(monte_carlo, quantiles[i], &q);
+        printf("%-10.2f %16.4f\n", quantiles[i], q.salt_load_lake);
+      }
+    }
+
+    zsf_monte_carlo_free(monte_carlo);
+  }
+
+  return 0;
+}
@@ -0,0 +1,123 @@
+/*****************************************************************************
+ * bench_operation.c: years of lock operation with random ship traffic, for
+ *                    a range of traffic scenarios on a tidal sea
+ *****************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "timer.h"
+#include "zsf.h"
+
+#define HOURS_PER_YEAR (365 * 24)
+
+int main(int argc, char *argv[]) {
+  int num_years = (argc > 1) ? atoi(argv[1]) : 1;
+  int num_scenarios = (argc > 2) ? atoi(argv[2]) : 8;
+
+  zsf_param_t p;
+  zsf_param_default(&p);
+  p.lock_length = 240.0;
+  p.lock_width = 12.0;
+  p.lock_bottom = -4.0;
+  p.salinity_sea = 25.0;
+  p.salinity_lake = 5.0;
+
+  // A semi-diurnal tide, and a sea salinity that varies over the seasons
+  int num_boundaries = num_years * HOURS_PER_YEAR;
+  double *head_sea = (double *)malloc(num_boundaries * sizeof(double));
+  double *salinity_sea = (double *)malloc(num_boundaries * sizeof(double));
+  for (int k = 0; k < num_boundaries; k++) {
+    head_sea[k] = 1.5 * sin(2.0 * M_PI * k / 12.42);
+    salinity_sea[k] = 25.0 + 3.0 * sin(2.0 * M_PI * k / HOURS_PER_YEAR);
+  }
+  zsf_param_columns_t boundaries = {0};
+  boundaries.head_sea = head_sea;
+  boundaries.salinity_sea = salinity_sea;
+
+  int max_events = num_years * 200000;
+  zsf_operation_event_t *events =
+      (zsf_operation_event_t *)malloc(max_events * sizeof(zsf_operation_event_t));
+  double duration = num_years * HOURS_PER_YEAR * 3600.0;
+
+  printf("%d year(s) of operation\n\n", num_years);
+  printf("%-10s %10s %10s %10s %12s %14s %10s %12s\n", "ships/h", "lockages", "empty", "events",
+         "wait (min)", "salt (t/year)", "time (s)", "events/s");
+
+  for (int s = 0; s < num_scenarios; s++) {
+    zsf_traffic_t traffic;
+    zsf_traffic_default(&traffic);
+    traffic.arrival_rate_lake = 0.5 * (s + 1);
+    traffic.arrival_rate_sea = 0.5 * (s + 1);
+    traffic.ship_volume_max = 1500.0;
+    traffic.time_per_ship = 180.0;
+    traffic.max_head_difference = 1.2;
+
+    zsf_phase_state_t state;
+    zsf_initialize_state(&p, &state, 15.0, p.head_sea);
+    zsf_operation_stats_t stats;
+
+    double t0 = timer_now();
+    int err = zsf_simulate_operation(&p, &boundaries, 1, num_boundaries, 3600.0, &traffic,
+                                     duration, s, &state, events, max_events, &stats, NULL);
+    double t = timer_now() - t0;
+    if (err) {
+      fprintf(stderr, "%s\n", zsf_error_msg(err));
+      return 1;
+    }
+
+    double salt = -stats.total.mass_transport_lake / num_years * 1E-3;
+    printf("%-10.1f %10lld %10lld %10lld %12.1f %14.0f %10.4f %12.0f\n",
+           traffic.arrival_rate_lake + traffic.arrival_rate_sea, stats.num_lockages,
+           stats.num_empty_lockages, stats.num_events, stats.mean_waiting_time / 60.0, salt, t,
+           stats.num_events / t);
+  }
+
+  // The share of the time in the phase kernels, from a replay of the last
+  // scenario's routines
+  zsf_phase_state_t state;
+  zsf_initialize_state(&p, &state, 15.0, p.head_sea);
+  zsf_traffic_t traffic;
+  zsf_traffic_default(&traffic);
+  zsf_operation_stats_t stats;
+
+  double t0 = timer_now();
+  zsf_simulate_operation(&p, NULL, 1, 0, 3600.0, &traffic, duration, 0, &state, events,
+                         max_events, &stats, NULL);
+  double t_simulate = timer_now() - t0;
+
+  int n = (stats.num_events < max_events) ? (int)stats.num_events : max_events;
+  int *routines = (int *)malloc(n * sizeof(int));
+  double *durations = (double *)malloc(n * sizeof(double));
+  double *volume_lake_to_sea = (double *)malloc(n * sizeof(double));
+  double *volume_sea_to_lake = (double *)malloc(n * sizeof(double));
+  for (int i = 0; i < n; i++) {
+    routines[i] = events[i].routine;
+    durations[i] = events[i].duration;
+    double volume = events[i].ship_volume;
+    volume_lake_to_sea[i] = (routines[i] == ZSF_ROUTINE_DOOR_OPEN_LAKE) ? volume : 0.0;
+    volume_sea_to_lake[i] = (routines[i] == ZSF_ROUTINE_DOOR_OPEN_SEA) ? volume : 0.0;
+  }
+  zsf_param_columns_t ships = {0};
+  ships.ship_volume_lake_to_sea = volume_lake_to_sea;
+  ships.ship_volume_sea_to_lake = volume_sea_to_lake;
+
+  zsf_initialize_state(&p, &state, 15.0, p.head_sea);
+  t0 = timer_now();
+  zsf_run_lockages(&p, &ships, 1, routines, durations, n, &state, NULL, NULL, NULL);
+  double t_replay = timer_now() - t0;
+
+  printf("\n%d routines: simulated in %.4f s, of which %.4f s in the phase kernels\n", n,
+         t_simulate, t_replay);
+
+  free(head_sea);
+  free(salinity_sea);
+  free(events);
+  free(routines);
+  free(durations);
+  free(volume_lake_to_sea);
+  free(volume_sea_to_lake);
+
+  return 0;
+}
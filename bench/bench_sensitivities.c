@@ -0,0 +1,123 @@
+/*****************************************************************************
+ * bench_sensitivities.c: sensitivities of the steady state by implicit
+ *                         differentiation versus finite differences of solves
+ *****************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "timer.h"
+#include "zsf.h"
+
+#define NUM_PARAMS 6
+
+static const char *param_names[NUM_PARAMS] = {
+    "calibration_coefficient",      "symmetry_coefficient",
+    "density_current_factor_sea",   "density_current_factor_lake",
+    "flushing_discharge_high_tide", "flushing_discharge_low_tide"};
+
+// Central differences of full solves, with a step of which the truncation
+// error is below the (tight) tolerance of the solves
+static void finite_differences(const zsf_param_t *p, const int *params, int num_params,
+                               zsf_results_t *sensitivities) {
+  for (int j = 0; j < num_params; j++) {
+    zsf_param_t q = *p;
+    double *x = &((double *)&q)[params[j]];
+    double x0 = *x;
+    double h = 1E-4 * fmax(fabs(x0), 1.0);
+
+    zsf_results_t plus, minus;
+    *x = x0 + h;
+    zsf_calc_steady(&q, &plus, NULL);
+    *x = x0 - h;
+    zsf_calc_steady(&q, &minus, NULL);
+
+    sensitivities[j].salt_load_lake = (plus.salt_load_lake - minus.salt_load_lake) / (2.0 * h);
+  }
+}
+
+static double time_per_call(int which, const zsf_param_t *p, const int *params, int num_params,
+                            int repeat, zsf_results_t *sensitivities) {
+  zsf_results_t results;
+
+  double t0 = timer_now();
+  for (int i = 0; i < repeat; i++) {
+    if (which == 0)
+      zsf_calc_steady(p, &results, NULL);
+    else if (which == 1)
+      zsf_calc_steady_sensitivities(p, params, num_params, NULL, &results, sensitivities, NULL);
+    else
+      finite_differences(p, params, num_params, sensitivities);
+  }
+  return (timer_now() - t0) / repeat * 1E6;
+}
+
+#define NUM_ALL_PARAMS ((int)(sizeof(zsf_param_t) / sizeof(double)))
+
+static void bench(const char *name, const zsf_param_t *p, int repeat) {
+  int params[NUM_PARAMS];
+  for (int j = 0; j < NUM_PARAMS; j++) {
+    params[j] = zsf_param_index(param_names[j]);
+  }
+
+  // All parameters, of which some have no influence at all
+  int all_params[NUM_ALL_PARAMS];
+  for (int j = 0; j < NUM_ALL_PARAMS; j++) {
+    all_params[j] = j;
+  }
+
+  zsf_results_t implicit[NUM_ALL_PARAMS], fd[NUM_PARAMS];
+  zsf_steady_stats_t stats;
+  zsf_results_t results;
+  zsf_calc_steady_sensitivities(p, params, NUM_PARAMS, NULL, &results, implicit, &stats);
+  finite_differences(p, params, NUM_PARAMS, fd);
+
+  printf("%s lock, %d cycles per solve\n\n", name, stats.num_cycles);
+  printf("%-30s %16s %16s %10s\n", "d salt_load_lake / d", "implicit", "differences", "rel diff");
+  for (int j = 0; j < NUM_PARAMS; j++) {
+    double a = implicit[j].salt_load_lake;
+    double b = fd[j].salt_load_lake;
+    printf("%-30s %16.8e %16.8e %10.1e\n", param_names[j], a, b,
+           (b != 0.0) ? fabs(a - b) / fabs(b) : fabs(a));
+  }
+
+  double t_solve = time_per_call(0, p, params, NUM_PARAMS, repeat, implicit);
+  double t_implicit = time_per_call(1, p, params, NUM_PARAMS, repeat, implicit);
+  double t_fd = time_per_call(2, p, params, NUM_PARAMS, repeat, fd);
+  double t_implicit_all = time_per_call(1, p, all_params, NUM_ALL_PARAMS, repeat, implicit);
+
+  printf("\n%-40s %10s\n", "", "us/call");
+  printf("%-40s %10.1f\n", "solve", t_solve);
+  printf("%-40s %10.1f\n", "implicit, 6 parameters", t_implicit);
+  printf("%-40s %10.1f\n", "finite differences, 6 parameters", t_fd);
+  printf("%-40s %10.1f\n\n", "implicit, all parameters", t_implicit_all);
+}
+
+int main(int argc, char *argv[]) {
+  int repeat = (argc > 1) ? atoi(argv[1]) : 100;
+
+  zsf_param_t p;
+  zsf_param_default(&p);
+  p.lock_length = 240.0;
+  p.lock_width = 12.0;
+  p.lock_bottom = -4.0;
+  p.head_sea = 0.5;
+  p.ship_volume_sea_to_lake = 1000.0;
+  p.flushing_discharge_high_tide = 0.5;
+  p.density_current_factor_sea = 0.5;
+  p.density_current_factor_lake = 0.5;
+  p.rtol = 1E-12;
+  p.atol = 1E-13;
+
+  bench("A quickly converging", &p, repeat);
+
+  // A poor exchange needs many more cycles to converge
+  p.num_cycles = 96.0;
+  p.density_current_factor_sea = 0.1;
+  p.density_current_factor_lake = 0.1;
+
+  bench("A slowly converging", &p, repeat);
+
+  return 0;
+}
@@ -0,0 +1,120 @@
+/*****************************************************************************
+ * bench_series.c: a tidal time series of steady states, with a cold start of
+ *                  every step and with the warm start of
+ *                  zsf_calc_steady_series
+ *****************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "timer.h"
+#include "zsf.h"
+
+#define PI 3.14159265358979323846
+#define TIDAL_PERIOD 12.42
+
+typedef struct series_t {
+  double seconds;
+  long long total_cycles;
+  int num_failed;
+} series_t;
+
+static void run_series(const zsf_param_t *base, const zsf_param_columns_t *columns, int n,
+                       const zsf_options_t *options, double *salt_load_lake, series_t *s) {
+  int *errors = (int *)malloc(n * sizeof(int));
+  int *num_cycles = (int *)malloc(n * sizeof(int));
+
+  zsf_results_columns_t results = {0};
+  results.salt_load_lake = salt_load_lake;
+
+  double t0 = timer_now();
+  zsf_calc_steady_series(base, columns, 1, &results, 1, errors, num_cycles, n, options);
+  s->seconds = timer_now() - t0;
+
+  s->total_cycles = 0;
+  s->num_failed = 0;
+  for (int i = 0; i < n; i++) {
+    s->total_cycles += num_cycles[i];
+    s->num_failed += (errors[i] != 0);
+  }
+
+  free(errors);
+  free(num_cycles);
+}
+
+int main(int argc, char *argv[]) {
+  int days = (argc > 1) ? atoi(argv[1]) : 365;
+  int steps_per_hour = (argc > 2) ? atoi(argv[2]) : 4;
+  int n = days * 24 * steps_per_hour;
+
+  // A lock with a poor exchange, such that the steady state needs many
+  // cycles to converge
+  zsf_param_t base;
+  zsf_param_default(&base);
+  base.num_cycles = 96.0;
+  base.density_current_factor_sea = 0.1;
+  base.density_current_factor_lake = 0.1;
+  base.rtol = 1E-8;
+  base.atol = 1E-10;
+
+  double *head_sea = (double *)malloc(n * sizeof(double));
+  double *salinity_sea = (double *)malloc(n * sizeof(double));
+  double *cold_start = (double *)malloc(n * sizeof(double));
+  double *load_cold = (double *)malloc(n * sizeof(double));
+  double *load_warm = (double *)malloc(n * sizeof(double));
+
+  for (int i = 0; i < n; i++) {
+    double phase = 2.0 * PI * i / (steps_per_hour * TIDAL_PERIOD);
+    head_sea[i] = 1.5 * sin(phase);
+    salinity_sea[i] = 25.0 + 3.0 * sin(phase - 1.0);
+    cold_start[i] = ZSF_NAN;
+  }
+
+  zsf_param_columns_t columns = {0};
+  columns.head_sea = head_sea;
+  columns.salinity_sea = salinity_sea;
+
+  printf("%d days, %d steps per hour\n\n", days, steps_per_hour);
+  printf("%-8s %-6s %14s %12s %10s %8s %12s\n", "solver", "start", "cycles", "cycles/step",
+         "seconds", "failed", "max diff");
+
+  const char *solver_names[] = {"picard", "aitken"};
+  const int solvers[] = {ZSF_SOLVER_PICARD, ZSF_SOLVER_AITKEN};
+
+  for (int k = 0; k < 2; k++) {
+    zsf_options_t options;
+    zsf_options_default(&options);
+    options.solver = solvers[k];
+
+    // A column of ZSF_NAN lock salinities gives the cold start of
+    // zsf_calc_steady for every step
+    series_t cold, warm;
+    columns.salinity_lock = cold_start;
+    run_series(&base, &columns, n, &options, load_cold, &cold);
+    columns.salinity_lock = NULL;
+    run_series(&base, &columns, n, &options, load_warm, &warm);
+
+    double max_diff = 0.0;
+    for (int i = 0; i < n; i++) {
+      max_diff = fmax(max_diff, fabs(load_warm[i] - load_cold[i]));
+    }
+
+    printf("%-8s %-6s %14lld %12.2f %10.3f %8d\n", solver_names[k], "cold", cold.total_cycles,
+           (double)cold.total_cycles / n, cold.seconds, cold.num_failed);
+    printf("%-8s %-6s %14lld %12.2f %10.3f %8d %12.1e\n", solver_names[k], "warm",
+           warm.total_cycles, (double)warm.total_cycles / n, warm.seconds, warm.num_failed,
+           max_diff);
+    printf("%-8s saved %.1f%% of the cycles, speedup %.2f\n\n", solver_names[k],
+           100.0 * (cold.total_cycles - warm.total_cycles) / cold.total_cycles,
+           cold.seconds / warm.seconds);
+  }
+
+  free(head_sea);
+  free(salinity_sea);
+  free(cold_start);
+  free(load_cold);
+  free(load_warm);
+
+  return 0;
+}
@@ -0,0 +1,139 @@
+/*****************************************************************************
+ * bench_solver.c: cycles and time needed by the steady state solvers
+ *****************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "zsf.h"
+
+// The parameter sets of wrappers/python/tests/test_steady.py, as changes
+// versus the reference parameters.
+#define SCENARIOS(X)                                                                               \
+  X(reference, )                                                                                   \
+  X(high_head, p->head_lake = 4.0; p->head_sea = 4.0;)                                             \
+  X(low_bottom, p->lock_bottom = -8.0;)                                                            \
+  X(higher_bottom, p->lock_bottom = -2.0;)                                                         \
+  X(sal_gap_smaller, p->salinity_lake = 10.0; p->salinity_sea = 20.0;)                             \
+  X(sal_gap_wider, p->salinity_lake = 0.0; p->salinity_sea = 30.0;)                                \
+  X(lock_longer, p->lock_length = 480.0;)                                                          \
+  X(lock_wider, p->lock_width = 24.0;)                                                             \
+  X(num_cycles_54, p->num_cycles = 54.0;)                                                          \
+  X(num_cycles_8, p->num_cycles = 8.0;)                                                            \
+  X(door_quick_open, p->door_time_to_open = 0.0;)                                                  \
+  X(door_quick_level, p->leveling_time = 0.0;)                                                     \
+  X(calibration, p->num_cycles = 14.4; p->calibration_coefficient = 0.5;)                          \
+  X(symmetry_0_5, p->symmetry_coefficient = 0.5;)                                                  \
+  X(symmetry_1_5, p->symmetry_coefficient = 1.5;)                                                  \
+  X(ship_sea_to_lake, p->ship_volume_sea_to_lake = 5000.0;)                                        \
+  X(ship_lake_to_sea, p->ship_volume_lake_to_sea = 5000.0;)                                        \
+  X(ship_both, p->ship_volume_sea_to_lake = 5000.0; p->ship_volume_lake_to_sea = 5000.0;)          \
+  X(bubble_50, p->density_current_factor_sea = 0.5; p->density_current_factor_lake = 0.5;)         \
+  X(bubble_25, p->density_current_factor_sea = 0.25; p->density_current_factor_lake = 0.25;)       \
+  X(flushing_low_tide_eq, p->flushing_discharge_low_tide = 1.0;)                                   \
+  X(flushing_high_tide_eq, p->flushing_discharge_high_tide = 1.0;)                                 \
+  X(low_tide, p->head_sea = -2.0;)                                                                 \
+  X(high_tide, p->head_sea = 2.0;)                                                                 \
+  X(flushing_low_tide, p->head_sea = -2.0; p->flushing_discharge_low_tide = 1.0;)                  \
+  X(flushing_high_tide, p->head_sea = 2.0; p->flushing_discharge_high_tide = 1.0;)                 \
+  X(sill_sea, p->sill_height_sea = 1.0;)                                                           \
+  X(sill_lake, p->sill_height_lake = 1.0;)                                                         \
+  X(bubble_distance_sea, p->density_current_factor_sea = 0.25;                                     \
+    p->density_current_factor_lake = 0.25; p->distance_door_bubble_screen_sea = 4.0;)              \
+  X(bubble_distance_lake, p->density_current_factor_sea = 0.25;                                    \
+    p->density_current_factor_lake = 0.25; p->distance_door_bubble_screen_lake = 4.0;)
+
+static void reference_parameters(zsf_param_t *p) {
+  zsf_param_default(p);
+
+  p->lock_length = 240.0;
+  p->lock_width = 12.0;
+  p->lock_bottom = -4.0;
+  p->num_cycles = 24.0;
+  p->door_time_to_open = 300.0;
+  p->leveling_time = 300.0;
+  p->calibration_coefficient = 1.0;
+  p->symmetry_coefficient = 1.0;
+  p->ship_volume_sea_to_lake = 0.0;
+  p->ship_volume_lake_to_sea = 0.0;
+  p->head_sea = 0.0;
+  p->salinity_sea = 25.0;
+  p->temperature_sea = 15.0;
+  p->head_lake = 0.0;
+  p->salinity_lake = 5.0;
+  p->temperature_lake = 15.0;
+  p->flushing_discharge_high_tide = 0.0;
+  p->flushing_discharge_low_tide = 0.0;
+  p->density_current_factor_sea = 1.0;
+  p->density_current_factor_lake = 1.0;
+}
+
+// Time per calculation in microseconds, best of a few repetitions
+static double run(const zsf_param_t *p, int solver, int repeat, zsf_results_t *results,
+                  zsf_steady_stats_t *stats) {
+  zsf_options_t options;
+  zsf_options_default(&options);
+  options.solver = solver;
+
+  double best;
+  BENCH_BEST_OF(best, 3, for (int i = 0; i < repeat; i++) {
+    zsf_calc_steady_ex(p, &options, results, NULL, stats);
+  });
+  return best / repeat * 1E6;
+}
+
+static void bench(const char *name, const zsf_param_t *p, int repeat, double totals[4]) {
+  zsf_results_t r_picard, r_aitken;
+  zsf_steady_stats_t s_picard, s_aitken;
+
+  double t_picard = run(p, ZSF_SOLVER_PICARD, repeat, &r_picard, &s_picard);
+  double t_aitken = run(p, ZSF_SOLVER_AITKEN, repeat, &r_aitken, &s_aitken);
+
+  double rel_diff =
+      fabs(r_aitken.salt_load_lake - r_picard.salt_load_lake) / fabs(r_picard.salt_load_lake);
+
+  printf("%-22s %8d %8d %10.2f %10.2f %9.2f %10.1e\n", name, s_picard.num_cycles,
+         s_aitken.num_cycles, t_picard, t_aitken, t_picard / t_aitken, rel_diff);
+
+  totals[0] += s_picard.num_cycles;
+  totals[1] += s_aitken.num_cycles;
+  totals[2] += t_picard;
+  totals[3] += t_aitken;
+}
+
+int main(int argc, char *argv[]) {
+  int repeat = (argc > 1) ? atoi(argv[1]) : 1000;
+
+  // Tighter tolerances show how the solvers scale, the defaults how they
+  // compare in practice.
+  const double rtols[] = {1E-5, 1E-12};
+  const double atols[] = {1E-8, 1E-14};
+
+  for (int k = 0; k < 2; k++) {
+    printf("rtol = %.0e, atol = %.0e\n\n", rtols[k], atols[k]);
+    printf("%-22s %8s %8s %10s %10s %9s %10s\n", "scenario", "picard", "aitken", "picard us",
+           "aitken us", "speedup", "rel diff");
+
+    double totals[4] = {0.0};
+
+#define BENCH_SCENARIO(NAME, CHANGES)                                                              \
+  {                                                                                                \
+    zsf_param_t params;                                                                            \
+    zsf_param_t *p = &params;                                                                      \
+    reference_parameters(p);                                                                       \
+    p->rtol = rtols[k];                                                                            \
+    p->atol = atols[k];                                                                            \
+    CHANGES                                                                                        \
+    bench(#NAME, p, repeat, totals);                                                               \
+  }
+    SCENARIOS(BENCH_SCENARIO)
+#undef BENCH_SCENARIO
+
+    printf("%-22s %8.0f %8.0f %10.2f %10.2f %9.2f\n\n", "total", totals[0], totals[1], totals[2],
+           totals[3], totals[2] / totals[3]);
+  }
+
+  return 0;
+}
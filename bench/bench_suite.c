@@ -0,0 +1,290 @@
+/*****************************************************************************
+ * bench_suite.c: the time per call of the phase kernels, the density and the
+ *                steady state solve in representative regimes, as a table
+ *                and as JSON to compare between commits
+ *****************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "util.h"
+#include "zsf.h"
+
+// Keeps the compiler from optimizing away the calculations
+static volatile double sink;
+
+// A regime of lock operation, as changes to the base parameters
+typedef struct regime_t {
+  const char *name;
+  void (*apply)(zsf_param_t *p);
+} regime_t;
+
+static void no_mitigation(zsf_param_t *p) { (void)p; }
+
+static void heavy_flushing(zsf_param_t *p) {
+  p->flushing_discharge_high_tide = 5.0;
+  p->flushing_discharge_low_tide = 5.0;
+}
+
+static void bubble_screens(zsf_param_t *p) {
+  p->density_current_factor_sea = 0.25;
+  p->density_current_factor_lake = 0.25;
+  p->distance_door_bubble_screen_sea = 10.0;
+  p->distance_door_bubble_screen_lake = 10.0;
+  p->flushing_discharge_high_tide = 1.0;
+  p->flushing_discharge_low_tide = 1.0;
+}
+
+static void sills(zsf_param_t *p) {
+  p->sill_height_sea = 1.5;
+  p->sill_height_lake = 1.5;
+}
+
+static void all_measures(zsf_param_t *p) {
+  bubble_screens(p);
+  heavy_flushing(p);
+  sills(p);
+}
+
+static void high_tide(zsf_param_t *p) { p->head_sea = 1.5; }
+
+static void low_tide(zsf_param_t *p) { p->head_sea = -1.5; }
+
+static const regime_t regimes[] = {
+    {"no_mitigation", no_mitigation}, {"heavy_flushing", heavy_flushing},
+    {"bubble_screens", bubble_screens}, {"sills", sills},
+    {"all_measures", all_measures}, {"high_tide", high_tide},
+    {"low_tide", low_tide},
+};
+
+#define NUM_REGIMES (int)(sizeof(regimes) / sizeof(regimes[0]))
+
+// A measurement, of which the steady state solves also have the number of
+// cycles per solve (the iterations of the solver) and the time per cycle
+typedef struct result_t {
+  char name[32];
+  const char *regime;
+  double ns_per_call;
+  double cycles_per_solve;
+  double ns_per_cycle;
+} result_t;
+
+#define MAX_RESULTS 128
+
+static result_t results[MAX_RESULTS];
+static int num_results = 0;
+
+static result_t *add_result(const char *name, const char *regime, double ns_per_call) {
+  result_t *r = &results[num_results++];
+  snprintf(r->name, sizeof(r->name), "%s", name);
+  r->regime = regime;
+  r->ns_per_call = ns_per_call;
+  r->cycles_per_solve = 0.0;
+  r->ns_per_cycle = 0.0;
+  return r;
+}
+
+// The phase kernels through the public API, every call from the same state
+typedef int (*step_fn)(const zsf_param_t *p, double t, zsf_phase_state_t *state,
+                       zsf_phase_transports_t *results);
+
+static double time_step(step_fn step, const zsf_param_t *p, double t,
+                        const zsf_phase_state_t *initial, double min_time) {
+  double best;
+  BENCH_UNTIL(best, min_time, n, 64, for (long long i = 0; i < n; i++) {
+    zsf_phase_state_t state = *initial;
+    zsf_phase_transports_t transports;
+    step(p, t, &state, &transports);
+    sink = transports.mass_transport_lake;
+  });
+  return 1E9 * best;
+}
+
+static double time_density(double min_time) {
+  // Salinities in kg/m3 and temperatures as they occur in the lake and the sea
+  enum { N = 1024 };
+  double sal[N], temp[N];
+  for (int i = 0; i < N; i++) {
+    sal[i] = 35.0 * i / (N - 1);
+    temp[i] = 5.0 + 20.0 * ((i * 7) % N) / (N - 1);
+  }
+
+  zsf_param_t p;
+  zsf_param_default(&p);
+
+  double best;
+  BENCH_UNTIL(best, min_time, n, 1, for (long long k = 0; k < n; k++) {
+    for (int i = 0; i < N; i++) {
+      sink = sal_2_density(sal[i], temp[i], p.rtol, p.atol);
+    }
+  });
+  return 1E9 * best / N;
+}
+
+static void time_steady(const zsf_param_t *p, int solver, const char *name, const char *regime,
+                        double min_time) {
+  zsf_options_t options;
+  zsf_options_default(&options);
+  options.solver = solver;
+
+  zsf_results_t steady;
+  zsf_steady_stats_t stats;
+  double best;
+  BENCH_UNTIL(best, min_time, n, 1, for (long long i = 0; i < n; i++) {
+    zsf_calc_steady_ex(p, &options, &steady, NULL, &stats);
+    sink = steady.salt_load_lake;
+  });
+
+  result_t *r = add_result(name, regime, 1E9 * best);
+  r->cycles_per_solve = stats.num_cycles;
+  r->ns_per_cycle = r->ns_per_call / stats.num_cycles;
+}
+
+static void print_json_string(FILE *f, const char *s) {
+  fputc('"', f);
+  for (; *s; s++) {
+    if (*s == '"' || *s == '\\')
+      fputc('\\', f);
+    fputc(*s, f);
+  }
+  fputc('"', f);
+}
+
+static int write_json(const char *path, double min_time) {
+  FILE *f = fopen(path, "w");
+  if (f == NULL)
+    return 0;
+
+  fprintf(f, "{\n  \"version\": ");
+  print_json_string(f, zsf_version());
+  fprintf(f, ",\n  \"cpu_variant\": ");
+  print_json_string(f, zsf_cpu_variant());
+  fprintf(f, ",\n  \"min_time\": %g,\n", min_time);
+
+  // The build options that change the timings
+  fprintf(f, "  \"config\": {\n");
+#ifdef ZSF_NO_FORCEINLINE
+  fprintf(f, "    \"forceinline\": false,\n");
+#else
+  fprintf(f, "    \"forceinline\": true,\n");
+#endif
+#ifdef ZSF_USE_DENSITY_TABLE
+  fprintf(f, "    \"density_table\": true,\n");
+#else
+  fprintf(f, "    \"density_table\": false,\n");
+#endif
+#ifdef __FAST_MATH__
+  fprintf(f, "    \"fast_math\": true,\n");
+#else
+  fprintf(f, "    \"fast_math\": false,\n");
+#endif
+  fprintf(f, "    \"stats\": %s\n", zsf_counters_enabled() ? "true" : "false");
+  fprintf(f, "  },\n");
+
+  fprintf(f, "  \"results\": [\n");
+  for (int i = 0; i < num_results; i++) {
+    const result_t *r = &results[i];
+    fprintf(f, "    {\"name\": ");
+    print_json_string(f, r->name);
+    fprintf(f, ", \"regime\": ");
+    print_json_string(f, r->regime);
+    fprintf(f, ", \"ns_per_call\": %.3f", r->ns_per_call);
+    if (r->cycles_per_solve > 0.0)
+      fprintf(f, ", \"cycles_per_solve\": %g, \"ns_per_cycle\": %.3f", r->cycles_per_solve,
+              r->ns_per_cycle);
+    fprintf(f, "}%s\n", (i + 1 < num_results) ? "," : "");
+  }
+  fprintf(f, "  ]\n}\n");
+
+  int ok = !ferror(f);
+  return fclose(f) == 0 && ok;
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: zsf-bench [--json path] [--min-time seconds] [--regime name]\n");
+}
+
+int main(int argc, char *argv[]) {
+  const char *json_path = NULL;
+  const char *only_regime = NULL;
+  double min_time = 0.05;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+      json_path = argv[++i];
+    } else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+      min_time = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--regime") == 0 && i + 1 < argc) {
+      only_regime = argv[++i];
+    } else {
+      usage();
+      return 1;
+    }
+  }
+
+  zsf_param_t base;
+  zsf_param_default(&base);
+  base.lock_length = 240.0;
+  base.lock_width = 12.0;
+  base.lock_bottom = -4.0;
+  base.num_cycles = 24.0;
+  base.head_sea = 0.5;
+  base.salinity_sea = 25.0;
+  base.salinity_lake = 5.0;
+  base.ship_volume_sea_to_lake = 1000.0;
+  base.ship_volume_lake_to_sea = 1000.0;
+
+  printf("zsf %s (%s)\n\n", zsf_version(), zsf_cpu_variant());
+  printf("%-24s %-16s %12s %14s %12s\n", "name", "regime", "ns/call", "cycles/solve",
+         "ns/cycle");
+
+  add_result("sal_2_density", "all", time_density(min_time));
+
+  for (int k = 0; k < NUM_REGIMES; k++) {
+    const regime_t *regime = &regimes[k];
+    if (only_regime != NULL && strcmp(only_regime, regime->name) != 0)
+      continue;
+
+    zsf_param_t p = base;
+    regime->apply(&p);
+
+    // Every phase starts from the state at the end of the phase before it
+    zsf_phase_state_t at_sea, at_lake;
+    zsf_initialize_state(&p, &at_sea, 15.0, p.head_sea);
+    zsf_initialize_state(&p, &at_lake, 15.0, p.head_lake);
+    at_sea.volume_ship_in_lock = p.ship_volume_sea_to_lake;
+    at_lake.volume_ship_in_lock = p.ship_volume_lake_to_sea;
+
+    add_result("step_phase_1", regime->name,
+               time_step(zsf_step_phase_1, &p, p.leveling_time, &at_sea, min_time));
+    add_result("step_phase_2", regime->name,
+               time_step(zsf_step_phase_2, &p, 1800.0, &at_lake, min_time));
+    add_result("step_phase_3", regime->name,
+               time_step(zsf_step_phase_3, &p, p.leveling_time, &at_lake, min_time));
+    add_result("step_phase_4", regime->name,
+               time_step(zsf_step_phase_4, &p, 1800.0, &at_sea, min_time));
+    add_result("step_flush_doors_closed", regime->name,
+               time_step(zsf_step_flush_doors_closed, &p, 1800.0, &at_lake, min_time));
+
+    time_steady(&p, ZSF_SOLVER_PICARD, "calc_steady", regime->name, min_time);
+    time_steady(&p, ZSF_SOLVER_AITKEN, "calc_steady_aitken", regime->name, min_time);
+  }
+
+  for (int i = 0; i < num_results; i++) {
+    const result_t *r = &results[i];
+    printf("%-24s %-16s %12.1f", r->name, r->regime, r->ns_per_call);
+    if (r->cycles_per_solve > 0.0)
+      printf(" %14.0f %12.1f", r->cycles_per_solve, r->ns_per_cycle);
+    printf("\n");
+  }
+
+  if (json_path != NULL && !write_json(json_path, min_time)) {
+    fprintf(stderr, "Could not write %s\n", json_path);
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,107 @@
+/*****************************************************************************
+ * bench_surrogate.c: interpolating in a surrogate versus running the solver
+ *****************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "zsf.h"
+
+#define NUM_AXES 4
+
+int main(int argc, char *argv[]) {
+  int num_queries = (argc > 1) ? atoi(argv[1]) : 100000;
+  int num_threads = (argc > 2) ? atoi(argv[2]) : 0;
+
+  zsf_param_t base;
+  zsf_param_default(&base);
+  base.lock_length = 240.0;
+  base.lock_width = 12.0;
+  base.lock_bottom = -4.0;
+
+  zsf_surrogate_axis_t axes[NUM_AXES] = {
+      {zsf_param_index("head_sea"), 17, -2.0, 2.0},
+      {zsf_param_index("salinity_sea"), 11, 20.0, 30.0},
+      {zsf_param_index("salinity_lake"), 11, 0.0, 10.0},
+      {zsf_param_index("ship_volume_sea_to_lake"), 9, 0.0, 4000.0},
+  };
+
+  zsf_options_t options;
+  zsf_options_default(&options);
+  options.num_threads = num_threads;
+
+  zsf_surrogate_t *surrogate;
+  double t0 = timer_now();
+  int err = zsf_surrogate_create(&base, axes, NUM_AXES, 10000, &options, &surrogate);
+  double t_create = timer_now() - t0;
+  if (surrogate == NULL) {
+    fprintf(stderr, "%s\n", zsf_error_msg(err));
+    return 1;
+  }
+
+  int num_points = 1;
+  for (int a = 0; a < NUM_AXES; a++) {
+    num_points *= axes[a].num_points;
+  }
+  printf("%d grid points, created in %.3f s (%s)\n\n", num_points, t_create, zsf_error_msg(err));
+
+  // Random queries, and the exact results at a subset of them
+  double *x = (double *)malloc((size_t)num_queries * NUM_AXES * sizeof(double));
+  unsigned long long seed = 42;
+  for (int i = 0; i < num_queries * NUM_AXES; i++) {
+    const zsf_surrogate_axis_t *axis = &axes[i % NUM_AXES];
+    x[i] = bench_uniform(&seed, axis->min, axis->max);
+  }
+
+  int num_exact = (num_queries < 2000) ? num_queries : 2000;
+  zsf_results_t *exact = (zsf_results_t *)malloc(num_exact * sizeof(zsf_results_t));
+
+  t0 = timer_now();
+  for (int i = 0; i < num_exact; i++) {
+    zsf_param_t p = base;
+    for (int a = 0; a < NUM_AXES; a++) {
+      ((double *)&p)[axes[a].param] = x[i * NUM_AXES + a];
+    }
+    zsf_calc_steady(&p, &exact[i], NULL);
+  }
+  double t_solver = (timer_now() - t0) / num_exact;
+
+  printf("%-8s %12s %16s %16s\n", "method", "ns/query", "max error", "estimate");
+  printf("%-8s %12.0f\n", "solver", 1E9 * t_solver);
+
+  const char *method_names[] = {"linear", "cubic"};
+  const int methods[] = {ZSF_INTERPOLATION_LINEAR, ZSF_INTERPOLATION_CUBIC};
+
+  for (int m = 0; m < 2; m++) {
+    zsf_results_t r;
+
+    t0 = timer_now();
+    for (int i = 0; i < num_queries; i++) {
+      zsf_surrogate_interpolate(surrogate, methods[m], &x[i * NUM_AXES], &r);
+    }
+    double t_query = (timer_now() - t0) / num_queries;
+
+    double max_error = 0.0;
+    for (int i = 0; i < num_exact; i++) {
+      zsf_surrogate_interpolate(surrogate, methods[m], &x[i * NUM_AXES], &r);
+      max_error = fmax(max_error, fabs(r.salt_load_lake - exact[i].salt_load_lake));
+    }
+
+    zsf_results_t estimate;
+    zsf_surrogate_max_error(surrogate, methods[m], &estimate);
+
+    printf("%-8s %12.1f %16.2e %16.2e\n", method_names[m], 1E9 * t_query, max_error,
+           estimate.salt_load_lake);
+  }
+  printf("\nmaximum errors of salt_load_lake over %d random points, and the estimates of "
+         "zsf_surrogate_max_error\n",
+         num_exact);
+
+  free(x);
+  free(exact);
+  zsf_surrogate_free(surrogate);
+
+  return 0;
+}
@@ -0,0 +1,123 @@
+/*****************************************************************************
+ * bench_sweep.c: a design study over a grid of parameters, with a sweep and
+ *                with a batch of independent points
+ *****************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "timer.h"
+#include "zsf.h"
+
+#define NUM_AXES 4
+
+int main(int argc, char *argv[]) {
+  int num_points = (argc > 1) ? atoi(argv[1]) : 11;
+  int max_threads = (argc > 2) ? atoi(argv[2]) : 4;
+
+  zsf_param_t base;
+  zsf_param_default(&base);
+  base.lock_length = 240.0;
+  base.lock_width = 12.0;
+  base.lock_bottom = -4.0;
+  base.head_sea = 0.5;
+  base.salinity_lake = 5.0;
+  base.density_current_factor_sea = 0.25;
+  base.density_current_factor_lake = 0.25;
+  base.rtol = 1E-8;
+  base.atol = 1E-10;
+
+  zsf_surrogate_axis_t axes[NUM_AXES] = {
+      {zsf_param_index("sill_height_lake"), num_points, 1.0, 3.5},
+      {zsf_param_index("flushing_discharge_high_tide"), num_points, 0.0, 5.0},
+      {zsf_param_index("num_cycles"), 5, 12.0, 36.0},
+      {zsf_param_index("salinity_sea"), 3, 20.0, 30.0},
+  };
+
+  int n = 1;
+  for (int a = 0; a < NUM_AXES; a++) {
+    n *= axes[a].num_points;
+  }
+
+  // The same grid as columns of a batch, with the last axis contiguous
+  double *block = (double *)malloc((size_t)n * NUM_AXES * sizeof(double));
+  double *sweep_load = (double *)malloc(n * sizeof(double));
+  double *batch_load = (double *)malloc(n * sizeof(double));
+  int *sweep_cycles = (int *)malloc(n * sizeof(int));
+
+  zsf_param_columns_t params = {0};
+  int stride = 1;
+  for (int a = NUM_AXES - 1; a >= 0; a--) {
+    double *column = &block[(size_t)a * n];
+    for (int i = 0; i < n; i++) {
+      int j = (i / stride) % axes[a].num_points;
+      column[i] = axes[a].min + j * (axes[a].max - axes[a].min) / (axes[a].num_points - 1);
+    }
+    stride *= axes[a].num_points;
+  }
+  params.sill_height_lake = &block[0];
+  params.flushing_discharge_high_tide = &block[n];
+  params.num_cycles = &block[2 * (size_t)n];
+  params.salinity_sea = &block[3 * (size_t)n];
+
+  zsf_results_columns_t sweep_results = {0};
+  sweep_results.salt_load_lake = sweep_load;
+  zsf_results_columns_t batch_results = {0};
+  batch_results.salt_load_lake = batch_load;
+
+  printf("%d grid points\n\n", n);
+  printf("%-8s %12s %12s %14s %12s\n", "threads", "batch (s)", "sweep (s)", "cycles/point",
+         "max rel diff");
+
+  for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+    zsf_options_t options;
+    zsf_options_default(&options);
+    options.num_threads = num_threads;
+
+    double t0 = timer_now();
+    zsf_calc_steady_batch(&base, &params, 1, &batch_results, 1, NULL, n, &options);
+    double t_batch = timer_now() - t0;
+
+    t0 = timer_now();
+    int err = zsf_sweep(&base, axes, NUM_AXES, &sweep_results, 1, NULL, sweep_cycles, &options);
+    double t_sweep = timer_now() - t0;
+    if (err) {
+      fprintf(stderr, "%s\n", zsf_error_msg(err));
+      return 1;
+    }
+
+    long long total_cycles = 0;
+    double max_diff = 0.0;
+    for (int i = 0; i < n; i++) {
+      total_cycles += sweep_cycles[i];
+      max_diff = fmax(max_diff, fabs(sweep_load[i] - batch_load[i]) / fabs(batch_load[i]));
+    }
+
+    printf("%-8d %12.4f %12.4f %14.2f %12.1e\n", num_threads, t_batch, t_sweep,
+           (double)total_cycles / n, max_diff);
+  }
+
+  // The cycles of the batch, point by point
+  long long batch_cycles = 0;
+  for (int i = 0; i < n; i++) {
+    zsf_param_t p = base;
+    p.sill_height_lake = params.sill_height_lake[i];
+    p.flushing_discharge_high_tide = params.flushing_discharge_high_tide[i];
+    p.num_cycles = params.num_cycles[i];
+    p.salinity_sea = params.salinity_sea[i];
+
+    zsf_results_t results;
+    zsf_steady_stats_t stats;
+    zsf_calc_steady_ex(&p, NULL, &results, NULL, &stats);
+    batch_cycles += stats.num_cycles;
+  }
+  printf("\nThe batch takes %.2f cycles per point\n", (double)batch_cycles / n);
+
+  free(block);
+  free(sweep_load);
+  free(batch_load);
+  free(sweep_cycles);
+
+  return 0;
+}
@@ -0,0 +1,96 @@
+/*****************************************************************************
+ * bench_threads.c: scaling of zsf_calc_steady_batch with the number of threads
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "parallel.h"
+#include "zsf.h"
+
+static double run(const zsf_param_t *base, const zsf_param_columns_t *params,
+                  zsf_results_columns_t *results, int *errors, int n, int num_threads,
+                  int chunk_size) {
+  zsf_options_t options;
+  zsf_options_default(&options);
+  options.num_threads = num_threads;
+  options.chunk_size = chunk_size;
+
+  double best;
+  BENCH_BEST_OF(best, 3, zsf_calc_steady_batch(base, params, 1, results, 1, errors, n, &options));
+  return best;
+}
+
+int main(int argc, char *argv[]) {
+  int n = (argc > 1) ? atoi(argv[1]) : 100000;
+  int max_threads = (argc > 2) ? atoi(argv[2]) : parallel_num_cores();
+
+  zsf_param_t base;
+  zsf_param_default(&base);
+
+  double *head_sea = (double *)malloc(n * sizeof(double));
+  double *flushing = (double *)malloc(n * sizeof(double));
+  double *dc_factor = (double *)malloc(n * sizeof(double));
+  double *num_cycles = (double *)malloc(n * sizeof(double));
+  double *rtol = (double *)malloc(n * sizeof(double));
+  double *salt_load = (double *)malloc(n * sizeof(double));
+  int *errors = (int *)malloc(n * sizeof(int));
+
+  // Random scenarios, where the second half needs many more iterations than
+  // the first. A static partitioning of the rows over the threads would leave
+  // the threads that got the first half idle for most of the time.
+  unsigned long long seed = 42;
+  for (int i = 0; i < n; i++) {
+    head_sea[i] = bench_uniform(&seed, -2.0, 2.0);
+    flushing[i] = bench_uniform(&seed, 0.0, 2.0);
+    dc_factor[i] = bench_uniform(&seed, 0.25, 1.0);
+    num_cycles[i] = bench_uniform(&seed, 8.0, 54.0);
+    rtol[i] = (i < n / 2) ? 1E-3 : 1E-12;
+  }
+
+  zsf_param_columns_t params = {0};
+  params.head_sea = head_sea;
+  params.flushing_discharge_high_tide = flushing;
+  params.flushing_discharge_low_tide = flushing;
+  params.density_current_factor_sea = dc_factor;
+  params.density_current_factor_lake = dc_factor;
+  params.num_cycles = num_cycles;
+  params.rtol = rtol;
+
+  zsf_results_columns_t results = {0};
+  results.salt_load_lake = salt_load;
+
+  printf("%d rows, %d cores\n\n", n, parallel_num_cores());
+  printf("%8s %14s %10s %10s %18s\n", "threads", "rows/s", "speedup", "efficiency",
+         "static speedup");
+
+  double t_serial = run(&base, &params, &results, errors, n, 1, 0);
+
+  for (int num_threads = 1;; num_threads *= 2) {
+    if (num_threads > max_threads)
+      num_threads = max_threads;
+
+    double t = run(&base, &params, &results, errors, n, num_threads, 0);
+
+    // One chunk per thread means no work is left to steal
+    int static_chunk = (n + num_threads - 1) / num_threads;
+    double t_static = run(&base, &params, &results, errors, n, num_threads, static_chunk);
+
+    printf("%8d %14.0f %10.2f %9.0f%% %18.2f\n", num_threads, n / t, t_serial / t,
+           100.0 * t_serial / t / num_threads, t_serial / t_static);
+
+    if (num_threads == max_threads)
+      break;
+  }
+
+  free(head_sea);
+  free(flushing);
+  free(dc_factor);
+  free(num_cycles);
+  free(rtol);
+  free(salt_load);
+  free(errors);
+
+  return 0;
+}
@@ -0,0 +1,58 @@
+"""Compares two JSON reports of zsf-bench, e.g. of two commits.
+
+usage: python compare.py baseline.json current.json [threshold]
+
+Prints the ratio of the time per call of every benchmark in both reports, and
+exits with status 1 if any of them got slower by more than the threshold (by
+default 0.1, i.e. 10%).
+"""
+
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        report = json.load(f)
+    return report, {(r["name"], r["regime"]): r for r in report["results"]}
+
+
+def main(argv):
+    if len(argv) not in (3, 4):
+        print(__doc__.strip(), file=sys.stderr)
+        return 2
+
+    baseline, before = load(argv[1])
+    current, after = load(argv[2])
+    threshold = float(argv[3]) if len(argv) == 4 else 0.1
+
+    for key in ("cpu_variant", "config"):
+        if baseline.get(key) != current.get(key):
+            print(f"warning: {key} differs: {baseline.get(key)} vs {current.get(key)}")
+
+    print(f"{'name':<24} {'regime':<16} {'before':>10} {'after':>10} {'ratio':>8}")
+    slower = []
+    for key, r in after.items():
+        if key not in before:
+            continue
+        ratio = r["ns_per_call"] / before[key]["ns_per_call"]
+        mark = ""
+        if ratio > 1.0 + threshold:
+            slower.append(key)
+            mark = "  slower"
+        elif ratio < 1.0 - threshold:
+            mark = "  faster"
+        # A different number of cycles per solve is a change in convergence
+        cycles = r.get("cycles_per_solve")
+        if cycles is not None and cycles != before[key].get("cycles_per_solve"):
+            mark += f"  cycles {before[key].get('cycles_per_solve')} -> {cycles}"
+        print(
+            f"{key[0]:<24} {key[1]:<16} {before[key]['ns_per_call']:>10.1f} "
+            f"{r['ns_per_call']:>10.1f} {ratio:>8.3f}{mark}"
+        )
+
+    return 1 if slower else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
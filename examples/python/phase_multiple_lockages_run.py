@@ -0,0 +1,69 @@
+import pprint
+
+import numpy as np
+import pandas as pd
+
+import pyzsf
+
+
+lock_parameters = {
+    "lock_length": 300.0,
+    "lock_width": 25.0,
+    "lock_bottom": -7.0,
+}
+
+constant_boundary_conditions = {
+    'head_lake': 0.0,
+    'temperature_lake': 15.0,
+    'temperature_sea': 15.0,
+}
+
+mitigation_parameters = {
+    'density_current_factor_lake': 0.25,
+    'density_current_factor_sea': 0.25,
+    'distance_door_bubble_screen_lake': 10.0,
+    'distance_door_bubble_screen_sea': 10.0,
+    'flushing_discharge_high_tide': 0.0,
+    'flushing_discharge_low_tide': 0.0,
+    'sill_height_lake': 0.5,
+}
+
+# Initialize the lock
+z = pyzsf.ZSFUnsteady(15.0, 0.0, **lock_parameters, **constant_boundary_conditions, **mitigation_parameters)
+
+# Read the lockages from a file
+df_lockages = pd.read_csv('lockages.csv', index_col=0)
+
+# Every routine has its duration in a different column
+routines = df_lockages['routine'].astype(int)
+durations = np.select(
+    [routines.isin([1, 3]), routines == 2, routines == 4, routines.isin([-2, -4])],
+    [df_lockages['t_level'], df_lockages['t_open_lake'], df_lockages['t_open_sea'], df_lockages['t_flushing']],
+)
+columns = {k: df_lockages[k].tolist() for k in ['head_sea', 'salinity_lake', 'salinity_sea']}
+
+# Go through all lockages in one call
+all_results = z.run_lockages(routines.tolist(), durations.tolist(), columns)
+
+# Aggregate results
+duration = 60 * 24 * 3600  # 60 days
+
+overall_results = {k: sum(v) for k, v in all_results.items() if k.startswith(("volume_", "mass_"))}
+
+overall_mass_to_sea = sum(v * s for v, s in zip(all_results['volume_to_sea'], all_results['salinity_to_sea']))
+overall_mass_to_lake = sum(v * s for v, s in zip(all_results['volume_to_lake'], all_results['salinity_to_lake']))
+
+overall_results['salinity_to_sea'] = overall_mass_to_sea / overall_results['volume_to_sea']
+overall_results['salinity_to_lake'] = overall_mass_to_lake / overall_results['volume_to_lake']
+
+overall_discharges = {}
+for k, v in overall_results.items():
+    if k.startswith("volume_"):
+        overall_discharges[f"discharge_{k[7:]}"] = v / duration
+overall_results.update(overall_discharges)
+
+assert overall_results.keys() == all_results.keys()
+
+# Log to console
+print("Overall results (60 day aggregates and averages):")
+pprint.pprint(overall_results)
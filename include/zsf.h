@@ -7,6 +7,13 @@
 // Other languages have different assumptions. We try to keep everything
 // packed at 8-bytes ourselves, by only using 8-byte types.
 
+// All functions are reentrant: they can be called concurrently from multiple
+// threads as long as the output arguments of concurrent calls do not overlap.
+// The only global state is that of the optional counters of the solvers
+// (built with the USE_STATS option, see zsf_counters_t), which concurrent
+// callers share: they count each other's work, and zsf_reset_counters resets
+// the counts for all of them.
+
 #ifndef ZSF_ZSF_H
 #define ZSF_ZSF_H
 
@@ -37,6 +44,39 @@
 // A custom value to signify "not specified"
 #define ZSF_NAN -999.0
 
+// Fixed-point solvers for the steady state (see zsf_options_t)
+#define ZSF_SOLVER_PICARD 0
+#define ZSF_SOLVER_AITKEN 1
+
+// Accuracy tiers of the transcendental functions (see zsf_options_t)
+#define ZSF_ACCURACY_EXACT 0
+#define ZSF_ACCURACY_FAST 1
+#define ZSF_ACCURACY_FASTEST 2
+
+// Routines of a lockage event (see zsf_run_lockages)
+#define ZSF_ROUTINE_IDLE 0
+#define ZSF_ROUTINE_LEVEL_TO_LAKE 1
+#define ZSF_ROUTINE_DOOR_OPEN_LAKE 2
+#define ZSF_ROUTINE_LEVEL_TO_SEA 3
+#define ZSF_ROUTINE_DOOR_OPEN_SEA 4
+#define ZSF_ROUTINE_FLUSH_DOORS_CLOSED_LAKE -2
+#define ZSF_ROUTINE_FLUSH_DOORS_CLOSED_SEA -4
+
+// Interpolation methods of a surrogate (see zsf_surrogate_interpolate)
+#define ZSF_INTERPOLATION_LINEAR 1
+#define ZSF_INTERPOLATION_CUBIC 3
+
+// The maximum number of axes of the grid of a surrogate
+#define ZSF_SURROGATE_MAX_AXES 8
+
+// Distributions of an uncertain parameter (see zsf_distribution_t)
+#define ZSF_DISTRIBUTION_UNIFORM 1
+#define ZSF_DISTRIBUTION_NORMAL 2
+#define ZSF_DISTRIBUTION_TRIANGULAR 3
+
+// The relative accuracy of the quantiles of a Monte Carlo run
+#define ZSF_MONTE_CARLO_ACCURACY 0.01
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -135,6 +175,252 @@ typedef struct zsf_aux_results_t {
   zsf_phase_transports_t transports_phase_4;
 } zsf_aux_results_t;
 
+/* Column-wise (structure-of-arrays) input of the batch functions. Every member
+   points to an array with one value per row. A NULL member means that the
+   value of the base parameter set is used for all rows. */
+typedef struct zsf_param_columns_t {
+  const double *lock_length;
+  const double *lock_width;
+  const double *lock_bottom;
+  const double *num_cycles;
+  const double *door_time_to_open;
+  const double *leveling_time;
+  const double *calibration_coefficient;
+  const double *symmetry_coefficient;
+  const double *ship_volume_sea_to_lake;
+  const double *ship_volume_lake_to_sea;
+  const double *salinity_lock;
+  const double *head_sea;
+  const double *salinity_sea;
+  const double *temperature_sea;
+  const double *head_lake;
+  const double *salinity_lake;
+  const double *temperature_lake;
+  const double *flushing_discharge_high_tide;
+  const double *flushing_discharge_low_tide;
+  const double *density_current_factor_sea;
+  const double *density_current_factor_lake;
+  const double *distance_door_bubble_screen_sea;
+  const double *distance_door_bubble_screen_lake;
+  const double *sill_height_sea;
+  const double *sill_height_lake;
+  const double *rtol;
+  const double *atol;
+} zsf_param_columns_t;
+
+/* Column-wise output of the batch functions. A NULL member means that the
+   corresponding result is not written. */
+typedef struct zsf_results_columns_t {
+  double *mass_transport_lake;
+  double *salt_load_lake;
+  double *discharge_from_lake;
+  double *discharge_to_lake;
+  double *salinity_to_lake;
+
+  double *mass_transport_sea;
+  double *salt_load_sea;
+  double *discharge_from_sea;
+  double *discharge_to_sea;
+  double *salinity_to_sea;
+} zsf_results_columns_t;
+
+/* Options that control how (not what) is calculated. Integers come in pairs,
+   such that the layout is the same with 4-byte and 8-byte packing. */
+typedef struct zsf_options_t {
+  int num_threads;
+  int chunk_size;
+  int solver;
+  int max_cycles;
+  double max_time;
+  int accuracy;
+  int reserved;
+} zsf_options_t;
+
+/* Statistics of the iterative solution of a steady state calculation. The
+   number of cycles is the number of full lock cycles that were simulated, and
+   includes the cycles needed for extrapolation by accelerated solvers. The
+   residual is the change in salinity of the lock over the returned cycle. */
+typedef struct zsf_steady_stats_t {
+  int num_cycles;
+  int num_extrapolations;
+  double residual;
+} zsf_steady_stats_t;
+
+/* Statistics of an inverse solve. The number of cycles is the total over all
+   probes, and the residual is the result minus the target at the returned
+   value. */
+typedef struct zsf_inverse_stats_t {
+  int num_probes;
+  int num_cycles;
+  double residual;
+} zsf_inverse_stats_t;
+
+/* A cycle of the iterative solution of a steady state: the salinity of the
+   lock after each of its phases (see zsf_aux_results_t) and the change in
+   salinity of the lock over the cycle. A cycle that is restarted did not
+   continue from the end of the cycle before, but from a salinity that was
+   extrapolated by an accelerated solver, or from the best cycle so far when
+   the solver stops before convergence. */
+typedef struct zsf_steady_trace_t {
+  int cycle;
+  int restarted;
+  double salinity_lock_1;
+  double salinity_lock_2;
+  double salinity_lock_3;
+  double salinity_lock_4;
+  double residual;
+} zsf_steady_trace_t;
+
+/* Process-wide counts of the work of the solvers and of the branches taken
+   in the phases with open doors, over all threads since the last reset. Only
+   counted in libraries built with ZSF_ENABLE_STATS, see zsf_counters_enabled.
+   The raw exchange and the passthrough count the phases at both sides. */
+typedef struct zsf_counters_t {
+  long long num_steady_solves;
+  long long num_unconverged_solves;
+  long long num_cycles;
+  long long num_density_evaluations;
+  long long num_density_iterations;
+  long long num_doors_open_lake;
+  long long num_doors_open_sea;
+  long long num_bubble_screen_raw_exchange;
+  long long num_flushing_passthrough;
+  long long num_exchange_blocked_by_flushing;
+} zsf_counters_t;
+
+/* A parameter set together with the parameters derived from it, such that
+   subsequent calls with the same (or mostly the same) parameters are cheaper.
+   The layout is private, use the zsf_context_* functions to access it. */
+typedef struct zsf_context_t zsf_context_t;
+
+/* An axis of the grid of a surrogate: num_points equidistant values from min
+   to max of the parameter with index param (see zsf_param_index). */
+typedef struct zsf_surrogate_axis_t {
+  int param;
+  int num_points;
+  double min;
+  double max;
+} zsf_surrogate_axis_t;
+
+/* A coefficient to calibrate: the parameter with index param (see
+   zsf_param_index), its value (the initial guess on input, the fitted value on
+   output), its bounds, and the standard error of the fitted value. */
+typedef struct zsf_calibration_param_t {
+  int param;
+  int reserved;
+  double value;
+  double lower;
+  double upper;
+  double std_error;
+} zsf_calibration_param_t;
+
+/* Diagnostics of a calibration. The residuals are the modelled minus the
+   observed salt loads of the observations that did not fail. Converged is 0
+   if the maximum number of iterations was reached. */
+typedef struct zsf_calibration_stats_t {
+  int num_iterations;
+  int num_evaluations;
+  int num_observations;
+  int num_failed;
+  int converged;
+  int reserved;
+  double initial_rms_residual;
+  double rms_residual;
+  double max_abs_residual;
+} zsf_calibration_stats_t;
+
+/* Lock chambers side by side on the same lake and sea, each with its own
+   parameters, operation and state. The layout is private, use the
+   zsf_complex_* functions to access it. */
+typedef struct zsf_complex_t zsf_complex_t;
+
+/* Ship traffic at a lock, for zsf_simulate_operation. Ships arrive at random
+   at arrival_rate_lake and arrival_rate_sea ships per hour (going to the sea
+   and the lake respectively), with a water displacement uniform between
+   ship_volume_min and ship_volume_max. A lockage takes at most max_ships
+   ships (0 for no limit) with a total displacement of at most
+   max_ship_volume (0 for the volume of the lock, else at least
+   ship_volume_max), each of which takes time_per_ship seconds to sail in or
+   out. The lock only levels when the head difference between the lake and
+   the sea is at most max_head_difference (0 for always), and closes its
+   doors when there are no ships if close_doors_when_idle is not 0. */
+typedef struct zsf_traffic_t {
+  double arrival_rate_lake;
+  double arrival_rate_sea;
+  double ship_volume_min;
+  double ship_volume_max;
+  double max_ship_volume;
+  int max_ships;
+  int close_doors_when_idle;
+  double time_per_ship;
+  double max_head_difference;
+} zsf_traffic_t;
+
+/* A routine of the lock in a simulation of its operation: its start time and
+   duration in seconds, the number of ships that entered the lock and their
+   displacement (only for the routines with open doors), and the transports. */
+typedef struct zsf_operation_event_t {
+  double time;
+  double duration;
+  int routine;
+  int num_ships;
+  double ship_volume;
+  zsf_phase_transports_t transports;
+} zsf_operation_event_t;
+
+/* The outcome of a simulation of the operation of a lock. Lockages are the
+   levelings from one side to the other, of which the empty ones carry no
+   ships. Ships that are too large for the lock at the boundaries of their
+   lockage are turned away. The waiting times are from the arrival of a ship
+   until it enters the lock. The total holds the transports of all routines, with the salinities
+   weighted by volume and the discharges averaged over the simulated time. */
+typedef struct zsf_operation_stats_t {
+  long long num_events;
+  long long num_lockages;
+  long long num_empty_lockages;
+  long long num_ships_lake_to_sea;
+  long long num_ships_sea_to_lake;
+  long long num_ships_waiting;
+  long long num_ships_turned_away;
+  double mean_waiting_time;
+  double max_waiting_time;
+  zsf_phase_transports_t total;
+} zsf_operation_stats_t;
+
+/* The steady state results on a grid over a few parameters, with the other
+   parameters fixed, to interpolate in instead of running the solver. The
+   layout is private, use the zsf_surrogate_* functions to access it. */
+typedef struct zsf_surrogate_t zsf_surrogate_t;
+
+/* The distribution of an uncertain parameter with index param (see
+   zsf_param_index): uniform between min and max, normal with mean center and
+   standard deviation std_dev truncated to [min, max], or triangular between
+   min and max with mode center. */
+typedef struct zsf_distribution_t {
+  int param;
+  int type;
+  double min;
+  double max;
+  double center;
+  double std_dev;
+} zsf_distribution_t;
+
+/* The moments and extremes of every result over the samples of a Monte Carlo
+   run that did not fail. */
+typedef struct zsf_monte_carlo_stats_t {
+  long long num_samples;
+  long long num_failed;
+  zsf_results_t mean;
+  zsf_results_t std_dev;
+  zsf_results_t min;
+  zsf_results_t max;
+} zsf_monte_carlo_stats_t;
+
+/* The accumulated results of the samples of a Monte Carlo run, in constant
+   memory. The layout is private, use the zsf_monte_carlo_* functions to
+   access it. */
+typedef struct zsf_monte_carlo_t zsf_monte_carlo_t;
+
 /* zsf_initialize_state:
  *      fill zsf_state_t with an initial condition for an empty (no ships) lock */
 ZSF_EXPORT int ZSF_CALLCONV zsf_initialize_state(const zsf_param_t *p, zsf_phase_state_t *state,
@@ -178,6 +464,340 @@ ZSF_EXPORT void ZSF_CALLCONV zsf_param_default(zsf_param_t *p);
  *      calculate the salt intrusion for a set of parameters, assuming steady operation*/
 ZSF_EXPORT int ZSF_CALLCONV zsf_calc_steady(const zsf_param_t *p, zsf_results_t *results,
                                             zsf_aux_results_t *aux_results);
+
+/* zsf_options_default:
+ *      fill zsf_options_t with default values */
+ZSF_EXPORT void ZSF_CALLCONV zsf_options_default(zsf_options_t *options);
+
+/* zsf_calc_steady_ex:
+ *      like zsf_calc_steady, but with options to select and bound the solver.
+ *      The statistics of the solver are written to stats if not NULL. If the
+ *      solver does not converge within its bounds, the best estimate so far is
+ *      written to results, and an error code is returned. */
+ZSF_EXPORT int ZSF_CALLCONV zsf_calc_steady_ex(const zsf_param_t *p, const zsf_options_t *options,
+                                               zsf_results_t *results,
+                                               zsf_aux_results_t *aux_results,
+                                               zsf_steady_stats_t *stats);
+
+/* zsf_calc_steady_trace:
+ *      like zsf_calc_steady_ex, but also traces the cycles of the solver in a
+ *      ring buffer of max_trace entries, of which cycle k (counting from 1)
+ *      is at index (k - 1) % max_trace */
+ZSF_EXPORT int ZSF_CALLCONV zsf_calc_steady_trace(const zsf_param_t *p,
+                                                  const zsf_options_t *options,
+                                                  zsf_results_t *results,
+                                                  zsf_aux_results_t *aux_results,
+                                                  zsf_steady_stats_t *stats,
+                                                  zsf_steady_trace_t *trace, int max_trace);
+
+/* zsf_calc_steady_batch:
+ *      calculate the steady state salt intrusion for n rows of parameters at
+ *      once. Row i of every column is found at index i * param_stride, and its
+ *      results are written at index i * results_stride. A stride of zero
+ *      broadcasts a single row, and a negative stride returns
+ *      ZSF_ERR_INVALID_STRIDE (as do the other functions taking strides). The
+ *      error code of every row is written to errors (if not NULL), and a
+ *      failing row does not abort the rest of the batch. The rows are spread
+ *      over options->num_threads threads. */
+ZSF_EXPORT int ZSF_CALLCONV zsf_calc_steady_batch(const zsf_param_t *base,
+                                                  const zsf_param_columns_t *params,
+                                                  int param_stride,
+                                                  zsf_results_columns_t *results,
+                                                  int results_stride, int *errors, int n,
+                                                  const zsf_options_t *options);
+
+/* zsf_run_lockages:
+ *      step the state of a lock through n lockage events at once. Event i
+ *      performs routine routines[i] (ZSF_ROUTINE_*) for durations[i] seconds,
+ *      with the parameters of row i * param_stride of params. Its transports
+ *      are written to transports[i] if transports is not NULL. The run stops
+ *      at the first failing event, of which the index is written to
+ *      failed_event (if not NULL, -1 if no event failed). */
+ZSF_EXPORT int ZSF_CALLCONV zsf_run_lockages(const zsf_param_t *base,
+                                             const zsf_param_columns_t *params, int param_stride,
+                                             const int *routines, const double *durations, int n,
+                                             zsf_phase_state_t *state,
+                                             zsf_phase_transports_t *transports,
+                                             int *failed_event, const zsf_options_t *options);
+
+/* zsf_complex_create:
+ *      create a complex of num_chambers lock chambers with the parameters in
+ *      chambers, of which the lake and the sea are those of the first
+ *      chamber. Every chamber starts empty, at the head of the sea. */
+ZSF_EXPORT int ZSF_CALLCONV zsf_complex_create(const zsf_param_t *chambers, int num_chambers,
+                                               zsf_complex_t **complex);
+
+/* zsf_complex_free:
+ *      free a complex created by zsf_complex_create */
+ZSF_EXPORT void ZSF_CALLCONV zsf_complex_free(zsf_complex_t *complex);
+
+/* zsf_complex_get_state, zsf_complex_set_state:
+ *      get or set the state of a chamber of a complex */
+ZSF_EXPORT int ZSF_CALLCONV zsf_complex_get_state(const zsf_complex_t *complex, int chamber,
+                                                  zsf_phase_state_t *state);
+
+ZSF_EXPORT int ZSF_CALLCONV zsf_complex_set_state(zsf_complex_t *complex, int chamber,
+                                                  const zsf_phase_state_t *state);
+
+/* zsf_complex_run:
+ *      step all chambers of a complex through num_steps time steps, like
+ *      zsf_run_lockages. In step i, chamber j performs routine
+ *      routines[i * num_chambers + j] for durations[i * num_chambers + j]
+ *      seconds, with the parameters of row i * param_stride of params for all
+ *      chambers. The combined transports of step i are written to totals[i]
+ *      and those of the chambers to transports[i * num_chambers + j] (if not
+ *      NULL). A failing chamber stops, and its step is written to
+ *      failed_steps[j] (if not NULL, -1 if the chamber did not fail). */
+ZSF_EXPORT int ZSF_CALLCONV zsf_complex_run(zsf_complex_t *complex,
+                                            const zsf_param_columns_t *params, int param_stride,
+                                            const int *routines, const double *durations,
+                                            int num_steps, zsf_phase_transports_t *totals,
+                                            zsf_phase_transports_t *transports, int *failed_steps,
+                                            const zsf_options_t *options);
+
+/* zsf_traffic_default:
+ *      fill zsf_traffic_t with a ship an hour in both directions */
+ZSF_EXPORT void ZSF_CALLCONV zsf_traffic_default(zsf_traffic_t *traffic);
+
+/* zsf_simulate_operation:
+ *      simulate the operation of a lock with the parameters of p for duration
+ *      seconds of random ship traffic, starting from state. Row k of
+ *      boundaries holds from k * boundary_interval seconds until the next row
+ *      (the last row until the end). Every routine the lock performs is
+ *      stepped right away, and the first max_events are written to events (if
+ *      not NULL). Ships that do not fit in the lock at the boundaries of their
+ *      lockage are turned away and counted, instead of failing the run. The
+ *      random arrivals depend only on the seed. */
+ZSF_EXPORT int ZSF_CALLCONV zsf_simulate_operation(const zsf_param_t *p,
+                                                   const zsf_param_columns_t *boundaries,
+                                                   int boundary_stride, int num_boundaries,
+                                                   double boundary_interval,
+                                                   const zsf_traffic_t *traffic, double duration,
+                                                   unsigned long long seed,
+                                                   zsf_phase_state_t *state,
+                                                   zsf_operation_event_t *events, int max_events,
+                                                   zsf_operation_stats_t *stats,
+                                                   const zsf_options_t *options);
+
+/* zsf_calc_steady_series:
+ *      calculate the steady state salt intrusion for a time series of n steps
+ *      of slowly varying boundary conditions, with the same layout of columns
+ *      as zsf_calc_steady_batch. Every step starts from the converged lock
+ *      salinity of the previous step, unless a salinity_lock column is given.
+ *      The number of cycles of every step is written to num_cycles (if not
+ *      NULL). The steps are calculated in order, on the calling thread. */
+ZSF_EXPORT int ZSF_CALLCONV zsf_calc_steady_series(const zsf_param_t *base,
+                                                   const zsf_param_columns_t *params,
+                                                   int param_stride,
+                                                   zsf_results_columns_t *results,
+                                                   int results_stride, int *errors,
+                                                   int *num_cycles, int n,
+                                                   const zsf_options_t *options);
+
+/* zsf_context_create:
+ *      allocate a context for a parameter set, or the default parameters if p
+ *      is NULL. Returns NULL if out of memory. */
+ZSF_EXPORT zsf_context_t *ZSF_CALLCONV zsf_context_create(const zsf_param_t *p);
+
+/* zsf_context_free:
+ *      free a context created by zsf_context_create */
+ZSF_EXPORT void ZSF_CALLCONV zsf_context_free(zsf_context_t *ctx);
+
+/* zsf_context_set_param:
+ *      change the parameters of a context. Only the derived parameters that
+ *      depend on changed parameters are recalculated. */
+ZSF_EXPORT void ZSF_CALLCONV zsf_context_set_param(zsf_context_t *ctx, const zsf_param_t *p);
+
+/* zsf_context_get_param:
+ *      get the parameters of a context */
+ZSF_EXPORT void ZSF_CALLCONV zsf_context_get_param(const zsf_context_t *ctx, zsf_param_t *p);
+
+/* zsf_context_set_accuracy:
+ *      set the accuracy tier (ZSF_ACCURACY_*) of the zsf_context_step_*
+ *      functions. The steady state functions use the tier of their options. */
+ZSF_EXPORT void ZSF_CALLCONV zsf_context_set_accuracy(zsf_context_t *ctx, int accuracy);
+
+/* zsf_context_step_phase_1..4, zsf_context_step_flush_doors_closed:
+ *      like zsf_step_phase_1..4 and zsf_step_flush_doors_closed, but with the
+ *      parameters of a context */
+ZSF_EXPORT int ZSF_CALLCONV zsf_context_step_phase_1(const zsf_context_t *ctx, double t_level,
+                                                     zsf_phase_state_t *state,
+                                                     zsf_phase_transports_t *results);
+
+ZSF_EXPORT int ZSF_CALLCONV zsf_context_step_phase_2(const zsf_context_t *ctx, double t_open_lake,
+                                                     zsf_phase_state_t *state,
+                                                     zsf_phase_transports_t *results);
+
+ZSF_EXPORT int ZSF_CALLCONV zsf_context_step_phase_3(const zsf_context_t *ctx, double t_level,
+                                                     zsf_phase_state_t *state,
+                                                     zsf_phase_transports_t *results);
+
+ZSF_EXPORT int ZSF_CALLCONV zsf_context_step_phase_4(const zsf_context_t *ctx, double t_open_sea,
+                                                     zsf_phase_state_t *state,
+                                                     zsf_phase_transports_t *results);
+
+ZSF_EXPORT int ZSF_CALLCONV zsf_context_step_flush_doors_closed(const zsf_context_t *ctx,
+                                                                double t_flushing,
+                                                                zsf_phase_state_t *state,
+                                                                zsf_phase_transports_t *results);
+
+/* zsf_context_calc_steady:
+ *      like zsf_calc_steady_ex, but with the parameters of a context */
+ZSF_EXPORT int ZSF_CALLCONV zsf_context_calc_steady(const zsf_context_t *ctx,
+                                                    const zsf_options_t *options,
+                                                    zsf_results_t *results,
+                                                    zsf_aux_results_t *aux_results,
+                                                    zsf_steady_stats_t *stats);
+
+/* zsf_param_index:
+ *      get the index of a parameter in zsf_param_t by its name, or -1 if there
+ *      is no such parameter */
+ZSF_EXPORT int ZSF_CALLCONV zsf_param_index(const char *name);
+
+/* zsf_result_index:
+ *      get the index of the result name in zsf_results_t, or -1 if there is
+ *      no such result */
+ZSF_EXPORT int ZSF_CALLCONV zsf_result_index(const char *name);
+
+/* zsf_calc_steady_sensitivities:
+ *      like zsf_calc_steady_ex, and also calculate the derivatives of the
+ *      results with respect to num_params parameters (see zsf_param_index).
+ *      The derivatives to parameter params[j] are written to
+ *      sensitivities[j]. */
+ZSF_EXPORT int ZSF_CALLCONV zsf_calc_steady_sensitivities(const zsf_param_t *p, const int *params,
+                                                          int num_params,
+                                                          const zsf_options_t *options,
+                                                          zsf_results_t *results,
+                                                          zsf_results_t *sensitivities,
+                                                          zsf_steady_stats_t *stats);
+
+/* zsf_calc_steady_inverse:
+ *      find the value between lower and upper of parameter param for which
+ *      the result with index result (see zsf_result_index) equals target,
+ *      within an absolute tolerance. A tolerance of 0 solves as accurately as
+ *      the steady state itself (see rtol and atol) allows, and a positive
+ *      tolerance below that returns ZSF_ERR_TOLERANCE_NOT_REACHED. The results
+ *      at the (best) value are written to results (if not NULL). Bounds that
+ *      put a sill below the bottom of the lock or not below the water level
+ *      return ZSF_ERR_PARAM_OUT_OF_RANGE. */
+ZSF_EXPORT int ZSF_CALLCONV zsf_calc_steady_inverse(const zsf_param_t *p, int param, double lower,
+                                                    double upper, int result, double target,
+                                                    double tolerance, const zsf_options_t *options,
+                                                    double *value, zsf_results_t *results,
+                                                    zsf_inverse_stats_t *stats);
+
+/* zsf_calibrate:
+ *      fit num_fit parameters to the salt loads to the lake observed[i] of n
+ *      observations, with the other parameters of the observations given like
+ *      zsf_calc_steady_batch. The weighted sum of squared residuals is
+ *      minimized with the Levenberg-Marquardt method within the bounds of the
+ *      parameters, in at most max_iterations iterations. Weights can be NULL
+ *      for equal weights. The residual of every observation is written to
+ *      residuals (if not NULL). Observations that fail at the initial values
+ *      are left out, in which case ZSF_ERR_BATCH_FAILED_ROWS is returned.
+ *      The fitted values are written to fit also without convergence. */
+ZSF_EXPORT int ZSF_CALLCONV zsf_calibrate(const zsf_param_t *base,
+                                          const zsf_param_columns_t *params, int param_stride,
+                                          const double *observed, const double *weights, int n,
+                                          zsf_calibration_param_t *fit, int num_fit,
+                                          int max_iterations, const zsf_options_t *options,
+                                          double *residuals, zsf_calibration_stats_t *stats);
+
+/* zsf_surrogate_create:
+ *      calculate the steady state on the grid spanned by num_axes axes, with
+ *      the other parameters of base, spread over options->num_threads
+ *      threads. The interpolation error is estimated at num_checks points
+ *      halfway between grid points. On success, or if some grid points failed
+ *      (ZSF_ERR_BATCH_FAILED_ROWS), the surrogate is written to surrogate. */
+ZSF_EXPORT int ZSF_CALLCONV zsf_surrogate_create(const zsf_param_t *base,
+                                                 const zsf_surrogate_axis_t *axes, int num_axes,
+                                                 int num_checks, const zsf_options_t *options,
+                                                 zsf_surrogate_t **surrogate);
+
+/* zsf_surrogate_free:
+ *      free a surrogate created by zsf_surrogate_create or zsf_surrogate_load */
+ZSF_EXPORT void ZSF_CALLCONV zsf_surrogate_free(zsf_surrogate_t *surrogate);
+
+/* zsf_surrogate_interpolate:
+ *      interpolate the results at the point x, with one value per axis, with
+ *      method ZSF_INTERPOLATION_LINEAR or ZSF_INTERPOLATION_CUBIC */
+ZSF_EXPORT int ZSF_CALLCONV zsf_surrogate_interpolate(const zsf_surrogate_t *surrogate,
+                                                      int method, const double *x,
+                                                      zsf_results_t *results);
+
+/* zsf_surrogate_max_error:
+ *      get the maximum absolute error of an interpolation method over the
+ *      checks of zsf_surrogate_create. Returns the number of checks, or -1 for
+ *      an unknown method. */
+ZSF_EXPORT int ZSF_CALLCONV zsf_surrogate_max_error(const zsf_surrogate_t *surrogate, int method,
+                                                    zsf_results_t *max_error);
+
+/* zsf_surrogate_get_axes:
+ *      get the axes of a surrogate (if axes is not NULL), and return their
+ *      number */
+ZSF_EXPORT int ZSF_CALLCONV zsf_surrogate_get_axes(const zsf_surrogate_t *surrogate,
+                                                   zsf_surrogate_axis_t *axes);
+
+/* zsf_surrogate_get_param:
+ *      get the fixed parameters of a surrogate */
+ZSF_EXPORT void ZSF_CALLCONV zsf_surrogate_get_param(const zsf_surrogate_t *surrogate,
+                                                     zsf_param_t *p);
+
+/* zsf_surrogate_save, zsf_surrogate_load:
+ *      write a surrogate to a binary file, and read it back */
+ZSF_EXPORT int ZSF_CALLCONV zsf_surrogate_save(const zsf_surrogate_t *surrogate,
+                                               const char *path);
+
+ZSF_EXPORT int ZSF_CALLCONV zsf_surrogate_load(const char *path, zsf_surrogate_t **surrogate);
+
+/* zsf_sweep:
+ *      calculate the steady state on every point of the grid spanned by
+ *      num_axes axes (like zsf_surrogate_create), with the other parameters of
+ *      base. The results of the point with grid index i, where the last axis
+ *      is contiguous, are written to row i * results_stride of results, and
+ *      its error code and number of cycles to errors[i] and num_cycles[i] (if
+ *      not NULL). Every point starts from the lock salinity of a neighbour. */
+ZSF_EXPORT int ZSF_CALLCONV zsf_sweep(const zsf_param_t *base, const zsf_surrogate_axis_t *axes,
+                                      int num_axes, zsf_results_columns_t *results,
+                                      int results_stride, int *errors, int *num_cycles,
+                                      const zsf_options_t *options);
+
+/* zsf_monte_carlo_create:
+ *      create an empty Monte Carlo run over the parameters of base, of which
+ *      num_distributions are uncertain. The samples depend only on the seed
+ *      and their index. */
+ZSF_EXPORT int ZSF_CALLCONV zsf_monte_carlo_create(const zsf_param_t *base,
+                                                   const zsf_distribution_t *distributions,
+                                                   int num_distributions,
+                                                   unsigned long long seed,
+                                                   zsf_monte_carlo_t **monte_carlo);
+
+/* zsf_monte_carlo_free:
+ *      free a Monte Carlo run created by zsf_monte_carlo_create */
+ZSF_EXPORT void ZSF_CALLCONV zsf_monte_carlo_free(zsf_monte_carlo_t *monte_carlo);
+
+/* zsf_monte_carlo_run:
+ *      calculate the steady state of the next num_samples samples, spread
+ *      over options->num_threads threads, and accumulate their results */
+ZSF_EXPORT int ZSF_CALLCONV zsf_monte_carlo_run(zsf_monte_carlo_t *monte_carlo, int num_samples,
+                                                const zsf_options_t *options);
+
+/* zsf_monte_carlo_get_sample:
+ *      get the parameters of the sample with the given index */
+ZSF_EXPORT void ZSF_CALLCONV zsf_monte_carlo_get_sample(const zsf_monte_carlo_t *monte_carlo,
+                                                        long long index, zsf_param_t *p);
+
+/* zsf_monte_carlo_get_stats:
+ *      get the moments and extremes of the results of all samples so far */
+ZSF_EXPORT void ZSF_CALLCONV zsf_monte_carlo_get_stats(const zsf_monte_carlo_t *monte_carlo,
+                                                       zsf_monte_carlo_stats_t *stats);
+
+/* zsf_monte_carlo_quantile:
+ *      estimate the quantile q (between 0 and 1) of the results of all samples
+ *      so far, with a relative error of at most ZSF_MONTE_CARLO_ACCURACY */
+ZSF_EXPORT int ZSF_CALLCONV zsf_monte_carlo_quantile(const zsf_monte_carlo_t *monte_carlo,
+                                                     double q, zsf_results_t *results);
+
 /* zsf_error_msg:
  *      Get error messeage corresponding to error code */
 ZSF_EXPORT const char *ZSF_CALLCONV zsf_error_msg(int code);
@@ -186,6 +806,24 @@ ZSF_EXPORT const char *ZSF_CALLCONV zsf_error_msg(int code);
  *      Get version string */
 ZSF_EXPORT const char *ZSF_CALLCONV zsf_version();
 
+/* zsf_cpu_variant:
+ *      Get the instruction set the kernels run with on this CPU, e.g. "avx2",
+ *      or "default" for the instruction set the library was compiled for */
+ZSF_EXPORT const char *ZSF_CALLCONV zsf_cpu_variant();
+
+/* zsf_counters_enabled:
+ *      whether the library was built with ZSF_ENABLE_STATS, i.e. whether
+ *      zsf_get_counters counts anything */
+ZSF_EXPORT int ZSF_CALLCONV zsf_counters_enabled();
+
+/* zsf_get_counters:
+ *      get the counters of all calculations since the last reset */
+ZSF_EXPORT void ZSF_CALLCONV zsf_get_counters(zsf_counters_t *counters);
+
+/* zsf_reset_counters:
+ *      set all counters to zero */
+ZSF_EXPORT void ZSF_CALLCONV zsf_reset_counters();
+
 #ifdef __cplusplus
 }
 #endif
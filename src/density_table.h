@@ -0,0 +1,626 @@
+/*****************************************************************************
+ * density_table.h: generated by gen_density_table.c, do not edit
+ *****************************************************************************/
+
+#ifndef ZSF_DENSITY_TABLE_H
+#define ZSF_DENSITY_TABLE_H
+
+#define DENSITY_TABLE_SAL_MIN (0.0)
+#define DENSITY_TABLE_SAL_STEP 1.0
+#define DENSITY_TABLE_NUM_SAL 46
+
+#define DENSITY_TABLE_TEMP_MIN (-2.0)
+#define DENSITY_TABLE_TEMP_STEP 1.0
+#define DENSITY_TABLE_NUM_TEMP 43
+
+// Upper bound of the interpolation error in kg/m3
+#define DENSITY_TABLE_MAX_ERROR 4.9e-03
+
+// clang-format off
+static const double density_table[DENSITY_TABLE_NUM_TEMP][DENSITY_TABLE_NUM_SAL] = {
+  {
+    999.66951432150938, 1000.4966373321035, 1001.3184627580252, 1002.1367267403108,
+    1002.9520558940859, 1003.7648157473772, 1004.5752550733869, 1005.3835580080313,
+    1006.1898683432904, 1006.9943026374652, 1007.7969580133046, 1008.5979171326346,
+    1009.3972515425336, 1010.1950240218345, 1010.9912902828976, 1011.7861002405491,
+    1012.5794989806041, 1013.3715275139408, 1014.1622233737688, 1014.951621095825,
+    1015.7397526095608, 1016.5266475605581, 1017.3123335790475, 1018.0968365056416,
+    1018.8801805827121, 1019.6623886178908, 1020.4434821247345, 1021.2234814445243,
+    1022.00240585235, 1022.7802736500138, 1023.5571022477981, 1024.3329082367711,
+    1025.1077074530021, 1025.881515034825, 1026.6543454740913, 1027.426212662215,
+    1028.1971299316672, 1028.967110093495, 1029.7361654713413, 1030.5043079323798,
+    1031.2715489155189, 1032.0378994571802, 1032.8033702149141, 1033.5679714890864,
+    1034.331713242831, 1035.0946051204505,
+  },
+  {
+    999.76545789488068, 1000.5882899840951, 1001.4059275461811, 1002.2200749421431,
+    1003.0313472370366, 1003.8401031767543, 1004.6465868874976, 1005.4509790419195,
+    1006.2534207086863, 1007.0540262230656, 1007.8528908423907, 1008.650095629615,
+    1009.4457107381788, 1010.2397977154872, 1011.0324111734535, 1011.8236000341344,
+    1012.6134084804505, 1013.4018766963896, 1014.1890414532771, 1014.9749365811239,
+    1015.7595933525974, 1016.5430407994863, 1017.3253059762558, 1018.1064141816059,
+    1018.8863891463062, 1019.6652531936645, 1020.4430273775844, 1021.2197316021006,
+    1021.995384725493, 1022.7700046514589, 1023.5436084093595, 1024.3162122251761,
+    1025.0878315845257, 1025.8584812888532, 1026.6281755057284, 1027.3969278140237,
+    1028.1647512446325, 1028.9316583172836, 1029.6976610739189, 1030.4627711090484,
+    1031.22699959742, 1031.9903573193121, 1032.7528546837036, 1033.5145017495477,
+    1034.2753082453482, 1035.0352835872093,
+  },
+  {
+    999.84259399999996, 1000.6613056340283, 1001.474922300405, 1002.2851176153531,
+    1003.0924954724973, 1003.8974080591458, 1004.7000950084679, 1005.5007336451736,
+    1006.2994624057308, 1007.0963934770906, 1007.8916203141429, 1008.6852224351684,
+    1009.477268647401, 1010.2678193088879, 1011.0569279688274, 1011.8446425906641,
+    1012.6310064855923, 1013.4160590393424, 1014.1998362878171, 1014.9823713798818,
+    1015.763694954358, 1016.5438354507321, 1017.3228193679133, 1018.1006714817548,
+    1018.8774150294618, 1019.6530718671319, 1020.4276626052886, 1021.2012067262303,
+    1021.9737226862379, 1022.7452280050758, 1023.5157393447654, 1024.2852725792375,
+    1025.0538428561897, 1025.8214646522442, 1026.5881518223155, 1027.3539176439567,
+    1028.1187748573252, 1028.8827357013138, 1029.645811946313, 1030.4080149240012,
+    1031.1693555545016, 1031.9298443712041, 1032.6894915435032, 1033.448306897677,
+    1034.2062999360962, 1034.9634798549373,
+  },
+  {
+    999.90153728495329, 1000.7162931623355, 1001.526050172946, 1002.3324522182759,
+    1003.1360923969597, 1003.9373165598211, 1004.7363599998655, 1005.5333968082841,
+    1006.3285628796964, 1007.121968326784, 1007.9137048643639, 1008.7038505196974,
+    1009.4924728007397, 1010.2796309177825, 1011.0653773946037, 1011.8497592697819,
+    1012.6328190135625, 1013.4145952416826, 1014.1951232807309, 1014.9744356226702,
+    1015.7525622950908, 1016.529531166358, 1017.3053681997353, 1018.0800976670062,
+    1018.853742329572, 1019.6263235931638, 1020.3978616409377, 1021.1683755487132,
+    1021.9378833853382, 1022.7064023005768, 1023.4739486024604, 1024.2405378256813,
+    1025.0061847923309, 1025.7709036660585, 1026.5347080005438, 1027.2976107830386,
+    1028.0596244736053, 1028.8207610405909, 1029.5810319927932, 1030.3404484087059,
+    1031.0990209631811, 1031.8567599517964, 1032.6136753131773, 1033.3697766494918,
+    1034.1250732453086, 1034.8795740849837,
+  },
+  {
+    999.94287551583454, 1000.753834747041, 1001.5598877909449, 1002.362649859541,
+    1003.1627036308771, 1003.9603888400444, 1004.7559365917316, 1005.5495178572,
+    1006.3412660788598, 1007.1312893685441, 1007.9196777628084, 1008.7065078510371,
+    1009.4918458883653, 1010.2757499784957, 1011.0582716566716, 1011.8394570699666,
+    1012.6193478780921, 1013.3979819547093, 1014.1753939428723, 1014.9516157015701,
+    1015.7266766694737, 1016.5006041647184, 1017.2734236345531, 1018.0451588651987,
+    1018.8158321597534, 1019.5854644901732, 1020.3540756280163, 1021.1216842576431,
+    1021.8883080748056, 1022.6539638729773, 1023.4186676193322, 1024.1824345219243,
+    1024.945279089347, 1025.7072151839261, 1026.4682560693313, 1027.2284144533394,
+    1027.9877025263736, 1028.7461319963429, 1029.5037141202322, 1030.2604597328243,
+    1031.0163792728833, 1031.7714828070846, 1032.525780051935, 1033.2792803938996,
+    1034.0319929079187, 1034.7839263744806,
+  },
+  {
+    999.96717036110567, 1000.7744866449987, 1001.5769860346675, 1002.3762560733992,
+    1003.1728693911713, 1003.9671598268462, 1004.7593544476939, 1005.5496212178591,
+    1006.33809121652, 1007.1248706275012, 1007.9100478703856, 1008.6936981493491,
+    1009.4758865127272, 1010.256669998393, 1011.0360991895608, 1011.8142193748012,
+    1012.5910714333667, 1013.3666925244381, 1014.1411166330065, 1014.9143750087206,
+    1015.6864965233634, 1016.4575079654592, 1017.2274342856122, 1017.996298802737,
+    1018.7641233788851, 1019.5309285685937, 1020.2967337473638, 1021.0615572228966,
+    1021.8254163319694, 1022.5883275252662, 1023.3503064420333, 1024.1113679760897,
+    1024.8715263344445, 1025.6307950895632, 1026.3891872261463, 1027.1467151831439,
+    1027.9033908916208, 1028.6592258089847, 1029.4142309500219, 1030.1684169151138,
+    1030.9217939159605, 1031.6743717990882, 1032.426160067384, 1033.1771678998657,
+    1033.927404169872, 1034.6768774618336,
+  },
+  {
+    999.97495817595598, 1000.778779973319, 1001.5778708161076, 1002.3737915955925,
+    1003.1671052644532, 1003.9581399836713, 1004.7471189331155, 1005.5342071819083,
+    1006.319533534358, 1007.1032023185804, 1007.8853003979893, 1008.6659016437782,
+    1009.4450699430961, 1010.2228613083673, 1010.9993254069268, 1011.774506701511,
+    1012.5484453206711, 1013.3211777364027, 1014.0927373008174, 1014.8631546775839,
+    1015.6324581933636, 1016.4006741274366, 1017.1678269528884, 1017.9339395393475,
+    1018.6990333248482, 1019.463128462645, 1020.2262439475098, 1020.9883977250763,
+    1021.7496067870685, 1022.5098872546862, 1023.269254451988, 1024.0277229707749,
+    1024.7853067282076, 1025.5420190181771, 1026.2978725572843, 1027.0528795261339,
+    1027.8070516065493, 1028.5604000152139, 1029.3129355341725, 1030.064668538563,
+    1030.8156090218949, 1031.5657666191535, 1032.3151506279594, 1033.0637700279992,
+    1033.8116334988999, 1034.558749436708,
+  },
+  {
+    999.96675078666249, 1000.7672214909721, 1001.563043857937, 1002.3557531397358,
+    1003.1459029809137, 1003.9338160818509, 1004.719711884218, 1005.5037526735424,
+    1006.2860650670546, 1007.0667516089588, 1007.8458976668529, 1008.6235758307624,
+    1009.3998488718845, 1010.1747718172221, 1010.9483934540505, 1011.7207574516286,
+    1012.4919032172699, 1013.2618665627978, 1014.030680232362, 1014.7983743267542,
+    1015.5649766490352, 1016.3305129893713, 1017.0950073622275, 1017.8584822057469,
+    1018.6209585507632, 1019.3824561651795, 1020.1429936781664, 1020.9025886876892,
+    1021.661257854152, 1022.419016982393, 1023.1758810938455, 1023.9318644903375,
+    1024.6869808107465, 1025.4412430815121, 1026.1946637618439, 1026.9472547843257,
+    1027.6990275915034, 1028.4499931689643, 1029.2001620753226, 1029.9495444694862,
+    1030.698150135509, 1031.4459885053034, 1032.1930686794453, 1032.9393994462739,
+    1033.684989299464, 1034.4298464542253,
+  },
+  {
+    999.94303627494958, 1000.7402943805561, 1001.5329834727798, 1002.3226141741765,
+    1003.1097311888407, 1003.8946519728453, 1004.6775923781132, 1005.4587120173871,
+    1006.2381354080829, 1007.0159633818253, 1007.7922798703304, 1008.567156233889,
+    1009.340654172628, 1010.112827767829, 1010.8837249622197, 1011.6533886636482,
+    1012.4218575873784, 1013.1891669118144, 1013.9553487978112, 1014.7204328061478,
+    1015.4844462375769, 1016.24741441306, 1017.0093609071282, 1017.7703077440342,
+    1018.5302755640303, 1019.2892837654064, 1020.0473506266742, 1020.8044934123494,
+    1021.5607284650732, 1022.3160712862752, 1023.0705366071589, 1023.8241384514625,
+    1024.576890191189, 1025.3288045962945, 1026.0798938791568, 1026.8301697345155,
+    1027.5796433754615, 1028.3283255659717, 1029.076226650405, 1029.8233565803189,
+    1030.5697249389136, 1031.3153409633717, 1032.0602135653176, 1032.8043513496034,
+    1033.547762631591, 1034.2904554530826,
+  },
+  {
+    999.90427976234889, 1000.6984590302208, 1001.4881453427904, 1002.2748256993012,
+    1003.0590362297231, 1003.8410893612083, 1004.6211975036889, 1005.3995177073618,
+    1006.1761724766042, 1006.9512610013612, 1007.7248658370145, 1008.4970571651985,
+    1009.2678956595245, 1010.0374344949483, 1010.805720804876, 1011.5727967675421,
+    1012.3387004350936, 1013.1034663790248, 1013.867126201331, 1014.6297089454207,
+    1015.3912414308166, 1016.1517485289805, 1016.9112533929965, 1017.6697776506318,
+    1018.4273415679909, 1019.1839641893099, 1019.9396634572106, 1020.6944563168086,
+    1021.4483588063759, 1022.2013861367269, 1022.9535527610761, 1023.7048724368037,
+    1024.4553582802992, 1025.2050228158598, 1025.9538780194503, 1026.7019353580067,
+    1027.4492058248513, 1028.1956999717081, 1028.9414279377258, 1029.6863994758662,
+    1030.4306239769567, 1031.1741104916691, 1031.9168677506539, 1032.6589041830211,
+    1033.4002279333451, 1034.1408468773382,
+  },
+  {
+    999.85092419455896, 1000.6421538157369, 1001.4289632995159, 1002.2128170252632,
+    1002.9942429139051, 1003.7735485782277, 1004.5509431332899, 1005.326581176458,
+    1006.1005832853931, 1006.8730470788637, 1007.6440537951039, 1008.413672487843,
+    1009.1819628484283, 1009.9489771846019, 1010.7147618554097, 1011.4793583410187,
+    1012.2428040591551, 1013.005133000686, 1013.7663762329662, 1014.5265623044688,
+    1015.2857175743667, 1016.0438664841341, 1016.8010317837121, 1017.5572347216087,
+    1018.3124952060413, 1019.0668319425854, 1019.8202625525794, 1020.5728036756308,
+    1021.3244710588843, 1022.0752796351824, 1022.8252435918474, 1023.5743764314921,
+    1024.3226910260159, 1025.0701996647476, 1025.8169140975263, 1026.562845573397,
+    1027.3080048754753, 1028.0524023524656, 1028.7960479472333, 1029.5389512227814,
+    1030.2811213859286, 1031.022567308946, 1031.7632975493752, 1032.5033203682212,
+    1033.24264374669, 1033.9812754016177,
+  },
+  {
+    999.78339112580522, 1000.5717958827004, 1001.3558501040263, 1002.1369965501004,
+    1002.9157552967531, 1003.6924293561972, 1004.4672246951491, 1005.2402935673754,
+    1006.0117547097292, 1006.7817042399369, 1007.5502221379409, 1008.3173763800128,
+    1009.0832257192066, 1009.8478216349016, 1010.6112097464984, 1011.373430867411,
+    1012.1345218094192, 1012.8945160088365, 1013.6534440223954, 1014.4113339258766,
+    1015.1682116387977, 1015.9241011919809, 1016.6790249503555, 1017.4330038002305,
+    1018.1860573080376, 1018.9382038559282, 1019.6894607584129, 1020.4398443633378,
+    1021.1893701398178, 1021.9380527552299, 1022.6859061429649, 1023.4329435623271,
+    1024.1791776517214, 1024.9246204760723, 1025.6692835692593, 1026.4131779722284,
+    1027.1563142673335, 1027.8987026093791, 1028.6403527537614, 1029.381274082052,
+    1030.1214756253189, 1030.8609660854352, 1031.599753854596, 1032.3378470332373,
+    1033.0752534465171, 1033.8119806595109,
+  },
+  {
+    999.70208150319991, 1000.4877819288644, 1001.2691982272926, 1002.0477525382227,
+    1002.8239574553068, 1003.5981116032804, 1004.3704179465134, 1005.1410265039597,
+    1005.9100542571898, 1006.6775958926838, 1007.4437301906429, 1008.2085241000478,
+    1008.9720354793709, 1009.734315018237, 1010.4954076308891, 1011.2553534950869,
+    1012.0141888449347, 1012.7719465880706, 1013.528656794437, 1014.2843470891862,
+    1015.039042972704, 1015.7927680843297, 1016.5455444219537, 1017.2973925265914,
+    1018.0483316388404, 1018.7983798325205, 1019.5475541296295, 1020.2958705998611,
+    1021.0433444472669, 1021.7899900861343, 1022.5358212077577, 1023.2808508394694,
+    1024.0250913970551, 1024.7685547314832, 1025.5112521707238, 1026.2531945573057,
+    1026.9943922821567, 1027.7348553151937, 1028.4745932330532, 1029.2136152443006,
+    1029.9519302124108, 1030.6895466767626, 1031.4264728718722, 1032.1627167450467,
+    1032.8982859726239, 1033.6331879749437,
+  },
+  {
+    999.60737645110191, 1000.3904889865909, 1001.1693806307989, 1001.9454538992413,
+    1002.7192142653771, 1003.4909561789295, 1004.2608797474268, 1005.0291328633919,
+    1005.7958308382879, 1006.5610669968331, 1007.3249189777566, 1008.0874527526572,
+    1008.848725328898, 1009.6087866447342, 1010.3676809435279, 1011.1254477982848,
+    1011.8821228935151, 1012.6377386338794, 1013.3923246261895, 1014.1459080668678,
+    1014.8985140575325, 1015.6501658650561, 1016.4008851381134, 1017.1506920891899,
+    1017.899605648861, 1018.6476435975727, 1019.3948226789948, 1020.1411586981511,
+    1020.8866666068714, 1021.63136057861, 1022.375254074283, 1023.1183599004726,
+    1023.8606902611084, 1024.6022568035423, 1025.3430706597796, 1026.0831424835085,
+    1026.8224824834647, 1027.5611004535904, 1028.2990058003741, 1029.0362075677051,
+    1029.7727144595276, 1030.5085348605401, 1031.2436768551556, 1031.9781482449048,
+    1032.7119565644459, 1033.445109096323,
+  },
+  {
+    999.49963805547623, 1000.2802752054122, 1001.0567515473722, 1001.8304509671201,
+    1002.6018721790678, 1003.3713056698189, 1004.1389488351207, 1004.9049475490765,
+    1005.6694155378971, 1006.4324448337387, 1007.1941119918683, 1007.9544820561752,
+    1008.7136112261649, 1009.471548726902, 1010.2283381649507, 1010.9840185392788,
+    1011.7386250127092, 1012.492189512456, 1013.2447412057004, 1013.9963068818801,
+    1014.7469112640615, 1015.496577265525, 1016.2453262034162, 1016.9931779783199,
+    1017.7401512264737, 1018.4862634497822, 1019.2315311276503, 1019.9759698137963,
+    1020.7195942205558, 1021.4624182926941, 1022.2044552723574, 1022.9457177564939,
+    1023.6862177478371, 1024.4259667003596, 1025.1649755599474, 1025.9032548009277,
+    1026.6408144589832, 1027.3776641609013, 1028.1138131515443, 1028.8492703183645,
+    1029.5840442137523, 1030.318143075453, 1031.0515748452683, 1031.7843471862222,
+    1032.5164674983534, 1033.2479429332705,
+  },
+  {
+    999.37921014825429, 1000.1574806346983, 1000.9316472622178, 1001.703076279628,
+    1002.4722600026902, 1003.2394851662656, 1004.0049465989788, 1004.7687882641893,
+    1005.5311223874176, 1006.2920397771977, 1007.051615963109, 1007.8099151107854,
+    1008.5669926549248, 1009.3228971453906, 1010.0776715858531, 1010.8313544317892,
+    1011.5839803520799, 1012.3355808218705, 1013.0861845920634, 1013.8358180667152,
+    1014.5845056104212, 1015.3322698016108, 1016.07913164346, 1016.8251107411597,
+    1017.570225452174, 1018.314493014583, 1019.0579296574774, 1019.8005506965245,
+    1020.5423706171866, 1021.2834031475803, 1022.0236613225898, 1022.7631575405452,
+    1023.5019036135479, 1024.2399108123343, 1024.9771899064235, 1025.7137512001725,
+    1026.4496045652609, 1027.184759470055, 1027.919225006227, 1028.6530099129498,
+    1029.3861225989542, 1030.1185711626797, 1030.8503634107303, 1031.5815068748175,
+    1032.3120088273433, 1033.0418762957672,
+  },
+  {
+    999.2464190916935, 1000.0224280064211, 1000.7943868941441, 1001.5636453580721,
+    1002.3306896750457, 1003.0958030391007, 1003.8591778560345, 1004.6209562858347,
+    1005.3812491376291, 1006.1401460650326, 1006.8977216294952, 1007.6540391676508,
+    1008.4091533922551, 1009.1631122157856, 1009.9159580727591, 1010.6677289055528,
+    1011.4184589167032, 1012.1681791545219, 1012.9169179768489, 1013.6647014238328,
+    1014.4115535215509, 1015.1574965322034, 1015.9025511624377, 1016.6467367384437,
+    1017.3900713543657, 1018.1325719990688, 1018.8742546651758, 1019.615134443457,
+    1020.3552256050225, 1021.0945416732845, 1021.8330954872786, 1022.5708992576423,
+    1023.3079646163177, 1024.0443026608611, 1024.7799239940923, 1025.5148387597033,
+    1026.2490566743393, 1026.9825870565992, 1027.7154388533215, 1028.4476206634804,
+    1029.1791407599658, 1029.9100071094842, 1030.6402273907829, 1031.3698090113817,
+    1032.0987591229607, 1032.827084635546,
+  },
+  {
+    999.10157456273748, 999.8754235180096, 1000.6452731769674, 1001.4124574872942,
+    1002.1774570460543, 1002.940551716965, 1003.701931626969, 1004.4617372397794,
+    1005.2200780321907, 1005.9770425713863, 1006.7327045080498, 1007.4871263988899,
+    1008.2403622774153, 1008.9924594563747, 1009.7434598347214, 1010.4934008719821,
+    1011.2423163318091, 1011.9902368607858, 1012.7371904467813, 1013.4832027873881,
+    1014.2282975900043, 1014.9724968191084, 1015.7158209021532, 1016.4582889026143,
+    1017.1999186666687, 1017.9407269484772, 1018.6807295179441, 1019.4199412540019,
+    1020.1583762258394, 1020.8960477640192, 1021.6329685230544, 1022.3691505367299,
+    1023.1046052672197, 1023.8393436488735, 1024.5733761274003, 1025.3067126950543,
+    1026.0393629223397, 1026.7713359866655, 1027.5026406983209, 1028.2332855240895,
+    1028.9632786087693, 1029.6926277948367, 1030.421340640456, 1031.1494244360097,
+    1031.8768862193037, 1032.6037327895842,
+  },
+  {
+    998.94497033737514, 999.71675761528979, 1000.4845932410823, 1001.2497964959119,
+    1002.0128426557022, 1002.7740084639991, 1003.5334819125736, 1004.2914018757195,
+    1005.0478765817411, 1005.8029935796851, 1006.5568256666539, 1007.3094346683416,
+    1008.0608739815519, 1008.8111903568173, 1009.5604251909803, 1010.308615490835,
+    1011.0557946084868, 1011.8019928137767, 1012.5472377475788, 1013.291554786172,
+    1014.0349673380061, 1014.7774970882436, 1015.5191642023758, 1016.2599874973552,
+    1016.9999845866488, 1017.7391720041319, 1018.4775653106518, 1019.215179186276,
+    1019.9520275106178, 1020.6881234331621, 1021.4234794351462, 1022.1581073842634,
+    1022.8920185832329, 1023.6252238130976, 1024.3577333719691, 1025.0895571098206,
+    1025.8207044598362, 1026.551184466744, 1027.2810058125015, 1028.0101768396419,
+    1028.7387055725544, 1029.4665997369259, 1030.1938667775469, 1030.9205138746549,
+    1031.6465479589706, 1032.3719757255515,
+  },
+  {
+    998.77688507500147, 999.54670577550689, 1000.3126193951899, 1001.075931536792,
+    1001.8371125132945, 1002.5964361579047, 1003.354088470653, 1004.1102068430509,
+    1004.864898338565, 1005.6182495562258, 1006.3703324965811, 1007.121208303072,
+    1007.8709297782007, 1008.6195431476639, 1009.3670893395225, 1010.1136049378374,
+    1010.8591229103897, 1011.6036731751547, 1012.3472830488836, 1013.0899776076822,
+    1013.8317799806858, 1014.572711592052, 1015.3127923624515, 1016.0520408784159,
+    1016.7904745358738, 1017.5281096627496, 1018.2649616244126, 1019.0010449149585,
+    1019.7363732366927, 1020.4709595697193, 1021.2048162331711, 1021.9379549393385,
+    1022.6703868417288, 1023.4021225779074, 1024.1331723078351, 1024.8635457482928,
+    1025.5932522039011, 1026.3223005951525, 1027.0506994838254, 1027.7784570960835,
+    1028.505581343529, 1029.2320798424394, 1029.9579599313827, 1030.6832286873885,
+    1031.4078929408204, 1032.1319592890866,
+  },
+  {
+    998.59758310277653, 999.36552929041886, 1000.1296099081707, 1000.8911178677363,
+    1001.6505188769856, 1002.4080840683509, 1003.1639975933322, 1003.9183954671061,
+    1004.6713836717832, 1005.4230479243452, 1006.1734594856682, 1006.9226788655691,
+    1007.6707583145271, 1008.4177435706655, 1009.163675126479, 1009.908589173187,
+    1010.6525183213665, 1011.3954921619045, 1012.1375377102055, 1012.8786797632508,
+    1013.6189411904056, 1014.3583431730464, 1015.0969054040819, 1015.8346462556424,
+    1016.5715829212104, 1017.3077315370173, 1018.0431072864582, 1018.7777244904762,
+    1019.511596686266, 1020.2447366961767, 1020.9771566883401, 1021.7088682302656,
+    1022.4398823364257, 1023.1702095106741, 1023.8998597842037, 1024.6288427496315,
+    1025.3571675917096, 1026.0848431150816, 1026.8118777694422, 1027.5382796724075,
+    1028.2640566303605, 1028.9892161574935, 1029.7137654932499, 1030.4377116183325,
+    1031.1610612694283, 1031.883820952781,
+  },
+  {
+    998.40731519998587, 999.17347604946167, 999.93580979109493, 1000.6955976323702,
+    1001.4533010335755, 1002.2091886357045, 1002.963442884748, 1003.7161985258296,
+    1004.4675605430378, 1005.2176138391353, 1005.9664289920836, 1006.7140659265858,
+    1007.4605763832636, 1008.2060056498232, 1008.9503938163074, 1009.6937767108889,
+    1010.4361866139668, 1011.1776528140275, 1011.9182020478185, 1012.657858854161,
+    1013.3966458621134, 1014.1345840284167, 1014.8716928351989, 1015.6079904561348,
+    1016.3434938972804, 1017.0782191173615, 1017.8121811312335, 1018.54539409944,
+    1019.2778714061953, 1020.0096257276562, 1020.7406690919935, 1021.4710129324966,
+    1022.2006681347201, 1022.9296450785124, 1023.6579536756243, 1024.3856034034798,
+    1025.1126033356038, 1025.8389621691213, 1026.5646882496849, 1027.2897895941348,
+    1028.0142739111484, 1028.7381486201077, 1029.4614208683788, 1030.1840975471714,
+    1030.9061853061255, 1031.6276905667587,
+  },
+  {
+    998.20631938240001, 998.97078132297963, 999.73145157936085, 1000.4896006412185,
+    1001.2456860785506, 1001.9999742500619, 1002.7526460390957, 1003.503835026863,
+    1004.2536452826356, 1005.0021609626679, 1005.7494520186524, 1006.4955778385839,
+    1007.240589695293, 1007.9845324631298, 1008.7274458627087, 1009.4693653888633,
+    1010.2103230187573, 1010.9503477630835, 1011.689466102543, 1012.4277023386862,
+    1013.1650788796541, 1013.9016164756267, 1014.6373344148625, 1015.3722506884592,
+    1016.1063821300004, 1016.8397445348287, 1017.5723527626322, 1018.3042208262464,
+    1019.0353619689755, 1019.7657887322874, 1020.4955130153762, 1021.2245461278147,
+    1021.9528988363016, 1022.6805814063329, 1023.4076036394899, 1024.133974906923,
+    1024.8597041795185, 1025.5848000551646, 1026.3092707834651, 1027.0331242882053,
+    1027.7563681878241, 1028.4790098141218, 1029.2010562293885, 1029.922514242128,
+    1030.6433904215205, 1031.3636911107512,
+  },
+  {
+    997.99482168663451, 998.75766854551625, 999.51675611495148, 1000.2733451529575,
+    1001.0278896963561, 1001.7806540305646, 1002.5318176190101, 1003.2815129850133,
+    1004.0298433661235, 1004.7768922396963, 1005.5227289877037, 1006.2674125097453,
+    1007.0109936528398, 1007.7535169149585, 1008.4950216802303, 1009.2355431397792,
+    1009.9751129944015, 1010.7137600015304, 1011.4515104083614, 1012.1883882999949,
+    1012.924415882978, 1013.6596137189389, 1014.394000919116, 1015.1275953078466,
+    1015.8604135611359, 1016.592471325008, 1017.3237833172989, 1018.0543634157708,
+    1018.7842247348349, 1019.5133796927204, 1020.2418400705748, 1020.9696170647074,
+    1021.6967213329733, 1022.4231630361189, 1023.1489518747808, 1023.8740971227065,
+    1024.5986076566874, 1025.3224919836098, 1026.0457582649765, 1026.7684143391953,
+    1027.4904677418911, 1028.211925724466, 1028.9327952710942, 1029.6530831143207,
+    1030.37279574941, 1031.0919394475698,
+  },
+  {
+    997.77303695450973, 998.53435009916268, 999.29193332880402, 1000.0470386558311,
+    1000.8001169408825, 1001.551430604979, 1002.3011578342592, 1003.0494302000779,
+    1003.7963501912665, 1004.5420006738027, 1005.2864505164042, 1006.02975817851,
+    1006.7719741232287, 1007.513142509057, 1008.2533024165103, 1008.9924887625647,
+    1009.7307329984494, 1010.4680636528084, 1011.2045067618097, 1011.9400862148634,
+    1012.6748240361865, 1013.4087406168074, 1014.141854907737, 1014.8741845823138,
+    1015.6057461738048, 1016.3365551929276, 1017.0666262289296, 1017.7959730370851,
+    1018.5246086148785, 1019.2525452687023, 1019.9797946725411, 1020.7063679198471,
+    1021.4322755695972, 1022.1575276873474, 1022.8821338819689, 1023.6061033386356,
+    1024.3294448485437, 1025.0521668357715, 1025.7742773816269, 1026.495784246777,
+    1027.2166948914178, 1027.9370164936984, 1028.6567559665975, 1029.37591997341,
+    1030.0945149419924, 1030.8125470778925,
+  },
+  {
+    997.54116961741079, 998.30102809695927, 999.05718302328421, 999.81087864922119,
+    1000.5625630161552, 1001.312496889524, 1002.0608573207288, 1002.8077750350072,
+    1003.5533518554018, 1004.2976701039634, 1005.0407981925506, 1005.7827941886087,
+    1006.5237082131739, 1007.2635841221086, 1008.0024607251247, 1008.7403726945518,
+    1009.4773512587954, 1010.213424742123, 1010.9486189920979, 1011.6829577231456,
+    1012.4164627963643, 1013.1491544500832, 1013.8810514918272, 1014.6121714596491,
+    1015.3425307588697, 1016.0721447788642, 1016.8010279935094, 1017.5291940481305,
+    1018.2566558352084, 1018.9834255606565, 1019.7095148021369, 1020.4349345606095,
+    1021.1596953060974, 1021.8838070184839, 1022.6072792240157, 1023.3301210280815,
+    1024.0523411447439, 1024.7739479234294, 1025.4949493731197, 1026.2153531843423,
+    1026.9351667492106, 1027.6543971797321, 1028.373051324575, 1029.0911357844582,
+    1029.8086569263039, 1030.5256208962837,
+  },
+  {
+    997.2994144806471, 998.05789516634707, 998.81269565475679, 999.56505342536195,
+    1000.3154140572103, 1001.0640368689296, 1001.8110979196813, 1002.5567271943786,
+    1003.3010259331476, 1004.0440759815037, 1004.7859453507868, 1005.526691764559,
+    1006.2663650435661, 1007.0050087778226, 1007.7426615389951, 1008.4793577842161,
+    1009.2151285457597, 1009.9500019678807, 1010.6840037319118, 1011.4171573979528,
+    1012.1494846831475, 1012.8810056909809, 1013.6117391021894, 1014.3417023352092,
+    1015.0709116821636, 1015.7993824250085, 1016.5271289354256, 1017.2541647612909,
+    1017.9805027019635, 1018.7061548741972, 1019.4311327701338, 1020.1554473085669,
+    1020.8791088804539, 1021.6021273894866, 1022.3245122883912, 1023.0462726115255,
+    1023.7674170042453, 1024.4879537494458, 1025.2078907916186, 1025.9272357587186,
+    1026.6459959820918, 1027.3641785146808, 1028.0817901476987, 1028.7988374259298,
+    1029.5153266618049, 1030.231263948373,
+  },
+  {
+    997.0479575078125, 997.80513523266609, 998.55865311624973, 999.30974285118884,
+    1000.0588479111501, 1000.8062263767135, 1001.5520534572707, 1002.2964585031661,
+    1003.0395422544397, 1003.7813861474204, 1004.5220578492241, 1005.2616147875947,
+    1006.0001065247253, 1006.7375764215242, 1007.474062844326, 1008.2096000644724,
+    1008.9442189447554, 1009.6779474737378, 1010.4108111888552, 1011.1428335164982,
+    1011.8740360489815, 1012.6044387727602, 1013.3340602584415, 1014.0629178204749,
+    1014.7910276524983, 1015.5184049429332, 1016.2450639744062, 1016.9710182098071,
+    1017.6962803672205, 1018.4208624855249, 1019.1447759821099, 1019.8680317038954,
+    1020.5906399726279, 1021.3126106252558, 1022.0339530500578, 1022.7546762190818,
+    1023.4747887173731, 1024.1942987693863, 1024.9132142629276, 1025.6315427709167,
+    1026.3492915712175, 1027.0664676647571, 1027.7830777921174, 1028.4991284487635,
+    1029.2146258990492, 1029.9295761891267,
+  },
+  {
+    996.78697660514479, 997.54292430269811, 998.29522952020284, 999.04511915031389,
+    999.79303491836072, 1000.5392338756596, 1001.2838905242968, 1002.0271336857843,
+    1002.7690636828803, 1003.5097616100459, 1004.2492948464336, 1004.9877205720011,
+    1005.7250881320899, 1006.4614406952082, 1007.1968164550357, 1007.931249526493,
+    1008.6647706295039, 1009.3974076212244, 1010.1291859174902, 1010.8601288315655,
+    1011.5902578500254, 1012.3195928600767, 1013.0481523388219, 1013.7759535123213,
+    1014.5030124904055, 1015.2293443818154, 1015.9549633932298, 1016.6798829149841,
+    1017.4041155957051, 1018.1276734076495, 1018.850567704192, 1019.5728092706428,
+    1020.2944083693619, 1021.0153747799748, 1021.7357178353554, 1022.455446453937,
+    1023.174569168821, 1023.893094154085, 1024.6110292486285, 1025.3283819778455,
+    1026.0451595733778, 1026.7613689911593, 1027.4770169279409, 1028.1921098364569,
+    1028.9066539393741, 1029.6206552421484,
+  },
+  {
+    996.51664240588605, 997.27143124824909, 998.02259198129696, 998.77134768511951,
+    999.51813869388707, 1000.2632212384881, 1001.006769256184, 1001.7489111453899,
+    1002.4897468943755, 1003.2293573230335, 1003.9678095787934, 1004.7051606418323,
+    1005.4414596823161, 1006.1767497130307, 1006.91106878765, 1007.6444508940152,
+    1008.376926635765, 1009.1085237629059, 1009.8392675919415, 1010.5691813435628,
+    1011.2982864176665, 1012.026602619963, 1012.7541483506463, 1013.4809407629568,
+    1014.2069958975685, 1014.9323287973666, 1015.6569536061627, 1016.3808836541425,
+    1017.104131532264, 1017.8267091573894, 1018.5486278295906, 1019.2698982828045,
+    1019.9905307298047, 1020.710534902288, 1021.4299200867426, 1022.1486951566555,
+    1022.8668686015287, 1023.5844485531017, 1024.3014428091205, 1025.017858854942,
+    1025.7337038832211, 1026.4489848118983, 1027.1637083006699, 1027.8778807661063,
+    1028.5915083955549, 1029.3045971599547,
+  },
+  {
+    996.23711905464211, 996.99081858977115, 997.74090139935856, 998.488587738962,
+    999.23431690895131, 999.97834452870245, 1000.7208441131711, 1001.4619437434263,
+    1002.2017431560441, 1002.9403229636446, 1003.677750138162, 1004.4140815079844,
+    1005.1493661097595, 1005.8836468372103, 1006.6169616366327, 1007.3493443981074,
+    1008.0808256355506, 1008.8114330160519, 1009.5411917790281, 1010.2701250731263,
+    1010.9982542306025, 1011.7255989933988, 1012.4521777013739, 1013.1780074504931,
+    1013.9031042269011, 1014.6274830214293, 1015.3511579280794, 1016.0741422292684,
+    1016.7964484700526, 1017.5180885231041, 1018.2390736458807, 1018.9594145311615,
+    1019.6791213519108, 1020.398203801269, 1021.1166711283362, 1021.8345321703008,
+    1022.5517953813874, 1023.2684688590157, 1023.9845603675121, 1024.7000773596619,
+    1025.4150269963498, 1026.1294161645012, 1026.8432514935164, 1027.5565393703475,
+    1028.2692859533713, 1028.9814971851695,
+  },
+  {
+    995.94856499174239, 996.70124328001941, 997.45031324233378, 998.19699329847958,
+    998.94172207260715, 999.68475478160406, 1000.426264660697, 1001.1663795793918,
+    1001.9051991053828, 1002.6428037113175, 1003.3792602498627, 1004.1146254456037,
+    1004.8489482433182, 1005.5822714543133, 1006.3146329501214, 1007.0460665523674,
+    1007.7766027117901, 1008.5062690367788, 1009.2350907118904, 1009.96309083424,
+    1010.690290687461, 1011.4167099674379, 1012.1423669702471, 1012.8672787501052,
+    1013.5914612532357, 1014.3149294321991, 1015.0376973442245, 1015.7597782363237,
+    1016.4811846193977, 1017.2019283331144, 1017.922020602988, 1018.6414720908356,
+    1019.3602929395707, 1020.0784928131325, 1020.7960809322103, 1021.5130661063246,
+    1022.2294567627259, 1022.9452609725147, 1023.6604864743134, 1024.3751406957849,
+    1025.0892307732406, 1025.8027635695551, 1026.5157456905704, 1027.2281835001515,
+    1027.9400831340349, 1028.6514505125888,
+  },
+  {
+    995.65113373759993, 996.40285748774318, 997.15097832932952, 997.89671383599659,
+    998.64050231352212, 999.38259878546296, 1000.123176349972, 1000.8623627708224,
+    1001.6002575296677, 1002.3369410265005, 1003.0724800509574, 1003.8069312718094,
+    1004.5403435836122, 1005.2727597518999, 1006.0042176060493, 1006.7347509285249,
+    1007.4643901334236, 1008.1931627946396, 1008.9210940640847, 1009.6482070078408,
+    1010.374522879924, 1011.1000613478565, 1011.824840680472, 1012.5488779057501,
+    1013.2721889445859, 1013.9947887250366, 1014.7166912805822, 1015.437909835175,
+    1016.1584568772942, 1016.8783442247728, 1017.5975830818364, 1018.3161840895209,
+    1019.0341573704328, 1019.751512568648, 1020.4682588854093, 1021.184405111183,
+    1021.8999596545352, 1022.6149305682317, 1023.3293255728918, 1024.0431520784898,
+    1024.7564172039481, 1025.4691277950367, 1026.1812904407655, 1026.8929114884272,
+    1027.6039970574352, 1028.3145530520726,
+  },
+  {
+    995.34497467707115, 996.09580938140789, 996.84304361371494, 997.58789509201893,
+    998.33080216187727, 999.07201986283451, 999.81172129872175, 1000.5500342334722,
+    1001.2870581455815, 1002.0228734297339, 1002.7575468687908, 1003.4911351237105,
+    1004.2236870804809, 1004.955245495509, 1005.6858481886239, 1006.4155289324231,
+    1007.144318130893, 1007.8722433476318, 1008.5993297241142, 1009.3256003158796,
+    1010.0510763663236, 1010.7757775322921, 1011.4997220719056, 1012.2229270024077,
+    1012.945408233947, 1013.6671806838347, 1014.3882583748118, 1015.1086545201082,
+    1015.8283815975002, 1016.5474514141449, 1017.2658751636217, 1017.983663476354,
+    1018.7008264643728, 1019.4173737612168, 1020.1333145576343, 1020.8486576336386,
+    1021.5634113873886, 1022.2775838612882, 1022.9911827656425, 1023.7042155001589,
+    1024.4166891735413, 1025.1286106213913, 1025.8399864225996, 1026.5508229143904,
+    1027.2611262061582, 1027.9709021922188,
+  },
+  {
+    995.03023384381538, 995.7802439129465, 996.52665296628049, 997.27067985781378,
+    998.01276333137935, 998.75315865201333, 999.49203907209176, 1000.2295324616787,
+    1000.9657383790486, 1001.7007372809624, 1002.43459599979, 1003.1673712366978,
+    1003.8991119107754, 1004.6298608059587, 1005.3596557651433, 1006.0885305803565,
+    1006.8165156720075, 1007.5436386175974, 1008.26992457037, 1008.9953965958096,
+    1009.7200759456836, 1010.4439822838432, 1011.167133874219, 1011.8895477388135,
+    1012.6112397916042, 1013.3322249529051, 1014.0525172477227, 1014.7721298908905,
+    1015.491075361195, 1016.2093654662667, 1016.9270113996728, 1017.644023791384,
+    1018.3604127525775, 1019.0761879155732, 1019.7913584695654, 1020.5059331927082,
+    1021.2199204810204, 1021.9333283745075, 1022.6461645808388, 1023.3584364968673,
+    1024.0701512282408, 1024.7813156073178, 1025.4919362095734, 1026.2020193686569,
+    1026.91157119024, 1027.6205975647779,
+  },
+  {
+    994.70705470465543, 995.45630360153871, 996.2019479584518, 996.94520875806893,
+    997.68652550137665, 998.42615388861498, 999.1642674637053, 999.90099430890427,
+    1000.6364341452677, 1001.3706675590671, 1002.1037614885017, 1002.835772722996,
+    1003.5667502564316, 1004.2967369369462, 1005.0257706631292, 1005.7538852757446,
+    1006.4811112381637, 1007.2074761659945, 1007.9330052464596, 1008.6577215754771,
+    1009.3816464321793, 1010.1047995051028, 1010.8271990805106, 1011.5488622006561,
+    1012.2698047979185, 1012.9900418093597, 1013.7095872752509, 1014.4284544243527,
+    1015.1466557481684, 1015.8642030659462, 1016.5811075818693, 1017.29737993561,
+    1018.0130302472079, 1018.7280681570744, 1019.442502861786, 1020.1563431462234,
+    1020.8695974125259, 1021.5822737062573, 1022.2943797401234, 1023.0059229155278,
+    1023.7169103422166, 1024.4273488562239, 1025.1372450363065, 1025.8466052190245,
+    1026.5554355126148, 1027.2637418097731,
+  },
+  {
+    994.37557894393672, 995.12412931741437, 995.86906864555169, 996.61162103362528,
+    997.35222709907066, 998.09114318727677, 998.82854327686039, 999.56455576843734,
+    1000.2992806289251, 1001.0327986415984, 1001.7651769068522, 1002.4964723504548,
+    1003.2267340828001, 1003.9560050529234, 1004.6843232477537, 1005.4117225861141,
+    1006.1382336008905, 1006.8638839700111, 1007.5886989368946, 1008.3127016483885,
+    1009.035913429987, 1009.7583540125967, 1010.480041721337, 1011.2009936342064,
+    1011.9212257165581, 1012.6407529359479, 1013.3595893609103, 1014.0777482464543,
+    1014.7952421085057, 1015.512082789072, 1016.2282815135792, 1016.9438489415512,
+    1017.6587952116032, 1018.3731299815461, 1019.0868624642701, 1019.8000014599648,
+    1020.5125553851465, 1021.2245322988896, 1021.9359399266041, 1022.646785681645,
+    1023.3570766850066, 1024.0668197833129, 1024.7760215652929, 1025.4846883769005,
+    1026.1928263352202, 1026.9004413412836,
+  },
+  {
+    994.03594724788741, 994.78386106568155, 995.52815435011019, 996.27005532427825,
+    997.01000608181926, 997.74826382346998, 998.48500310585882, 999.22035275424662,
+    999.95441306458031, 1000.6872650846991, 1001.418976133614, 1002.1496033215674,
+    1002.8791959172207, 1003.6077970072328, 1004.3354446995434, 1005.0621730203774,
+    1005.7880125987048, 1006.5129911990031, 1007.2371341431166, 1007.9604646493282,
+    1008.6830041085008, 1009.4047723116022, 1010.125787639139, 1010.8460672203538,
+    1011.5656270681509, 1012.284482194329, 1013.0026467086871, 1013.7201339048067,
+    1014.436956334742, 1015.1531258744039, 1015.8686537810866, 1016.5835507443172,
+    1017.297826930999, 1018.0114920256491, 1018.7245552664024, 1019.4370254773386,
+    1020.1489110976055, 1020.8602202077392, 1021.5709605535194, 1022.2811395676513,
+    1022.9907643895248, 1023.6998418832654, 1024.4083786542637, 1025.1163810643457,
+    1025.8238552457242, 1026.5308071138581,
+  },
+  {
+    993.68830008897839, 994.43563877017607, 995.17934444521643, 995.92065045164338,
+    996.6600007195226, 997.39765351541439, 998.13378411745816, 998.86852188197497,
+    999.60196751720912, 1000.334202403203, 1001.0652941340668, 1001.7953000526973,
+    1002.5242696278222, 1003.2522461204856, 1003.9792677923396, 1004.7053688063796,
+    1005.4305799142523, 1006.154928991233, 1006.878441459838, 1007.6011406303071,
+    1008.3230479778908, 1009.0441833713219, 1009.7645652630343, 1010.4842108490229,
+    1011.2031362043281, 1011.921356398747, 1012.6388855963505, 1013.3557371416215,
+    1014.0719236344542, 1014.7874569958093, 1015.5023485254792, 1016.2166089531482,
+    1016.9302484837225, 1017.6432768377349, 1018.355703287497, 1019.0675366895607,
+    1019.778785513962, 1020.4894578706499, 1021.1995615334396, 1021.9091039617854,
+    1022.6180923206209, 1023.3265334984842, 1024.0344341241162, 1024.7418005816928,
+    1025.4486390248355, 1026.1549553895222,
+  },
+  {
+    993.33277851028265, 994.07960305733093, 994.82277913791086, 995.56354620207901,
+    996.30235037708667, 997.03945120608944, 997.77502483243461, 998.50920125006337,
+    999.24208166289407, 999.9737478508971, 1000.7042677398352, 1001.4336989534996,
+    1002.1620912025311, 1002.8894879591629, 1003.6159276714968, 1004.3414446686999,
+    1005.066069851715, 1005.7898312308877, 1006.5127543516752, 1007.2348626368139,
+    1007.956177664979, 1008.6767194003861, 1009.3965063839515, 1010.1155558939424,
+    1010.8338840821314, 1011.5515060900801, 1012.2684361491479, 1012.9846876670561,
+    1013.7002733032577, 1014.4152050349173, 1015.1294942149615, 1015.8431516233911,
+    1016.5561875128357, 1017.2686116491568, 1017.9804333477801, 1018.6916615063159,
+    1019.4023046339474, 1020.112370877991, 1020.821868047967, 1021.5308036374797,
+    1022.2391848441565, 1022.9470185878614, 1023.6543115273761, 1024.3610700757067,
+    1025.0673004141638, 1025.773008505337,
+  },
+  {
+    992.96952490983574, 993.71589604006476, 994.45860025261413, 995.1988841096653,
+    995.93719629695795, 996.67379784533193, 997.40886590725233, 998.14253122099535,
+    998.87489556964931, 999.60604120093342, 1000.3360364288947, 1001.0649392065226,
+    1001.7927995282746, 1002.5196611144244, 1003.2455626323028, 1003.9705386066854,
+    1004.6946201144639, 1005.4178353253552, 1006.140209930052, 1006.8617674843506,
+    1007.5825296894084, 1008.3025166226615, 1009.0217469300807, 1009.7402379877414,
+    1010.4580060387593, 1011.1750663102399, 1011.89143311386, 1012.6071199329277,
+    1013.3221394981845, 1014.0365038541621, 1014.7502244175664, 1015.463312028883,
+    1016.1757769981923, 1016.8876291460064, 1017.5988778398074, 1018.3095320268568,
+    1019.0196002637512, 1019.7290907431334, 1020.4380113179031, 1021.1463695232216,
+    1021.8541725965634, 1022.5614274960369, 1023.2681409171582, 1023.974319308248,
+    1024.6799688845902, 1025.3850956414817,
+  },
+  {
+    992.59868382499508, 993.34466210168648, 994.08695201458829, 994.82680823923033,
+    995.56468238172272, 996.30083717201467, 997.03545091582623, 997.76865520264994,
+    998.50055247837008, 999.23122552637892, 999.96074310572465, 1000.6891635469718,
+    1001.4165371703591, 1002.142907981106, 1002.8683148985982, 1003.5927926726988,
+    1004.3163725829373, 1005.0390829827375, 1005.7609497303511, 1006.4819965352251,
+    1007.2022452400821, 1007.9217160533391, 1008.6404277426136, 1009.3583977973456,
+    1010.0756425666224, 1010.792177376889, 1011.5080166331838, 1012.2231739067652,
+    1012.9376620114053, 1013.65149307018, 1014.3646785742307, 1015.0772294347067,
+    1015.789156028878, 1016.5004682412373, 1017.211175500277, 1017.9212868115101,
+    1018.63081078722, 1019.3397556733446, 1020.0481293738443, 1020.7559394728498,
+    1021.463193254845, 1022.1698977231057, 1022.8760596165836, 1023.5816854254025,
+    1024.2867814051101, 1024.9913535898118,
+  },
+  {
+    992.22040271679998, 992.96604867981512, 993.70798183342902, 994.44746596942207,
+    995.1849559767652, 995.9207164962969, 996.6549271313703, 997.38772042975461,
+    998.11919958389376, 998.84944798088952, 999.57853488160129, 1000.3065190426242,
+    1001.0334511520107, 1001.7593755368898, 1002.4843314015812, 1003.2083537505599,
+    1003.931474092725, 1004.6537209895786, 1005.3751204892906, 1006.0956964755809,
+    1006.8154709518481, 1007.5344642752768, 1008.2526953517495, 1008.970181799648,
+    1009.6869400886812, 1010.4029856584498, 1011.1183330204163, 1011.8329958461694,
+    1012.5469870442714, 1013.2603188275332, 1013.9730027722035, 1014.685049870288,
+    1015.3964705759976, 1016.1072748471488, 1016.8174721822079, 1017.5270716535526,
+    1018.2360819374371, 1018.944511341072, 1019.6523678271699, 1020.3596590362532,
+    1021.066392306985, 1021.7725746947409, 1022.4782129886167, 1023.1833137270368,
+    1023.8878832121095, 1024.5919275228575,
+  },
+};
+// clang-format on
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef ZSF_EVENT_QUEUE_H
+#define ZSF_EVENT_QUEUE_H
+
+/* A priority queue of events for discrete-event simulation, as a binary heap
+   ordered by time. Events at the same time come out in the order in which
+   they were pushed, such that a simulation does not depend on how the heap
+   happens to break ties. */
+
+#include <stdlib.h>
+
+typedef struct event_t {
+  double time;
+  unsigned long long seq;
+  int type;
+  int arg;
+} event_t;
+
+typedef struct event_queue_t {
+  event_t *events;
+  int size;
+  int capacity;
+  unsigned long long next_seq;
+} event_queue_t;
+
+static inline void event_queue_init(event_queue_t *q) {
+  q->events = NULL;
+  q->size = 0;
+  q->capacity = 0;
+  q->next_seq = 0;
+}
+
+static inline void event_queue_free(event_queue_t *q) {
+  free(q->events);
+  event_queue_init(q);
+}
+
+static inline int event_before(const event_t *a, const event_t *b) {
+  return (a->time < b->time) || (a->time == b->time && a->seq < b->seq);
+}
+
+// Returns 0 if there is no memory for the event
+static inline int event_queue_push(event_queue_t *q, double time, int type, int arg) {
+  if (q->size == q->capacity) {
+    int capacity = (q->capacity > 0) ? 2 * q->capacity : 16;
+    event_t *events = (event_t *)realloc(q->events, capacity * sizeof(event_t));
+    if (events == NULL)
+      return 0;
+    q->events = events;
+    q->capacity = capacity;
+  }
+
+  event_t e = {time, q->next_seq++, type, arg};
+  int i = q->size++;
+  while (i > 0) {
+    int parent = (i - 1) / 2;
+    if (!event_before(&e, &q->events[parent]))
+      break;
+    q->events[i] = q->events[parent];
+    i = parent;
+  }
+  q->events[i] = e;
+  return 1;
+}
+
+// The earliest event, of a queue that is not empty
+static inline const event_t *event_queue_top(const event_queue_t *q) { return &q->events[0]; }
+
+static inline event_t event_queue_pop(event_queue_t *q) {
+  event_t top = q->events[0];
+  event_t last = q->events[--q->size];
+
+  int i = 0;
+  for (;;) {
+    int child = 2 * i + 1;
+    if (child >= q->size)
+      break;
+    if (child + 1 < q->size && event_before(&q->events[child + 1], &q->events[child]))
+      child++;
+    if (!event_before(&q->events[child], &last))
+      break;
+    q->events[i] = q->events[child];
+    i = child;
+  }
+  if (q->size > 0)
+    q->events[i] = last;
+  return top;
+}
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef ZSF_FASTMATH_H
+#define ZSF_FASTMATH_H
+
+/* Approximations of the transcendental functions used by the phase kernels,
+   in accuracy tiers that can be selected at runtime (see ZSF_ACCURACY_* in
+   zsf.h). The approximations are branch-free, such that loops over them can
+   be vectorized by the compiler. The maximum errors are measured by
+   bench/bench_math.c and listed in the documentation of zsf_options_t.
+
+   The square root has no approximations, as hardware square roots are both
+   exact and about as fast as any approximation. */
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "zsf.h"
+
+static inline double fastmath_from_bits(uint64_t u) {
+  double d;
+  memcpy(&d, &u, sizeof(double));
+  return d;
+}
+
+static inline uint64_t fastmath_to_bits(double d) {
+  uint64_t u;
+  memcpy(&u, &d, sizeof(double));
+  return u;
+}
+
+// Range reduction for exp: x = n * ln(2) + r with |r| <= ln(2) / 2. The
+// argument is clipped to the range where 2^n is a normal number, which gives
+// an absolute error of at most 1E-307 below that range.
+static inline double exp_reduce(double x, double *scale) {
+  const double ln2_hi = 6.93147180369123816490E-01;
+  const double ln2_lo = 1.90821492927058770002E-10;
+
+  x = fmin(fmax(x, -708.0), 709.0);
+
+  double n = floor(x * 1.44269504088896338700 + 0.5);
+  *scale = fastmath_from_bits((uint64_t)((int64_t)n + 1023) << 52);
+
+  return (x - n * ln2_hi) - n * ln2_lo;
+}
+
+// Taylor polynomial of degree 10, relative error below 1E-13
+static inline double exp_fast(double x) {
+  double scale;
+  double r = exp_reduce(x, &scale);
+
+  double p = 1.0 / 3628800.0 * r + 1.0 / 362880.0;
+  p = p * r + 1.0 / 40320.0;
+  p = p * r + 1.0 / 5040.0;
+  p = p * r + 1.0 / 720.0;
+  p = p * r + 1.0 / 120.0;
+  p = p * r + 1.0 / 24.0;
+  p = p * r + 1.0 / 6.0;
+  p = p * r + 0.5;
+  p = p * r + 1.0;
+  p = p * r + 1.0;
+
+  return p * scale;
+}
+
+// Taylor polynomial of degree 5, relative error below 3E-6
+static inline double exp_fastest(double x) {
+  double scale;
+  double r = exp_reduce(x, &scale);
+
+  double p = 1.0 / 120.0 * r + 1.0 / 24.0;
+  p = p * r + 1.0 / 6.0;
+  p = p * r + 0.5;
+  p = p * r + 1.0;
+  p = p * r + 1.0;
+
+  return p * scale;
+}
+
+// Initial guess of the cube root of a positive number, by dividing the
+// exponent (and mantissa) bits by three. Relative error below 4%.
+static inline double cbrt_guess(double ax) {
+  return fastmath_from_bits(fastmath_to_bits(ax) / 3 + ((uint64_t)715094163 << 32));
+}
+
+// Halley's iteration for the cube root, which triples the number of correct
+// digits every step
+static inline double cbrt_halley(double y, double ax) {
+  double y3 = y * y * y;
+  return y * (y3 + 2.0 * ax) / (2.0 * y3 + ax);
+}
+
+static inline double cbrt_fast(double x) {
+  double ax = fabs(x);
+  double y = cbrt_guess(ax);
+  y = cbrt_halley(y, ax);
+  y = cbrt_halley(y, ax);
+  return (ax > 0.0) ? copysign(y, x) : x;
+}
+
+static inline double cbrt_fastest(double x) {
+  double ax = fabs(x);
+  double y = cbrt_halley(cbrt_guess(ax), ax);
+  return (ax > 0.0) ? copysign(y, x) : x;
+}
+
+// tanh(x) = (1 - exp(-2|x|)) / (1 + exp(-2|x|)), which cannot overflow
+static inline double tanh_fast(double x) {
+  double e = exp_fast(-2.0 * fabs(x));
+  return copysign((1.0 - e) / (1.0 + e), x);
+}
+
+// A rational approximation with an absolute error below 3E-3
+static inline double tanh_fastest(double x) {
+  const double ax = fabs(x);
+  const double x2 = x * x;
+
+  const double z1 =
+      (x *
+       (2.45550750702956 + 2.45550750702956 * ax +
+        (0.893229853513558 + 0.821226666969744 * ax) * x2) /
+       (2.44506634652299 + (2.44506634652299 + x2) * fabs(x + 0.814642734961073 * x * ax)));
+
+  return fmin(z1, 1.0);
+}
+
+// Dispatch on the accuracy tier. Unknown tiers are exact.
+static inline double math_exp(int accuracy, double x) {
+  if (accuracy == ZSF_ACCURACY_FASTEST)
+    return exp_fastest(x);
+  if (accuracy == ZSF_ACCURACY_FAST)
+    return exp_fast(x);
+  return exp(x);
+}
+
+static inline double math_cbrt(int accuracy, double x) {
+  if (accuracy == ZSF_ACCURACY_FASTEST)
+    return cbrt_fastest(x);
+  if (accuracy == ZSF_ACCURACY_FAST)
+    return cbrt_fast(x);
+  return cbrt(x);
+}
+
+static inline double math_tanh(int accuracy, double x) {
+  if (accuracy == ZSF_ACCURACY_FASTEST)
+    return tanh_fastest(x);
+  if (accuracy == ZSF_ACCURACY_FAST)
+    return tanh_fast(x);
+  return tanh(x);
+}
+
+#endif
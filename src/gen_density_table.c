@@ -0,0 +1,94 @@
+/*****************************************************************************
+ * gen_density_table.c: generate density_table.h
+ *
+ * The table holds the density of sea water for a grid of salinities (in
+ * kg/m3) and temperatures, for bilinear interpolation by
+ * sal_2_density_table. To regenerate it, build the zsf-gen-density-table
+ * target and run
+ *
+ *     zsf-gen-density-table > src/density_table.h
+ *****************************************************************************/
+
+#include <stdio.h>
+
+#include "util.h"
+
+#define SAL_MIN 0.0
+#define SAL_STEP 1.0
+#define NUM_SAL 46
+
+#define TEMP_MIN -2.0
+#define TEMP_STEP 1.0
+#define NUM_TEMP 43
+
+// Points per cell (in both directions) at which the interpolation error is
+// checked. The density is smooth and its second derivatives vary little
+// within a cell, so the maximum error over these points is close to the true
+// maximum. The safety factor covers the difference.
+#define NUM_CHECK 16
+#define SAFETY_FACTOR 1.5
+
+static double exact(double sal, double temperature) {
+  return sal_2_density(sal, temperature, 1E-15, 0.0);
+}
+
+int main(void) {
+  static double table[NUM_TEMP][NUM_SAL];
+
+  for (int j = 0; j < NUM_TEMP; j++) {
+    for (int i = 0; i < NUM_SAL; i++) {
+      table[j][i] = exact(SAL_MIN + i * SAL_STEP, TEMP_MIN + j * TEMP_STEP);
+    }
+  }
+
+  double max_error = 0.0;
+
+  for (int j = 0; j < NUM_TEMP - 1; j++) {
+    for (int i = 0; i < NUM_SAL - 1; i++) {
+      for (int m = 0; m <= NUM_CHECK; m++) {
+        for (int n = 0; n <= NUM_CHECK; n++) {
+          double fx = (double)n / NUM_CHECK;
+          double fy = (double)m / NUM_CHECK;
+
+          double rho_0 = table[j][i] + fx * (table[j][i + 1] - table[j][i]);
+          double rho_1 = table[j + 1][i] + fx * (table[j + 1][i + 1] - table[j + 1][i]);
+          double rho = rho_0 + fy * (rho_1 - rho_0);
+
+          double error =
+              fabs(rho - exact(SAL_MIN + (i + fx) * SAL_STEP, TEMP_MIN + (j + fy) * TEMP_STEP));
+          max_error = fmax(max_error, error);
+        }
+      }
+    }
+  }
+
+  printf("/*****************************************************************************\n");
+  printf(" * density_table.h: generated by gen_density_table.c, do not edit\n");
+  printf(" *****************************************************************************/\n\n");
+  printf("#ifndef ZSF_DENSITY_TABLE_H\n");
+  printf("#define ZSF_DENSITY_TABLE_H\n\n");
+  printf("#define DENSITY_TABLE_SAL_MIN (%.1f)\n", SAL_MIN);
+  printf("#define DENSITY_TABLE_SAL_STEP %.1f\n", SAL_STEP);
+  printf("#define DENSITY_TABLE_NUM_SAL %d\n\n", NUM_SAL);
+  printf("#define DENSITY_TABLE_TEMP_MIN (%.1f)\n", TEMP_MIN);
+  printf("#define DENSITY_TABLE_TEMP_STEP %.1f\n", TEMP_STEP);
+  printf("#define DENSITY_TABLE_NUM_TEMP %d\n\n", NUM_TEMP);
+  printf("// Upper bound of the interpolation error in kg/m3\n");
+  printf("#define DENSITY_TABLE_MAX_ERROR %.1e\n\n", SAFETY_FACTOR * max_error);
+  printf("// clang-format off\n");
+  printf("static const double density_table[DENSITY_TABLE_NUM_TEMP][DENSITY_TABLE_NUM_SAL] = {\n");
+  for (int j = 0; j < NUM_TEMP; j++) {
+    printf("  {");
+    for (int i = 0; i < NUM_SAL; i++) {
+      if (i % 4 == 0)
+        printf("\n   ");
+      printf(" %.17g,", table[j][i]);
+    }
+    printf("\n  },\n");
+  }
+  printf("};\n");
+  printf("// clang-format on\n\n");
+  printf("#endif\n");
+
+  return 0;
+}
@@ -0,0 +1,222 @@
+#include <stdlib.h>
+
+#include "parallel.h"
+
+#ifdef _WIN32
+#  define WIN32_LEAN_AND_MEAN
+#  include <process.h>
+#  include <windows.h>
+
+typedef CRITICAL_SECTION mutex_t;
+#  define mutex_init(m) InitializeCriticalSection(m)
+#  define mutex_destroy(m) DeleteCriticalSection(m)
+#  define mutex_lock(m) EnterCriticalSection(m)
+#  define mutex_unlock(m) LeaveCriticalSection(m)
+
+typedef HANDLE thread_t;
+#else
+#  include <pthread.h>
+#  include <unistd.h>
+
+typedef pthread_mutex_t mutex_t;
+#  define mutex_init(m) pthread_mutex_init(m, NULL)
+#  define mutex_destroy(m) pthread_mutex_destroy(m)
+#  define mutex_lock(m) pthread_mutex_lock(m)
+#  define mutex_unlock(m) pthread_mutex_unlock(m)
+
+typedef pthread_t thread_t;
+#endif
+
+// The remaining part of the iteration range owned by a thread. The owner
+// takes chunks from the front, other threads steal from the back.
+typedef struct worker_t {
+  mutex_t lock;
+  int begin;
+  int end;
+} worker_t;
+
+typedef struct scheduler_t {
+  worker_t *workers;
+  int num_workers;
+  int chunk_size;
+  parallel_range_fn fn;
+  void *data;
+} scheduler_t;
+
+typedef struct worker_arg_t {
+  scheduler_t *scheduler;
+  int index;
+} worker_arg_t;
+
+int parallel_num_cores(void) {
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  int n = (int)info.dwNumberOfProcessors;
+#else
+  int n = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+  return (n > 0) ? n : 1;
+}
+
+int parallel_num_threads(int num_threads, int n) {
+  if (num_threads <= 0)
+    num_threads = parallel_num_cores();
+  if (num_threads > n)
+    num_threads = n;
+  return (num_threads > 0) ? num_threads : 1;
+}
+
+static int take_chunk(scheduler_t *s, worker_t *w, int *begin, int *end) {
+  int found = 0;
+
+  mutex_lock(&w->lock);
+  if (w->begin < w->end) {
+    *begin = w->begin;
+    *end = (w->end - w->begin > s->chunk_size) ? w->begin + s->chunk_size : w->end;
+    w->begin = *end;
+    found = 1;
+  }
+  mutex_unlock(&w->lock);
+
+  return found;
+}
+
+static int steal_work(scheduler_t *s, int thief) {
+  for (int offset = 1; offset < s->num_workers; offset++) {
+    worker_t *victim = &s->workers[(thief + offset) % s->num_workers];
+
+    int begin = 0, end = 0;
+
+    mutex_lock(&victim->lock);
+    int remaining = victim->end - victim->begin;
+    if (remaining > 0) {
+      // Take the back half, rounding up such that a single remaining
+      // iteration can also be stolen.
+      end = victim->end;
+      begin = end - (remaining + 1) / 2;
+      victim->end = begin;
+    }
+    mutex_unlock(&victim->lock);
+
+    if (begin < end) {
+      worker_t *w = &s->workers[thief];
+      mutex_lock(&w->lock);
+      w->begin = begin;
+      w->end = end;
+      mutex_unlock(&w->lock);
+      return 1;
+    }
+  }
+
+  // The total amount of work never increases, so if all other threads are out
+  // of work as well, we are done.
+  return 0;
+}
+
+static void worker_loop(scheduler_t *s, int index) {
+  worker_t *w = &s->workers[index];
+
+  do {
+    int begin, end;
+    while (take_chunk(s, w, &begin, &end)) {
+      s->fn(s->data, begin, end, index);
+    }
+  } while (steal_work(s, index));
+}
+
+#ifdef _WIN32
+static unsigned __stdcall worker_main(void *arg) {
+  worker_arg_t *a = (worker_arg_t *)arg;
+  worker_loop(a->scheduler, a->index);
+  return 0;
+}
+
+static int thread_start(thread_t *t, worker_arg_t *arg) {
+  *t = (HANDLE)_beginthreadex(NULL, 0, worker_main, arg, 0, NULL);
+  return *t != 0;
+}
+
+static void thread_join(thread_t t) {
+  WaitForSingleObject(t, INFINITE);
+  CloseHandle(t);
+}
+#else
+static void *worker_main(void *arg) {
+  worker_arg_t *a = (worker_arg_t *)arg;
+  worker_loop(a->scheduler, a->index);
+  return NULL;
+}
+
+static int thread_start(thread_t *t, worker_arg_t *arg) {
+  return pthread_create(t, NULL, worker_main, arg) == 0;
+}
+
+static void thread_join(thread_t t) { pthread_join(t, NULL); }
+#endif
+
+void parallel_for(int n, int chunk_size, int num_threads, parallel_range_fn fn, void *data) {
+  if (n <= 0)
+    return;
+
+  num_threads = parallel_num_threads(num_threads, n);
+  if (chunk_size <= 0)
+    chunk_size = 1;
+
+  worker_t *workers = NULL;
+  thread_t *threads = NULL;
+  worker_arg_t *args = NULL;
+  int *started = NULL;
+
+  if (num_threads > 1) {
+    workers = (worker_t *)malloc(num_threads * sizeof(worker_t));
+    threads = (thread_t *)malloc(num_threads * sizeof(thread_t));
+    args = (worker_arg_t *)malloc(num_threads * sizeof(worker_arg_t));
+    started = (int *)malloc(num_threads * sizeof(int));
+  }
+
+  // Serial execution, either on request or as fallback when out of memory
+  if (workers == NULL || threads == NULL || args == NULL || started == NULL) {
+    free(workers);
+    free(threads);
+    free(args);
+    free(started);
+
+    for (int begin = 0; begin < n; begin += chunk_size) {
+      fn(data, begin, (n - begin > chunk_size) ? begin + chunk_size : n, 0);
+    }
+    return;
+  }
+
+  scheduler_t s = {workers, num_threads, chunk_size, fn, data};
+
+  for (int i = 0; i < num_threads; i++) {
+    mutex_init(&workers[i].lock);
+    workers[i].begin = (int)((long long)n * i / num_threads);
+    workers[i].end = (int)((long long)n * (i + 1) / num_threads);
+    args[i].scheduler = &s;
+    args[i].index = i;
+  }
+
+  // Threads that fail to start leave their share of the work to be stolen by
+  // the others. The calling thread is worker 0.
+  for (int i = 1; i < num_threads; i++) {
+    started[i] = thread_start(&threads[i], &args[i]);
+  }
+
+  worker_loop(&s, 0);
+
+  for (int i = 1; i < num_threads; i++) {
+    if (started[i])
+      thread_join(threads[i]);
+  }
+
+  for (int i = 0; i < num_threads; i++) {
+    mutex_destroy(&workers[i].lock);
+  }
+
+  free(started);
+  free(workers);
+  free(threads);
+  free(args);
+}
@@ -0,0 +1,23 @@
+#ifndef ZSF_PARALLEL_H
+#define ZSF_PARALLEL_H
+
+/* Work on the range [begin, end) of a parallel loop. The thread index is in
+   the range [0, num_threads), and can be used to index per-thread data. */
+typedef void (*parallel_range_fn)(void *data, int begin, int end, int thread);
+
+/* The number of processors available to this process (at least 1). */
+int parallel_num_cores(void);
+
+/* The number of threads that parallel_for will use for a requested number of
+   threads, where 0 (or less) means one thread per core. */
+int parallel_num_threads(int num_threads, int n);
+
+/* Call fn for chunks of at most chunk_size iterations in the range [0, n),
+   spread over num_threads threads (see parallel_num_threads). The calling
+   thread takes part in the work. Every thread starts with an equal share of
+   the range, and threads that run out of work steal half of the remaining
+   work of another thread, such that chunks that take much longer than others
+   do not leave threads idle. */
+void parallel_for(int n, int chunk_size, int num_threads, parallel_range_fn fn, void *data);
+
+#endif
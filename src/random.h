@@ -0,0 +1,59 @@
+#ifndef ZSF_RANDOM_H
+#define ZSF_RANDOM_H
+
+/* The counter-based random number generator Philox4x32-10 (Salmon et al.,
+   "Parallel random numbers: as easy as 1, 2, 3", 2011). Every counter gives
+   four independent 32-bit random numbers, without any state to carry from one
+   number to the next. Numbers can therefore be generated in any order, on any
+   thread, and the same counter and key always give the same numbers. */
+
+#include <math.h>
+#include <stdint.h>
+
+static inline void philox_mulhilo(uint32_t a, uint32_t b, uint32_t *hi, uint32_t *lo) {
+  uint64_t product = (uint64_t)a * b;
+  *hi = (uint32_t)(product >> 32);
+  *lo = (uint32_t)product;
+}
+
+static inline void philox4x32(const uint32_t counter[4], uint64_t key, uint32_t out[4]) {
+  uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+  uint32_t k0 = (uint32_t)key, k1 = (uint32_t)(key >> 32);
+
+  for (int round = 0; round < 10; round++) {
+    uint32_t hi0, lo0, hi1, lo1;
+    philox_mulhilo(0xD2511F53, c0, &hi0, &lo0);
+    philox_mulhilo(0xCD9E8D57, c2, &hi1, &lo1);
+
+    c0 = hi1 ^ c1 ^ k0;
+    c1 = lo1;
+    c2 = hi0 ^ c3 ^ k1;
+    c3 = lo0;
+
+    k0 += 0x9E3779B9;
+    k1 += 0xBB67AE85;
+  }
+
+  out[0] = c0;
+  out[1] = c1;
+  out[2] = c2;
+  out[3] = c3;
+}
+
+// A double in [0, 1) from 53 of the 64 random bits
+static inline double random_uniform(uint32_t hi, uint32_t lo) {
+  return (double)((((uint64_t)hi << 32) | lo) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Two uniform numbers in [0, 1) for the counter (index, stream, draw)
+static inline void random_uniform_2(uint64_t key, uint64_t index, uint32_t stream, uint32_t draw,
+                                    double *u0, double *u1) {
+  uint32_t counter[4] = {(uint32_t)index, (uint32_t)(index >> 32), stream, draw};
+  uint32_t out[4];
+  philox4x32(counter, key, out);
+
+  *u0 = random_uniform(out[0], out[1]);
+  *u1 = random_uniform(out[2], out[3]);
+}
+
+#endif
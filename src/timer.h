@@ -0,0 +1,26 @@
+#ifndef ZSF_TIMER_H
+#define ZSF_TIMER_H
+
+#ifdef _WIN32
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+#else
+#  include <time.h>
+#endif
+
+/* timer_now:
+ *      monotonic wall-clock time in seconds, relative to an arbitrary epoch */
+static double timer_now(void) {
+#ifdef _WIN32
+  LARGE_INTEGER frequency, counter;
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+  return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (double)t.tv_sec + 1E-9 * (double)t.tv_nsec;
+#endif
+}
+
+#endif
@@ -4,11 +4,18 @@
 #include "zsf.h"
 #include <math.h>
 
-int is_close(double a, double b, double rtol, double atol);
-double sal_psu_2_density(double sal_psu, double temperature);
-double sal_2_density(double sal_kgm3, double temperature, double rtol, double atol);
+#ifdef ZSF_USE_DENSITY_TABLE
+#  include "density_table.h"
+#endif
+
+static inline int is_close(double a, double b, double rtol, double atol);
+static inline double sal_psu_2_density(double sal_psu, double temperature);
+static inline double sal_2_density(double sal_kgm3, double temperature, double rtol,
+                                   double atol);
+static inline double sal_2_density_iterations(double sal_kgm3, double temperature, double rtol,
+                                              double atol, int *num_iterations);
 
-int is_close(double a, double b, double rtol, double atol) {
+static inline int is_close(double a, double b, double rtol, double atol) {
   double max_abs = fmax(fabs(a), fabs(b));
   if (fabs(a - b) <= fmax(rtol * max_abs, atol))
     return 1;
@@ -16,46 +23,123 @@ int is_close(double a, double b, double rtol, double atol) {
     return 0;
 }
 
-double sal_psu_2_density(double sal_psu, double temperature) {
-  // Calculates the density of sea water using the UNESCO 1981 algorithm.
-  double a = (8.24493E-1 - 4.0899E-3 * temperature + 7.6438E-5 * pow(temperature, 2.0) -
-              8.2467E-7 * pow(temperature, 3.0) + 5.3875E-9 * pow(temperature, 4.0));
-  double b = -5.72466E-3 + 1.0227E-4 * temperature - 1.6546E-6 * pow(temperature, 2.0);
-  double c = 4.8314E-4;
+// Coefficients of the UNESCO 1981 algorithm that only depend on temperature,
+// such that density(S) = rho_ref + S * (a + b * sqrt(S) + c * S)
+typedef struct density_coefficients_t {
+  double rho_ref;
+  double a;
+  double b;
+  double c;
+} density_coefficients_t;
 
-  double rho_ref = (999.842594 + 6.793952E-2 * temperature - 9.095290E-3 * pow(temperature, 2.0) +
-                    1.001685E-4 * pow(temperature, 3.0) - 1.120083E-6 * pow(temperature, 4.0) +
-                    6.536332E-9 * pow(temperature, 5.0));
+static inline void density_coefficients(double temperature, density_coefficients_t *k) {
+  const double t = temperature;
+
+  k->rho_ref =
+      999.842594 +
+      t * (6.793952E-2 +
+           t * (-9.095290E-3 + t * (1.001685E-4 + t * (-1.120083E-6 + t * 6.536332E-9))));
+  k->a = 8.24493E-1 + t * (-4.0899E-3 + t * (7.6438E-5 + t * (-8.2467E-7 + t * 5.3875E-9)));
+  k->b = -5.72466E-3 + t * (1.0227E-4 + t * -1.6546E-6);
+  k->c = 4.8314E-4;
+}
+
+static inline double sal_psu_2_density(double sal_psu, double temperature) {
+  // Calculates the density of sea water using the UNESCO 1981 algorithm, with
+  // the polynomials in Horner form.
+  density_coefficients_t k;
+  density_coefficients(temperature, &k);
+
+  return k.rho_ref + sal_psu * (k.a + k.b * sqrt(sal_psu) + k.c * sal_psu);
+}
 
-  return rho_ref + a * sal_psu + b * pow(sal_psu, 1.5) + c * pow(sal_psu, 2.0);
+static inline double sal_2_density(double sal_kgm3, double temperature, double rtol,
+                                   double atol) {
+  int num_iterations;
+  return sal_2_density_iterations(sal_kgm3, temperature, rtol, atol, &num_iterations);
 }
 
-double sal_2_density(double sal_kgm3, double temperature, double rtol, double atol) {
+static inline double sal_2_density_iterations(double sal_kgm3, double temperature, double rtol,
+                                              double atol, int *num_iterations) {
   /*
     Calculates the density of sea water using the UNESCO 1981 algorith, but
     using salinity in kg/m3 as input.
 
-    It defers to the reference implementation (with salinity in psu), and
-    loops until absolute or relative convergence tolerance (on the density)
-    has been reached.
+    The salinity in psu is the salinity in kg/m3 divided by the density (in
+    kg/l), so we look for the root of
 
-    Typically only a handful (1-10) of iterations are needed to reach any
-    reasonably desired absolute tolerance. An upper bound of 100 iterations is
-    used to catch any case where the algorithm does not converge.
+        g(rho) = rho - density(1000 * sal_kgm3 / rho)
+
+    with Newton's method, until the absolute or relative convergence tolerance
+    (on the density) has been reached. Because the convergence is quadratic,
+    the error is then much smaller than the tolerance.
+
+    Typically only 2-3 iterations are needed to reach any reasonably desired
+    tolerance. An upper bound of 100 iterations is used to catch any case
+    where the algorithm does not converge. The number of iterations is
+    written to num_iterations.
     */
 
-  double sal_psu = sal_kgm3;
+  density_coefficients_t k;
+  density_coefficients(temperature, &k);
+
   double rho = 1000.0;
 
   for (int i = 0; i < 100; i++) {
-    double rho_new = sal_psu_2_density(sal_psu, temperature);
-    sal_psu = sal_kgm3 / rho_new * 1000.0;
+    double sal_psu = sal_kgm3 / rho * 1000.0;
+    double sqrt_sal_psu = sqrt(sal_psu);
+
+    double f = k.rho_ref + sal_psu * (k.a + k.b * sqrt_sal_psu + k.c * sal_psu);
+    double df_dsal = k.a + 1.5 * k.b * sqrt_sal_psu + 2.0 * k.c * sal_psu;
+
+    // d(sal_psu)/d(rho) = -sal_psu / rho
+    double g = rho - f;
+    double dg = 1.0 + df_dsal * sal_psu / rho;
+
+    double rho_new = rho - g / dg;
 
-    if (is_close(rho_new, rho, rtol, atol))
+    if (is_close(rho_new, rho, rtol, atol)) {
+      *num_iterations = i + 1;
       return rho_new;
+    }
 
     rho = rho_new;
   }
+  *num_iterations = 100;
   return ZSF_NAN;
 }
+
+#ifdef ZSF_USE_DENSITY_TABLE
+static inline int sal_2_density_table(double sal_kgm3, double temperature, double *rho) {
+  /*
+    Bilinear interpolation in the table of densities generated by
+    gen_density_table.c. Returns 0 if the salinity or temperature is outside
+    of the table (or NaN), in which case the caller should fall back to
+    sal_2_density. The error is at most DENSITY_TABLE_MAX_ERROR in kg/m3.
+    */
+
+  double x = (sal_kgm3 - DENSITY_TABLE_SAL_MIN) / DENSITY_TABLE_SAL_STEP;
+  double y = (temperature - DENSITY_TABLE_TEMP_MIN) / DENSITY_TABLE_TEMP_STEP;
+
+  if (!(x >= 0.0 && x <= DENSITY_TABLE_NUM_SAL - 1 && y >= 0.0 &&
+        y <= DENSITY_TABLE_NUM_TEMP - 1))
+    return 0;
+
+  // The last row and column only serve as upper bound of the cells before
+  int i = (x < DENSITY_TABLE_NUM_SAL - 1) ? (int)x : DENSITY_TABLE_NUM_SAL - 2;
+  int j = (y < DENSITY_TABLE_NUM_TEMP - 1) ? (int)y : DENSITY_TABLE_NUM_TEMP - 2;
+  double fx = x - i;
+  double fy = y - j;
+
+  const double *r0 = density_table[j];
+  const double *r1 = density_table[j + 1];
+
+  double rho_0 = r0[i] + fx * (r0[i + 1] - r0[i]);
+  double rho_1 = r1[i] + fx * (r1[i + 1] - r1[i]);
+
+  *rho = rho_0 + fy * (rho_1 - rho_0);
+  return 1;
+}
+#endif
+
 #endif
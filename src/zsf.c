@@ -1,18 +1,29 @@
 #include <assert.h>
+#include <float.h>
+#include <limits.h>
 #include <math.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "config.h"
+#include "event_queue.h"
+#include "fastmath.h"
+#include "parallel.h"
+#include "random.h"
+#include "timer.h"
 #include "util.h"
 #include "zsf.h"
 
 // The zsf_calculate loop can take advantage of shared values (e.g. a
 // reciprocal volume) between steps and the derivative parameters. Most
 // compilers cannot seem to recognize the ~20% speedup that can be gained this
-// way, so we have to force it.
-#ifdef _MSC_VER
+// way, so we have to force it. Building with -DUSE_FORCEINLINE=OFF leaves
+// it to the compiler, to check that claim with zsf-bench.
+#ifdef ZSF_NO_FORCEINLINE
+#  define forceinline inline
+#elif defined(_MSC_VER)
 #  define forceinline __forceinline
 #elif defined(__GNUC__)
 #  define forceinline inline __attribute__((__always_inline__))
@@ -26,28 +37,49 @@
 #  define forceinline inline
 #endif
 
-#ifdef ZSF_USE_FAST_TANH
-inline double TANH(const double x) {
-  const double ax = fabs(x);
-  const double x2 = x * x;
-
-  const double z1 =
-      (x *
-       (2.45550750702956 + 2.45550750702956 * ax +
-        (0.893229853513558 + 0.821226666969744 * ax) * x2) /
-       (2.44506634652299 + (2.44506634652299 + x2) * fabs(x + 0.814642734961073 * x * ax)));
-
-  return fmin(z1, 1.0);
-}
+// The functions with the hot loops are compiled for several instruction sets,
+// of which the best one the CPU supports is selected when the library is
+// loaded. Every variant calls its own copy of the (force-inlined) kernels.
+// The build disables contraction to FMA, such that all variants give exactly
+// the same results.
+#ifdef ZSF_USE_CPU_DISPATCH
+#  define ZSF_CPU_VARIANTS(X) X("avx512f") X("avx2")
+#  define ZSF_CPU_VARIANT_NAME(NAME) NAME,
+#  define cpu_dispatch                                                                             \
+    __attribute__((target_clones(ZSF_CPU_VARIANTS(ZSF_CPU_VARIANT_NAME) "default")))
 #else
-#  define TANH tanh
+#  define cpu_dispatch
 #endif
 
 #define ERROR_CODES(X)                                                                             \
   X(ZSF_SUCCESS, "Success")                                                                        \
   X(ZSF_SHIP_TOO_BIG, "The ship is too large for the lock")                                        \
   X(ZSF_ERR_REMAINING_HEAD_DIFF, "Remaining head difference when opening doors")                   \
-  X(ZSF_ERR_SAL_LOCK_OUT_OF_BOUNDS, "The salinity of the lock exceeds that of the boundaries")
+  X(ZSF_ERR_SAL_LOCK_OUT_OF_BOUNDS, "The salinity of the lock exceeds that of the boundaries")   \
+  X(ZSF_ERR_BATCH_FAILED_ROWS, "One or more rows of the batch failed")                             \
+  X(ZSF_ERR_MAX_CYCLES, "No convergence within the maximum number of cycles")                      \
+  X(ZSF_ERR_MAX_TIME, "No convergence within the maximum time")                                    \
+  X(ZSF_ERR_STAGNATION, "The iteration stagnated before convergence")                              \
+  X(ZSF_ERR_OSCILLATION, "The iteration oscillates without converging")                            \
+  X(ZSF_ERR_UNKNOWN_ROUTINE, "Unknown lockage routine")                                            \
+  X(ZSF_ERR_OUT_OF_MEMORY, "Out of memory")                                                        \
+  X(ZSF_ERR_INVALID_AXIS, "Invalid axis of the surrogate grid")                                    \
+  X(ZSF_ERR_OUTSIDE_GRID, "The point lies outside of the surrogate grid")                          \
+  X(ZSF_ERR_GRID_POINT_FAILED, "The interpolation needs a grid point that failed")                 \
+  X(ZSF_ERR_UNKNOWN_INTERPOLATION, "Unknown interpolation method")                                 \
+  X(ZSF_ERR_FILE_IO, "Could not read or write the file")                                           \
+  X(ZSF_ERR_FILE_FORMAT, "The file is not a surrogate file of this version")                       \
+  X(ZSF_ERR_UNKNOWN_PARAM, "Unknown parameter index")                                             \
+  X(ZSF_ERR_MAX_ITERATIONS, "No convergence within the maximum number of iterations")              \
+  X(ZSF_ERR_INVALID_DISTRIBUTION, "Invalid distribution of an uncertain parameter")                \
+  X(ZSF_ERR_INVALID_QUANTILE, "The quantile is outside [0, 1], or there are no samples")           \
+  X(ZSF_ERR_UNKNOWN_RESULT, "Unknown result index")                                                \
+  X(ZSF_ERR_NOT_BRACKETED, "The target is not between the results at the bounds")                  \
+  X(ZSF_ERR_INVALID_CHAMBER, "Invalid chamber index, or no chambers")                              \
+  X(ZSF_ERR_INVALID_TRAFFIC, "Invalid ship traffic or simulation time")                           \
+  X(ZSF_ERR_INVALID_STRIDE, "Negative stride of the parameter or result columns")                 \
+  X(ZSF_ERR_TOLERANCE_NOT_REACHED, "Tolerance not reached within the steady state accuracy")       \
+  X(ZSF_ERR_PARAM_OUT_OF_RANGE, "A parameter is outside of its physically valid range")
 
 #define ERROR_ENUM(ID, TEXT) ID,
 enum error_ids { ERROR_CODES(ERROR_ENUM) ZSF_NUM_ERRORS };
@@ -76,12 +108,80 @@ typedef struct derived_parameters_t {
   double t_open_sea;
   double flushing_discharge;
   double density_average;
+  int accuracy;
 } derived_parameters_t;
 
 const char *ZSF_CALLCONV zsf_version() { return ZSF_GIT_DESCRIBE; }
 
-static forceinline void calculate_derived_parameters(const zsf_param_t *p,
-                                                     derived_parameters_t *o) {
+const char *ZSF_CALLCONV zsf_cpu_variant() {
+#ifdef ZSF_USE_CPU_DISPATCH
+  // Same order of preference as the resolvers generated for target_clones
+  __builtin_cpu_init();
+#  define RETURN_IF_SUPPORTED(NAME)                                                                \
+    if (__builtin_cpu_supports(NAME))                                                              \
+      return NAME;
+  ZSF_CPU_VARIANTS(RETURN_IF_SUPPORTED)
+#  undef RETURN_IF_SUPPORTED
+#endif
+  return "default";
+}
+
+// Counters
+// ~~~~~~~~
+// Relaxed atomic increments, as the counters are only read after the
+// calculations. Without ZSF_ENABLE_STATS the counting compiles to nothing.
+#define COUNTER_FIELDS(X)                                                                          \
+  X(num_steady_solves)                                                                             \
+  X(num_unconverged_solves)                                                                        \
+  X(num_cycles)                                                                                    \
+  X(num_density_evaluations)                                                                       \
+  X(num_density_iterations)                                                                        \
+  X(num_doors_open_lake)                                                                           \
+  X(num_doors_open_sea)                                                                            \
+  X(num_bubble_screen_raw_exchange)                                                                \
+  X(num_flushing_passthrough)                                                                      \
+  X(num_exchange_blocked_by_flushing)
+
+#ifdef ZSF_ENABLE_STATS
+static zsf_counters_t global_counters;
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#    define COUNTER_ADD(NAME, N) _InterlockedExchangeAdd64(&global_counters.NAME, (N))
+#    define COUNTER_LOAD(NAME) _InterlockedOr64(&global_counters.NAME, 0)
+#    define COUNTER_RESET(NAME) _InterlockedExchange64(&global_counters.NAME, 0)
+#  else
+#    define COUNTER_ADD(NAME, N) __atomic_fetch_add(&global_counters.NAME, (N), __ATOMIC_RELAXED)
+#    define COUNTER_LOAD(NAME) __atomic_load_n(&global_counters.NAME, __ATOMIC_RELAXED)
+#    define COUNTER_RESET(NAME) __atomic_store_n(&global_counters.NAME, 0, __ATOMIC_RELAXED)
+#  endif
+#else
+#  define COUNTER_ADD(NAME, N) ((void)0)
+#  define COUNTER_LOAD(NAME) 0
+#  define COUNTER_RESET(NAME) ((void)0)
+#endif
+#define COUNT(NAME) COUNTER_ADD(NAME, 1)
+
+int ZSF_CALLCONV zsf_counters_enabled() {
+#ifdef ZSF_ENABLE_STATS
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+#define COUNTER_GET(NAME) counters->NAME = COUNTER_LOAD(NAME);
+void ZSF_CALLCONV zsf_get_counters(zsf_counters_t *counters) {
+  COUNTER_FIELDS(COUNTER_GET)
+}
+#undef COUNTER_GET
+
+#define COUNTER_ZERO(NAME) COUNTER_RESET(NAME);
+void ZSF_CALLCONV zsf_reset_counters() { COUNTER_FIELDS(COUNTER_ZERO) }
+#undef COUNTER_ZERO
+#undef COUNTER_FIELDS
+
+static forceinline void calculate_derived_operation(const zsf_param_t *p,
+                                                    derived_parameters_t *o) {
   // Gravitational constant
   o->g = 9.81;
 
@@ -106,20 +206,59 @@ static forceinline void calculate_derived_parameters(const zsf_param_t *p,
   // Flushing discharge
   o->flushing_discharge =
       o->is_low_tide ? p->flushing_discharge_low_tide : p->flushing_discharge_high_tide;
+}
+
+static double density(double sal_kgm3, double temperature, double rtol, double atol) {
+  COUNT(num_density_evaluations);
+  double rho;
+#ifdef ZSF_USE_DENSITY_TABLE
+  if (sal_2_density_table(sal_kgm3, temperature, &rho))
+    return rho;
+#endif
+  int num_iterations;
+  rho = sal_2_density_iterations(sal_kgm3, temperature, rtol, atol, &num_iterations);
+  COUNTER_ADD(num_density_iterations, num_iterations);
+  return rho;
+}
 
+static forceinline void calculate_derived_density(const zsf_param_t *p, derived_parameters_t *o) {
   // Average density (for lock exchange)
-  o->density_average =
-      0.5 * (sal_2_density(p->salinity_lake, p->temperature_lake, p->rtol, p->atol) +
-             sal_2_density(p->salinity_sea, p->temperature_sea, p->rtol, p->atol));
+  o->density_average = 0.5 * (density(p->salinity_lake, p->temperature_lake, p->rtol, p->atol) +
+                              density(p->salinity_sea, p->temperature_sea, p->rtol, p->atol));
 }
 
-static int check_parameters_state(const zsf_param_t *p, const derived_parameters_t *o,
-                                  const zsf_phase_state_t *state) {
+static forceinline void calculate_derived_parameters(const zsf_param_t *p,
+                                                     derived_parameters_t *o) {
+  calculate_derived_operation(p, o);
+  calculate_derived_density(p, o);
+}
+
+static int same_density_inputs(const zsf_param_t *a, const zsf_param_t *b) {
+  return (a->salinity_lake == b->salinity_lake) && (a->temperature_lake == b->temperature_lake) &&
+         (a->salinity_sea == b->salinity_sea) && (a->temperature_sea == b->temperature_sea) &&
+         (a->rtol == b->rtol) && (a->atol == b->atol);
+}
 
+// Whether the member at an offset in zsf_param_t is one of the inputs that
+// same_density_inputs compares
+static int is_density_input(size_t offset) {
+  return offset == offsetof(zsf_param_t, salinity_lake) ||
+         offset == offsetof(zsf_param_t, temperature_lake) ||
+         offset == offsetof(zsf_param_t, salinity_sea) ||
+         offset == offsetof(zsf_param_t, temperature_sea) ||
+         offset == offsetof(zsf_param_t, rtol) || offset == offsetof(zsf_param_t, atol);
+}
+
+static int check_parameters(const zsf_param_t *p, const derived_parameters_t *o) {
   if (fmax(p->ship_volume_lake_to_sea, p->ship_volume_sea_to_lake) >
       fmin(o->volume_lock_at_lake, o->volume_lock_at_sea)) {
     return ZSF_SHIP_TOO_BIG;
   }
+
+  return ZSF_SUCCESS;
+}
+
+static int check_state(const zsf_param_t *p, const zsf_phase_state_t *state) {
   if ((state->salinity_lock > fmax(p->salinity_lake, p->salinity_sea)) ||
       (state->salinity_lock < fmin(p->salinity_lake, p->salinity_sea))) {
     return ZSF_ERR_SAL_LOCK_OUT_OF_BOUNDS;
@@ -128,6 +267,92 @@ static int check_parameters_state(const zsf_param_t *p, const derived_parameters
   return ZSF_SUCCESS;
 }
 
+static int check_parameters_state(const zsf_param_t *p, const derived_parameters_t *o,
+                                  const zsf_phase_state_t *state) {
+  int err = check_parameters(p, o);
+  if (err) {
+    return err;
+  }
+
+  return check_state(p, state);
+}
+
+// Context
+// ~~~~~~~
+// A parameter set together with its derived parameters, such that repeated
+// calls with (mostly) the same parameters do not have to derive them again.
+struct zsf_context_t {
+  zsf_param_t p;
+  derived_parameters_t o;
+  int param_error;
+};
+
+static void context_init(zsf_context_t *ctx, const zsf_param_t *p) {
+  ctx->p = *p;
+  calculate_derived_parameters(&ctx->p, &ctx->o);
+  ctx->o.accuracy = ZSF_ACCURACY_EXACT;
+  ctx->param_error = check_parameters(&ctx->p, &ctx->o);
+}
+
+static void context_update(zsf_context_t *ctx, const zsf_param_t *p) {
+  // The densities are by far the most expensive derived parameters, so we
+  // only recalculate them when their inputs change. The others cost next to
+  // nothing, and are always recalculated.
+  int density_changed = !same_density_inputs(p, &ctx->p);
+
+  ctx->p = *p;
+  calculate_derived_operation(&ctx->p, &ctx->o);
+  if (density_changed)
+    calculate_derived_density(&ctx->p, &ctx->o);
+  ctx->param_error = check_parameters(&ctx->p, &ctx->o);
+}
+
+// Like context_update, but with the densities of another context of which the
+// density inputs are the same
+static void context_update_shared_density(zsf_context_t *ctx, const zsf_param_t *p,
+                                          double density_average) {
+  ctx->p = *p;
+  calculate_derived_operation(&ctx->p, &ctx->o);
+  ctx->o.density_average = density_average;
+  ctx->param_error = check_parameters(&ctx->p, &ctx->o);
+}
+
+static int context_check_state(const zsf_context_t *ctx, const zsf_phase_state_t *state) {
+  if (ctx->param_error) {
+    return ctx->param_error;
+  }
+
+  return check_state(&ctx->p, state);
+}
+
+zsf_context_t *ZSF_CALLCONV zsf_context_create(const zsf_param_t *p) {
+  zsf_context_t *ctx = (zsf_context_t *)malloc(sizeof(zsf_context_t));
+  if (ctx == NULL) {
+    return NULL;
+  }
+
+  zsf_param_t default_param;
+  if (p == NULL) {
+    zsf_param_default(&default_param);
+    p = &default_param;
+  }
+  context_init(ctx, p);
+
+  return ctx;
+}
+
+void ZSF_CALLCONV zsf_context_free(zsf_context_t *ctx) { free(ctx); }
+
+void ZSF_CALLCONV zsf_context_set_param(zsf_context_t *ctx, const zsf_param_t *p) {
+  context_update(ctx, p);
+}
+
+void ZSF_CALLCONV zsf_context_get_param(const zsf_context_t *ctx, zsf_param_t *p) { *p = ctx->p; }
+
+void ZSF_CALLCONV zsf_context_set_accuracy(zsf_context_t *ctx, int accuracy) {
+  ctx->o.accuracy = accuracy;
+}
+
 void ZSF_CALLCONV zsf_param_default(zsf_param_t *p) {
   /* */
   memset(p, 0, sizeof(zsf_param_t));
@@ -173,6 +398,12 @@ void ZSF_CALLCONV zsf_param_default(zsf_param_t *p) {
   p->atol = 1E-8;
 }
 
+// The kernels are deliberately not specialized per combination of mitigation
+// measures. A cycle is bound by the latency of the chain of divisions, square
+// roots and tanh through the lock salinity, with which the other work of the
+// measures (e.g. the cbrt of the equilibrium depth) overlaps. Variants without
+// the flushing, bubble screen and sill calculations were no faster per cycle
+// in zsf-bench, and the copies of the kernels made the library 50% larger.
 static forceinline void step_phase_1(const zsf_param_t *p, const derived_parameters_t *o,
                                      double t_level, zsf_phase_state_t *state,
                                      zsf_phase_transports_t *results) {
@@ -256,6 +487,8 @@ static forceinline void step_phase_2(const zsf_param_t *p, const derived_paramet
   double sal_lock_1 = state->salinity_lock;
   double volume_ship_in_lock_1 = state->volume_ship_in_lock;
 
+  COUNT(num_doors_open_lake);
+
   // Subphase a. Ships exiting the lock chamber towards the lake
   // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   double mt_lake_2_ship_exit = volume_ship_in_lock_1 * p->salinity_lake;
@@ -290,6 +523,7 @@ static forceinline void step_phase_2(const zsf_param_t *p, const derived_paramet
 
   // Until the density current reaches the bubble screen
   if (p->distance_door_bubble_screen_lake != 0.0) {
+    COUNT(num_bubble_screen_raw_exchange);
     double velocity_t_raw_exchange =
         velocity_exchange_raw - copysign(velocity_flushing, p->distance_door_bubble_screen_lake);
     velocity_t_raw_exchange = fmax(velocity_t_raw_exchange, 1E-10);
@@ -300,7 +534,7 @@ static forceinline void step_phase_2(const zsf_param_t *p, const derived_paramet
         fmax((velocity_exchange_raw - velocity_flushing) / velocity_exchange_raw, 0.0);
     double t_lock_exchange_raw = 2 * p->lock_length / velocity_exchange_raw;
     volume_exchange_2 += frac_lock_exchange_raw * volume_lock_at_lake_effective *
-                         TANH(t_raw_exchange / t_lock_exchange_raw);
+                         math_tanh(o->accuracy, t_raw_exchange / t_lock_exchange_raw);
   }
 
   // After the current reaches the bubble screen
@@ -308,8 +542,9 @@ static forceinline void step_phase_2(const zsf_param_t *p, const derived_paramet
   double frac_lock_exchange =
       fmax((velocity_exchange_eta - velocity_flushing) / velocity_exchange_eta, 0.0);
   double t_lock_exchange = 2 * p->lock_length / velocity_exchange_eta;
-  volume_exchange_2 += frac_lock_exchange * (volume_lock_at_lake_effective - volume_exchange_2) *
-                       TANH(fmax(t_open_lake - t_raw_exchange, 0.0) / t_lock_exchange);
+  volume_exchange_2 +=
+      frac_lock_exchange * (volume_lock_at_lake_effective - volume_exchange_2) *
+      math_tanh(o->accuracy, fmax(t_open_lake - t_raw_exchange, 0.0) / t_lock_exchange);
 
   // Flushing itself (taking lock exchange into account)
   double volume_flush = o->flushing_discharge * t_open_lake;
@@ -321,6 +556,8 @@ static forceinline void step_phase_2(const zsf_param_t *p, const derived_paramet
 
   double volume_flush_refresh = fmin(volume_flush, max_volume_flush_refresh);
   double volume_flush_passthrough = fmax(volume_flush - max_volume_flush_refresh, 0.0);
+  if (volume_flush > max_volume_flush_refresh)
+    COUNT(num_flushing_passthrough);
 
   double mt_sea_2_flushing =
       volume_flush_refresh * sal_lock_2a + volume_flush_passthrough * p->salinity_lake;
@@ -478,6 +715,8 @@ static forceinline void step_phase_4(const zsf_param_t *p, const derived_paramet
   double sal_lock_3 = state->salinity_lock;
   double volume_ship_in_lock_3 = state->volume_ship_in_lock;
 
+  COUNT(num_doors_open_sea);
+
   // Subphase a. Ships exiting the lock chamber towards the sea
   // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   double mt_sea_4_ship_exit = -1 * volume_ship_in_lock_3 * p->salinity_sea;
@@ -502,9 +741,10 @@ static forceinline void step_phase_4(const zsf_param_t *p, const derived_paramet
 
   // The equilibrium depth of the boundary layer between the salt (sal_sea)
   // and fresh (sal_lake) water when flushing for a very long time.
-  double head_equilibrium =
-      cbrt(2.0 * pow(o->flushing_discharge / p->lock_width, 2.0) * o->density_average /
-           (o->g * 0.8 * (p->salinity_sea - p->salinity_lake)));
+  double flushing_discharge_per_width = o->flushing_discharge / p->lock_width;
+  double head_equilibrium = math_cbrt(
+      o->accuracy, 2.0 * flushing_discharge_per_width * flushing_discharge_per_width *
+                       o->density_average / (o->g * 0.8 * (p->salinity_sea - p->salinity_lake)));
 
   head_equilibrium = fmin(head_equilibrium, p->head_sea - p->lock_bottom);
 
@@ -519,6 +759,7 @@ static forceinline void step_phase_4(const zsf_param_t *p, const derived_paramet
 
   // Until the density current reaches the bubble screen
   if (p->distance_door_bubble_screen_sea != 0.0) {
+    COUNT(num_bubble_screen_raw_exchange);
     double velocity_t_raw_exchange =
         velocity_exchange_raw + copysign(velocity_flushing, p->distance_door_bubble_screen_sea);
     velocity_t_raw_exchange = fmax(velocity_t_raw_exchange, 1E-10);
@@ -528,8 +769,8 @@ static forceinline void step_phase_4(const zsf_param_t *p, const derived_paramet
     double t_lock_exchange_raw =
         2 * p->lock_length * frac_lock_exchange / (velocity_exchange_raw - velocity_flushing);
 
-    volume_exchange_4 +=
-        frac_lock_exchange * o->volume_lock_at_sea * TANH(t_raw_exchange / t_lock_exchange_raw);
+    volume_exchange_4 += frac_lock_exchange * o->volume_lock_at_sea *
+                         math_tanh(o->accuracy, t_raw_exchange / t_lock_exchange_raw);
   }
 
   // After the current reaches the bubble screen
@@ -538,8 +779,11 @@ static forceinline void step_phase_4(const zsf_param_t *p, const derived_paramet
   if (velocity_exchange_eta > velocity_flushing) {
     double t_lock_exchange =
         2 * p->lock_length * frac_lock_exchange / (velocity_exchange_eta - velocity_flushing);
-    volume_exchange_4 += frac_lock_exchange * (o->volume_lock_at_sea - volume_exchange_4) *
-                         TANH(fmax(t_open_sea - t_raw_exchange, 0.0) / t_lock_exchange);
+    volume_exchange_4 +=
+        frac_lock_exchange * (o->volume_lock_at_sea - volume_exchange_4) *
+        math_tanh(o->accuracy, fmax(t_open_sea - t_raw_exchange, 0.0) / t_lock_exchange);
+  } else {
+    COUNT(num_exchange_blocked_by_flushing);
   }
 
   // Flushing itself (taking lock exchange into account)
@@ -552,6 +796,8 @@ static forceinline void step_phase_4(const zsf_param_t *p, const derived_paramet
 
   double volume_flush_refresh = fmin(volume_flush, max_volume_flush_refresh);
   double volume_flush_passthrough = fmax(volume_flush - max_volume_flush_refresh, 0.0);
+  if (volume_flush > max_volume_flush_refresh)
+    COUNT(num_flushing_passthrough);
 
   double mt_lake_4_flushing =
       volume_flush_refresh * p->salinity_lake + volume_flush_passthrough * p->salinity_lake;
@@ -662,8 +908,9 @@ static forceinline void step_flush_doors_closed(const zsf_param_t *p, const deri
       state->volume_ship_in_lock;
 
   double lam_exp = o->flushing_discharge * sal_diff / state->saltmass_lock;
-  double saltmass_lock = volume_water_in_lock * sal_diff * exp(-1.0 * lam_exp * t_flushing) +
-                         volume_water_in_lock * p->salinity_lake;
+  double saltmass_lock =
+      volume_water_in_lock * sal_diff * math_exp(o->accuracy, -1.0 * lam_exp * t_flushing) +
+      volume_water_in_lock * p->salinity_lake;
   double saltmass_out = state->saltmass_lock - saltmass_lock;
 
   // Update state variables of the lock
@@ -710,232 +957,3574 @@ int ZSF_CALLCONV zsf_initialize_state(const zsf_param_t *p, zsf_phase_state_t *s
   return ZSF_SUCCESS;
 }
 
-int ZSF_CALLCONV zsf_step_phase_1(const zsf_param_t *p, double t_level, zsf_phase_state_t *state,
-                                  zsf_phase_transports_t *results) {
-  // Get the derived parameters
-  derived_parameters_t o;
-  calculate_derived_parameters(p, &o);
-
-  int err = check_parameters_state(p, &o, state);
+cpu_dispatch int ZSF_CALLCONV zsf_context_step_phase_1(const zsf_context_t *ctx, double t_level,
+                                                       zsf_phase_state_t *state,
+                                                       zsf_phase_transports_t *results) {
+  int err = context_check_state(ctx, state);
   if (err) {
     return err;
   }
 
-  step_phase_1(p, &o, t_level, state, results);
+  step_phase_1(&ctx->p, &ctx->o, t_level, state, results);
 
   return ZSF_SUCCESS;
 }
 
-int ZSF_CALLCONV zsf_step_phase_2(const zsf_param_t *p, double t_open_lake,
-                                  zsf_phase_state_t *state, zsf_phase_transports_t *results) {
-  // Get the derived parameters
-  derived_parameters_t o;
-  calculate_derived_parameters(p, &o);
-
-  int err = check_parameters_state(p, &o, state);
+cpu_dispatch int ZSF_CALLCONV zsf_context_step_phase_2(const zsf_context_t *ctx, double t_open_lake,
+                                                       zsf_phase_state_t *state,
+                                                       zsf_phase_transports_t *results) {
+  int err = context_check_state(ctx, state);
   if (err) {
     return err;
   }
-  if (fabs(state->head_lock - p->head_lake) > 1E-8) {
+  if (fabs(state->head_lock - ctx->p.head_lake) > 1E-8) {
     return ZSF_ERR_REMAINING_HEAD_DIFF;
   }
 
-  step_phase_2(p, &o, t_open_lake, state, results);
+  step_phase_2(&ctx->p, &ctx->o, t_open_lake, state, results);
 
   return ZSF_SUCCESS;
 }
 
-int ZSF_CALLCONV zsf_step_flush_doors_closed(const zsf_param_t *p, double t_flushing,
-                                             zsf_phase_state_t *state,
-                                             zsf_phase_transports_t *results) {
-  // Get the derived parameters
-  derived_parameters_t o;
-  calculate_derived_parameters(p, &o);
-
-  int err = check_parameters_state(p, &o, state);
+cpu_dispatch int ZSF_CALLCONV zsf_context_step_flush_doors_closed(const zsf_context_t *ctx,
+                                                                  double t_flushing,
+                                                                  zsf_phase_state_t *state,
+                                                                  zsf_phase_transports_t *results) {
+  int err = context_check_state(ctx, state);
   if (err) {
     return err;
   }
 
-  step_flush_doors_closed(p, &o, t_flushing, state, results);
+  step_flush_doors_closed(&ctx->p, &ctx->o, t_flushing, state, results);
 
   return ZSF_SUCCESS;
 }
 
-int ZSF_CALLCONV zsf_step_phase_3(const zsf_param_t *p, double t_level, zsf_phase_state_t *state,
-                                  zsf_phase_transports_t *results) {
-  // Get the derived parameters
-  derived_parameters_t o;
-  calculate_derived_parameters(p, &o);
-
-  int err = check_parameters_state(p, &o, state);
+cpu_dispatch int ZSF_CALLCONV zsf_context_step_phase_3(const zsf_context_t *ctx, double t_level,
+                                                       zsf_phase_state_t *state,
+                                                       zsf_phase_transports_t *results) {
+  int err = context_check_state(ctx, state);
   if (err) {
     return err;
   }
 
-  step_phase_3(p, &o, t_level, state, results);
+  step_phase_3(&ctx->p, &ctx->o, t_level, state, results);
 
   return ZSF_SUCCESS;
 }
 
-int ZSF_CALLCONV zsf_step_phase_4(const zsf_param_t *p, double t_open_sea, zsf_phase_state_t *state,
-                                  zsf_phase_transports_t *results) {
-  // Get the derived parameters
-  derived_parameters_t o;
-  calculate_derived_parameters(p, &o);
-
-  int err = check_parameters_state(p, &o, state);
+cpu_dispatch int ZSF_CALLCONV zsf_context_step_phase_4(const zsf_context_t *ctx, double t_open_sea,
+                                                       zsf_phase_state_t *state,
+                                                       zsf_phase_transports_t *results) {
+  int err = context_check_state(ctx, state);
   if (err) {
     return err;
   }
-  if (fabs(state->head_lock - p->head_sea) > 1E-8) {
+  if (fabs(state->head_lock - ctx->p.head_sea) > 1E-8) {
     return ZSF_ERR_REMAINING_HEAD_DIFF;
   }
 
-  step_phase_4(p, &o, t_open_sea, state, results);
+  step_phase_4(&ctx->p, &ctx->o, t_open_sea, state, results);
 
   return ZSF_SUCCESS;
 }
-int ZSF_CALLCONV zsf_calc_steady(const zsf_param_t *p, zsf_results_t *results,
-                                 zsf_aux_results_t *aux_results) {
 
-  derived_parameters_t o;
-  calculate_derived_parameters(p, &o);
+// The functions without context derive the parameters on every call
+int ZSF_CALLCONV zsf_step_phase_1(const zsf_param_t *p, double t_level, zsf_phase_state_t *state,
+                                  zsf_phase_transports_t *results) {
+  zsf_context_t ctx;
+  context_init(&ctx, p);
+  return zsf_context_step_phase_1(&ctx, t_level, state, results);
+}
 
-  // Start salinity and salt mass
-  zsf_phase_state_t state;
+int ZSF_CALLCONV zsf_step_phase_2(const zsf_param_t *p, double t_open_lake,
+                                  zsf_phase_state_t *state, zsf_phase_transports_t *results) {
+  zsf_context_t ctx;
+  context_init(&ctx, p);
+  return zsf_context_step_phase_2(&ctx, t_open_lake, state, results);
+}
+
+int ZSF_CALLCONV zsf_step_flush_doors_closed(const zsf_param_t *p, double t_flushing,
+                                             zsf_phase_state_t *state,
+                                             zsf_phase_transports_t *results) {
+  zsf_context_t ctx;
+  context_init(&ctx, p);
+  return zsf_context_step_flush_doors_closed(&ctx, t_flushing, state, results);
+}
+
+int ZSF_CALLCONV zsf_step_phase_3(const zsf_param_t *p, double t_level, zsf_phase_state_t *state,
+                                  zsf_phase_transports_t *results) {
+  zsf_context_t ctx;
+  context_init(&ctx, p);
+  return zsf_context_step_phase_3(&ctx, t_level, state, results);
+}
+
+int ZSF_CALLCONV zsf_step_phase_4(const zsf_param_t *p, double t_open_sea, zsf_phase_state_t *state,
+                                  zsf_phase_transports_t *results) {
+  zsf_context_t ctx;
+  context_init(&ctx, p);
+  return zsf_context_step_phase_4(&ctx, t_open_sea, state, results);
+}
+
+// The transports and lock salinities of one full locking cycle, i.e. the
+// values needed to calculate the cycle-averaged results once converged.
+typedef struct steady_cycle_t {
+  zsf_phase_transports_t tp1;
+  zsf_phase_transports_t tp2;
+  zsf_phase_transports_t tp3;
+  zsf_phase_transports_t tp4;
+  double sal_lock_1;
+  double sal_lock_2;
+  double sal_lock_3;
+  double sal_lock_4;
+} steady_cycle_t;
+
+static double steady_initial_salinity(const zsf_param_t *p) {
+  if (p->salinity_lock == ZSF_NAN)
+    return 0.5 * (p->salinity_sea + p->salinity_lake);
+  return p->salinity_lock;
+}
+
+// Closed-form steady state
+// ~~~~~~~~~~~~~~~~~~~~~~~~
+// Without flushing and bubble screens, every subphase of the cycle changes the
+// lock salinity affinely: leveling and ships mix in water of the lake or the
+// sea, and the lock exchange replaces a fraction g2 (g4) of the lock with water
+// of the lake (sea). Only these fractions depend on the salinity, through the
+// velocity of the density current. For fixed fractions a cycle is the map
+// x -> alpha + beta * x of the lock salinity at its start, of which the fixed
+// point alpha / (1 - beta) is the steady state. This is a Newton step on the
+// cycle map that ignores how the fractions change with the salinity, and
+// alternating it with the fractions would converge (oscillating) with a ratio
+// of about -0.5. Newton's method with the derivative of the fractions too
+// converges quadratically, in a few iterations of a handful of operations.
+#define CLOSED_FORM_ITERATIONS 16
+
+static int closed_form_qualifies(const zsf_param_t *p, const derived_parameters_t *o) {
+  return (o->flushing_discharge == 0.0) & (p->distance_door_bubble_screen_lake == 0.0) &
+         (p->distance_door_bubble_screen_sea == 0.0);
+}
+
+// The fraction of the (effective) lock volume that the lock exchange replaces
+// while the doors are open, and its derivative to the salinity difference. As
+// in step_phase_2 and step_phase_4 without flushing and bubble screens, with
+// the velocity of the density current and the door open time in k and c.
+static double closed_form_exchange(int accuracy, double k, double c, double sal_diff,
+                                   double *derivative) {
+  double t_ratio = k * sqrt(c * sal_diff);
+
+  *derivative = 0.0;
+  if (!(t_ratio > 0.0))
+    return 0.0;
+
+  double frac = math_tanh(accuracy, t_ratio);
+
+  // t_ratio goes with the square root of sal_diff
+  *derivative = (1.0 - frac * frac) * 0.5 * t_ratio / sal_diff;
+  return frac;
+}
+
+// The steady lock salinity at the end of phase 4 from a start x, or x if it
+// does not converge. Newton's method could also find a fixed point that Picard
+// iteration moves away from, so we only take one where the map contracts.
+static double steady_closed_form(const zsf_param_t *p, const derived_parameters_t *o,
+                                 double sal_lock_start) {
+  double lock_area = p->lock_length * p->lock_width;
+  double vol_to_lake = fmax(p->head_sea - p->head_lake, 0.0) * lock_area;
+  double vol_from_lake = fmax(p->head_lake - p->head_sea, 0.0) * lock_area;
+  double vol_to_sea = vol_from_lake;
+  double vol_from_sea = vol_to_lake;
+
+  // Phase 1 and 2a, sal_lock_2a = a1 * x + b1
+  double a1 = (o->volume_lock_at_sea - p->ship_volume_sea_to_lake - vol_to_lake) /
+              o->volume_lock_at_lake;
+  double b1 = (vol_from_lake + p->ship_volume_sea_to_lake) * p->salinity_lake /
+              o->volume_lock_at_lake;
+
+  // Phase 3 and 4a, sal_lock_4a = a3 * sal_lock_2 + b3
+  double a3 = (o->volume_lock_at_lake - p->ship_volume_lake_to_sea - vol_to_sea) /
+              o->volume_lock_at_sea;
+  double b3 = (vol_from_sea + p->ship_volume_lake_to_sea) * p->salinity_sea /
+              o->volume_lock_at_sea;
+
+  // The lock exchange as tanh(k * sqrt(c * sal_diff)), i.e. the door open time
+  // over that of the lock exchange
+  double head_above_sill_dc_effective_lake =
+      p->head_lake - p->lock_bottom - 0.8 * p->sill_height_lake;
+  double head_above_sill_dc_effective_sea = p->head_sea - p->lock_bottom - 0.8 * p->sill_height_sea;
+  double volume_effective_lake =
+      head_above_sill_dc_effective_lake / (p->head_lake - p->lock_bottom);
+
+  double c_lake = o->g * 0.8 / o->density_average * head_above_sill_dc_effective_lake;
+  double c_sea = o->g * 0.8 / o->density_average * head_above_sill_dc_effective_sea;
+  double k_lake =
+      p->density_current_factor_lake * 0.5 * fmax(o->t_open_lake, 0.0) / (2 * p->lock_length);
+  double k_sea =
+      p->density_current_factor_sea * 0.5 * fmax(o->t_open_sea, 0.0) / (2 * p->lock_length);
+
+  double sal_min = fmin(p->salinity_lake, p->salinity_sea);
+  double sal_max = fmax(p->salinity_lake, p->salinity_sea);
+
+  double x = sal_lock_start;
+  for (int i = 0; i < CLOSED_FORM_ITERATIONS; i++) {
+    // The salinities through the cycle, and their derivatives to x
+    double dg2, dg4;
+
+    double sal_lock_2a = a1 * x + b1;
+    double g2 = volume_effective_lake *
+                closed_form_exchange(o->accuracy, k_lake, c_lake, sal_lock_2a - p->salinity_lake,
+                                     &dg2);
+    dg2 *= volume_effective_lake * a1;
+    double sal_lock_2 = sal_lock_2a + g2 * (p->salinity_lake - sal_lock_2a);
+    double dsal_lock_2 = a1 * (1.0 - g2) + dg2 * (p->salinity_lake - sal_lock_2a);
+
+    double sal_lock_4a = a3 * sal_lock_2 + b3;
+    double g4 =
+        closed_form_exchange(o->accuracy, k_sea, c_sea, p->salinity_sea - sal_lock_4a, &dg4);
+    dg4 *= -a3 * dsal_lock_2;
+    double sal_lock_4 = sal_lock_4a + g4 * (p->salinity_sea - sal_lock_4a);
+    double dsal_lock_4 = a3 * dsal_lock_2 * (1.0 - g4) + dg4 * (p->salinity_sea - sal_lock_4a);
+
+    double x_next = x - (sal_lock_4 - x) / (dsal_lock_4 - 1.0);
+    if (!isfinite(x_next))
+      break;
+    x_next = fmin(fmax(x_next, sal_min), sal_max);
+
+    if (is_close(x_next, x, p->rtol, p->atol))
+      return (fabs(dsal_lock_4) < 1.0) ? x_next : sal_lock_start;
+    x = x_next;
+  }
+
+  return sal_lock_start;
+}
+
+// Newton's method from a start of the solvers to the closed-form steady state,
+// if there is one and the parameters do not give the lock salinity to start
+// from
+static double steady_closed_form_start(const zsf_param_t *p, const derived_parameters_t *o,
+                                       double sal_lock_4) {
+  if (p->salinity_lock == ZSF_NAN && closed_form_qualifies(p, o))
+    return steady_closed_form(p, o, sal_lock_4);
+  return sal_lock_4;
+}
+
+static double steady_cold_salinity(const zsf_param_t *p, const derived_parameters_t *o) {
+  return steady_closed_form_start(p, o, steady_initial_salinity(p));
+}
 
-  double sal_lock_4 = p->salinity_lock;
+// A warm start from the lock salinity of a similar steady state, or the cold
+// start if there is none (ZSF_NAN). The lock salinity has to lie between that
+// of the lake and the sea, which may have moved past the previous steady state.
+static double steady_warm_salinity(const zsf_param_t *p, const derived_parameters_t *o,
+                                   double sal_lock_4) {
   if (sal_lock_4 == ZSF_NAN)
-    sal_lock_4 = 0.5 * (p->salinity_sea + p->salinity_lake);
+    return steady_cold_salinity(p, o);
 
-  state.volume_ship_in_lock = p->ship_volume_sea_to_lake;
-  state.saltmass_lock = sal_lock_4 * (o.volume_lock_at_sea - state.volume_ship_in_lock);
-  state.head_lock = p->head_sea;
-  state.salinity_lock = sal_lock_4;
+  double sal_min = fmin(p->salinity_lake, p->salinity_sea);
+  double sal_max = fmax(p->salinity_lake, p->salinity_sea);
+  return steady_closed_form_start(p, o, fmin(fmax(sal_lock_4, sal_min), sal_max));
+}
 
-  int err = check_parameters_state(p, &o, &state);
-  if (err) {
-    return err;
+static int steady_initial_state_from(const zsf_param_t *p, const derived_parameters_t *o,
+                                     double sal_lock_4, zsf_phase_state_t *state) {
+  // Start salinity and salt mass
+  state->volume_ship_in_lock = p->ship_volume_sea_to_lake;
+  state->saltmass_lock = sal_lock_4 * (o->volume_lock_at_sea - state->volume_ship_in_lock);
+  state->head_lock = p->head_sea;
+  state->salinity_lock = sal_lock_4;
+
+  return check_parameters_state(p, o, state);
+}
+
+static int steady_initial_state(const zsf_param_t *p, const derived_parameters_t *o,
+                                zsf_phase_state_t *state) {
+  return steady_initial_state_from(p, o, steady_cold_salinity(p, o), state);
+}
+
+static forceinline void steady_cycle(const zsf_param_t *p, const derived_parameters_t *o,
+                                     zsf_phase_state_t *state, steady_cycle_t *c) {
+  step_phase_1(p, o, p->leveling_time, state, &c->tp1);
+  c->sal_lock_1 = state->salinity_lock;
+
+  step_phase_2(p, o, o->t_open_lake, state, &c->tp2);
+  c->sal_lock_2 = state->salinity_lock;
+
+  step_phase_3(p, o, p->leveling_time, state, &c->tp3);
+  c->sal_lock_3 = state->salinity_lock;
+
+  step_phase_4(p, o, o->t_open_sea, state, &c->tp4);
+  c->sal_lock_4 = state->salinity_lock;
+}
+
+static void steady_results(const zsf_param_t *p, const derived_parameters_t *o,
+                           const steady_cycle_t *c, zsf_results_t *results,
+                           zsf_aux_results_t *aux_results) {
+  const zsf_phase_transports_t *tp1 = &c->tp1;
+  const zsf_phase_transports_t *tp2 = &c->tp2;
+  const zsf_phase_transports_t *tp3 = &c->tp3;
+  const zsf_phase_transports_t *tp4 = &c->tp4;
+
+  // Cycle-averaged discharges and salinities
+  // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // Lake side
+  double mt_lake = tp1->mass_transport_lake + tp2->mass_transport_lake +
+                   tp3->mass_transport_lake + tp4->mass_transport_lake;
+
+  double vol_from_lake =
+      tp1->volume_from_lake + tp2->volume_from_lake + tp3->volume_from_lake + tp4->volume_from_lake;
+  double disch_from_lake = vol_from_lake / o->t_cycle;
+
+  double vol_to_lake =
+      tp1->volume_to_lake + tp2->volume_to_lake + tp3->volume_to_lake + tp4->volume_to_lake;
+  double disch_to_lake = vol_to_lake / o->t_cycle;
+
+  double salt_load_lake = mt_lake / o->t_cycle;
+  double sal_to_lake = -1 * (mt_lake - vol_from_lake * p->salinity_lake) / vol_to_lake;
+
+  // Sea side
+  double mt_sea = tp1->mass_transport_sea + tp2->mass_transport_sea + tp3->mass_transport_sea +
+                  tp4->mass_transport_sea;
+
+  double vol_from_sea =
+      tp1->volume_from_sea + tp2->volume_from_sea + tp3->volume_from_sea + tp4->volume_from_sea;
+  double disch_from_sea = vol_from_sea / o->t_cycle;
+
+  double vol_to_sea =
+      tp1->volume_to_sea + tp2->volume_to_sea + tp3->volume_to_sea + tp4->volume_to_sea;
+  double disch_to_sea = vol_to_sea / o->t_cycle;
+
+  double salt_load_sea = mt_sea / o->t_cycle;
+  double sal_to_sea = (mt_sea + vol_from_sea * p->salinity_sea) / vol_to_sea;
+
+  // Put the main results in the output stucture
+  results->mass_transport_lake = mt_lake;
+  results->salt_load_lake = salt_load_lake;
+  results->discharge_from_lake = disch_from_lake;
+  results->discharge_to_lake = disch_to_lake;
+  results->salinity_to_lake = sal_to_lake;
+
+  results->mass_transport_sea = mt_sea;
+  results->salt_load_sea = salt_load_sea;
+  results->discharge_from_sea = disch_from_sea;
+  results->discharge_to_sea = disch_to_sea;
+  results->salinity_to_sea = sal_to_sea;
+
+  // Additional results. Only interesting when one wants to get a closer
+  // understanding of what is going on, what happens in each phase, etc.
+  if (aux_results != NULL) {
+    // Equivalent full lock exchanges
+    aux_results->z_fraction = 0.5 * (mt_lake + mt_sea) /
+                              (0.5 * (o->volume_lock_at_lake + o->volume_lock_at_sea) *
+                               (p->salinity_sea - p->salinity_lake));
+
+    // Dimensionless door open time
+    double sal_diff = p->salinity_sea - p->salinity_lake;
+    double head_avg = 0.5 * (p->head_sea + p->head_lake);
+    double velocity_exchange =
+        0.5 * sqrt(o->g * 0.8 * sal_diff / o->density_average * (head_avg - p->lock_bottom));
+    double t_lock_exchange = 2 * p->lock_length / velocity_exchange;
+
+    aux_results->dimensionless_door_open_time = t_lock_exchange / o->t_open;
+
+    // Volumes from/to lake and sea
+    aux_results->volume_to_lake = vol_to_lake;
+    aux_results->volume_from_lake = vol_from_lake;
+    aux_results->volume_to_sea = vol_to_sea;
+    aux_results->volume_from_sea = vol_from_sea;
+
+    // Dependent parameters
+    aux_results->volume_lock_at_lake = o->volume_lock_at_lake;
+    aux_results->volume_lock_at_sea = o->volume_lock_at_sea;
+
+    aux_results->t_cycle = o->t_cycle;
+    aux_results->t_open = o->t_open;
+    aux_results->t_open_lake = o->t_open_lake;
+    aux_results->t_open_sea = o->t_open_sea;
+
+    // Salinities after each phase
+    aux_results->salinity_lock_1 = c->sal_lock_1;
+    aux_results->salinity_lock_2 = c->sal_lock_2;
+    aux_results->salinity_lock_3 = c->sal_lock_3;
+    aux_results->salinity_lock_4 = c->sal_lock_4;
+
+    // Transports in each phase
+    memcpy(&aux_results->transports_phase_1, tp1, sizeof(zsf_phase_transports_t));
+    memcpy(&aux_results->transports_phase_2, tp2, sizeof(zsf_phase_transports_t));
+    memcpy(&aux_results->transports_phase_3, tp3, sizeof(zsf_phase_transports_t));
+    memcpy(&aux_results->transports_phase_4, tp4, sizeof(zsf_phase_transports_t));
   }
+}
 
-  while (1) {
-    // Backup old salinity value for convergence check
-    double sal_lock_4_prev = sal_lock_4;
+// Aitken's delta-squared extrapolation of the salinity at the end of a cycle.
+// The lock salinity after a cycle is a smooth function of the salinity at the
+// start, and the Picard iteration converges (close to) linearly with a ratio
+// r of successive differences. If the lock exchanges only a small fraction of
+// its volume per cycle, r is close to 1 and many cycles are needed. From
+// three successive iterates we estimate r, and jump to the limit of the
+// geometric series. Estimates of r that are not in (-1, 1) would not converge
+// with Picard iteration either, and are ignored.
+static int aitken_extrapolate(const zsf_param_t *p, double x0, double x1, double x2, double *x) {
+  double d1 = x1 - x0;
+  double d2 = x2 - x1;
+  double r = d2 / d1;
+
+  if (!isfinite(r) || fabs(r) >= 1.0)
+    return 0;
+
+  *x = x2 + d2 * r / (1.0 - r);
+  *x = fmax(*x, p->salinity_lake);
+  *x = fmin(*x, p->salinity_sea);
+  return 1;
+}
+
+// Restart the cycle from a different salinity of the lock, as at the end of
+// phase 4.
+static void steady_restart(const derived_parameters_t *o, zsf_phase_state_t *state, double x) {
+  state->salinity_lock = x;
+  state->saltmass_lock = x * (o->volume_lock_at_sea - state->volume_ship_in_lock);
+}
+
+// The number of cycles without a smaller change in salinity after which we
+// consider the iteration to be stuck. A converging iteration makes progress
+// every cycle (or every few cycles when extrapolating), so this only triggers
+// when the tolerances are below what rounding errors allow.
+#define STAGNATION_CYCLES 16
+
+static void steady_trace(zsf_steady_trace_t *trace, int max_trace, int num_cycles, int restarted,
+                         const steady_cycle_t *cycle, double residual) {
+  if (max_trace <= 0)
+    return;
+
+  zsf_steady_trace_t *t = &trace[(num_cycles - 1) % max_trace];
+  t->cycle = num_cycles;
+  t->restarted = restarted;
+  t->salinity_lock_1 = cycle->sal_lock_1;
+  t->salinity_lock_2 = cycle->sal_lock_2;
+  t->salinity_lock_3 = cycle->sal_lock_3;
+  t->salinity_lock_4 = cycle->sal_lock_4;
+  t->residual = residual;
+}
+
+static cpu_dispatch int steady_iterate(const zsf_param_t *p, const derived_parameters_t *o,
+                                       const zsf_options_t *options, zsf_phase_state_t *state,
+                                       steady_cycle_t *cycle, zsf_steady_stats_t *stats,
+                                       zsf_steady_trace_t *trace, int max_trace) {
+  int err = ZSF_SUCCESS;
+
+  int num_cycles = 0;
+  int num_extrapolations = 0;
+
+  double t_start = (options->max_time > 0.0) ? timer_now() : 0.0;
 
-    zsf_phase_transports_t tp1;
-    step_phase_1(p, &o, p->leveling_time, &state, &tp1);
-    double sal_lock_1 = state.salinity_lock;
+  // Lock salinities at the start of the previous cycle(s), for extrapolation
+  double x0 = 0.0, x1 = 0.0;
+  int num_iterates = 0;
 
-    zsf_phase_transports_t tp2;
-    step_phase_2(p, &o, o.t_open_lake, &state, &tp2);
-    double sal_lock_2 = state.salinity_lock;
+  // The cycle with the smallest change in salinity is our best estimate if
+  // we do not converge.
+  double best_start = state->salinity_lock;
+  double best_residual = INFINITY;
+  int best_cycle = 0;
+  double residual = 0.0;
+  double prev_step = 0.0;
+  int num_sign_changes = 0;
+  int restarted = 0;
 
-    zsf_phase_transports_t tp3;
-    step_phase_3(p, &o, p->leveling_time, &state, &tp3);
-    double sal_lock_3 = state.salinity_lock;
+  while (1) {
+    // Backup old salinity value for convergence check
+    double sal_lock_4_prev = state->salinity_lock;
 
-    zsf_phase_transports_t tp4;
-    step_phase_4(p, &o, o.t_open_sea, &state, &tp4);
+    steady_cycle(p, o, state, cycle);
+    num_cycles++;
 
-    sal_lock_4 = state.salinity_lock;
+    double step = cycle->sal_lock_4 - sal_lock_4_prev;
+    residual = fabs(step);
+    steady_trace(trace, max_trace, num_cycles, restarted, cycle, residual);
+    restarted = 0;
 
     // Convergence check
     // ~~~~~~~~~~~~~~~~~
-    if (is_close(sal_lock_4, sal_lock_4_prev, p->rtol, p->atol)) {
-      // Cycle-averaged discharges and salinities
-      // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-      // Lake side
-      double mt_lake = tp1.mass_transport_lake + tp2.mass_transport_lake + tp3.mass_transport_lake +
-                       tp4.mass_transport_lake;
-
-      double vol_from_lake =
-          tp1.volume_from_lake + tp2.volume_from_lake + tp3.volume_from_lake + tp4.volume_from_lake;
-      double disch_from_lake = vol_from_lake / o.t_cycle;
-
-      double vol_to_lake =
-          tp1.volume_to_lake + tp2.volume_to_lake + tp3.volume_to_lake + tp4.volume_to_lake;
-      double disch_to_lake = vol_to_lake / o.t_cycle;
-
-      double salt_load_lake = mt_lake / o.t_cycle;
-      double sal_to_lake = -1 * (mt_lake - vol_from_lake * p->salinity_lake) / vol_to_lake;
-
-      // Sea side
-      double mt_sea = tp1.mass_transport_sea + tp2.mass_transport_sea + tp3.mass_transport_sea +
-                      tp4.mass_transport_sea;
-
-      double vol_from_sea =
-          tp1.volume_from_sea + tp2.volume_from_sea + tp3.volume_from_sea + tp4.volume_from_sea;
-      double disch_from_sea = vol_from_sea / o.t_cycle;
-
-      double vol_to_sea =
-          tp1.volume_to_sea + tp2.volume_to_sea + tp3.volume_to_sea + tp4.volume_to_sea;
-      double disch_to_sea = vol_to_sea / o.t_cycle;
-
-      double salt_load_sea = mt_sea / o.t_cycle;
-      double sal_to_sea = (mt_sea + vol_from_sea * p->salinity_sea) / vol_to_sea;
-
-      // Put the main results in the output stucture
-      results->mass_transport_lake = mt_lake;
-      results->salt_load_lake = salt_load_lake;
-      results->discharge_from_lake = disch_from_lake;
-      results->discharge_to_lake = disch_to_lake;
-      results->salinity_to_lake = sal_to_lake;
-
-      results->mass_transport_sea = mt_sea;
-      results->salt_load_sea = salt_load_sea;
-      results->discharge_from_sea = disch_from_sea;
-      results->discharge_to_sea = disch_to_sea;
-      results->salinity_to_sea = sal_to_sea;
-
-      // Additional results. Only interesting when one wants to get a closer
-      // understanding of what is going on, what happens in each phase, etc.
-      if (aux_results != NULL) {
-        // Equivalent full lock exchanges
-        aux_results->z_fraction = 0.5 * (mt_lake + mt_sea) /
-                                  (0.5 * (o.volume_lock_at_lake + o.volume_lock_at_sea) *
-                                   (p->salinity_sea - p->salinity_lake));
-
-        // Dimensionless door open time
-        double sal_diff = p->salinity_sea - p->salinity_lake;
-        double head_avg = 0.5 * (p->head_sea + p->head_lake);
-        double velocity_exchange =
-            0.5 * sqrt(o.g * 0.8 * sal_diff / o.density_average * (head_avg - p->lock_bottom));
-        double t_lock_exchange = 2 * p->lock_length / velocity_exchange;
-
-        aux_results->dimensionless_door_open_time = t_lock_exchange / o.t_open;
-
-        // Volumes from/to lake and sea
-        aux_results->volume_to_lake = vol_to_lake;
-        aux_results->volume_from_lake = vol_from_lake;
-        aux_results->volume_to_sea = vol_to_sea;
-        aux_results->volume_from_sea = vol_from_sea;
-
-        // Dependent parameters
-        aux_results->volume_lock_at_lake = o.volume_lock_at_lake;
-        aux_results->volume_lock_at_sea = o.volume_lock_at_sea;
-
-        aux_results->t_cycle = o.t_cycle;
-        aux_results->t_open = o.t_open;
-        aux_results->t_open_lake = o.t_open_lake;
-        aux_results->t_open_sea = o.t_open_sea;
-
-        // Salinities after each phase
-        aux_results->salinity_lock_1 = sal_lock_1;
-        aux_results->salinity_lock_2 = sal_lock_2;
-        aux_results->salinity_lock_3 = sal_lock_3;
-        aux_results->salinity_lock_4 = sal_lock_4;
-
-        // Transports in each phase
-        memcpy(&aux_results->transports_phase_1, &tp1, sizeof(zsf_phase_transports_t));
-        memcpy(&aux_results->transports_phase_2, &tp2, sizeof(zsf_phase_transports_t));
-        memcpy(&aux_results->transports_phase_3, &tp3, sizeof(zsf_phase_transports_t));
-        memcpy(&aux_results->transports_phase_4, &tp4, sizeof(zsf_phase_transports_t));
-      }
+    // Always on the result of a full cycle, such that the transports of the
+    // last cycle are consistent with the salinity we converged to.
+    if (is_close(cycle->sal_lock_4, sal_lock_4_prev, p->rtol, p->atol)) {
+      break;
+    }
+
+    // Bounds on the number of cycles and time
+    // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    if (residual < best_residual) {
+      best_start = sal_lock_4_prev;
+      best_residual = residual;
+      best_cycle = num_cycles;
+      num_sign_changes = 0;
+    } else if (step * prev_step < 0.0) {
+      num_sign_changes++;
+    }
+    prev_step = step;
 
+    if (num_cycles - best_cycle >= STAGNATION_CYCLES) {
+      // Jumping back and forth without getting closer, or just stuck
+      err = (2 * num_sign_changes >= STAGNATION_CYCLES) ? ZSF_ERR_OSCILLATION : ZSF_ERR_STAGNATION;
+      break;
+    }
+    if (options->max_cycles > 0 && num_cycles >= options->max_cycles) {
+      err = ZSF_ERR_MAX_CYCLES;
+      break;
+    }
+    if (options->max_time > 0.0 && timer_now() - t_start >= options->max_time) {
+      err = ZSF_ERR_MAX_TIME;
       break;
     }
+
+    // Acceleration
+    // ~~~~~~~~~~~~
+    if (options->solver == ZSF_SOLVER_AITKEN) {
+      if (num_iterates == 0) {
+        x0 = sal_lock_4_prev;
+        x1 = cycle->sal_lock_4;
+        num_iterates = 2;
+      } else {
+        double x;
+        if (aitken_extrapolate(p, x0, x1, cycle->sal_lock_4, &x)) {
+          steady_restart(o, state, x);
+          num_extrapolations++;
+          restarted = 1;
+        }
+        num_iterates = 0;
+      }
+    }
+  }
+
+  // Redo the best cycle if it is not the last one, such that the results are
+  // those of the best estimate. This is the only cycle beyond the limits.
+  if (err && best_cycle != num_cycles) {
+    steady_restart(o, state, best_start);
+    steady_cycle(p, o, state, cycle);
+    num_cycles++;
+    residual = fabs(cycle->sal_lock_4 - best_start);
+    steady_trace(trace, max_trace, num_cycles, 1, cycle, residual);
+  }
+
+  COUNT(num_steady_solves);
+  COUNTER_ADD(num_cycles, num_cycles);
+  if (err)
+    COUNT(num_unconverged_solves);
+
+  if (stats != NULL) {
+    stats->num_cycles = num_cycles;
+    stats->num_extrapolations = num_extrapolations;
+    stats->residual = residual;
+  }
+
+  return err;
+}
+
+static int context_calc_steady(const zsf_context_t *ctx, const zsf_options_t *options,
+                               zsf_results_t *results, zsf_aux_results_t *aux_results,
+                               zsf_steady_stats_t *stats, zsf_steady_trace_t *trace,
+                               int max_trace) {
+  zsf_options_t default_options;
+  if (options == NULL) {
+    zsf_options_default(&default_options);
+    options = &default_options;
+  }
+  if (stats != NULL)
+    memset(stats, 0, sizeof(zsf_steady_stats_t));
+
+  derived_parameters_t o = ctx->o;
+  o.accuracy = options->accuracy;
+
+  zsf_phase_state_t state;
+
+  int err = steady_initial_state(&ctx->p, &o, &state);
+  if (err) {
+    return err;
+  }
+
+  // Also when not converged, we have a (best) estimate to return
+  steady_cycle_t cycle;
+  err = steady_iterate(&ctx->p, &o, options, &state, &cycle, stats, trace, max_trace);
+
+  steady_results(&ctx->p, &o, &cycle, results, aux_results);
+
+  return err;
+}
+
+int ZSF_CALLCONV zsf_context_calc_steady(const zsf_context_t *ctx, const zsf_options_t *options,
+                                         zsf_results_t *results, zsf_aux_results_t *aux_results,
+                                         zsf_steady_stats_t *stats) {
+  return context_calc_steady(ctx, options, results, aux_results, stats, NULL, 0);
+}
+
+int ZSF_CALLCONV zsf_calc_steady_ex(const zsf_param_t *p, const zsf_options_t *options,
+                                    zsf_results_t *results, zsf_aux_results_t *aux_results,
+                                    zsf_steady_stats_t *stats) {
+  zsf_context_t ctx;
+  context_init(&ctx, p);
+  return zsf_context_calc_steady(&ctx, options, results, aux_results, stats);
+}
+
+int ZSF_CALLCONV zsf_calc_steady_trace(const zsf_param_t *p, const zsf_options_t *options,
+                                       zsf_results_t *results, zsf_aux_results_t *aux_results,
+                                       zsf_steady_stats_t *stats, zsf_steady_trace_t *trace,
+                                       int max_trace) {
+  zsf_context_t ctx;
+  context_init(&ctx, p);
+  return context_calc_steady(&ctx, options, results, aux_results, stats, trace, max_trace);
+}
+
+int ZSF_CALLCONV zsf_calc_steady(const zsf_param_t *p, zsf_results_t *results,
+                                 zsf_aux_results_t *aux_results) {
+  return zsf_calc_steady_ex(p, NULL, results, aux_results, NULL);
+}
+
+// Batch calculation
+// ~~~~~~~~~~~~~~~~~
+#define PARAM_FIELDS(X)                                                                            \
+  X(lock_length)                                                                                   \
+  X(lock_width)                                                                                    \
+  X(lock_bottom)                                                                                   \
+  X(num_cycles)                                                                                    \
+  X(door_time_to_open)                                                                             \
+  X(leveling_time)                                                                                 \
+  X(calibration_coefficient)                                                                       \
+  X(symmetry_coefficient)                                                                          \
+  X(ship_volume_sea_to_lake)                                                                       \
+  X(ship_volume_lake_to_sea)                                                                       \
+  X(salinity_lock)                                                                                 \
+  X(head_sea)                                                                                      \
+  X(salinity_sea)                                                                                  \
+  X(temperature_sea)                                                                               \
+  X(head_lake)                                                                                     \
+  X(salinity_lake)                                                                                 \
+  X(temperature_lake)                                                                              \
+  X(flushing_discharge_high_tide)                                                                  \
+  X(flushing_discharge_low_tide)                                                                   \
+  X(density_current_factor_sea)                                                                    \
+  X(density_current_factor_lake)                                                                   \
+  X(distance_door_bubble_screen_sea)                                                               \
+  X(distance_door_bubble_screen_lake)                                                              \
+  X(sill_height_sea)                                                                               \
+  X(sill_height_lake)                                                                              \
+  X(rtol)                                                                                          \
+  X(atol)
+
+#define RESULTS_FIELDS(X)                                                                          \
+  X(mass_transport_lake)                                                                           \
+  X(salt_load_lake)                                                                                \
+  X(discharge_from_lake)                                                                           \
+  X(discharge_to_lake)                                                                             \
+  X(salinity_to_lake)                                                                              \
+  X(mass_transport_sea)                                                                            \
+  X(salt_load_sea)                                                                                 \
+  X(discharge_from_sea)                                                                            \
+  X(discharge_to_sea)                                                                              \
+  X(salinity_to_sea)
+
+static void gather_param(const zsf_param_t *base, const zsf_param_columns_t *params, size_t index,
+                         zsf_param_t *p) {
+#define GATHER_PARAM(F) p->F = (params->F != NULL) ? params->F[index] : base->F;
+  PARAM_FIELDS(GATHER_PARAM)
+#undef GATHER_PARAM
+}
+
+static void scatter_results(const zsf_results_t *r, size_t index, zsf_results_columns_t *results) {
+#define SCATTER_RESULT(F)                                                                          \
+  if (results->F != NULL)                                                                          \
+    results->F[index] = r->F;
+  RESULTS_FIELDS(SCATTER_RESULT)
+#undef SCATTER_RESULT
+}
+
+static const zsf_param_columns_t no_param_columns = {0};
+static zsf_results_columns_t no_results_columns = {0};
+
+void ZSF_CALLCONV zsf_options_default(zsf_options_t *options) {
+  memset(options, 0, sizeof(zsf_options_t));
+
+  // Parallelization
+  options->num_threads = 1;
+  options->chunk_size = 0;
+
+  // Solver
+  options->solver = ZSF_SOLVER_PICARD;
+  options->max_cycles = 0;
+  options->max_time = 0.0;
+
+  // Math
+  options->accuracy = ZSF_ACCURACY_EXACT;
+}
+
+typedef struct steady_batch_t {
+  const zsf_param_t *base;
+  const zsf_param_columns_t *params;
+  int param_stride;
+  zsf_results_columns_t *results;
+  int results_stride;
+  int *errors;
+  const zsf_options_t *options;
+  int *num_failed; // One counter per thread
+} steady_batch_t;
+
+static cpu_dispatch void steady_batch_range(void *data, int begin, int end, int thread) {
+  steady_batch_t *b = (steady_batch_t *)data;
+
+  zsf_param_t p;
+  zsf_context_t ctx;
+
+  for (int i = begin; i < end; i++) {
+    gather_param(b->base, b->params, (size_t)i * b->param_stride, &p);
+
+    // Most columns in a batch vary only a few parameters, so the context
+    // of the previous row saves us from calculating the densities again.
+    if (i == begin) {
+      context_init(&ctx, &p);
+      ctx.o.accuracy = b->options->accuracy;
+    } else {
+      context_update(&ctx, &p);
+    }
+
+    zsf_phase_state_t state;
+    steady_cycle_t cycle;
+
+    int err = steady_initial_state(&ctx.p, &ctx.o, &state);
+    if (err) {
+      if (b->errors != NULL)
+        b->errors[i] = err;
+      b->num_failed[thread]++;
+      continue;
+    }
+
+    // Rows that do not converge still get their best estimate
+    err = steady_iterate(&ctx.p, &ctx.o, b->options, &state, &cycle, NULL, NULL, 0);
+    if (b->errors != NULL)
+      b->errors[i] = err;
+    if (err)
+      b->num_failed[thread]++;
+
+    zsf_results_t r;
+    steady_results(&ctx.p, &ctx.o, &cycle, &r, NULL);
+    scatter_results(&r, (size_t)i * b->results_stride, b->results);
+  }
+}
+
+int ZSF_CALLCONV zsf_calc_steady_batch(const zsf_param_t *base, const zsf_param_columns_t *params,
+                                       int param_stride, zsf_results_columns_t *results,
+                                       int results_stride, int *errors, int n,
+                                       const zsf_options_t *options) {
+  zsf_param_t default_param;
+  if (base == NULL) {
+    zsf_param_default(&default_param);
+    base = &default_param;
+  }
+  if (params == NULL)
+    params = &no_param_columns;
+  if (results == NULL)
+    results = &no_results_columns;
+  if (param_stride < 0 || results_stride < 0)
+    return ZSF_ERR_INVALID_STRIDE;
+
+  zsf_options_t default_options;
+  if (options == NULL) {
+    zsf_options_default(&default_options);
+    options = &default_options;
+  }
+
+  // The number of iterations needed differs a lot between rows, so we use
+  // relatively small chunks and let idle threads steal work from busy ones.
+  int num_threads = parallel_num_threads(options->num_threads, n);
+  int chunk_size = (options->chunk_size > 0) ? options->chunk_size : 32;
+
+  int single_failed = 0;
+  int *num_failed = (num_threads > 1) ? (int *)calloc(num_threads, sizeof(int)) : NULL;
+  if (num_failed == NULL) {
+    num_threads = 1;
+    num_failed = &single_failed;
+  }
+
+  steady_batch_t b = {
+      base, params, param_stride, results, results_stride, errors, options, num_failed};
+  parallel_for(n, chunk_size, num_threads, steady_batch_range, &b);
+
+  int total_failed = 0;
+  for (int t = 0; t < num_threads; t++) {
+    total_failed += num_failed[t];
+  }
+  if (num_failed != &single_failed)
+    free(num_failed);
+
+  return total_failed ? ZSF_ERR_BATCH_FAILED_ROWS : ZSF_SUCCESS;
+}
+
+// Lockage sequences
+// ~~~~~~~~~~~~~~~~~
+// Most parameters of a sequence of events are constant, so instead of
+// gathering all parameters for every event like the batch does, we only visit
+// the columns that are given.
+typedef struct param_column_t {
+  size_t offset;
+  const double *values;
+} param_column_t;
+
+#define COUNT_PARAM(F) +1
+enum { NUM_PARAM_FIELDS = 0 PARAM_FIELDS(COUNT_PARAM) };
+#undef COUNT_PARAM
+
+static int given_param_columns(const zsf_param_columns_t *params, param_column_t *columns) {
+  int n = 0;
+#define ADD_PARAM_COLUMN(F)                                                                        \
+  if (params->F != NULL) {                                                                         \
+    columns[n].offset = offsetof(zsf_param_t, F);                                                  \
+    columns[n].values = params->F;                                                                 \
+    n++;                                                                                           \
+  }
+  PARAM_FIELDS(ADD_PARAM_COLUMN)
+#undef ADD_PARAM_COLUMN
+  return n;
+}
+
+// Sets the parameters of an event, and returns whether any of them changed
+static int apply_param_columns(const param_column_t *columns, int num_columns, size_t index,
+                                 zsf_param_t *p) {
+  int changed = 0;
+  for (int j = 0; j < num_columns; j++) {
+    double *field = (double *)((char *)p + columns[j].offset);
+    double value = columns[j].values[index];
+    if (!(*field == value)) {
+      *field = value;
+      changed = 1;
+    }
   }
+  return changed;
+}
 
+// Doors closed and no flushing, so nothing flows
+static int step_idle(const zsf_phase_state_t *state, zsf_phase_transports_t *results) {
+  memset(results, 0, sizeof(zsf_phase_transports_t));
+  results->salinity_to_lake = state->salinity_lock;
+  results->salinity_to_sea = state->salinity_lock;
   return ZSF_SUCCESS;
 }
+
+static int step_routine(const zsf_context_t *ctx, int routine, double duration,
+                        zsf_phase_state_t *state, zsf_phase_transports_t *results) {
+  switch (routine) {
+  case ZSF_ROUTINE_IDLE:
+    return step_idle(state, results);
+  case ZSF_ROUTINE_LEVEL_TO_LAKE:
+    return zsf_context_step_phase_1(ctx, duration, state, results);
+  case ZSF_ROUTINE_DOOR_OPEN_LAKE:
+    return zsf_context_step_phase_2(ctx, duration, state, results);
+  case ZSF_ROUTINE_LEVEL_TO_SEA:
+    return zsf_context_step_phase_3(ctx, duration, state, results);
+  case ZSF_ROUTINE_DOOR_OPEN_SEA:
+    return zsf_context_step_phase_4(ctx, duration, state, results);
+  case ZSF_ROUTINE_FLUSH_DOORS_CLOSED_LAKE:
+  case ZSF_ROUTINE_FLUSH_DOORS_CLOSED_SEA:
+    return zsf_context_step_flush_doors_closed(ctx, duration, state, results);
+  default:
+    return ZSF_ERR_UNKNOWN_ROUTINE;
+  }
+}
+
+int ZSF_CALLCONV zsf_run_lockages(const zsf_param_t *base, const zsf_param_columns_t *params,
+                                  int param_stride, const int *routines, const double *durations,
+                                  int n, zsf_phase_state_t *state,
+                                  zsf_phase_transports_t *transports, int *failed_event,
+                                  const zsf_options_t *options) {
+  zsf_param_t default_param;
+  if (base == NULL) {
+    zsf_param_default(&default_param);
+    base = &default_param;
+  }
+  if (params == NULL)
+    params = &no_param_columns;
+  if (param_stride < 0)
+    return ZSF_ERR_INVALID_STRIDE;
+
+  zsf_options_t default_options;
+  if (options == NULL) {
+    zsf_options_default(&default_options);
+    options = &default_options;
+  }
+
+  if (failed_event != NULL)
+    *failed_event = -1;
+
+  param_column_t columns[NUM_PARAM_FIELDS];
+  int num_columns = given_param_columns(params, columns);
+
+  zsf_param_t p = *base;
+  zsf_context_t ctx;
+  zsf_phase_transports_t discarded;
+
+  for (int i = 0; i < n; i++) {
+    int changed = apply_param_columns(columns, num_columns, (size_t)i * param_stride, &p);
+
+    // Boundary conditions typically change slowly compared to the events, so
+    // most events can reuse the context of the previous one as is.
+    if (i == 0) {
+      context_init(&ctx, &p);
+      ctx.o.accuracy = options->accuracy;
+    } else if (changed) {
+      context_update(&ctx, &p);
+    }
+
+    int err = step_routine(&ctx, routines[i], durations[i], state,
+                           (transports != NULL) ? &transports[i] : &discarded);
+    if (err) {
+      if (failed_event != NULL)
+        *failed_event = i;
+      return err;
+    }
+  }
+
+  return ZSF_SUCCESS;
+}
+
+// Lock complexes
+// ~~~~~~~~~~~~~~
+// Chambers side by side on the same lake and sea. The chambers do not
+// influence each other, so every thread steps whole chambers through a block of
+// time steps. The densities of the shared boundaries are calculated once per
+// time step for all chambers, instead of once per chamber.
+
+// The number of transports of all chambers together in a block of time steps
+#define COMPLEX_BLOCK_TRANSPORTS 4096
+
+struct zsf_complex_t {
+  int num_chambers;
+  zsf_param_t *params;
+
+  // The states of the chambers, as a structure of arrays
+  double *salinity_lock;
+  double *saltmass_lock;
+  double *head_lock;
+  double *volume_ship_in_lock;
+};
+
+static void complex_get_state(const zsf_complex_t *c, int chamber, zsf_phase_state_t *state) {
+  state->salinity_lock = c->salinity_lock[chamber];
+  state->saltmass_lock = c->saltmass_lock[chamber];
+  state->head_lock = c->head_lock[chamber];
+  state->volume_ship_in_lock = c->volume_ship_in_lock[chamber];
+}
+
+static void complex_set_state(zsf_complex_t *c, int chamber, const zsf_phase_state_t *state) {
+  c->salinity_lock[chamber] = state->salinity_lock;
+  c->saltmass_lock[chamber] = state->saltmass_lock;
+  c->head_lock[chamber] = state->head_lock;
+  c->volume_ship_in_lock[chamber] = state->volume_ship_in_lock;
+}
+
+int ZSF_CALLCONV zsf_complex_create(const zsf_param_t *chambers, int num_chambers,
+                                    zsf_complex_t **complex) {
+  *complex = NULL;
+  if (num_chambers < 1)
+    return ZSF_ERR_INVALID_CHAMBER;
+
+  zsf_complex_t *c = (zsf_complex_t *)calloc(1, sizeof(zsf_complex_t));
+  if (c == NULL)
+    return ZSF_ERR_OUT_OF_MEMORY;
+
+  c->num_chambers = num_chambers;
+  c->params = (zsf_param_t *)malloc(num_chambers * sizeof(zsf_param_t));
+  c->salinity_lock = (double *)malloc(4 * num_chambers * sizeof(double));
+  if (c->params == NULL || c->salinity_lock == NULL) {
+    zsf_complex_free(c);
+    return ZSF_ERR_OUT_OF_MEMORY;
+  }
+  c->saltmass_lock = c->salinity_lock + num_chambers;
+  c->head_lock = c->saltmass_lock + num_chambers;
+  c->volume_ship_in_lock = c->head_lock + num_chambers;
+
+  // The lake and the sea are those of the first chamber. Every chamber starts
+  // empty and level with the sea, like a steady state calculation.
+  for (int j = 0; j < num_chambers; j++) {
+    zsf_param_t *p = &c->params[j];
+    *p = chambers[j];
+    p->head_sea = chambers[0].head_sea;
+    p->salinity_sea = chambers[0].salinity_sea;
+    p->temperature_sea = chambers[0].temperature_sea;
+    p->head_lake = chambers[0].head_lake;
+    p->salinity_lake = chambers[0].salinity_lake;
+    p->temperature_lake = chambers[0].temperature_lake;
+
+    zsf_phase_state_t state;
+    zsf_initialize_state(p, &state, steady_initial_salinity(p), p->head_sea);
+    complex_set_state(c, j, &state);
+  }
+
+  *complex = c;
+  return ZSF_SUCCESS;
+}
+
+void ZSF_CALLCONV zsf_complex_free(zsf_complex_t *complex) {
+  if (complex == NULL)
+    return;
+  free(complex->params);
+  free(complex->salinity_lock);
+  free(complex);
+}
+
+int ZSF_CALLCONV zsf_complex_get_state(const zsf_complex_t *complex, int chamber,
+                                       zsf_phase_state_t *state) {
+  if (chamber < 0 || chamber >= complex->num_chambers)
+    return ZSF_ERR_INVALID_CHAMBER;
+  complex_get_state(complex, chamber, state);
+  return ZSF_SUCCESS;
+}
+
+int ZSF_CALLCONV zsf_complex_set_state(zsf_complex_t *complex, int chamber,
+                                       const zsf_phase_state_t *state) {
+  if (chamber < 0 || chamber >= complex->num_chambers)
+    return ZSF_ERR_INVALID_CHAMBER;
+  complex_set_state(complex, chamber, state);
+  return ZSF_SUCCESS;
+}
+
+// A chamber during a run, of which the context carries over from one block of
+// time steps to the next
+typedef struct complex_chamber_t {
+  zsf_param_t p;
+  zsf_context_t ctx;
+  zsf_phase_state_t state;
+  int shared_density;
+  int failed_step;
+  int error;
+} complex_chamber_t;
+
+typedef struct complex_run_t {
+  complex_chamber_t *chambers;
+  int num_chambers;
+  const param_column_t *columns;
+  int num_columns;
+  int param_stride;
+  const double *densities; // Per time step, or NULL if the columns do not change them
+  const int *routines;
+  const double *durations;
+  int begin_step, end_step;
+  zsf_phase_transports_t *transports; // Of the time steps from begin_step
+} complex_run_t;
+
+static void complex_run_range(void *data, int begin, int end, int thread) {
+  (void)thread;
+  const complex_run_t *r = (const complex_run_t *)data;
+  int num_chambers = r->num_chambers;
+
+  for (int j = begin; j < end; j++) {
+    complex_chamber_t *chamber = &r->chambers[j];
+
+    for (int i = r->begin_step; i < r->end_step; i++) {
+      size_t index = (size_t)i * num_chambers + j;
+      zsf_phase_transports_t *transports =
+          &r->transports[(size_t)(i - r->begin_step) * num_chambers + j];
+
+      // A failed chamber stops, and nothing flows for the rest of the run
+      if (chamber->error) {
+        step_idle(&chamber->state, transports);
+        continue;
+      }
+
+      if (apply_param_columns(r->columns, r->num_columns, (size_t)i * r->param_stride,
+                              &chamber->p)) {
+        if (chamber->shared_density)
+          context_update_shared_density(&chamber->ctx, &chamber->p, r->densities[i]);
+        else
+          context_update(&chamber->ctx, &chamber->p);
+      }
+
+      int err = step_routine(&chamber->ctx, r->routines[index], r->durations[index],
+                             &chamber->state, transports);
+      if (err) {
+        chamber->failed_step = i;
+        chamber->error = err;
+        step_idle(&chamber->state, transports);
+      }
+    }
+  }
+}
+
+// Adds the transports of a chamber to the total of a time step, with the
+// salinities weighted by the volumes they come with
+static void complex_add_transports(zsf_phase_transports_t *total, const zsf_phase_transports_t *t) {
+  total->mass_transport_lake += t->mass_transport_lake;
+  total->volume_from_lake += t->volume_from_lake;
+  total->volume_to_lake += t->volume_to_lake;
+  total->discharge_from_lake += t->discharge_from_lake;
+  total->discharge_to_lake += t->discharge_to_lake;
+  total->salinity_to_lake += t->salinity_to_lake * t->volume_to_lake;
+
+  total->mass_transport_sea += t->mass_transport_sea;
+  total->volume_from_sea += t->volume_from_sea;
+  total->volume_to_sea += t->volume_to_sea;
+  total->discharge_from_sea += t->discharge_from_sea;
+  total->discharge_to_sea += t->discharge_to_sea;
+  total->salinity_to_sea += t->salinity_to_sea * t->volume_to_sea;
+}
+
+static void complex_total(const zsf_phase_transports_t *transports, int num_chambers,
+                          zsf_phase_transports_t *total) {
+  memset(total, 0, sizeof(zsf_phase_transports_t));
+  double sal_lake = 0.0, sal_sea = 0.0;
+  for (int j = 0; j < num_chambers; j++) {
+    complex_add_transports(total, &transports[j]);
+    sal_lake += transports[j].salinity_to_lake;
+    sal_sea += transports[j].salinity_to_sea;
+  }
+
+  // Without any flow, the average over the chambers
+  if (total->volume_to_lake > 0.0)
+    total->salinity_to_lake /= total->volume_to_lake;
+  else
+    total->salinity_to_lake = sal_lake / num_chambers;
+  if (total->volume_to_sea > 0.0)
+    total->salinity_to_sea /= total->volume_to_sea;
+  else
+    total->salinity_to_sea = sal_sea / num_chambers;
+}
+
+int ZSF_CALLCONV zsf_complex_run(zsf_complex_t *complex, const zsf_param_columns_t *params,
+                                 int param_stride, const int *routines, const double *durations,
+                                 int num_steps, zsf_phase_transports_t *totals,
+                                 zsf_phase_transports_t *transports, int *failed_steps,
+                                 const zsf_options_t *options) {
+  if (params == NULL)
+    params = &no_param_columns;
+  if (param_stride < 0)
+    return ZSF_ERR_INVALID_STRIDE;
+
+  zsf_options_t default_options;
+  if (options == NULL) {
+    zsf_options_default(&default_options);
+    options = &default_options;
+  }
+
+  int num_chambers = complex->num_chambers;
+  if (num_steps <= 0) {
+    if (failed_steps != NULL) {
+      for (int j = 0; j < num_chambers; j++) {
+        failed_steps[j] = -1;
+      }
+    }
+    return ZSF_SUCCESS;
+  }
+
+  param_column_t columns[NUM_PARAM_FIELDS];
+  int num_columns = given_param_columns(params, columns);
+
+  // The time steps are run in blocks, of which the transports of all chambers
+  // stay in cache until they are summed. Without transports from the caller,
+  // only one block of them is kept.
+  int block_steps = COMPLEX_BLOCK_TRANSPORTS / num_chambers;
+  if (block_steps < 1)
+    block_steps = 1;
+  if (block_steps > num_steps)
+    block_steps = num_steps;
+
+  zsf_phase_transports_t *scratch = NULL;
+  if (transports == NULL)
+    scratch = (zsf_phase_transports_t *)malloc((size_t)block_steps * num_chambers *
+                                               sizeof(zsf_phase_transports_t));
+  complex_chamber_t *chambers =
+      (complex_chamber_t *)malloc(num_chambers * sizeof(complex_chamber_t));
+  double *densities = NULL;
+
+  // The densities change only with the columns of the boundaries
+  int density_columns = 0;
+  for (int k = 0; k < num_columns; k++) {
+    density_columns |= is_density_input(columns[k].offset);
+  }
+  if (density_columns)
+    densities = (double *)malloc(num_steps * sizeof(double));
+
+  if ((transports == NULL && scratch == NULL) || chambers == NULL ||
+      (density_columns && densities == NULL)) {
+    free(scratch);
+    free(chambers);
+    free(densities);
+    return ZSF_ERR_OUT_OF_MEMORY;
+  }
+
+  if (density_columns) {
+    zsf_param_t p = complex->params[0];
+    apply_param_columns(columns, num_columns, 0, &p);
+    derived_parameters_t o;
+    calculate_derived_density(&p, &o);
+    densities[0] = o.density_average;
+    for (int i = 1; i < num_steps; i++) {
+      if (apply_param_columns(columns, num_columns, (size_t)i * param_stride, &p))
+        calculate_derived_density(&p, &o);
+      densities[i] = o.density_average;
+    }
+  }
+
+  for (int j = 0; j < num_chambers; j++) {
+    complex_chamber_t *chamber = &chambers[j];
+    chamber->p = complex->params[j];
+    context_init(&chamber->ctx, &chamber->p);
+    chamber->ctx.o.accuracy = options->accuracy;
+    complex_get_state(complex, j, &chamber->state);
+
+    // The densities of the first chamber hold for all that have the same
+    // tolerances
+    chamber->shared_density =
+        density_columns && same_density_inputs(&chamber->p, &complex->params[0]);
+    chamber->failed_step = -1;
+    chamber->error = ZSF_SUCCESS;
+  }
+
+  complex_run_t r = {.chambers = chambers,
+                     .num_chambers = num_chambers,
+                     .columns = columns,
+                     .num_columns = num_columns,
+                     .param_stride = param_stride,
+                     .densities = densities,
+                     .routines = routines,
+                     .durations = durations};
+
+  // Every thread steps whole chambers through a block
+  int num_threads = parallel_num_threads(options->num_threads, num_chambers);
+
+  for (int begin = 0; begin < num_steps; begin += block_steps) {
+    r.begin_step = begin;
+    r.end_step = (begin + block_steps < num_steps) ? begin + block_steps : num_steps;
+    r.transports = (transports != NULL) ? &transports[(size_t)begin * num_chambers] : scratch;
+
+    parallel_for(num_chambers, 1, num_threads, complex_run_range, &r);
+
+    if (totals != NULL) {
+      for (int i = r.begin_step; i < r.end_step; i++) {
+        complex_total(&r.transports[(size_t)(i - begin) * num_chambers], num_chambers,
+                      &totals[i]);
+      }
+    }
+  }
+
+  int err = ZSF_SUCCESS;
+  for (int j = 0; j < num_chambers; j++) {
+    complex_set_state(complex, j, &chambers[j].state);
+    if (failed_steps != NULL)
+      failed_steps[j] = chambers[j].failed_step;
+    if (!err)
+      err = chambers[j].error;
+  }
+
+  free(scratch);
+  free(chambers);
+  free(densities);
+
+  return err;
+}
+
+// Lock operation
+// ~~~~~~~~~~~~~~
+// A discrete-event simulation of a lock with ship traffic. Ships arrive at
+// random on both sides and wait in line, and the lock takes them across as
+// they come, within its fill limits and tide window. Every routine of the lock
+// is stepped with the phase kernels as soon as it is decided on, so no
+// schedule of lockages is ever stored.
+//
+// The boundaries of a lockage are those at the time it departs, and hold for
+// the leveling and the time the doors are open at the other side, such that
+// the head of the lock matches that of the side it opens to. When the
+// salinity of the lake or the sea changes, the lock salinity is kept within
+// theirs.
+
+#define SIDE_LAKE 0
+#define SIDE_SEA 1
+
+enum operation_event_types { EVENT_ARRIVAL, EVENT_READY, EVENT_DEPART };
+
+// The chamber is exchanging ships (doors open, ships sailing out), loading
+// ships (doors open, ships sailing in), idle with its doors open, or idle
+// with its doors closed
+enum chamber_states { CHAMBER_EXCHANGING, CHAMBER_LOADING, CHAMBER_IDLE, CHAMBER_CLOSED };
+
+typedef struct ship_t {
+  double arrival;
+  double volume;
+} ship_t;
+
+// The ships waiting on one side, as a ring buffer
+typedef struct ship_queue_t {
+  ship_t *ships;
+  int first;
+  int size;
+  int capacity;
+} ship_queue_t;
+
+static int ship_queue_push(ship_queue_t *q, ship_t ship) {
+  if (q->size == q->capacity) {
+    int capacity = (q->capacity > 0) ? 2 * q->capacity : 64;
+    ship_t *ships = (ship_t *)malloc(capacity * sizeof(ship_t));
+    if (ships == NULL)
+      return 0;
+    for (int i = 0; i < q->size; i++) {
+      ships[i] = q->ships[(q->first + i) % q->capacity];
+    }
+    free(q->ships);
+    q->ships = ships;
+    q->first = 0;
+    q->capacity = capacity;
+  }
+
+  q->ships[(q->first + q->size) % q->capacity] = ship;
+  q->size++;
+  return 1;
+}
+
+// The routines of the lock on a side, and of leveling to a side
+static int door_open_routine(int side) {
+  return (side == SIDE_LAKE) ? ZSF_ROUTINE_DOOR_OPEN_LAKE : ZSF_ROUTINE_DOOR_OPEN_SEA;
+}
+
+static int flush_routine(int side) {
+  return (side == SIDE_LAKE) ? ZSF_ROUTINE_FLUSH_DOORS_CLOSED_LAKE
+                             : ZSF_ROUTINE_FLUSH_DOORS_CLOSED_SEA;
+}
+
+static int level_routine(int side) {
+  return (side == SIDE_LAKE) ? ZSF_ROUTINE_LEVEL_TO_LAKE : ZSF_ROUTINE_LEVEL_TO_SEA;
+}
+
+static ship_t ship_queue_pop(ship_queue_t *q) {
+  ship_t ship = q->ships[q->first];
+  q->first = (q->first + 1) % q->capacity;
+  q->size--;
+  return ship;
+}
+
+typedef struct operation_t {
+  const zsf_traffic_t *traffic;
+  unsigned long long seed;
+  zsf_param_t p;
+  zsf_context_t ctx;
+
+  const param_column_t *columns;
+  int num_columns;
+  int boundary_stride;
+  int num_boundaries;
+  double boundary_interval;
+
+  event_queue_t events;
+  ship_queue_t waiting[2];
+  long long num_arrivals[2];
+  double next_volume[2];
+
+  // The chamber, and the boundary row of its current lockage
+  zsf_phase_state_t *state;
+  int side;
+  int chamber;
+  int row;
+  double t_open;
+  double t_closed;
+  int num_loaded;
+  double volume_loaded;
+
+  zsf_operation_event_t *log;
+  int max_log;
+  zsf_operation_stats_t *stats;
+  double total_waiting_time;
+} operation_t;
+
+// The boundary row at a time, or -1 if there are none
+static int operation_row(const operation_t *op, double time) {
+  if (op->num_boundaries <= 0)
+    return -1;
+  double k = floor(time / op->boundary_interval);
+  if (k < 0.0)
+    return 0;
+  if (k >= op->num_boundaries - 1)
+    return op->num_boundaries - 1;
+  return (int)k;
+}
+
+static void operation_set_row(operation_t *op, int row) {
+  if (row >= 0 &&
+      apply_param_columns(op->columns, op->num_columns, (size_t)row * op->boundary_stride, &op->p))
+    context_update(&op->ctx, &op->p);
+}
+
+// Steps the state of the lock through a routine, with the boundaries of a row
+static int operation_step(operation_t *op, int row, double time, int routine, double duration,
+                          int num_ships, double ship_volume) {
+  operation_set_row(op, row);
+
+  // Only the routines with open doors let ships in
+  double volume_lake_to_sea = (routine == ZSF_ROUTINE_DOOR_OPEN_LAKE) ? ship_volume : 0.0;
+  double volume_sea_to_lake = (routine == ZSF_ROUTINE_DOOR_OPEN_SEA) ? ship_volume : 0.0;
+  if (volume_lake_to_sea != op->p.ship_volume_lake_to_sea ||
+      volume_sea_to_lake != op->p.ship_volume_sea_to_lake) {
+    op->p.ship_volume_lake_to_sea = volume_lake_to_sea;
+    op->p.ship_volume_sea_to_lake = volume_sea_to_lake;
+    context_update(&op->ctx, &op->p);
+  }
+
+  // The lock may hold water of a salinity the boundaries have since moved
+  // past, which is where it mixes to within a few lockages anyway
+  zsf_phase_state_t *state = op->state;
+  double sal_min = fmin(op->p.salinity_lake, op->p.salinity_sea);
+  double sal_max = fmax(op->p.salinity_lake, op->p.salinity_sea);
+  if (state->salinity_lock < sal_min || state->salinity_lock > sal_max) {
+    double salinity_lock = fmin(fmax(state->salinity_lock, sal_min), sal_max);
+    if (state->salinity_lock != 0.0)
+      state->saltmass_lock *= salinity_lock / state->salinity_lock;
+    state->salinity_lock = salinity_lock;
+  }
+
+  zsf_phase_transports_t transports;
+  int err = step_routine(&op->ctx, routine, duration, state, &transports);
+  if (err)
+    return err;
+
+  complex_add_transports(&op->stats->total, &transports);
+  if (op->stats->num_events < op->max_log) {
+    zsf_operation_event_t *e = &op->log[op->stats->num_events];
+    e->time = time;
+    e->duration = duration;
+    e->routine = routine;
+    e->num_ships = num_ships;
+    e->ship_volume = ship_volume;
+    e->transports = transports;
+  }
+  op->stats->num_events++;
+
+  return ZSF_SUCCESS;
+}
+
+static int operation_schedule_arrival(operation_t *op, int side, double now) {
+  const zsf_traffic_t *traffic = op->traffic;
+  double rate = (side == SIDE_LAKE) ? traffic->arrival_rate_lake : traffic->arrival_rate_sea;
+  if (rate <= 0.0)
+    return ZSF_SUCCESS;
+
+  // Exponential times between arrivals (per hour), and uniform ship volumes
+  double u0, u1;
+  random_uniform_2(op->seed, (uint64_t)op->num_arrivals[side], (uint32_t)side, 0, &u0, &u1);
+  op->next_volume[side] =
+      traffic->ship_volume_min + u1 * (traffic->ship_volume_max - traffic->ship_volume_min);
+
+  double time = now - log1p(-u0) * 3600.0 / rate;
+  return event_queue_push(&op->events, time, EVENT_ARRIVAL, side) ? ZSF_SUCCESS
+                                                                   : ZSF_ERR_OUT_OF_MEMORY;
+}
+
+// Opens the doors on the side of the chamber, after leveling to the head of
+// that side if it moved while the doors were closed
+static int operation_open(operation_t *op, double now) {
+  int row = operation_row(op, now);
+  operation_set_row(op, row);
+
+  double head = (op->side == SIDE_LAKE) ? op->p.head_lake : op->p.head_sea;
+  double time = now;
+  if (fabs(op->state->head_lock - head) > 1E-8) {
+    int err = operation_step(op, row, time, level_routine(op->side), op->p.leveling_time, 0, 0.0);
+    if (err)
+      return err;
+    time += op->p.leveling_time;
+  }
+
+  op->row = row;
+  op->chamber = CHAMBER_EXCHANGING;
+  op->t_open = time + 0.5 * op->p.door_time_to_open;
+  op->num_loaded = 0;
+  op->volume_loaded = 0.0;
+  return event_queue_push(&op->events, op->t_open, EVENT_READY, 0) ? ZSF_SUCCESS
+                                                                     : ZSF_ERR_OUT_OF_MEMORY;
+}
+
+// What the chamber does next, once the ships in it have sailed out: take the
+// ships waiting on this side, fetch those on the other side, or wait
+static int operation_decide(operation_t *op, double now) {
+  const zsf_traffic_t *traffic = op->traffic;
+  ship_queue_t *here = &op->waiting[op->side];
+  ship_queue_t *there = &op->waiting[!op->side];
+
+  if (here->size > 0) {
+    // The ships enter in the order in which they arrived, as long as they fit
+    // in the lock at the boundaries of this lockage. A ship that does not fit
+    // on its own, e.g. at low tide, is turned away instead of blocking the
+    // ones behind it.
+    operation_set_row(op, op->row);
+    double max_volume = fmin(op->ctx.o.volume_lock_at_lake, op->ctx.o.volume_lock_at_sea);
+    if (traffic->max_ship_volume > 0.0)
+      max_volume = fmin(max_volume, traffic->max_ship_volume);
+
+    int num_ships = 0;
+    double volume = 0.0;
+    while (here->size > 0 && (traffic->max_ships <= 0 || num_ships < traffic->max_ships)) {
+      double ship_volume = here->ships[here->first].volume;
+      if (ship_volume > max_volume) {
+        ship_queue_pop(here);
+        op->stats->num_ships_turned_away++;
+        continue;
+      }
+      if (volume + ship_volume > max_volume)
+        break;
+      ship_t ship = ship_queue_pop(here);
+      double waiting_time = now - ship.arrival;
+      op->total_waiting_time += waiting_time;
+      op->stats->max_waiting_time = fmax(op->stats->max_waiting_time, waiting_time);
+      volume += ship.volume;
+      num_ships++;
+    }
+
+    if (num_ships > 0) {
+      if (op->side == SIDE_LAKE)
+        op->stats->num_ships_lake_to_sea += num_ships;
+      else
+        op->stats->num_ships_sea_to_lake += num_ships;
+
+      op->chamber = CHAMBER_LOADING;
+      op->num_loaded = num_ships;
+      op->volume_loaded = volume;
+      double depart = now + num_ships * traffic->time_per_ship;
+      return event_queue_push(&op->events, depart, EVENT_DEPART, 0) ? ZSF_SUCCESS
+                                                                     : ZSF_ERR_OUT_OF_MEMORY;
+    }
+  }
+
+  if (there->size > 0) {
+    op->chamber = CHAMBER_LOADING;
+    return event_queue_push(&op->events, now, EVENT_DEPART, 0) ? ZSF_SUCCESS
+                                                                : ZSF_ERR_OUT_OF_MEMORY;
+  } else if (traffic->close_doors_when_idle) {
+    int err = operation_step(op, op->row, op->t_open, door_open_routine(op->side),
+                             now - op->t_open, 0, 0.0);
+    op->chamber = CHAMBER_CLOSED;
+    op->t_closed = now + 0.5 * op->p.door_time_to_open;
+    return err;
+  } else {
+    op->chamber = CHAMBER_IDLE;
+    return ZSF_SUCCESS;
+  }
+}
+
+// The chamber closes its doors behind the loaded ships and levels to the other
+// side, if the tide allows it
+static int operation_depart(operation_t *op, double now) {
+  int row = operation_row(op, now);
+  operation_set_row(op, row);
+
+  // Outside of the tide window, or with too little water for the ships that
+  // were let in at other boundaries, try again with the next boundaries (if
+  // they ever change)
+  double max_head_difference = op->traffic->max_head_difference;
+  double volume_lock = fmin(op->ctx.o.volume_lock_at_lake, op->ctx.o.volume_lock_at_sea);
+  if ((max_head_difference > 0.0 &&
+       fabs(op->p.head_sea - op->p.head_lake) > max_head_difference) ||
+      op->volume_loaded > volume_lock) {
+    if (row < 0 || row + 1 >= op->num_boundaries)
+      return ZSF_SUCCESS;
+    double retry = (row + 1) * op->boundary_interval;
+    return event_queue_push(&op->events, retry, EVENT_DEPART, 0) ? ZSF_SUCCESS
+                                                                  : ZSF_ERR_OUT_OF_MEMORY;
+  }
+
+  int err = operation_step(op, op->row, op->t_open, door_open_routine(op->side),
+                           now - op->t_open, op->num_loaded, op->volume_loaded);
+  if (err)
+    return err;
+
+  double t_level = now + 0.5 * op->p.door_time_to_open;
+  err = operation_step(op, row, t_level, level_routine(!op->side), op->p.leveling_time, 0, 0.0);
+  if (err)
+    return err;
+
+  op->stats->num_lockages++;
+  if (op->num_loaded == 0)
+    op->stats->num_empty_lockages++;
+
+  // The loaded ships sail out on the other side
+  op->side = !op->side;
+  op->row = row;
+  op->chamber = CHAMBER_EXCHANGING;
+  op->t_open = t_level + op->p.leveling_time + 0.5 * op->p.door_time_to_open;
+  double ready = op->t_open + op->num_loaded * op->traffic->time_per_ship;
+  op->num_loaded = 0;
+  op->volume_loaded = 0.0;
+  return event_queue_push(&op->events, ready, EVENT_READY, 0) ? ZSF_SUCCESS
+                                                               : ZSF_ERR_OUT_OF_MEMORY;
+}
+
+static int operation_arrival(operation_t *op, int side, double now) {
+  ship_t ship = {now, op->next_volume[side]};
+  if (!ship_queue_push(&op->waiting[side], ship))
+    return ZSF_ERR_OUT_OF_MEMORY;
+  op->num_arrivals[side]++;
+
+  int err = operation_schedule_arrival(op, side, now);
+  if (err)
+    return err;
+
+  if (op->chamber == CHAMBER_IDLE)
+    return operation_decide(op, now);
+
+  if (op->chamber == CHAMBER_CLOSED) {
+    // The time with the doors closed ends when the doors start to open
+    double time = fmax(now, op->t_closed);
+    err = operation_step(op, op->row, op->t_closed, flush_routine(op->side), time - op->t_closed,
+                         0, 0.0);
+    if (err)
+      return err;
+    return operation_open(op, time);
+  }
+
+  return ZSF_SUCCESS;
+}
+
+// Steps the routine that is going on at the end of the simulation up to the end
+static int operation_finish(operation_t *op, double end) {
+  if (op->chamber == CHAMBER_CLOSED) {
+    if (end <= op->t_closed)
+      return ZSF_SUCCESS;
+    return operation_step(op, op->row, op->t_closed, flush_routine(op->side), end - op->t_closed,
+                          0, 0.0);
+  }
+
+  // Still leveling, or the doors are not open yet
+  if (end <= op->t_open)
+    return ZSF_SUCCESS;
+
+  return operation_step(op, op->row, op->t_open, door_open_routine(op->side), end - op->t_open,
+                        op->num_loaded, op->volume_loaded);
+}
+
+static int check_traffic(const zsf_traffic_t *traffic) {
+  if (traffic->arrival_rate_lake < 0.0 || traffic->arrival_rate_sea < 0.0 ||
+      traffic->ship_volume_min < 0.0 || traffic->ship_volume_max < traffic->ship_volume_min ||
+      traffic->max_ship_volume < 0.0 || traffic->max_ships < 0 || traffic->time_per_ship < 0.0 ||
+      traffic->max_head_difference < 0.0)
+    return ZSF_ERR_INVALID_TRAFFIC;
+  // Ships that can never be let in
+  if (traffic->max_ship_volume > 0.0 && traffic->ship_volume_max > traffic->max_ship_volume)
+    return ZSF_ERR_INVALID_TRAFFIC;
+  return ZSF_SUCCESS;
+}
+
+void ZSF_CALLCONV zsf_traffic_default(zsf_traffic_t *traffic) {
+  memset(traffic, 0, sizeof(zsf_traffic_t));
+
+  traffic->arrival_rate_lake = 1.0;
+  traffic->arrival_rate_sea = 1.0;
+  traffic->ship_volume_min = 0.0;
+  traffic->ship_volume_max = 2000.0;
+  traffic->max_ship_volume = 0.0;
+  traffic->max_ships = 0;
+  traffic->close_doors_when_idle = 0;
+  traffic->time_per_ship = 300.0;
+  traffic->max_head_difference = 0.0;
+}
+
+int ZSF_CALLCONV zsf_simulate_operation(const zsf_param_t *p, const zsf_param_columns_t *boundaries,
+                                        int boundary_stride, int num_boundaries,
+                                        double boundary_interval, const zsf_traffic_t *traffic,
+                                        double duration, unsigned long long seed,
+                                        zsf_phase_state_t *state, zsf_operation_event_t *events,
+                                        int max_events, zsf_operation_stats_t *stats,
+                                        const zsf_options_t *options) {
+  memset(stats, 0, sizeof(zsf_operation_stats_t));
+
+  if (boundaries == NULL)
+    boundaries = &no_param_columns;
+  if (boundary_stride < 0)
+    return ZSF_ERR_INVALID_STRIDE;
+
+  zsf_options_t default_options;
+  if (options == NULL) {
+    zsf_options_default(&default_options);
+    options = &default_options;
+  }
+
+  int err = check_traffic(traffic);
+  if (err)
+    return err;
+  if (duration < 0.0 || (num_boundaries > 0 && boundary_interval <= 0.0))
+    return ZSF_ERR_INVALID_TRAFFIC;
+
+  param_column_t columns[NUM_PARAM_FIELDS];
+  int num_columns = given_param_columns(boundaries, columns);
+
+  operation_t op;
+  memset(&op, 0, sizeof(operation_t));
+  op.traffic = traffic;
+  op.seed = seed;
+  op.p = *p;
+  op.columns = columns;
+  op.num_columns = num_columns;
+  op.boundary_stride = boundary_stride;
+  op.num_boundaries = (num_columns > 0) ? num_boundaries : 0;
+  op.boundary_interval = boundary_interval;
+  op.state = state;
+  op.log = events;
+  op.max_log = (events != NULL) ? max_events : 0;
+  op.stats = stats;
+  event_queue_init(&op.events);
+
+  op.p.ship_volume_lake_to_sea = 0.0;
+  op.p.ship_volume_sea_to_lake = 0.0;
+  context_init(&op.ctx, &op.p);
+  op.ctx.o.accuracy = options->accuracy;
+  operation_set_row(&op, operation_row(&op, 0.0));
+
+  // The chamber starts on the side of which the head is closest
+  op.side = (fabs(state->head_lock - op.p.head_lake) < fabs(state->head_lock - op.p.head_sea))
+                ? SIDE_LAKE
+                : SIDE_SEA;
+
+  err = operation_schedule_arrival(&op, SIDE_LAKE, 0.0);
+  if (!err)
+    err = operation_schedule_arrival(&op, SIDE_SEA, 0.0);
+  if (!err)
+    err = operation_open(&op, 0.0);
+
+  while (!err && op.events.size > 0 && event_queue_top(&op.events)->time <= duration) {
+    event_t e = event_queue_pop(&op.events);
+    switch (e.type) {
+    case EVENT_ARRIVAL:
+      err = operation_arrival(&op, e.arg, e.time);
+      break;
+    case EVENT_READY:
+      err = operation_decide(&op, e.time);
+      break;
+    case EVENT_DEPART:
+      err = operation_depart(&op, e.time);
+      break;
+    }
+  }
+  if (!err)
+    err = operation_finish(&op, duration);
+
+  stats->num_ships_waiting = op.waiting[SIDE_LAKE].size + op.waiting[SIDE_SEA].size;
+  long long num_ships = stats->num_ships_lake_to_sea + stats->num_ships_sea_to_lake;
+  if (num_ships > 0)
+    stats->mean_waiting_time = op.total_waiting_time / num_ships;
+
+  // Salinities weighted by volume, and discharges averaged over the duration
+  zsf_phase_transports_t *total = &stats->total;
+  total->salinity_to_lake = (total->volume_to_lake > 0.0)
+                                ? total->salinity_to_lake / total->volume_to_lake
+                                : 0.0;
+  total->salinity_to_sea =
+      (total->volume_to_sea > 0.0) ? total->salinity_to_sea / total->volume_to_sea : 0.0;
+  if (duration > 0.0) {
+    total->discharge_from_lake = total->volume_from_lake / duration;
+    total->discharge_to_lake = total->volume_to_lake / duration;
+    total->discharge_from_sea = total->volume_from_sea / duration;
+    total->discharge_to_sea = total->volume_to_sea / duration;
+  }
+
+  event_queue_free(&op.events);
+  free(op.waiting[SIDE_LAKE].ships);
+  free(op.waiting[SIDE_SEA].ships);
+
+  return err;
+}
+
+// Steady state time series
+// ~~~~~~~~~~~~~~~~~~~~~~~~
+// The boundary conditions of consecutive steps differ little, and so do their
+// steady states. Starting every step from the converged lock salinity of the
+// previous one instead of the mean of the lake and sea salinities saves most
+// of the cycles needed to converge.
+int ZSF_CALLCONV zsf_calc_steady_series(const zsf_param_t *base, const zsf_param_columns_t *params,
+                                        int param_stride, zsf_results_columns_t *results,
+                                        int results_stride, int *errors, int *num_cycles, int n,
+                                        const zsf_options_t *options) {
+  zsf_param_t default_param;
+  if (base == NULL) {
+    zsf_param_default(&default_param);
+    base = &default_param;
+  }
+  if (params == NULL)
+    params = &no_param_columns;
+  if (results == NULL)
+    results = &no_results_columns;
+  if (param_stride < 0 || results_stride < 0)
+    return ZSF_ERR_INVALID_STRIDE;
+
+  zsf_options_t default_options;
+  if (options == NULL) {
+    zsf_options_default(&default_options);
+    options = &default_options;
+  }
+
+  param_column_t columns[NUM_PARAM_FIELDS];
+  int num_columns = given_param_columns(params, columns);
+
+  zsf_param_t p = *base;
+  zsf_context_t ctx;
+  int num_failed = 0;
+
+  // A given lock salinity overrides the warm start
+  int warm_start = (params->salinity_lock == NULL);
+  double sal_lock_4 = ZSF_NAN;
+
+  for (int i = 0; i < n; i++) {
+    int changed = apply_param_columns(columns, num_columns, (size_t)i * param_stride, &p);
+
+    if (i == 0) {
+      context_init(&ctx, &p);
+      ctx.o.accuracy = options->accuracy;
+    } else if (changed) {
+      context_update(&ctx, &p);
+    }
+
+    double sal_lock_start = steady_warm_salinity(&ctx.p, &ctx.o, warm_start ? sal_lock_4 : ZSF_NAN);
+
+    zsf_phase_state_t state;
+    steady_cycle_t cycle;
+    zsf_steady_stats_t stats = {0};
+
+    int err = steady_initial_state_from(&ctx.p, &ctx.o, sal_lock_start, &state);
+    if (!err) {
+      // Steps that do not converge still get (and pass on) their best estimate
+      err = steady_iterate(&ctx.p, &ctx.o, options, &state, &cycle, &stats, NULL, 0);
+
+      zsf_results_t r;
+      steady_results(&ctx.p, &ctx.o, &cycle, &r, NULL);
+      scatter_results(&r, (size_t)i * results_stride, results);
+
+      sal_lock_4 = cycle.sal_lock_4;
+    }
+
+    if (errors != NULL)
+      errors[i] = err;
+    if (num_cycles != NULL)
+      num_cycles[i] = stats.num_cycles;
+    if (err)
+      num_failed++;
+  }
+
+  return num_failed ? ZSF_ERR_BATCH_FAILED_ROWS : ZSF_SUCCESS;
+}
+
+// Surrogate tables
+// ~~~~~~~~~~~~~~~~
+// The steady state results on a regular grid over a few parameters. An
+// interpolation touches 2 (linear) or 4 (cubic) grid points per axis, which is
+// orders of magnitude cheaper than the cycles of the solver.
+static const size_t param_offsets[] = {
+#define PARAM_OFFSET(F) offsetof(zsf_param_t, F),
+    PARAM_FIELDS(PARAM_OFFSET)
+#undef PARAM_OFFSET
+};
+
+static const size_t param_column_offsets[] = {
+#define PARAM_COLUMN_OFFSET(F) offsetof(zsf_param_columns_t, F),
+    PARAM_FIELDS(PARAM_COLUMN_OFFSET)
+#undef PARAM_COLUMN_OFFSET
+};
+
+int ZSF_CALLCONV zsf_param_index(const char *name) {
+  int index = 0;
+#define PARAM_INDEX(F)                                                                             \
+  if (strcmp(name, #F) == 0)                                                                       \
+    return index;                                                                                  \
+  index++;
+  PARAM_FIELDS(PARAM_INDEX)
+#undef PARAM_INDEX
+  return -1;
+}
+
+// The results of a grid point are stored as an array, in the order of
+// RESULTS_FIELDS
+#define RESULT_INDEX(F) RESULT_##F,
+enum { RESULTS_FIELDS(RESULT_INDEX) NUM_RESULTS_FIELDS };
+#undef RESULT_INDEX
+
+static const size_t result_offsets[] = {
+#define RESULT_OFFSET(F) offsetof(zsf_results_t, F),
+    RESULTS_FIELDS(RESULT_OFFSET)
+#undef RESULT_OFFSET
+};
+
+int ZSF_CALLCONV zsf_result_index(const char *name) {
+  int index = 0;
+#define RESULT_NAME_INDEX(F)                                                                       \
+  if (strcmp(name, #F) == 0)                                                                       \
+    return index;                                                                                  \
+  index++;
+  RESULTS_FIELDS(RESULT_NAME_INDEX)
+#undef RESULT_NAME_INDEX
+  return -1;
+}
+
+struct zsf_surrogate_t {
+  zsf_param_t base;
+  int num_axes;
+  int num_checks;
+  zsf_surrogate_axis_t axes[ZSF_SURROGATE_MAX_AXES];
+  size_t strides[ZSF_SURROGATE_MAX_AXES]; // In grid points, the last axis is contiguous
+  size_t num_points;
+  size_t num_failed;
+  zsf_results_t max_error_linear;
+  zsf_results_t max_error_cubic;
+  double *values;
+  unsigned char *failed;
+};
+
+static int check_axes(const zsf_surrogate_axis_t *axes, int num_axes, size_t *num_points) {
+  if (num_axes < 1 || num_axes > ZSF_SURROGATE_MAX_AXES)
+    return ZSF_ERR_INVALID_AXIS;
+
+  // The grid is calculated by a single batch, of which the number of rows is
+  // an int
+  size_t n = 1;
+  for (int a = 0; a < num_axes; a++) {
+    const zsf_surrogate_axis_t *axis = &axes[a];
+    if (axis->param < 0 || axis->param >= NUM_PARAM_FIELDS || axis->num_points < 2 ||
+        !(axis->min < axis->max) || !isfinite(axis->max - axis->min))
+      return ZSF_ERR_INVALID_AXIS;
+    for (int b = 0; b < a; b++) {
+      if (axes[b].param == axis->param)
+        return ZSF_ERR_INVALID_AXIS;
+    }
+    n *= axis->num_points;
+    if (n > INT_MAX)
+      return ZSF_ERR_INVALID_AXIS;
+  }
+
+  *num_points = n;
+  return ZSF_SUCCESS;
+}
+
+static zsf_surrogate_t *surrogate_alloc(const zsf_param_t *base, const zsf_surrogate_axis_t *axes,
+                                        int num_axes, size_t num_points) {
+  zsf_surrogate_t *s = (zsf_surrogate_t *)calloc(1, sizeof(zsf_surrogate_t));
+  if (s == NULL)
+    return NULL;
+
+  s->values = (double *)malloc(num_points * NUM_RESULTS_FIELDS * sizeof(double));
+  s->failed = (unsigned char *)calloc(num_points, 1);
+  if (s->values == NULL || s->failed == NULL) {
+    zsf_surrogate_free(s);
+    return NULL;
+  }
+
+  s->base = *base;
+  s->num_axes = num_axes;
+  s->num_points = num_points;
+
+  size_t stride = 1;
+  for (int a = num_axes - 1; a >= 0; a--) {
+    s->axes[a] = axes[a];
+    s->strides[a] = stride;
+    stride *= axes[a].num_points;
+  }
+
+  return s;
+}
+
+void ZSF_CALLCONV zsf_surrogate_free(zsf_surrogate_t *surrogate) {
+  if (surrogate == NULL)
+    return;
+  free(surrogate->values);
+  free(surrogate->failed);
+  free(surrogate);
+}
+
+static double axis_value(const zsf_surrogate_axis_t *axis, double i) {
+  return axis->min + i * (axis->max - axis->min) / (axis->num_points - 1);
+}
+
+// Solves the steady state for n points, of which the value on axis a is
+// coords[a][i]. Writes the results to values (NUM_RESULTS_FIELDS per point),
+// and the error codes to errors.
+static int surrogate_solve(const zsf_surrogate_t *s, double *const *coords, int n,
+                           const zsf_options_t *options, double *values, int *errors) {
+  zsf_param_columns_t params = {0};
+  for (int a = 0; a < s->num_axes; a++) {
+    *(const double **)((char *)&params + param_column_offsets[s->axes[a].param]) = coords[a];
+  }
+
+  zsf_results_columns_t results;
+#define RESULTS_COLUMN(F) results.F = &values[RESULT_##F];
+  RESULTS_FIELDS(RESULTS_COLUMN)
+#undef RESULTS_COLUMN
+
+  return zsf_calc_steady_batch(&s->base, &params, 1, &results, NUM_RESULTS_FIELDS, errors, n,
+                               options);
+}
+
+// The grid points along an axis that contribute to an interpolation, and
+// their weights
+typedef struct axis_stencil_t {
+  size_t first;
+  int count;
+  double weights[4];
+} axis_stencil_t;
+
+static int axis_stencil(const zsf_surrogate_axis_t *axis, int method, double x,
+                        axis_stencil_t *stencil) {
+  int n = axis->num_points;
+  double t = (x - axis->min) / (axis->max - axis->min) * (n - 1);
+
+  // Also rejects NaN
+  if (!(t >= 0.0 && t <= n - 1))
+    return ZSF_ERR_OUTSIDE_GRID;
+
+  int i = (t < n - 1) ? (int)t : n - 2;
+  double f = t - i;
+
+  if (method == ZSF_INTERPOLATION_LINEAR) {
+    stencil->first = i;
+    stencil->count = 2;
+    stencil->weights[0] = 1.0 - f;
+    stencil->weights[1] = f;
+    return ZSF_SUCCESS;
+  }
+  if (method != ZSF_INTERPOLATION_CUBIC)
+    return ZSF_ERR_UNKNOWN_INTERPOLATION;
+
+  // Catmull-Rom spline through the points i - 1 to i + 2. Points beyond the
+  // ends of the axis are extrapolated linearly from the last two points,
+  // which folds their weights onto those.
+  const double f2 = f * f;
+  const double f3 = f2 * f;
+  const double w[4] = {-0.5 * f3 + f2 - 0.5 * f, 1.5 * f3 - 2.5 * f2 + 1.0,
+                       -1.5 * f3 + 2.0 * f2 + 0.5 * f, 0.5 * f3 - 0.5 * f2};
+
+  int count = (n < 4) ? n : 4;
+  int first = i - 1;
+  if (first > n - count)
+    first = n - count;
+  if (first < 0)
+    first = 0;
+
+  stencil->first = first;
+  stencil->count = count;
+  memset(stencil->weights, 0, sizeof(stencil->weights));
+
+  for (int k = 0; k < 4; k++) {
+    int j = i - 1 + k;
+    if (j < 0) {
+      stencil->weights[0 - first] += 2.0 * w[k];
+      stencil->weights[1 - first] -= w[k];
+    } else if (j > n - 1) {
+      stencil->weights[n - 1 - first] += 2.0 * w[k];
+      stencil->weights[n - 2 - first] -= w[k];
+    } else {
+      stencil->weights[j - first] += w[k];
+    }
+  }
+
+  return ZSF_SUCCESS;
+}
+
+cpu_dispatch int ZSF_CALLCONV zsf_surrogate_interpolate(const zsf_surrogate_t *surrogate,
+                                                        int method, const double *x,
+                                                        zsf_results_t *results) {
+  const zsf_surrogate_t *s = surrogate;
+
+  axis_stencil_t stencils[ZSF_SURROGATE_MAX_AXES];
+  for (int a = 0; a < s->num_axes; a++) {
+    int err = axis_stencil(&s->axes[a], method, x[a], &stencils[a]);
+    if (err)
+      return err;
+  }
+
+  // Sum over all combinations of the grid points of the stencils. The points
+  // of the last axis are contiguous, and k counts the points of the other
+  // axes like an odometer.
+  const int last = s->num_axes - 1;
+  const axis_stencil_t *inner = &stencils[last];
+
+  int k[ZSF_SURROGATE_MAX_AXES] = {0};
+  double sum[NUM_RESULTS_FIELDS] = {0};
+  int any_failed = 0;
+
+  while (1) {
+    double weight = 1.0;
+    size_t index = inner->first;
+    for (int a = 0; a < last; a++) {
+      weight *= stencils[a].weights[k[a]];
+      index += (stencils[a].first + k[a]) * s->strides[a];
+    }
+
+    for (int j = 0; j < inner->count; j++) {
+      const double w = weight * inner->weights[j];
+      const double *v = &s->values[(index + j) * NUM_RESULTS_FIELDS];
+      for (int f = 0; f < NUM_RESULTS_FIELDS; f++) {
+        sum[f] += w * v[f];
+      }
+    }
+    if (s->num_failed > 0) {
+      for (int j = 0; j < inner->count; j++) {
+        any_failed |= s->failed[index + j];
+      }
+    }
+
+    int a = last - 1;
+    while (a >= 0 && ++k[a] == stencils[a].count) {
+      k[a] = 0;
+      a--;
+    }
+    if (a < 0)
+      break;
+  }
+
+  if (any_failed)
+    return ZSF_ERR_GRID_POINT_FAILED;
+
+#define GET_RESULT(F) results->F = sum[RESULT_##F];
+  RESULTS_FIELDS(GET_RESULT)
+#undef GET_RESULT
+  return ZSF_SUCCESS;
+}
+
+static unsigned long long surrogate_random(unsigned long long *seed) {
+  *seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+  return *seed >> 33;
+}
+
+// Estimates the interpolation errors at points halfway between the grid
+// points along every axis, where they are typically largest
+static int surrogate_check(zsf_surrogate_t *s, int num_checks, const zsf_options_t *options) {
+  double *coords[ZSF_SURROGATE_MAX_AXES];
+  double *block = (double *)malloc((size_t)num_checks * s->num_axes * sizeof(double));
+  double *exact = (double *)malloc((size_t)num_checks * NUM_RESULTS_FIELDS * sizeof(double));
+  int *errors = (int *)malloc(num_checks * sizeof(int));
+  if (block == NULL || exact == NULL || errors == NULL) {
+    free(block);
+    free(exact);
+    free(errors);
+    return ZSF_ERR_OUT_OF_MEMORY;
+  }
+
+  unsigned long long seed = 42;
+  for (int a = 0; a < s->num_axes; a++) {
+    coords[a] = &block[(size_t)a * num_checks];
+    for (int c = 0; c < num_checks; c++) {
+      int cell = (int)(surrogate_random(&seed) % (s->axes[a].num_points - 1));
+      coords[a][c] = axis_value(&s->axes[a], cell + 0.5);
+    }
+  }
+
+  surrogate_solve(s, coords, num_checks, options, exact, errors);
+
+  zsf_results_t zero = {0};
+  s->max_error_linear = zero;
+  s->max_error_cubic = zero;
+  s->num_checks = 0;
+
+  for (int c = 0; c < num_checks; c++) {
+    double x[ZSF_SURROGATE_MAX_AXES];
+    for (int a = 0; a < s->num_axes; a++) {
+      x[a] = coords[a][c];
+    }
+
+    zsf_results_t linear, cubic;
+    if (errors[c] || zsf_surrogate_interpolate(s, ZSF_INTERPOLATION_LINEAR, x, &linear) ||
+        zsf_surrogate_interpolate(s, ZSF_INTERPOLATION_CUBIC, x, &cubic))
+      continue;
+
+    const double *e = &exact[(size_t)c * NUM_RESULTS_FIELDS];
+#define MAX_ERROR(F)                                                                               \
+  s->max_error_linear.F = fmax(s->max_error_linear.F, fabs(linear.F - e[RESULT_##F]));             \
+  s->max_error_cubic.F = fmax(s->max_error_cubic.F, fabs(cubic.F - e[RESULT_##F]));
+    RESULTS_FIELDS(MAX_ERROR)
+#undef MAX_ERROR
+    s->num_checks++;
+  }
+
+  free(block);
+  free(exact);
+  free(errors);
+  return ZSF_SUCCESS;
+}
+
+int ZSF_CALLCONV zsf_surrogate_create(const zsf_param_t *base, const zsf_surrogate_axis_t *axes,
+                                      int num_axes, int num_checks, const zsf_options_t *options,
+                                      zsf_surrogate_t **surrogate) {
+  *surrogate = NULL;
+
+  zsf_param_t default_param;
+  if (base == NULL) {
+    zsf_param_default(&default_param);
+    base = &default_param;
+  }
+
+  zsf_options_t default_options;
+  if (options == NULL) {
+    zsf_options_default(&default_options);
+    options = &default_options;
+  }
+
+  size_t num_points;
+  int err = check_axes(axes, num_axes, &num_points);
+  if (err)
+    return err;
+
+  zsf_surrogate_t *s = surrogate_alloc(base, axes, num_axes, num_points);
+  double *block = (double *)malloc(num_points * num_axes * sizeof(double));
+  int *errors = (int *)malloc(num_points * sizeof(int));
+  if (s == NULL || block == NULL || errors == NULL) {
+    zsf_surrogate_free(s);
+    free(block);
+    free(errors);
+    return ZSF_ERR_OUT_OF_MEMORY;
+  }
+
+  // The coordinates of every grid point, as columns of the batch
+  double *coords[ZSF_SURROGATE_MAX_AXES];
+  for (int a = 0; a < num_axes; a++) {
+    coords[a] = &block[a * num_points];
+    for (size_t i = 0; i < num_points; i++) {
+      int j = (int)((i / s->strides[a]) % axes[a].num_points);
+      coords[a][i] = (j == axes[a].num_points - 1) ? axes[a].max : axis_value(&axes[a], j);
+    }
+  }
+
+  // Points that did not converge are failed too, as their best estimate may
+  // be far off
+  err = surrogate_solve(s, coords, (int)num_points, options, s->values, errors);
+  for (size_t i = 0; i < num_points; i++) {
+    s->failed[i] = (errors[i] != ZSF_SUCCESS);
+    s->num_failed += s->failed[i];
+  }
+
+  free(block);
+  free(errors);
+
+  if (num_checks > 0) {
+    int check_err = surrogate_check(s, num_checks, options);
+    if (check_err) {
+      zsf_surrogate_free(s);
+      return check_err;
+    }
+  }
+
+  *surrogate = s;
+  return err;
+}
+
+int ZSF_CALLCONV zsf_surrogate_max_error(const zsf_surrogate_t *surrogate, int method,
+                                         zsf_results_t *max_error) {
+  if (method == ZSF_INTERPOLATION_LINEAR)
+    *max_error = surrogate->max_error_linear;
+  else if (method == ZSF_INTERPOLATION_CUBIC)
+    *max_error = surrogate->max_error_cubic;
+  else
+    return -1;
+  return surrogate->num_checks;
+}
+
+int ZSF_CALLCONV zsf_surrogate_get_axes(const zsf_surrogate_t *surrogate,
+                                        zsf_surrogate_axis_t *axes) {
+  if (axes != NULL)
+    memcpy(axes, surrogate->axes, surrogate->num_axes * sizeof(zsf_surrogate_axis_t));
+  return surrogate->num_axes;
+}
+
+void ZSF_CALLCONV zsf_surrogate_get_param(const zsf_surrogate_t *surrogate, zsf_param_t *p) {
+  *p = surrogate->base;
+}
+
+// The file starts with a header, followed by the fixed parameters, the axes,
+// the estimated errors, and the results and failed flags of every grid point,
+// all in the native byte order. The byte order mark detects files from
+// machines with a different one.
+#define SURROGATE_MAGIC "ZSFSURR"
+#define SURROGATE_VERSION 1
+#define SURROGATE_BYTE_ORDER 0x01020304
+
+typedef struct surrogate_header_t {
+  char magic[8];
+  int version;
+  int byte_order;
+  int num_axes;
+  int num_checks;
+} surrogate_header_t;
+
+int ZSF_CALLCONV zsf_surrogate_save(const zsf_surrogate_t *surrogate, const char *path) {
+  const zsf_surrogate_t *s = surrogate;
+
+  FILE *f = fopen(path, "wb");
+  if (f == NULL)
+    return ZSF_ERR_FILE_IO;
+
+  surrogate_header_t header = {SURROGATE_MAGIC, SURROGATE_VERSION, SURROGATE_BYTE_ORDER,
+                               s->num_axes, s->num_checks};
+
+  int ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+           fwrite(&s->base, sizeof(zsf_param_t), 1, f) == 1 &&
+           fwrite(s->axes, sizeof(zsf_surrogate_axis_t), s->num_axes, f) == (size_t)s->num_axes &&
+           fwrite(&s->max_error_linear, sizeof(zsf_results_t), 1, f) == 1 &&
+           fwrite(&s->max_error_cubic, sizeof(zsf_results_t), 1, f) == 1 &&
+           fwrite(s->values, NUM_RESULTS_FIELDS * sizeof(double), s->num_points, f) ==
+               s->num_points &&
+           fwrite(s->failed, 1, s->num_points, f) == s->num_points;
+
+  if (fclose(f) != 0)
+    ok = 0;
+
+  return ok ? ZSF_SUCCESS : ZSF_ERR_FILE_IO;
+}
+
+int ZSF_CALLCONV zsf_surrogate_load(const char *path, zsf_surrogate_t **surrogate) {
+  *surrogate = NULL;
+
+  FILE *f = fopen(path, "rb");
+  if (f == NULL)
+    return ZSF_ERR_FILE_IO;
+
+  surrogate_header_t header;
+  zsf_param_t base;
+  zsf_surrogate_axis_t axes[ZSF_SURROGATE_MAX_AXES];
+  size_t num_points;
+
+  if (fread(&header, sizeof(header), 1, f) != 1 ||
+      memcmp(header.magic, SURROGATE_MAGIC, sizeof(SURROGATE_MAGIC)) != 0 ||
+      header.version != SURROGATE_VERSION || header.byte_order != SURROGATE_BYTE_ORDER ||
+      header.num_axes < 1 || header.num_axes > ZSF_SURROGATE_MAX_AXES ||
+      fread(&base, sizeof(zsf_param_t), 1, f) != 1 ||
+      fread(axes, sizeof(zsf_surrogate_axis_t), header.num_axes, f) != (size_t)header.num_axes ||
+      check_axes(axes, header.num_axes, &num_points) != ZSF_SUCCESS) {
+    fclose(f);
+    return ZSF_ERR_FILE_FORMAT;
+  }
+
+  zsf_surrogate_t *s = surrogate_alloc(&base, axes, header.num_axes, num_points);
+  if (s == NULL) {
+    fclose(f);
+    return ZSF_ERR_OUT_OF_MEMORY;
+  }
+  s->num_checks = header.num_checks;
+
+  int ok = fread(&s->max_error_linear, sizeof(zsf_results_t), 1, f) == 1 &&
+           fread(&s->max_error_cubic, sizeof(zsf_results_t), 1, f) == 1 &&
+           fread(s->values, NUM_RESULTS_FIELDS * sizeof(double), num_points, f) == num_points &&
+           fread(s->failed, 1, num_points, f) == num_points;
+  fclose(f);
+
+  if (!ok) {
+    zsf_surrogate_free(s);
+    return ZSF_ERR_FILE_FORMAT;
+  }
+
+  for (size_t i = 0; i < num_points; i++) {
+    s->num_failed += (s->failed[i] != 0);
+  }
+
+  *surrogate = s;
+  return ZSF_SUCCESS;
+}
+
+// Parameter sweeps
+// ~~~~~~~~~~~~~~~~
+// The steady state on every point of a grid like that of a surrogate, written
+// to the arrays of the caller. The grid is walked in serpentine order, in
+// which consecutive points differ by a single step along a single axis, so
+// every point starts from the converged lock salinity of its neighbour. The
+// axes that change the densities are walked outermost, such that the densities
+// are only calculated again when the walk steps along one of those.
+typedef struct sweep_t {
+  const zsf_param_t *base;
+  const zsf_surrogate_axis_t *axes;
+  int num_axes;
+  int order[ZSF_SURROGATE_MAX_AXES];      // From the outermost to the innermost axis of the walk
+  size_t strides[ZSF_SURROGATE_MAX_AXES]; // In grid points, the last axis is contiguous
+  int warm_start;
+  zsf_results_columns_t *results;
+  int results_stride;
+  int *errors;
+  int *num_cycles;
+  const zsf_options_t *options;
+  int *num_failed; // One counter per thread
+} sweep_t;
+
+// Sets the parameters of the point at position k of the walk, and returns its
+// index in the grid
+static size_t sweep_point(const sweep_t *s, int k, zsf_param_t *p) {
+  int digits[ZSF_SURROGATE_MAX_AXES];
+  size_t rest = (size_t)k;
+  for (int j = s->num_axes - 1; j >= 0; j--) {
+    int num_points = s->axes[s->order[j]].num_points;
+    digits[j] = (int)(rest % num_points);
+    rest /= num_points;
+  }
+
+  // An axis is walked backwards when the walk over the axes outside of it is
+  // at an odd position
+  size_t outer = 0, index = 0;
+  for (int j = 0; j < s->num_axes; j++) {
+    const zsf_surrogate_axis_t *axis = &s->axes[s->order[j]];
+    int i = (outer % 2) ? axis->num_points - 1 - digits[j] : digits[j];
+    outer = outer * axis->num_points + digits[j];
+    index += i * s->strides[s->order[j]];
+    *(double *)((char *)p + param_offsets[axis->param]) =
+        (i == axis->num_points - 1) ? axis->max : axis_value(axis, i);
+  }
+  return index;
+}
+
+static cpu_dispatch void sweep_range(void *data, int begin, int end, int thread) {
+  const sweep_t *s = (const sweep_t *)data;
+
+  zsf_param_t p = *s->base;
+  zsf_context_t ctx;
+  double sal_lock_4 = ZSF_NAN;
+
+  for (int k = begin; k < end; k++) {
+    size_t i = sweep_point(s, k, &p);
+
+    if (k == begin) {
+      context_init(&ctx, &p);
+      ctx.o.accuracy = s->options->accuracy;
+    } else {
+      context_update(&ctx, &p);
+    }
+
+    double sal_lock_start =
+        steady_warm_salinity(&ctx.p, &ctx.o, s->warm_start ? sal_lock_4 : ZSF_NAN);
+
+    zsf_phase_state_t state;
+    steady_cycle_t cycle;
+    zsf_steady_stats_t stats = {0};
+
+    int err = steady_initial_state_from(&ctx.p, &ctx.o, sal_lock_start, &state);
+    if (!err) {
+      // Points that do not converge still get (and pass on) their best estimate
+      err = steady_iterate(&ctx.p, &ctx.o, s->options, &state, &cycle, &stats, NULL, 0);
+
+      zsf_results_t r;
+      steady_results(&ctx.p, &ctx.o, &cycle, &r, NULL);
+      scatter_results(&r, i * s->results_stride, s->results);
+
+      sal_lock_4 = cycle.sal_lock_4;
+    }
+
+    if (s->errors != NULL)
+      s->errors[i] = err;
+    if (s->num_cycles != NULL)
+      s->num_cycles[i] = stats.num_cycles;
+    if (err)
+      s->num_failed[thread]++;
+  }
+}
+
+int ZSF_CALLCONV zsf_sweep(const zsf_param_t *base, const zsf_surrogate_axis_t *axes, int num_axes,
+                           zsf_results_columns_t *results, int results_stride, int *errors,
+                           int *num_cycles, const zsf_options_t *options) {
+  zsf_param_t default_param;
+  if (base == NULL) {
+    zsf_param_default(&default_param);
+    base = &default_param;
+  }
+  if (results == NULL)
+    results = &no_results_columns;
+  if (results_stride < 0)
+    return ZSF_ERR_INVALID_STRIDE;
+
+  zsf_options_t default_options;
+  if (options == NULL) {
+    zsf_options_default(&default_options);
+    options = &default_options;
+  }
+
+  size_t num_points;
+  int err = check_axes(axes, num_axes, &num_points);
+  if (err)
+    return err;
+
+  sweep_t s = {.base = base,
+               .axes = axes,
+               .num_axes = num_axes,
+               .warm_start = 1,
+               .results = results,
+               .results_stride = results_stride,
+               .errors = errors,
+               .num_cycles = num_cycles,
+               .options = options};
+
+  size_t stride = 1;
+  for (int a = num_axes - 1; a >= 0; a--) {
+    s.strides[a] = stride;
+    stride *= axes[a].num_points;
+  }
+
+  // The axes that change the densities first, otherwise in the given order. A
+  // lock salinity on an axis overrides the warm start.
+  int j = 0;
+  for (int density = 1; density >= 0; density--) {
+    for (int a = 0; a < num_axes; a++) {
+      if (is_density_input(param_offsets[axes[a].param]) == density)
+        s.order[j++] = a;
+    }
+  }
+  for (int a = 0; a < num_axes; a++) {
+    if (param_offsets[axes[a].param] == offsetof(zsf_param_t, salinity_lock))
+      s.warm_start = 0;
+  }
+
+  // Every chunk starts cold, so the chunks are larger than those of a batch
+  int n = (int)num_points;
+  int num_threads = parallel_num_threads(options->num_threads, n);
+  int chunk_size = (options->chunk_size > 0) ? options->chunk_size : 256;
+
+  int single_failed = 0;
+  int *num_failed = (num_threads > 1) ? (int *)calloc(num_threads, sizeof(int)) : NULL;
+  if (num_failed == NULL) {
+    num_threads = 1;
+    num_failed = &single_failed;
+  }
+
+  s.num_failed = num_failed;
+  parallel_for(n, chunk_size, num_threads, sweep_range, &s);
+
+  int total_failed = 0;
+  for (int t = 0; t < num_threads; t++) {
+    total_failed += num_failed[t];
+  }
+  if (num_failed != &single_failed)
+    free(num_failed);
+
+  return total_failed ? ZSF_ERR_BATCH_FAILED_ROWS : ZSF_SUCCESS;
+}
+
+// Sensitivities
+// ~~~~~~~~~~~~~
+// The steady state is the fixed point s = G(s, q) of the map G from the lock
+// salinity at the start of a cycle to that at its end, for parameters q. The
+// results R(s, q) are those of the cycle that starts at the fixed point. By
+// implicit differentiation
+//
+//     ds/dq = G_q / (1 - G_s)
+//     dR/dq = R_s ds/dq + R_q
+//
+// where the partial derivatives of a single cycle are taken by central
+// differences. That costs two cycles per parameter, instead of the two full
+// solves per parameter of differentiating the steady state numerically.
+#define SENSITIVITY_STEP 1E-5
+
+// The lock salinity at the end of a cycle and its results, as one vector
+enum { CYCLE_SAL_LOCK_4, CYCLE_RESULTS, NUM_CYCLE_VALUES = CYCLE_RESULTS + NUM_RESULTS_FIELDS };
+
+static int cycle_map(const zsf_context_t *ctx, double sal_lock_start, double *v) {
+  zsf_phase_state_t state;
+  steady_cycle_t cycle;
+  zsf_results_t r;
+
+  int err = steady_initial_state_from(&ctx->p, &ctx->o, sal_lock_start, &state);
+  if (err)
+    return err;
+
+  steady_cycle(&ctx->p, &ctx->o, &state, &cycle);
+  steady_results(&ctx->p, &ctx->o, &cycle, &r, NULL);
+
+  v[CYCLE_SAL_LOCK_4] = cycle.sal_lock_4;
+#define CYCLE_RESULT(F) v[CYCLE_RESULTS + RESULT_##F] = r.F;
+  RESULTS_FIELDS(CYCLE_RESULT)
+#undef CYCLE_RESULT
+  return ZSF_SUCCESS;
+}
+
+// The cycle map with parameter param (or the start salinity if param < 0)
+// changed to x
+static int perturbed_cycle_map(const zsf_context_t *ctx, double sal_lock_start, int param,
+                               double x, double *v) {
+  if (param < 0)
+    return cycle_map(ctx, x, v);
+
+  zsf_context_t perturbed = *ctx;
+  zsf_param_t p = ctx->p;
+  *(double *)((char *)&p + param_offsets[param]) = x;
+  context_update(&perturbed, &p);
+
+  return cycle_map(&perturbed, sal_lock_start, v);
+}
+
+// Where one side of the central difference is invalid, e.g. because the start
+// salinity would exceed that of the boundaries, we take a one-sided
+// difference instead.
+static int cycle_map_derivative(const zsf_context_t *ctx, double sal_lock_start,
+                                const double *center, int param, double *dv) {
+  double x = sal_lock_start;
+  if (param >= 0)
+    x = *(const double *)((const char *)&ctx->p + param_offsets[param]);
+  double h = SENSITIVITY_STEP * fmax(fabs(x), 1.0);
+
+  double plus[NUM_CYCLE_VALUES], minus[NUM_CYCLE_VALUES];
+  int err_plus = perturbed_cycle_map(ctx, sal_lock_start, param, x + h, plus);
+  int err_minus = perturbed_cycle_map(ctx, sal_lock_start, param, x - h, minus);
+
+  if (err_plus && err_minus)
+    return err_plus;
+
+  const double *hi = err_plus ? center : plus;
+  const double *lo = err_minus ? center : minus;
+  double dx = (err_plus || err_minus) ? h : 2.0 * h;
+
+  for (int i = 0; i < NUM_CYCLE_VALUES; i++) {
+    dv[i] = (hi[i] - lo[i]) / dx;
+  }
+  return ZSF_SUCCESS;
+}
+
+// The steady state from a given start salinity, and its sensitivities. The
+// salinity of the lock at the end of the last cycle is written to sal_lock_4,
+// which is a good start for similar parameters.
+static int steady_sensitivities(const zsf_context_t *ctx, const zsf_options_t *options,
+                                double sal_lock_start, const int *params, int num_params,
+                                zsf_results_t *results, zsf_results_t *sensitivities,
+                                zsf_steady_stats_t *stats, double *sal_lock_4) {
+  zsf_phase_state_t state;
+  steady_cycle_t cycle;
+
+  int err = steady_initial_state_from(&ctx->p, &ctx->o, sal_lock_start, &state);
+  if (err)
+    return err;
+
+  // The sensitivities of an estimate that did not converge are meaningless
+  err = steady_iterate(&ctx->p, &ctx->o, options, &state, &cycle, stats, NULL, 0);
+  steady_results(&ctx->p, &ctx->o, &cycle, results, NULL);
+  *sal_lock_4 = cycle.sal_lock_4;
+  if (err)
+    return err;
+
+  double center[NUM_CYCLE_VALUES], d_sal[NUM_CYCLE_VALUES];
+
+  err = cycle_map(ctx, *sal_lock_4, center);
+  if (!err)
+    err = cycle_map_derivative(ctx, *sal_lock_4, center, -1, d_sal);
+  if (err)
+    return err;
+
+  // A converged fixed point is attracting, i.e. |G_s| < 1
+  double amplification = 1.0 / (1.0 - d_sal[CYCLE_SAL_LOCK_4]);
+
+  for (int j = 0; j < num_params; j++) {
+    double d_param[NUM_CYCLE_VALUES];
+    err = cycle_map_derivative(ctx, *sal_lock_4, center, params[j], d_param);
+    if (err)
+      return err;
+
+    double d_sal_lock_4 = d_param[CYCLE_SAL_LOCK_4] * amplification;
+
+#define SENSITIVITY(F)                                                                             \
+  sensitivities[j].F =                                                                             \
+      d_sal[CYCLE_RESULTS + RESULT_##F] * d_sal_lock_4 + d_param[CYCLE_RESULTS + RESULT_##F];
+    RESULTS_FIELDS(SENSITIVITY)
+#undef SENSITIVITY
+  }
+
+  return ZSF_SUCCESS;
+}
+
+int ZSF_CALLCONV zsf_calc_steady_sensitivities(const zsf_param_t *p, const int *params,
+                                               int num_params, const zsf_options_t *options,
+                                               zsf_results_t *results,
+                                               zsf_results_t *sensitivities,
+                                               zsf_steady_stats_t *stats) {
+  zsf_options_t default_options;
+  if (options == NULL) {
+    zsf_options_default(&default_options);
+    options = &default_options;
+  }
+  if (stats != NULL)
+    memset(stats, 0, sizeof(zsf_steady_stats_t));
+
+  for (int j = 0; j < num_params; j++) {
+    if (params[j] < 0 || params[j] >= NUM_PARAM_FIELDS)
+      return ZSF_ERR_UNKNOWN_PARAM;
+  }
+
+  zsf_context_t ctx;
+  context_init(&ctx, p);
+  ctx.o.accuracy = options->accuracy;
+
+  double sal_lock_4;
+  return steady_sensitivities(&ctx, options, steady_cold_salinity(&ctx.p, &ctx.o), params,
+                              num_params, results, sensitivities, stats, &sal_lock_4);
+}
+
+// Calibration
+// ~~~~~~~~~~~
+// Fits parameters like the calibration coefficient to observed salt loads with
+// the Levenberg-Marquardt method. The Jacobian comes from the sensitivities,
+// which cost a few cycles per observation on top of its solve. The fitted
+// parameters change little between iterations, so every observation keeps its
+// context and starts from its lock salinity of the previous iteration.
+#define CALIBRATION_LAMBDA 1E-3
+#define CALIBRATION_MAX_LAMBDA 1E12
+#define CALIBRATION_RTOL 1E-8
+
+// The model of all observations at one set of fitted values
+typedef struct calibration_eval_t {
+  double *sal_lock_4;
+  double *salt_load;
+  double *jacobian; // num_fit per observation
+  int *errors;
+} calibration_eval_t;
+
+typedef struct calibration_t {
+  const zsf_param_t *base;
+  const zsf_param_columns_t *params;
+  int param_stride;
+  const zsf_options_t *options;
+  const int *fit_params;
+  int num_fit;
+  const double *values;
+  zsf_context_t *contexts;
+  const unsigned char *used; // Observations that failed at the start are left out
+  const double *sal_lock_start;
+  calibration_eval_t *eval;
+} calibration_t;
+
+static void calibration_range(void *data, int begin, int end, int thread) {
+  calibration_t *c = (calibration_t *)data;
+  calibration_eval_t *e = c->eval;
+  (void)thread;
+
+  for (int i = begin; i < end; i++) {
+    if (c->used != NULL && !c->used[i])
+      continue;
+
+    // The first evaluation, before it is known which observations fail, sets
+    // up the contexts
+    zsf_context_t *ctx = &c->contexts[i];
+    zsf_param_t p;
+    if (c->used == NULL)
+      gather_param(c->base, c->params, (size_t)i * c->param_stride, &p);
+    else
+      p = ctx->p;
+
+    for (int k = 0; k < c->num_fit; k++) {
+      *(double *)((char *)&p + param_offsets[c->fit_params[k]]) = c->values[k];
+    }
+
+    if (c->used == NULL) {
+      context_init(ctx, &p);
+      ctx->o.accuracy = c->options->accuracy;
+    } else {
+      context_update(ctx, &p);
+    }
+
+    zsf_results_t r, sensitivities[NUM_PARAM_FIELDS];
+    double sal_lock_start = steady_warm_salinity(&ctx->p, &ctx->o, c->sal_lock_start[i]);
+
+    e->sal_lock_4[i] = c->sal_lock_start[i];
+    e->errors[i] = steady_sensitivities(ctx, c->options, sal_lock_start, c->fit_params, c->num_fit,
+                                        &r, sensitivities, NULL, &e->sal_lock_4[i]);
+    if (e->errors[i])
+      continue;
+
+    e->salt_load[i] = r.salt_load_lake;
+    for (int k = 0; k < c->num_fit; k++) {
+      e->jacobian[(size_t)i * c->num_fit + k] = sensitivities[k].salt_load_lake;
+    }
+  }
+}
+
+// The weighted sum of squared residuals, which is infinite if an observation
+// that is used failed
+static double calibration_cost(const calibration_eval_t *e, const unsigned char *used,
+                               const double *observed, const double *weights, int n) {
+  double cost = 0.0;
+  for (int i = 0; i < n; i++) {
+    if (!used[i])
+      continue;
+    if (e->errors[i])
+      return HUGE_VAL;
+    double r = (e->salt_load[i] - observed[i]) * (weights != NULL ? weights[i] : 1.0);
+    cost += r * r;
+  }
+  return cost;
+}
+
+// The normal equations J^T W J and J^T W r, with the first in a (row major)
+static void calibration_normal_equations(const calibration_eval_t *e, const unsigned char *used,
+                                         const double *observed, const double *weights, int n,
+                                         int num_fit, double *a, double *g) {
+  memset(a, 0, (size_t)num_fit * num_fit * sizeof(double));
+  memset(g, 0, (size_t)num_fit * sizeof(double));
+
+  for (int i = 0; i < n; i++) {
+    if (!used[i])
+      continue;
+    double w = (weights != NULL) ? weights[i] * weights[i] : 1.0;
+    double r = e->salt_load[i] - observed[i];
+    const double *jac = &e->jacobian[(size_t)i * num_fit];
+
+    for (int k = 0; k < num_fit; k++) {
+      g[k] += w * jac[k] * r;
+      for (int l = 0; l < num_fit; l++) {
+        a[k * num_fit + l] += w * jac[k] * jac[l];
+      }
+    }
+  }
+}
+
+// Cholesky factorization of a symmetric positive definite matrix, in place.
+// Returns 0 if the matrix is not positive definite.
+static int cholesky_factor(double *a, int n) {
+  for (int j = 0; j < n; j++) {
+    double d = a[j * n + j];
+    for (int k = 0; k < j; k++) {
+      d -= a[j * n + k] * a[j * n + k];
+    }
+    if (!(d > 0.0))
+      return 0;
+    a[j * n + j] = sqrt(d);
+
+    for (int i = j + 1; i < n; i++) {
+      double s = a[i * n + j];
+      for (int k = 0; k < j; k++) {
+        s -= a[i * n + k] * a[j * n + k];
+      }
+      a[i * n + j] = s / a[j * n + j];
+    }
+  }
+  return 1;
+}
+
+// Solves L L^T x = b with the factor of cholesky_factor, in place
+static void cholesky_solve(const double *l, int n, double *b) {
+  for (int i = 0; i < n; i++) {
+    for (int k = 0; k < i; k++) {
+      b[i] -= l[i * n + k] * b[k];
+    }
+    b[i] /= l[i * n + i];
+  }
+  for (int i = n - 1; i >= 0; i--) {
+    for (int k = i + 1; k < n; k++) {
+      b[i] -= l[k * n + i] * b[k];
+    }
+    b[i] /= l[i * n + i];
+  }
+}
+
+static void calibration_residual_stats(const calibration_eval_t *e, const unsigned char *used,
+                                       const double *observed, int n, double *rms,
+                                       double *max_abs) {
+  double sum = 0.0;
+  int count = 0;
+  *max_abs = 0.0;
+
+  for (int i = 0; i < n; i++) {
+    if (!used[i])
+      continue;
+    double r = e->salt_load[i] - observed[i];
+    sum += r * r;
+    count++;
+    *max_abs = fmax(*max_abs, fabs(r));
+  }
+  *rms = (count > 0) ? sqrt(sum / count) : 0.0;
+}
+
+int ZSF_CALLCONV zsf_calibrate(const zsf_param_t *base, const zsf_param_columns_t *params,
+                               int param_stride, const double *observed, const double *weights,
+                               int n, zsf_calibration_param_t *fit, int num_fit,
+                               int max_iterations, const zsf_options_t *options,
+                               double *residuals, zsf_calibration_stats_t *stats) {
+  zsf_param_t default_param;
+  if (base == NULL) {
+    zsf_param_default(&default_param);
+    base = &default_param;
+  }
+  if (params == NULL)
+    params = &no_param_columns;
+  if (param_stride < 0)
+    return ZSF_ERR_INVALID_STRIDE;
+
+  zsf_options_t default_options;
+  if (options == NULL) {
+    zsf_options_default(&default_options);
+    options = &default_options;
+  }
+
+  zsf_calibration_stats_t default_stats;
+  if (stats == NULL)
+    stats = &default_stats;
+  memset(stats, 0, sizeof(zsf_calibration_stats_t));
+
+  if (num_fit < 1 || num_fit > NUM_PARAM_FIELDS)
+    return ZSF_ERR_UNKNOWN_PARAM;
+
+  int fit_params[NUM_PARAM_FIELDS];
+  double values[NUM_PARAM_FIELDS], trial_values[NUM_PARAM_FIELDS];
+  for (int k = 0; k < num_fit; k++) {
+    if (fit[k].param < 0 || fit[k].param >= NUM_PARAM_FIELDS)
+      return ZSF_ERR_UNKNOWN_PARAM;
+    fit_params[k] = fit[k].param;
+    values[k] = fmin(fmax(fit[k].value, fit[k].lower), fit[k].upper);
+  }
+
+  // Two evaluations, of the current values and of a trial step
+  calibration_eval_t evals[2], *current = &evals[0], *trial = &evals[1];
+  zsf_context_t *contexts = (zsf_context_t *)malloc((size_t)n * sizeof(zsf_context_t));
+  unsigned char *used = (unsigned char *)malloc((size_t)n);
+  double *block = (double *)malloc((size_t)n * 2 * (2 + num_fit) * sizeof(double));
+  int *errors = (int *)malloc((size_t)n * 2 * sizeof(int));
+  if (contexts == NULL || used == NULL || block == NULL || errors == NULL) {
+    free(contexts);
+    free(used);
+    free(block);
+    free(errors);
+    return ZSF_ERR_OUT_OF_MEMORY;
+  }
+  for (int j = 0; j < 2; j++) {
+    double *values_j = &block[(size_t)j * n * (2 + num_fit)];
+    evals[j].sal_lock_4 = values_j;
+    evals[j].salt_load = values_j + n;
+    evals[j].jacobian = values_j + 2 * (size_t)n;
+    evals[j].errors = &errors[(size_t)j * n];
+  }
+  for (int i = 0; i < n; i++) {
+    trial->sal_lock_4[i] = ZSF_NAN;
+  }
+
+  int num_threads = parallel_num_threads(options->num_threads, n);
+  int chunk_size = (options->chunk_size > 0) ? options->chunk_size : 32;
+
+  // The first evaluation sets up the contexts, and finds the observations
+  // that fail at the initial values
+  calibration_t c = {base,    params, param_stride, options,           fit_params,
+                     num_fit, values, contexts,     NULL,              trial->sal_lock_4,
+                     current};
+  parallel_for(n, chunk_size, num_threads, calibration_range, &c);
+  stats->num_evaluations = 1;
+
+  for (int i = 0; i < n; i++) {
+    used[i] = (current->errors[i] == ZSF_SUCCESS);
+    stats->num_observations += used[i];
+  }
+  stats->num_failed = n - stats->num_observations;
+  c.used = used;
+
+  double max_abs_residual;
+  calibration_residual_stats(current, used, observed, n, &stats->initial_rms_residual,
+                             &max_abs_residual);
+
+  int err = ZSF_ERR_MAX_ITERATIONS;
+  if (stats->num_observations == 0)
+    err = ZSF_ERR_BATCH_FAILED_ROWS;
+
+  double cost = calibration_cost(current, used, observed, weights, n);
+  double a[NUM_PARAM_FIELDS * NUM_PARAM_FIELDS], m[NUM_PARAM_FIELDS * NUM_PARAM_FIELDS];
+  double g[NUM_PARAM_FIELDS], step[NUM_PARAM_FIELDS];
+  double lambda = CALIBRATION_LAMBDA;
+
+  for (int iteration = 0; err == ZSF_ERR_MAX_ITERATIONS && iteration < max_iterations;
+       iteration++) {
+    calibration_normal_equations(current, used, observed, weights, n, num_fit, a, g);
+
+    // Increase the damping until a step decreases the cost. If no step does,
+    // the current values are a minimum within the accuracy of the solver.
+    int converged = 1;
+    for (; lambda <= CALIBRATION_MAX_LAMBDA; lambda *= 10.0) {
+      memcpy(m, a, (size_t)num_fit * num_fit * sizeof(double));
+      for (int k = 0; k < num_fit; k++) {
+        m[k * num_fit + k] += lambda * fmax(a[k * num_fit + k], DBL_MIN);
+        step[k] = -g[k];
+      }
+      if (!cholesky_factor(m, num_fit))
+        continue;
+      cholesky_solve(m, num_fit, step);
+
+      int small_step = 1;
+      for (int k = 0; k < num_fit; k++) {
+        trial_values[k] = fmin(fmax(values[k] + step[k], fit[k].lower), fit[k].upper);
+        if (fabs(trial_values[k] - values[k]) >
+            CALIBRATION_RTOL * (fabs(values[k]) + CALIBRATION_RTOL))
+          small_step = 0;
+      }
+      if (small_step)
+        break;
+
+      c.values = trial_values;
+      c.sal_lock_start = current->sal_lock_4;
+      c.eval = trial;
+      parallel_for(n, chunk_size, num_threads, calibration_range, &c);
+      stats->num_evaluations++;
+
+      double trial_cost = calibration_cost(trial, used, observed, weights, n);
+      if (trial_cost < cost) {
+        converged = (cost - trial_cost <= CALIBRATION_RTOL * cost);
+        cost = trial_cost;
+        memcpy(values, trial_values, (size_t)num_fit * sizeof(double));
+
+        calibration_eval_t *swap = current;
+        current = trial;
+        trial = swap;
+
+        lambda = fmax(lambda / 10.0, CALIBRATION_RTOL);
+        stats->num_iterations++;
+        break;
+      }
+    }
+
+    if (converged)
+      err = ZSF_SUCCESS;
+  }
+
+  calibration_residual_stats(current, used, observed, n, &stats->rms_residual,
+                             &stats->max_abs_residual);
+
+  // The standard errors follow from the covariance s^2 (J^T W J)^-1, where
+  // s^2 is the estimated variance of the (weighted) residuals
+  calibration_normal_equations(current, used, observed, weights, n, num_fit, a, g);
+  int num_dof = stats->num_observations - num_fit;
+  int regular = (num_dof > 0) && cholesky_factor(a, num_fit);
+
+  for (int k = 0; k < num_fit; k++) {
+    fit[k].value = values[k];
+    fit[k].std_error = HUGE_VAL;
+    if (regular) {
+      memset(step, 0, (size_t)num_fit * sizeof(double));
+      step[k] = 1.0;
+      cholesky_solve(a, num_fit, step);
+      fit[k].std_error = sqrt(cost / num_dof * step[k]);
+    }
+  }
+
+  if (residuals != NULL) {
+    for (int i = 0; i < n; i++) {
+      if (used[i])
+        residuals[i] = current->salt_load[i] - observed[i];
+    }
+  }
+
+  free(contexts);
+  free(used);
+  free(block);
+  free(errors);
+
+  stats->converged = (err == ZSF_SUCCESS);
+  if (err == ZSF_SUCCESS && stats->num_failed > 0)
+    err = ZSF_ERR_BATCH_FAILED_ROWS;
+  return err;
+}
+
+// Monte Carlo
+// ~~~~~~~~~~~
+// Every sample draws its parameters from the counter-based generator with its
+// index as counter, such that the samples do not depend on the number of
+// threads or the order in which they run. Every thread accumulates the
+// results of its samples in its own accumulator, which are merged after the
+// run. The moments are updated with Welford's algorithm, and the quantiles
+// come from a histogram with logarithmic buckets, of which the bucket width
+// bounds the relative error (the DDSketch of Masson et al., 2019).
+#define NORMAL_MAX_TRIES 32
+#define TWO_PI 6.28318530717958647693
+
+// Magnitudes below SKETCH_MIN count as zero, and the last bucket also counts
+// all larger magnitudes (from about 6E8).
+#define SKETCH_MIN 1E-9
+#define SKETCH_NUM_BUCKETS 2048
+
+typedef struct monte_carlo_acc_t {
+  long long num_samples;
+  long long num_failed;
+  double mean[NUM_RESULTS_FIELDS];
+  double m2[NUM_RESULTS_FIELDS];
+  double min[NUM_RESULTS_FIELDS];
+  double max[NUM_RESULTS_FIELDS];
+  long long zeros[NUM_RESULTS_FIELDS];
+  long long buckets[NUM_RESULTS_FIELDS][2][SKETCH_NUM_BUCKETS]; // Negative and positive values
+} monte_carlo_acc_t;
+
+struct zsf_monte_carlo_t {
+  zsf_param_t base;
+  int num_distributions;
+  zsf_distribution_t distributions[NUM_PARAM_FIELDS];
+  unsigned long long seed;
+  monte_carlo_acc_t total;
+};
+
+// The bucket growth factor gamma, such that any value in a bucket is within
+// ZSF_MONTE_CARLO_ACCURACY of 2 gamma^k / (gamma + 1)
+static double sketch_log_gamma(void) {
+  return log((1.0 + ZSF_MONTE_CARLO_ACCURACY) / (1.0 - ZSF_MONTE_CARLO_ACCURACY));
+}
+
+static void monte_carlo_acc_add(monte_carlo_acc_t *acc, const double *v, double log_gamma) {
+  acc->num_samples++;
+
+  for (int f = 0; f < NUM_RESULTS_FIELDS; f++) {
+    double delta = v[f] - acc->mean[f];
+    acc->mean[f] += delta / acc->num_samples;
+    acc->m2[f] += delta * (v[f] - acc->mean[f]);
+    acc->min[f] = (acc->num_samples == 1) ? v[f] : fmin(acc->min[f], v[f]);
+    acc->max[f] = (acc->num_samples == 1) ? v[f] : fmax(acc->max[f], v[f]);
+
+    double magnitude = fabs(v[f]);
+    if (magnitude < SKETCH_MIN) {
+      acc->zeros[f]++;
+      continue;
+    }
+    double k = ceil(log(magnitude / SKETCH_MIN) / log_gamma);
+    int bucket = (k < SKETCH_NUM_BUCKETS - 1) ? (int)k : SKETCH_NUM_BUCKETS - 1;
+    acc->buckets[f][v[f] > 0.0][bucket]++;
+  }
+}
+
+// Merges b into a, with the parallel variant of Welford's algorithm (Chan et
+// al., 1979)
+static void monte_carlo_acc_merge(monte_carlo_acc_t *a, const monte_carlo_acc_t *b) {
+  long long n = a->num_samples + b->num_samples;
+  a->num_failed += b->num_failed;
+  if (b->num_samples == 0)
+    return;
+
+  for (int f = 0; f < NUM_RESULTS_FIELDS; f++) {
+    double delta = b->mean[f] - a->mean[f];
+    double weight = (double)b->num_samples / n;
+    a->mean[f] += delta * weight;
+    a->m2[f] += b->m2[f] + delta * delta * a->num_samples * weight;
+    a->min[f] = (a->num_samples == 0) ? b->min[f] : fmin(a->min[f], b->min[f]);
+    a->max[f] = (a->num_samples == 0) ? b->max[f] : fmax(a->max[f], b->max[f]);
+
+    a->zeros[f] += b->zeros[f];
+    for (int sign = 0; sign < 2; sign++) {
+      for (int k = 0; k < SKETCH_NUM_BUCKETS; k++) {
+        a->buckets[f][sign][k] += b->buckets[f][sign][k];
+      }
+    }
+  }
+  a->num_samples = n;
+}
+
+static int check_distribution(const zsf_distribution_t *d) {
+  if (d->param < 0 || d->param >= NUM_PARAM_FIELDS || !(d->min <= d->max))
+    return ZSF_ERR_INVALID_DISTRIBUTION;
+
+  switch (d->type) {
+  case ZSF_DISTRIBUTION_UNIFORM:
+    return (d->min > -HUGE_VAL && d->max < HUGE_VAL) ? ZSF_SUCCESS : ZSF_ERR_INVALID_DISTRIBUTION;
+  case ZSF_DISTRIBUTION_NORMAL:
+    return (d->std_dev >= 0.0) ? ZSF_SUCCESS : ZSF_ERR_INVALID_DISTRIBUTION;
+  case ZSF_DISTRIBUTION_TRIANGULAR:
+    return (d->min > -HUGE_VAL && d->max < HUGE_VAL && d->min <= d->center && d->center <= d->max)
+               ? ZSF_SUCCESS
+               : ZSF_ERR_INVALID_DISTRIBUTION;
+  default:
+    return ZSF_ERR_INVALID_DISTRIBUTION;
+  }
+}
+
+// A value of distribution d for the sample with the given index, from the
+// random numbers of the stream of the distribution
+static double sample_distribution(const zsf_distribution_t *d, unsigned long long seed,
+                                  unsigned long long index, int stream) {
+  double u0, u1;
+  random_uniform_2(seed, index, (uint32_t)stream, 0, &u0, &u1);
+
+  if (d->type == ZSF_DISTRIBUTION_UNIFORM)
+    return d->min + (d->max - d->min) * u0;
+
+  if (d->type == ZSF_DISTRIBUTION_TRIANGULAR) {
+    double width = d->max - d->min;
+    if (u0 * width < d->center - d->min)
+      return d->min + sqrt(u0 * width * (d->center - d->min));
+    return d->max - sqrt((1.0 - u0) * width * (d->max - d->center));
+  }
+
+  // Box-Muller gives two normal values per draw, and values outside of the
+  // bounds are rejected. Where the bounds are far in a tail, we fall back to
+  // the nearest bound.
+  for (uint32_t draw = 1; draw <= NORMAL_MAX_TRIES; draw++) {
+    double r = d->std_dev * sqrt(-2.0 * log(1.0 - u0));
+    double x0 = d->center + r * cos(TWO_PI * u1);
+    double x1 = d->center + r * sin(TWO_PI * u1);
+    if (x0 >= d->min && x0 <= d->max)
+      return x0;
+    if (x1 >= d->min && x1 <= d->max)
+      return x1;
+    random_uniform_2(seed, index, (uint32_t)stream, draw, &u0, &u1);
+  }
+  return fmin(fmax(d->center, d->min), d->max);
+}
+
+static void monte_carlo_sample(const zsf_monte_carlo_t *mc, unsigned long long index,
+                               zsf_param_t *p) {
+  *p = mc->base;
+  for (int k = 0; k < mc->num_distributions; k++) {
+    const zsf_distribution_t *d = &mc->distributions[k];
+    *(double *)((char *)p + param_offsets[d->param]) = sample_distribution(d, mc->seed, index, k);
+  }
+}
+
+int ZSF_CALLCONV zsf_monte_carlo_create(const zsf_param_t *base,
+                                        const zsf_distribution_t *distributions,
+                                        int num_distributions, unsigned long long seed,
+                                        zsf_monte_carlo_t **monte_carlo) {
+  *monte_carlo = NULL;
+
+  if (num_distributions < 0 || num_distributions > NUM_PARAM_FIELDS)
+    return ZSF_ERR_INVALID_DISTRIBUTION;
+
+  for (int k = 0; k < num_distributions; k++) {
+    int err = check_distribution(&distributions[k]);
+    if (err)
+      return err;
+    for (int j = 0; j < k; j++) {
+      if (distributions[j].param == distributions[k].param)
+        return ZSF_ERR_INVALID_DISTRIBUTION;
+    }
+  }
+
+  zsf_monte_carlo_t *mc = (zsf_monte_carlo_t *)calloc(1, sizeof(zsf_monte_carlo_t));
+  if (mc == NULL)
+    return ZSF_ERR_OUT_OF_MEMORY;
+
+  if (base == NULL)
+    zsf_param_default(&mc->base);
+  else
+    mc->base = *base;
+
+  mc->num_distributions = num_distributions;
+  for (int k = 0; k < num_distributions; k++) {
+    mc->distributions[k] = distributions[k];
+  }
+  mc->seed = seed;
+
+  *monte_carlo = mc;
+  return ZSF_SUCCESS;
+}
+
+void ZSF_CALLCONV zsf_monte_carlo_free(zsf_monte_carlo_t *monte_carlo) { free(monte_carlo); }
+
+typedef struct monte_carlo_run_t {
+  const zsf_monte_carlo_t *mc;
+  long long first;
+  const zsf_options_t *options;
+  monte_carlo_acc_t **accs; // One per thread
+  double log_gamma;
+} monte_carlo_run_t;
+
+static void monte_carlo_range(void *data, int begin, int end, int thread) {
+  monte_carlo_run_t *run = (monte_carlo_run_t *)data;
+  monte_carlo_acc_t *acc = run->accs[thread];
+
+  zsf_param_t p;
+  zsf_context_t ctx;
+
+  for (int i = begin; i < end; i++) {
+    monte_carlo_sample(run->mc, run->first + i, &p);
+
+    if (i == begin) {
+      context_init(&ctx, &p);
+      ctx.o.accuracy = run->options->accuracy;
+    } else {
+      context_update(&ctx, &p);
+    }
+
+    zsf_phase_state_t state;
+    steady_cycle_t cycle;
+
+    // Samples that do not converge are failed too, as their best estimate may
+    // be far off
+    int err = steady_initial_state(&ctx.p, &ctx.o, &state);
+    if (!err)
+      err = steady_iterate(&ctx.p, &ctx.o, run->options, &state, &cycle, NULL, NULL, 0);
+    if (err) {
+      acc->num_failed++;
+      continue;
+    }
+
+    zsf_results_t r;
+    double v[NUM_RESULTS_FIELDS];
+    steady_results(&ctx.p, &ctx.o, &cycle, &r, NULL);
+#define RESULT_VALUE(F) v[RESULT_##F] = r.F;
+    RESULTS_FIELDS(RESULT_VALUE)
+#undef RESULT_VALUE
+
+    monte_carlo_acc_add(acc, v, run->log_gamma);
+  }
+}
+
+int ZSF_CALLCONV zsf_monte_carlo_run(zsf_monte_carlo_t *monte_carlo, int num_samples,
+                                     const zsf_options_t *options) {
+  zsf_options_t default_options;
+  if (options == NULL) {
+    zsf_options_default(&default_options);
+    options = &default_options;
+  }
+  if (num_samples <= 0)
+    return ZSF_SUCCESS;
+
+  int num_threads = parallel_num_threads(options->num_threads, num_samples);
+  int chunk_size = (options->chunk_size > 0) ? options->chunk_size : 32;
+
+  // The accumulators are large, so every thread gets its own allocation
+  monte_carlo_acc_t **accs = (monte_carlo_acc_t **)calloc(num_threads, sizeof(monte_carlo_acc_t *));
+  if (accs == NULL)
+    return ZSF_ERR_OUT_OF_MEMORY;
+
+  int err = ZSF_SUCCESS;
+  for (int t = 0; t < num_threads; t++) {
+    accs[t] = (monte_carlo_acc_t *)calloc(1, sizeof(monte_carlo_acc_t));
+    if (accs[t] == NULL)
+      err = ZSF_ERR_OUT_OF_MEMORY;
+  }
+
+  if (!err) {
+    long long first = monte_carlo->total.num_samples + monte_carlo->total.num_failed;
+    monte_carlo_run_t run = {monte_carlo, first, options, accs, sketch_log_gamma()};
+    parallel_for(num_samples, chunk_size, num_threads, monte_carlo_range, &run);
+
+    long long num_failed = monte_carlo->total.num_failed;
+    for (int t = 0; t < num_threads; t++) {
+      monte_carlo_acc_merge(&monte_carlo->total, accs[t]);
+    }
+    if (monte_carlo->total.num_failed > num_failed)
+      err = ZSF_ERR_BATCH_FAILED_ROWS;
+  }
+
+  for (int t = 0; t < num_threads; t++) {
+    free(accs[t]);
+  }
+  free(accs);
+  return err;
+}
+
+void ZSF_CALLCONV zsf_monte_carlo_get_sample(const zsf_monte_carlo_t *monte_carlo,
+                                             long long index, zsf_param_t *p) {
+  monte_carlo_sample(monte_carlo, (unsigned long long)index, p);
+}
+
+void ZSF_CALLCONV zsf_monte_carlo_get_stats(const zsf_monte_carlo_t *monte_carlo,
+                                            zsf_monte_carlo_stats_t *stats) {
+  const monte_carlo_acc_t *acc = &monte_carlo->total;
+  long long n = acc->num_samples;
+
+  stats->num_samples = n;
+  stats->num_failed = acc->num_failed;
+
+#define MONTE_CARLO_STATS(F)                                                                       \
+  stats->mean.F = (n > 0) ? acc->mean[RESULT_##F] : ZSF_NAN;                                       \
+  stats->std_dev.F = (n > 1) ? sqrt(acc->m2[RESULT_##F] / (n - 1)) : ((n > 0) ? 0.0 : ZSF_NAN);    \
+  stats->min.F = (n > 0) ? acc->min[RESULT_##F] : ZSF_NAN;                                         \
+  stats->max.F = (n > 0) ? acc->max[RESULT_##F] : ZSF_NAN;
+  RESULTS_FIELDS(MONTE_CARLO_STATS)
+#undef MONTE_CARLO_STATS
+}
+
+// The value of rank (from 0) in the sorted results, from the negative buckets
+// of decreasing magnitude, the zeros, and the positive buckets of increasing
+// magnitude
+static double sketch_quantile(const monte_carlo_acc_t *acc, int f, double rank, double log_gamma) {
+  if (rank <= 0.0)
+    return acc->min[f];
+  if (rank >= acc->num_samples - 1)
+    return acc->max[f];
+
+  double gamma = exp(log_gamma);
+  long long count = 0;
+
+  for (int k = SKETCH_NUM_BUCKETS - 1; k >= 0; k--) {
+    count += acc->buckets[f][0][k];
+    if (count > rank)
+      return -SKETCH_MIN * exp(k * log_gamma) * 2.0 / (gamma + 1.0);
+  }
+
+  count += acc->zeros[f];
+  if (count > rank)
+    return 0.0;
+
+  for (int k = 0; k < SKETCH_NUM_BUCKETS; k++) {
+    count += acc->buckets[f][1][k];
+    if (count > rank)
+      return SKETCH_MIN * exp(k * log_gamma) * 2.0 / (gamma + 1.0);
+  }
+  return acc->max[f];
+}
+
+int ZSF_CALLCONV zsf_monte_carlo_quantile(const zsf_monte_carlo_t *monte_carlo, double q,
+                                          zsf_results_t *results) {
+  const monte_carlo_acc_t *acc = &monte_carlo->total;
+  if (!(q >= 0.0 && q <= 1.0) || acc->num_samples == 0)
+    return ZSF_ERR_INVALID_QUANTILE;
+
+  double rank = q * (acc->num_samples - 1);
+  double log_gamma = sketch_log_gamma();
+
+  // The extremes are known exactly, and bound the estimates of the buckets
+#define MONTE_CARLO_QUANTILE(F)                                                                    \
+  results->F = fmin(fmax(sketch_quantile(acc, RESULT_##F, rank, log_gamma), acc->min[RESULT_##F]), \
+                    acc->max[RESULT_##F]);
+  RESULTS_FIELDS(MONTE_CARLO_QUANTILE)
+#undef MONTE_CARLO_QUANTILE
+
+  return ZSF_SUCCESS;
+}
+
+// Inverse solve
+// ~~~~~~~~~~~~~
+// Finds the value of a parameter for which a result hits a target, with
+// Newton steps from the sensitivities safeguarded by bisection of a bracket
+// (like rtsafe of Numerical Recipes). Near the root, consecutive probes differ
+// little, so every probe starts from the lock salinity of the previous one.
+#define INVERSE_MAX_PROBES 100
+#define INVERSE_XTOL 1E-8
+#define INVERSE_NOISE_STEP 1E-4
+
+typedef struct inverse_probe_t {
+  double x;
+  double f; // Result minus target
+  double df;
+  double sal_lock_4;
+  zsf_results_t results;
+} inverse_probe_t;
+
+// The sills should be between the bottom of the lock and the water level,
+// which the kernels assume without checking
+static int check_sill_heights(const zsf_param_t *p) {
+  if (!(p->sill_height_lake >= 0.0 && p->head_lake - p->lock_bottom - p->sill_height_lake > 0.0))
+    return ZSF_ERR_PARAM_OUT_OF_RANGE;
+  if (!(p->sill_height_sea >= 0.0 && p->head_sea - p->lock_bottom - p->sill_height_sea > 0.0))
+    return ZSF_ERR_PARAM_OUT_OF_RANGE;
+  return ZSF_SUCCESS;
+}
+
+static int inverse_probe(zsf_context_t *ctx, const zsf_options_t *options, int param, int result,
+                         double target, double x, double sal_lock_start, inverse_probe_t *probe,
+                         zsf_inverse_stats_t *stats) {
+  zsf_param_t p = ctx->p;
+  *(double *)((char *)&p + param_offsets[param]) = x;
+  context_update(ctx, &p);
+
+  zsf_results_t sensitivity;
+  zsf_steady_stats_t steady_stats = {0};
+  double sal_lock_warm = steady_warm_salinity(&ctx->p, &ctx->o, sal_lock_start);
+  int err = steady_sensitivities(ctx, options, sal_lock_warm, &param, 1, &probe->results,
+                                 &sensitivity, &steady_stats, &probe->sal_lock_4);
+  stats->num_probes++;
+  stats->num_cycles += steady_stats.num_cycles;
+  if (err)
+    return err;
+
+  probe->x = x;
+  probe->f = *(const double *)((const char *)&probe->results + result_offsets[result]) - target;
+  probe->df = *(const double *)((const char *)&sensitivity + result_offsets[result]);
+  return ZSF_SUCCESS;
+}
+
+int ZSF_CALLCONV zsf_calc_steady_inverse(const zsf_param_t *p, int param, double lower,
+                                         double upper, int result, double target,
+                                         double tolerance, const zsf_options_t *options,
+                                         double *value, zsf_results_t *results,
+                                         zsf_inverse_stats_t *stats) {
+  zsf_options_t default_options;
+  if (options == NULL) {
+    zsf_options_default(&default_options);
+    options = &default_options;
+  }
+
+  zsf_inverse_stats_t default_stats;
+  if (stats == NULL)
+    stats = &default_stats;
+  memset(stats, 0, sizeof(zsf_inverse_stats_t));
+
+  if (param < 0 || param >= NUM_PARAM_FIELDS)
+    return ZSF_ERR_UNKNOWN_PARAM;
+  if (result < 0 || result >= NUM_RESULTS_FIELDS)
+    return ZSF_ERR_UNKNOWN_RESULT;
+
+  // The conditions on the sills are linear in any single parameter, so they
+  // hold within the bracket if they hold at both ends
+  zsf_param_t bound = *p;
+  double *field = (double *)((char *)&bound + param_offsets[param]);
+  *field = lower;
+  int err = check_sill_heights(&bound);
+  *field = upper;
+  if (!err)
+    err = check_sill_heights(&bound);
+  if (err)
+    return err;
+
+  zsf_context_t ctx;
+  context_init(&ctx, p);
+  ctx.o.accuracy = options->accuracy;
+
+  // The ends of the bracket, a below and b above the target
+  inverse_probe_t a, b, probe;
+  err = inverse_probe(&ctx, options, param, result, target, lower, ZSF_NAN, &a, stats);
+  if (!err)
+    err = inverse_probe(&ctx, options, param, result, target, upper, a.sal_lock_4, &b, stats);
+  if (err)
+    return err;
+
+  if ((a.f > 0.0 && b.f > 0.0) || (a.f < 0.0 && b.f < 0.0))
+    return ZSF_ERR_NOT_BRACKETED;
+  if (a.f > 0.0) {
+    inverse_probe_t swap = a;
+    a = b;
+    b = swap;
+  }
+
+  // Newton steps from the best probe so far, unless they leave the bracket or
+  // do not shrink it faster than bisection
+  probe = (fabs(a.f) < fabs(b.f)) ? a : b;
+  double last_step = fabs(b.x - a.x);
+
+  for (;;) {
+    double xtol = INVERSE_XTOL * (fabs(probe.x) + INVERSE_XTOL);
+    if (fabs(probe.f) <= tolerance || fabs(b.x - a.x) <= xtol || last_step <= xtol) {
+      err = ZSF_SUCCESS;
+      break;
+    }
+
+    // A jump in the result across a small bracket that the sensitivity does
+    // not explain is the noise of the steady state itself
+    double width = fabs(b.x - a.x);
+    if (width <= INVERSE_NOISE_STEP * (fabs(probe.x) + INVERSE_NOISE_STEP) &&
+        b.f - a.f > 2.0 * fabs(probe.df) * width) {
+      probe = (fabs(a.f) < fabs(b.f)) ? a : b;
+      err = ZSF_SUCCESS;
+      break;
+    }
+    if (stats->num_probes >= INVERSE_MAX_PROBES) {
+      err = ZSF_ERR_MAX_ITERATIONS;
+      break;
+    }
+
+    double x = 0.5 * (a.x + b.x);
+    int is_newton = 0;
+    if (probe.df != 0.0) {
+      double newton = probe.x - probe.f / probe.df;
+      if (newton > fmin(a.x, b.x) && newton < fmax(a.x, b.x) &&
+          fabs(newton - probe.x) < 0.5 * last_step) {
+        x = newton;
+        is_newton = 1;
+      }
+    }
+    last_step = fabs(x - probe.x);
+
+    inverse_probe_t next;
+    err = inverse_probe(&ctx, options, param, result, target, x, probe.sal_lock_4, &next, stats);
+    if (err)
+      break;
+
+    // A small Newton step that does not even halve the residual means we are
+    // down to the accuracy of the steady state itself. Keep the best probe.
+    if (is_newton && fabs(next.f) > 0.5 * fabs(probe.f) &&
+        last_step <= INVERSE_NOISE_STEP * (fabs(probe.x) + INVERSE_NOISE_STEP)) {
+      if (fabs(next.f) < fabs(probe.f))
+        probe = next;
+      break;
+    }
+
+    probe = next;
+    if (probe.f < 0.0)
+      a = probe;
+    else
+      b = probe;
+  }
+
+  // Running into the accuracy of the steady state (or a collapsed bracket) is
+  // only a solution if no tolerance was asked for
+  if (err == ZSF_SUCCESS && tolerance > 0.0 && fabs(probe.f) > tolerance)
+    err = ZSF_ERR_TOLERANCE_NOT_REACHED;
+
+  if (err == ZSF_SUCCESS || err == ZSF_ERR_MAX_ITERATIONS || err == ZSF_ERR_TOLERANCE_NOT_REACHED) {
+    *value = probe.x;
+    stats->residual = probe.f;
+    if (results != NULL)
+      *results = probe.results;
+  }
+  return err;
+}
@@ -7,6 +7,30 @@ ffibuilder = FFI()
 
 ffibuilder.cdef(
     """
+    #define ZSF_SOLVER_PICARD 0
+    #define ZSF_SOLVER_AITKEN 1
+
+    #define ZSF_ACCURACY_EXACT 0
+    #define ZSF_ACCURACY_FAST 1
+    #define ZSF_ACCURACY_FASTEST 2
+
+    #define ZSF_ROUTINE_IDLE 0
+    #define ZSF_ROUTINE_LEVEL_TO_LAKE 1
+    #define ZSF_ROUTINE_DOOR_OPEN_LAKE 2
+    #define ZSF_ROUTINE_LEVEL_TO_SEA 3
+    #define ZSF_ROUTINE_DOOR_OPEN_SEA 4
+    #define ZSF_ROUTINE_FLUSH_DOORS_CLOSED_LAKE -2
+    #define ZSF_ROUTINE_FLUSH_DOORS_CLOSED_SEA -4
+
+    #define ZSF_INTERPOLATION_LINEAR 1
+    #define ZSF_INTERPOLATION_CUBIC 3
+
+    #define ZSF_SURROGATE_MAX_AXES 8
+
+    #define ZSF_DISTRIBUTION_UNIFORM 1
+    #define ZSF_DISTRIBUTION_NORMAL 2
+    #define ZSF_DISTRIBUTION_TRIANGULAR 3
+
     typedef struct zsf_param_t {
         double lock_length;
         double lock_width;
@@ -97,6 +121,183 @@ ffibuilder.cdef(
         zsf_phase_transports_t transports_phase_4;
     } zsf_aux_results_t;
 
+    typedef struct zsf_param_columns_t {
+        const double *lock_length;
+        const double *lock_width;
+        const double *lock_bottom;
+        const double *num_cycles;
+        const double *door_time_to_open;
+        const double *leveling_time;
+        const double *calibration_coefficient;
+        const double *symmetry_coefficient;
+        const double *ship_volume_sea_to_lake;
+        const double *ship_volume_lake_to_sea;
+        const double *salinity_lock;
+        const double *head_sea;
+        const double *salinity_sea;
+        const double *temperature_sea;
+        const double *head_lake;
+        const double *salinity_lake;
+        const double *temperature_lake;
+        const double *flushing_discharge_high_tide;
+        const double *flushing_discharge_low_tide;
+        const double *density_current_factor_sea;
+        const double *density_current_factor_lake;
+        const double *distance_door_bubble_screen_sea;
+        const double *distance_door_bubble_screen_lake;
+        const double *sill_height_sea;
+        const double *sill_height_lake;
+        const double *rtol;
+        const double *atol;
+    } zsf_param_columns_t;
+
+    typedef struct zsf_results_columns_t {
+        double *mass_transport_lake;
+        double *salt_load_lake;
+        double *discharge_from_lake;
+        double *discharge_to_lake;
+        double *salinity_to_lake;
+
+        double *mass_transport_sea;
+        double *salt_load_sea;
+        double *discharge_from_sea;
+        double *discharge_to_sea;
+        double *salinity_to_sea;
+    } zsf_results_columns_t;
+
+    typedef struct zsf_options_t {
+        int num_threads;
+        int chunk_size;
+        int solver;
+        int max_cycles;
+        double max_time;
+        int accuracy;
+        int reserved;
+    } zsf_options_t;
+
+    typedef struct zsf_steady_stats_t {
+        int num_cycles;
+        int num_extrapolations;
+        double residual;
+    } zsf_steady_stats_t;
+
+    typedef struct zsf_inverse_stats_t {
+        int num_probes;
+        int num_cycles;
+        double residual;
+    } zsf_inverse_stats_t;
+
+    typedef struct zsf_steady_trace_t {
+        int cycle;
+        int restarted;
+        double salinity_lock_1;
+        double salinity_lock_2;
+        double salinity_lock_3;
+        double salinity_lock_4;
+        double residual;
+    } zsf_steady_trace_t;
+
+    typedef struct zsf_counters_t {
+        long long num_steady_solves;
+        long long num_unconverged_solves;
+        long long num_cycles;
+        long long num_density_evaluations;
+        long long num_density_iterations;
+        long long num_doors_open_lake;
+        long long num_doors_open_sea;
+        long long num_bubble_screen_raw_exchange;
+        long long num_flushing_passthrough;
+        long long num_exchange_blocked_by_flushing;
+    } zsf_counters_t;
+
+    typedef struct zsf_context_t zsf_context_t;
+
+    typedef struct zsf_surrogate_axis_t {
+        int param;
+        int num_points;
+        double min;
+        double max;
+    } zsf_surrogate_axis_t;
+
+    typedef struct zsf_complex_t zsf_complex_t;
+
+    typedef struct zsf_traffic_t {
+        double arrival_rate_lake;
+        double arrival_rate_sea;
+        double ship_volume_min;
+        double ship_volume_max;
+        double max_ship_volume;
+        int max_ships;
+        int close_doors_when_idle;
+        double time_per_ship;
+        double max_head_difference;
+    } zsf_traffic_t;
+
+    typedef struct zsf_operation_event_t {
+        double time;
+        double duration;
+        int routine;
+        int num_ships;
+        double ship_volume;
+        zsf_phase_transports_t transports;
+    } zsf_operation_event_t;
+
+    typedef struct zsf_operation_stats_t {
+        long long num_events;
+        long long num_lockages;
+        long long num_empty_lockages;
+        long long num_ships_lake_to_sea;
+        long long num_ships_sea_to_lake;
+        long long num_ships_waiting;
+        long long num_ships_turned_away;
+        double mean_waiting_time;
+        double max_waiting_time;
+        zsf_phase_transports_t total;
+    } zsf_operation_stats_t;
+
+    typedef struct zsf_surrogate_t zsf_surrogate_t;
+
+    typedef struct zsf_distribution_t {
+        int param;
+        int type;
+        double min;
+        double max;
+        double center;
+        double std_dev;
+    } zsf_distribution_t;
+
+    typedef struct zsf_monte_carlo_stats_t {
+        long long num_samples;
+        long long num_failed;
+        zsf_results_t mean;
+        zsf_results_t std_dev;
+        zsf_results_t min;
+        zsf_results_t max;
+    } zsf_monte_carlo_stats_t;
+
+    typedef struct zsf_monte_carlo_t zsf_monte_carlo_t;
+
+    typedef struct zsf_calibration_param_t {
+        int param;
+        int reserved;
+        double value;
+        double lower;
+        double upper;
+        double std_error;
+    } zsf_calibration_param_t;
+
+    typedef struct zsf_calibration_stats_t {
+        int num_iterations;
+        int num_evaluations;
+        int num_observations;
+        int num_failed;
+        int converged;
+        int reserved;
+        double initial_rms_residual;
+        double rms_residual;
+        double max_abs_residual;
+    } zsf_calibration_stats_t;
+
     int zsf_initialize_state(const zsf_param_t *p, zsf_phase_state_t *state,
                               double salinity_lock, double head_lock);
 
@@ -126,21 +327,205 @@ ffibuilder.cdef(
     int zsf_calc_steady(const zsf_param_t *p, zsf_results_t *results,
                          zsf_aux_results_t *aux_results);
 
+    void zsf_options_default(zsf_options_t *options);
+
+    int zsf_calc_steady_ex(const zsf_param_t *p, const zsf_options_t *options,
+                           zsf_results_t *results,
+                           zsf_aux_results_t *aux_results,
+                           zsf_steady_stats_t *stats);
+
+    int zsf_calc_steady_trace(const zsf_param_t *p, const zsf_options_t *options,
+                              zsf_results_t *results,
+                              zsf_aux_results_t *aux_results,
+                              zsf_steady_stats_t *stats,
+                              zsf_steady_trace_t *trace, int max_trace);
+
+    int zsf_calc_steady_batch(const zsf_param_t *base,
+                              const zsf_param_columns_t *params,
+                              int param_stride,
+                              zsf_results_columns_t *results,
+                              int results_stride, int *errors, int n,
+                              const zsf_options_t *options);
+
+    int zsf_complex_create(const zsf_param_t *chambers, int num_chambers,
+                           zsf_complex_t **complex);
+
+    void zsf_complex_free(zsf_complex_t *complex);
+
+    int zsf_complex_get_state(const zsf_complex_t *complex, int chamber,
+                              zsf_phase_state_t *state);
+
+    int zsf_complex_set_state(zsf_complex_t *complex, int chamber,
+                              const zsf_phase_state_t *state);
+
+    int zsf_complex_run(zsf_complex_t *complex,
+                        const zsf_param_columns_t *params, int param_stride,
+                        const int *routines, const double *durations,
+                        int num_steps, zsf_phase_transports_t *totals,
+                        zsf_phase_transports_t *transports, int *failed_steps,
+                        const zsf_options_t *options);
+
+    void zsf_traffic_default(zsf_traffic_t *traffic);
+
+    int zsf_simulate_operation(const zsf_param_t *p,
+                               const zsf_param_columns_t *boundaries,
+                               int boundary_stride, int num_boundaries,
+                               double boundary_interval,
+                               const zsf_traffic_t *traffic, double duration,
+                               unsigned long long seed, zsf_phase_state_t *state,
+                               zsf_operation_event_t *events, int max_events,
+                               zsf_operation_stats_t *stats,
+                               const zsf_options_t *options);
+
+    int zsf_calc_steady_series(const zsf_param_t *base,
+                               const zsf_param_columns_t *params,
+                               int param_stride,
+                               zsf_results_columns_t *results,
+                               int results_stride, int *errors,
+                               int *num_cycles, int n,
+                               const zsf_options_t *options);
+
+    int zsf_run_lockages(const zsf_param_t *base,
+                         const zsf_param_columns_t *params, int param_stride,
+                         const int *routines, const double *durations, int n,
+                         zsf_phase_state_t *state,
+                         zsf_phase_transports_t *transports,
+                         int *failed_event, const zsf_options_t *options);
+
+    zsf_context_t * zsf_context_create(const zsf_param_t *p);
+
+    void zsf_context_free(zsf_context_t *ctx);
+
+    void zsf_context_set_param(zsf_context_t *ctx, const zsf_param_t *p);
+    void zsf_context_set_accuracy(zsf_context_t *ctx, int accuracy);
+
+    void zsf_context_get_param(const zsf_context_t *ctx, zsf_param_t *p);
+
+    int zsf_context_step_phase_1(const zsf_context_t *ctx, double t_level,
+                                 zsf_phase_state_t *state,
+                                 zsf_phase_transports_t *results);
+
+    int zsf_context_step_phase_2(const zsf_context_t *ctx, double t_open_lake,
+                                 zsf_phase_state_t *state,
+                                 zsf_phase_transports_t *results);
+
+    int zsf_context_step_phase_3(const zsf_context_t *ctx, double t_level,
+                                 zsf_phase_state_t *state,
+                                 zsf_phase_transports_t *results);
+
+    int zsf_context_step_phase_4(const zsf_context_t *ctx, double t_open_sea,
+                                 zsf_phase_state_t *state,
+                                 zsf_phase_transports_t *results);
+
+    int zsf_context_step_flush_doors_closed(const zsf_context_t *ctx,
+                                            double t_flushing,
+                                            zsf_phase_state_t *state,
+                                            zsf_phase_transports_t *results);
+
+    int zsf_context_calc_steady(const zsf_context_t *ctx,
+                                const zsf_options_t *options,
+                                zsf_results_t *results,
+                                zsf_aux_results_t *aux_results,
+                                zsf_steady_stats_t *stats);
+
+    int zsf_param_index(const char *name);
+
+    int zsf_result_index(const char *name);
+
+    int zsf_calc_steady_sensitivities(const zsf_param_t *p, const int *params,
+                                      int num_params,
+                                      const zsf_options_t *options,
+                                      zsf_results_t *results,
+                                      zsf_results_t *sensitivities,
+                                      zsf_steady_stats_t *stats);
+
+    int zsf_calc_steady_inverse(const zsf_param_t *p, int param, double lower,
+                                double upper, int result, double target,
+                                double tolerance, const zsf_options_t *options,
+                                double *value, zsf_results_t *results,
+                                zsf_inverse_stats_t *stats);
+
+    int zsf_calibrate(const zsf_param_t *base,
+                      const zsf_param_columns_t *params, int param_stride,
+                      const double *observed, const double *weights, int n,
+                      zsf_calibration_param_t *fit, int num_fit,
+                      int max_iterations, const zsf_options_t *options,
+                      double *residuals, zsf_calibration_stats_t *stats);
+
+    int zsf_surrogate_create(const zsf_param_t *base,
+                             const zsf_surrogate_axis_t *axes, int num_axes,
+                             int num_checks, const zsf_options_t *options,
+                             zsf_surrogate_t **surrogate);
+
+    void zsf_surrogate_free(zsf_surrogate_t *surrogate);
+
+    int zsf_surrogate_interpolate(const zsf_surrogate_t *surrogate,
+                                  int method, const double *x,
+                                  zsf_results_t *results);
+
+    int zsf_surrogate_max_error(const zsf_surrogate_t *surrogate, int method,
+                                zsf_results_t *max_error);
+
+    int zsf_surrogate_get_axes(const zsf_surrogate_t *surrogate,
+                               zsf_surrogate_axis_t *axes);
+
+    void zsf_surrogate_get_param(const zsf_surrogate_t *surrogate,
+                                 zsf_param_t *p);
+
+    int zsf_surrogate_save(const zsf_surrogate_t *surrogate,
+                           const char *path);
+
+    int zsf_surrogate_load(const char *path, zsf_surrogate_t **surrogate);
+
+    int zsf_sweep(const zsf_param_t *base, const zsf_surrogate_axis_t *axes,
+                  int num_axes, zsf_results_columns_t *results,
+                  int results_stride, int *errors, int *num_cycles,
+                  const zsf_options_t *options);
+
+    int zsf_monte_carlo_create(const zsf_param_t *base,
+                               const zsf_distribution_t *distributions,
+                               int num_distributions, unsigned long long seed,
+                               zsf_monte_carlo_t **monte_carlo);
+
+    void zsf_monte_carlo_free(zsf_monte_carlo_t *monte_carlo);
+
+    int zsf_monte_carlo_run(zsf_monte_carlo_t *monte_carlo, int num_samples,
+                            const zsf_options_t *options);
+
+    void zsf_monte_carlo_get_sample(const zsf_monte_carlo_t *monte_carlo,
+                                    long long index, zsf_param_t *p);
+
+    void zsf_monte_carlo_get_stats(const zsf_monte_carlo_t *monte_carlo,
+                                   zsf_monte_carlo_stats_t *stats);
+
+    int zsf_monte_carlo_quantile(const zsf_monte_carlo_t *monte_carlo,
+                                 double q, zsf_results_t *results);
+
     const char * zsf_error_msg(int code);
 
     const char * zsf_version();
+
+    const char * zsf_cpu_variant();
+
+    int zsf_counters_enabled();
+
+    void zsf_get_counters(zsf_counters_t *counters);
+
+    void zsf_reset_counters();
 """
 )
 
 if os.name == "posix":
     extra_compile_args = []
+    libraries = ["zsf-static", "pthread"]
 else:
     extra_compile_args = ["/MD"]
+    libraries = ["zsf-static"]
 
 ffibuilder.set_source(
     "pyzsf._zsf_cffi",
     '#include "zsf.h"',
-    libraries=["zsf-static"],
+    libraries=libraries,
     define_macros=[("ZSF_STATIC", None), ("Py_LIMITED_API", None)],
     py_limited_api=True,
     extra_compile_args=extra_compile_args,
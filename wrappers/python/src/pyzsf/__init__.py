@@ -1,4 +1,25 @@
-from .pyzsf import ZSFUnsteady, zsf_calc_steady  # noqa: F401
+from .pyzsf import (  # noqa: F401
+    ConvergenceError,
+    ZSFComplex,
+    ZSFMonteCarlo,
+    ZSFSurrogate,
+    ZSFUnsteady,
+    zsf_calc_steady,
+    zsf_calc_steady_array,
+    zsf_calc_steady_batch,
+    zsf_calc_steady_chunked,
+    zsf_calc_steady_inverse,
+    zsf_calc_steady_sensitivities,
+    zsf_calc_steady_series,
+    zsf_calibrate,
+    zsf_counters,
+    zsf_cpu_variant,
+    zsf_param_array,
+    zsf_param_dtype,
+    zsf_reset_counters,
+    zsf_simulate_operation,
+    zsf_sweep,
+)
 from .pyzsf import _zsf_version
 
 __version__ = _zsf_version()
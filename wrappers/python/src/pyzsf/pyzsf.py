@@ -1,4 +1,6 @@
-from typing import Dict
+import os
+from concurrent.futures import ThreadPoolExecutor
+from typing import Dict, List, Optional, Sequence, Tuple
 
 from ._zsf_cffi import ffi, lib
 
@@ -23,19 +25,189 @@ def _zsf_version():
     return ffi.string(lib.zsf_version()).decode("utf-8")
 
 
-def zsf_calc_steady(auxiliary_results: bool = False, **parameters: float) -> Dict[str, float]:
+def zsf_cpu_variant() -> str:
+    """
+    Get the instruction set the calculations run with on this CPU. See also
+    :c:func:`zsf_cpu_variant`.
+    """
+    return ffi.string(lib.zsf_cpu_variant()).decode("utf-8")
+
+
+def zsf_counters() -> Optional[Dict[str, int]]:
+    """
+    Get the process-wide counters of the work of the solvers and the branches
+    taken since the last :func:`zsf_reset_counters`, or None if the library
+    was built without them (``-DUSE_STATS=ON``). See
+    :c:struct:`zsf_counters_t`.
+
+    For the counts of a single calculation, reset the counters before it and
+    get them after it, with no other calculations running at the same time.
+    """
+    if not lib.zsf_counters_enabled():
+        return None
+    counters = ffi.new("zsf_counters_t *")
+    lib.zsf_get_counters(counters)
+    return _struct_to_dict(counters[0])
+
+
+def zsf_reset_counters() -> None:
+    """
+    Set all counters of :func:`zsf_counters` to zero.
+    """
+    lib.zsf_reset_counters()
+
+
+_SOLVERS = {
+    "picard": lib.ZSF_SOLVER_PICARD,
+    "aitken": lib.ZSF_SOLVER_AITKEN,
+}
+
+_INTERPOLATIONS = {
+    "linear": lib.ZSF_INTERPOLATION_LINEAR,
+    "cubic": lib.ZSF_INTERPOLATION_CUBIC,
+}
+
+_DISTRIBUTIONS = {
+    "uniform": lib.ZSF_DISTRIBUTION_UNIFORM,
+    "normal": lib.ZSF_DISTRIBUTION_NORMAL,
+    "triangular": lib.ZSF_DISTRIBUTION_TRIANGULAR,
+}
+
+_ACCURACIES = {
+    "exact": lib.ZSF_ACCURACY_EXACT,
+    "fast": lib.ZSF_ACCURACY_FAST,
+    "fastest": lib.ZSF_ACCURACY_FASTEST,
+}
+
+
+def _zsf_accuracy(accuracy: str) -> int:
+    if accuracy not in _ACCURACIES:
+        raise ValueError(f"No such accuracy '{accuracy}'")
+    return _ACCURACIES[accuracy]
+
+
+def _zsf_options(
+    solver: str = "picard",
+    max_cycles: int = 0,
+    max_time: float = 0.0,
+    num_threads: int = 1,
+    accuracy: str = "exact",
+):
+    if solver not in _SOLVERS:
+        raise ValueError(f"No such solver '{solver}'")
+
+    options_t = ffi.new("zsf_options_t *")
+    lib.zsf_options_default(options_t)
+    options_t.solver = _SOLVERS[solver]
+    options_t.max_cycles = max_cycles
+    options_t.max_time = max_time
+    options_t.num_threads = num_threads
+    options_t.accuracy = _zsf_accuracy(accuracy)
+
+    return options_t
+
+
+def _zsf_param_columns(columns: Dict[str, Sequence[float]], param_names):
+    for p in columns:
+        if p not in param_names:
+            raise TypeError(f"No such parameter '{p}'")
+
+    # The arrays have to be kept alive as long as the columns are used
+    param_columns_t = ffi.new("zsf_param_columns_t *")
+    param_arrays = {p: ffi.new("double[]", list(v)) for p, v in columns.items()}
+    for p, a in param_arrays.items():
+        setattr(param_columns_t, p, a)
+
+    return param_columns_t, param_arrays
+
+
+def _zsf_batch_param(columns: Dict[str, Sequence[float]], parameters: Dict[str, float]):
+    param_t = ffi.new("zsf_param_t *")
+
+    # Check input parameters
+    param_names = set(dir(param_t))
+    for p in parameters:
+        if p not in param_names:
+            raise TypeError(f"No such parameter '{p}'")
+
+    lengths = {len(v) for v in columns.values()}
+    if len(lengths) > 1:
+        raise ValueError("All columns should have the same length")
+    n = lengths.pop() if lengths else 1
+
+    # Set default and parameter values shared by all rows
+    lib.zsf_param_default(param_t)
+
+    for p, v in parameters.items():
+        setattr(param_t, p, v)
+
+    param_columns_t, param_arrays = _zsf_param_columns(columns, param_names)
+
+    return param_t, param_columns_t, param_arrays, n
+
+
+def _zsf_results_columns(n: int):
+    results_columns_t = ffi.new("zsf_results_columns_t *")
+    results_arrays = {r: ffi.new("double[]", n) for r in dir(results_columns_t)}
+    for r, a in results_arrays.items():
+        a[0:n] = [float("nan")] * n
+        setattr(results_columns_t, r, a)
+
+    return results_columns_t, results_arrays
+
+
+class ConvergenceError(RuntimeError):
+    """
+    The steady state (or calibration) did not converge within the bounds of
+    the solver. The best estimate is available in the ``results`` attribute,
+    in the same format as the return value of the function that raised it.
+    """
+
+    def __init__(self, message: str, results: Dict[str, float]):
+        super().__init__(message)
+        self.results = results
+
+
+def zsf_calc_steady(
+    auxiliary_results: bool = False,
+    solver: str = "picard",
+    max_cycles: int = 0,
+    max_time: float = 0.0,
+    statistics: bool = False,
+    accuracy: str = "exact",
+    trace: int = 0,
+    **parameters: float,
+) -> Dict[str, float]:
     """
     Calculate the salt intrusion for a set of parameters, assuming steady
     operation.
 
     :param auxiliary_results: Whether or not to calculate and output auxiliary
         results. See :c:struct:`zsf_aux_results_t`.
+    :param solver: The solver for the steady state, either ``"picard"`` or
+        ``"aitken"``. See also :c:member:`zsf_options_t.solver`.
+    :param max_cycles: The maximum number of cycles to simulate, where 0 means
+        no limit. See also :c:member:`zsf_options_t.max_cycles`.
+    :param max_time: The maximum time in seconds the solver may take, where 0
+        means no limit. See also :c:member:`zsf_options_t.max_time`.
+    :param statistics: Whether or not to output the statistics of the solver
+        in the ``statistics`` entry. See :c:struct:`zsf_steady_stats_t`.
+    :param accuracy: The accuracy of the transcendental functions, either
+        ``"exact"``, ``"fast"`` or ``"fastest"``. See also
+        :c:member:`zsf_options_t.accuracy`.
+    :param trace: The number of cycles of the solver to output in the
+        ``trace`` entry, i.e. the last ones of the solve. The trace is a
+        dictionary of lists, one entry per cycle, of the fields of
+        :c:struct:`zsf_steady_trace_t`. See also :c:func:`zsf_calc_steady_trace`.
     :param kwargs: Any parameters that should be changed versus the default.
         See also :c:struct:`zsf_param_t` for an overview of the parameters.
 
     :returns: A dictionary containing the cycle averaged salt fluxes and
         discharges (see :c:struct:`zsf_results_t`). Also outputs values in
         :c:struct:`zsf_aux_results_t` if ``auxiliary_results`` is `True`.
+
+    :raises ConvergenceError: If the solver did not converge within its
+        bounds. The best estimate is attached to the exception.
     """
     param_t = ffi.new("zsf_param_t *")
 
@@ -60,13 +232,696 @@ def zsf_calc_steady(auxiliary_results: bool = False, **parameters: float) -> Dic
         aux_results_t = ffi.NULL
         assert len(dir(aux_results_t)) == 0
 
-    err = lib.zsf_calc_steady(param_t, results_t, aux_results_t)
+    options_t = _zsf_options(solver, max_cycles, max_time, accuracy=accuracy)
+    stats_t = ffi.new("zsf_steady_stats_t *")
 
-    if err:
+    if trace > 0:
+        trace_t = ffi.new("zsf_steady_trace_t[]", trace)
+        err = lib.zsf_calc_steady_trace(
+            param_t, options_t, results_t, aux_results_t, stats_t, trace_t, trace
+        )
+    else:
+        err = lib.zsf_calc_steady_ex(param_t, options_t, results_t, aux_results_t, stats_t)
+
+    # Errors before the first cycle leave us without any results
+    if err and stats_t.num_cycles == 0:
         raise RuntimeError(_zsf_error_message(err))
 
     # Reformat results into a dictionary and return
-    return {**_struct_to_dict(results_t), **_struct_to_dict(aux_results_t)}
+    results = {**_struct_to_dict(results_t), **_struct_to_dict(aux_results_t)}
+    if statistics:
+        results["statistics"] = _struct_to_dict(stats_t)
+    if trace > 0:
+        # The ring buffer in order of the cycles
+        num_cycles = stats_t.num_cycles
+        first = max(num_cycles - trace, 0)
+        cycles = [trace_t[k % trace] for k in range(first, num_cycles)]
+        results["trace"] = {name: [getattr(c, name) for c in cycles] for name in dir(trace_t[0])}
+
+    if err:
+        raise ConvergenceError(_zsf_error_message(err), results)
+
+    return results
+
+
+def zsf_calc_steady_sensitivities(
+    wrt: Sequence[str],
+    solver: str = "picard",
+    max_cycles: int = 0,
+    max_time: float = 0.0,
+    statistics: bool = False,
+    accuracy: str = "exact",
+    **parameters: float,
+) -> Dict[str, float]:
+    """
+    Calculate the salt intrusion assuming steady operation, like
+    :func:`zsf_calc_steady`, together with the derivatives of the results with
+    respect to some of the parameters. This costs about one solve, instead of
+    two solves per parameter for finite differences of
+    :func:`zsf_calc_steady`. See also :c:func:`zsf_calc_steady_sensitivities`.
+
+    :param wrt: The names of the parameters to differentiate with respect to.
+    :param solver: The solver for the steady state, see :func:`zsf_calc_steady`.
+    :param max_cycles: The maximum number of cycles, see :func:`zsf_calc_steady`.
+    :param max_time: The maximum time in seconds, see :func:`zsf_calc_steady`.
+    :param statistics: Whether or not to output the statistics of the solver,
+        see :func:`zsf_calc_steady`.
+    :param accuracy: The accuracy of the transcendental functions, see :func:`zsf_calc_steady`.
+    :param parameters: Any parameters that should be changed versus the default.
+
+    :returns: The results of :func:`zsf_calc_steady`, with an additional
+        ``sensitivities`` entry. This is a dictionary of parameter names (of
+        ``wrt``) to dictionaries of the derivatives of the results.
+
+    :raises ConvergenceError: If the solver did not converge within its
+        bounds, in which case there are no sensitivities.
+    """
+    param_t = ffi.new("zsf_param_t *")
+
+    param_names = set(dir(param_t))
+    for p in list(parameters) + list(wrt):
+        if p not in param_names:
+            raise TypeError(f"No such parameter '{p}'")
+
+    lib.zsf_param_default(param_t)
+
+    for p, v in parameters.items():
+        setattr(param_t, p, v)
+
+    params = ffi.new("int[]", [lib.zsf_param_index(p.encode()) for p in wrt])
+    results_t = ffi.new("zsf_results_t *")
+    sensitivities_t = ffi.new("zsf_results_t[]", len(wrt))
+    options_t = _zsf_options(solver, max_cycles, max_time, accuracy=accuracy)
+    stats_t = ffi.new("zsf_steady_stats_t *")
+
+    err = lib.zsf_calc_steady_sensitivities(
+        param_t, params, len(wrt), options_t, results_t, sensitivities_t, stats_t
+    )
+
+    # Errors before the first cycle leave us without any results
+    if err and stats_t.num_cycles == 0:
+        raise RuntimeError(_zsf_error_message(err))
+
+    results = _struct_to_dict(results_t)
+    if statistics:
+        results["statistics"] = _struct_to_dict(stats_t)
+
+    if err:
+        raise ConvergenceError(_zsf_error_message(err), results)
+
+    results["sensitivities"] = {p: _struct_to_dict(sensitivities_t[j]) for j, p in enumerate(wrt)}
+
+    return results
+
+
+def zsf_calc_steady_inverse(
+    param: str,
+    bounds: Tuple[float, float],
+    result: str,
+    target: float,
+    tolerance: float = 0.0,
+    solver: str = "picard",
+    max_cycles: int = 0,
+    max_time: float = 0.0,
+    statistics: bool = False,
+    accuracy: str = "exact",
+    **parameters: float,
+) -> Dict[str, float]:
+    """
+    Find the value of a parameter for which a result hits a target, assuming
+    steady operation. For example, the flushing discharge that keeps the salt
+    load to the lake at a given value. See also
+    :c:func:`zsf_calc_steady_inverse`.
+
+    :param param: The name of the parameter to solve for.
+    :param bounds: The lower and upper bound of the parameter. The target
+        should be between the results at the bounds.
+    :param result: The name of the result, see :c:struct:`zsf_results_t`.
+    :param target: The target value of the result.
+    :param tolerance: The absolute tolerance on the result, where 0 means to
+        solve as accurately as the steady state itself allows.
+    :param solver: The solver for the steady state, see :func:`zsf_calc_steady`.
+    :param max_cycles: The maximum number of cycles per probe, see :func:`zsf_calc_steady`.
+    :param max_time: The maximum time per probe in seconds, see :func:`zsf_calc_steady`.
+    :param statistics: Whether or not to output the statistics of the inverse
+        solve in the ``statistics`` entry. See :c:struct:`zsf_inverse_stats_t`.
+    :param accuracy: The accuracy of the transcendental functions, see :func:`zsf_calc_steady`.
+    :param parameters: Any other parameters that should be changed versus the default.
+
+    :returns: The results of :func:`zsf_calc_steady` at the solution, with
+        the value of the parameter in the ``value`` entry.
+    """
+    param_t = ffi.new("zsf_param_t *")
+
+    param_names = set(dir(param_t))
+    for p in list(parameters) + [param]:
+        if p not in param_names:
+            raise TypeError(f"No such parameter '{p}'")
+    if param in parameters:
+        raise TypeError(f"Parameter '{param}' is both solved for and fixed")
+    if result not in dir(ffi.new("zsf_results_t *")):
+        raise TypeError(f"No such result '{result}'")
+
+    lib.zsf_param_default(param_t)
+
+    for p, v in parameters.items():
+        setattr(param_t, p, v)
+
+    value = ffi.new("double *")
+    results_t = ffi.new("zsf_results_t *")
+    options_t = _zsf_options(solver, max_cycles, max_time, accuracy=accuracy)
+    stats_t = ffi.new("zsf_inverse_stats_t *")
+
+    err = lib.zsf_calc_steady_inverse(
+        param_t,
+        lib.zsf_param_index(param.encode()),
+        bounds[0],
+        bounds[1],
+        lib.zsf_result_index(result.encode()),
+        target,
+        tolerance,
+        options_t,
+        value,
+        results_t,
+        stats_t,
+    )
+    if err:
+        raise RuntimeError(_zsf_error_message(err))
+
+    results = {**_struct_to_dict(results_t), "value": value[0]}
+    if statistics:
+        results["statistics"] = _struct_to_dict(stats_t)
+
+    return results
+
+
+def zsf_calc_steady_batch(
+    columns: Dict[str, Sequence[float]],
+    num_threads: int = 1,
+    solver: str = "picard",
+    max_cycles: int = 0,
+    max_time: float = 0.0,
+    accuracy: str = "exact",
+    **parameters: float,
+) -> Dict[str, List[float]]:
+    """
+    Calculate the salt intrusion for many sets of parameters at once, assuming
+    steady operation. See also :c:func:`zsf_calc_steady_batch`.
+
+    :param columns: A dictionary of parameter names to sequences of values,
+        one value per row. All sequences should have the same length.
+    :param num_threads: The number of threads, where 0 means one per core.
+    :param solver: The solver for the steady state, see :func:`zsf_calc_steady`.
+    :param max_cycles: The maximum number of cycles per row, see :func:`zsf_calc_steady`.
+    :param max_time: The maximum time per row in seconds, see :func:`zsf_calc_steady`.
+    :param accuracy: The accuracy of the transcendental functions, see :func:`zsf_calc_steady`.
+    :param parameters: Any parameters that should be changed versus the
+        default, and that are the same for all rows.
+
+    :returns: A dictionary of result names to lists of values, one value per
+        row (see :c:struct:`zsf_results_t`). The ``error`` entry contains the
+        error code of every row. The results of rows that did not converge are
+        the best estimate, and those of other failed rows are NaN.
+    """
+    param_t, param_columns_t, param_arrays, n = _zsf_batch_param(columns, parameters)
+    results_columns_t, results_arrays = _zsf_results_columns(n)
+
+    errors = ffi.new("int[]", n)
+
+    options_t = _zsf_options(solver, max_cycles, max_time, num_threads, accuracy)
+
+    lib.zsf_calc_steady_batch(
+        param_t, param_columns_t, 1, results_columns_t, 1, errors, n, options_t
+    )
+
+    return {**{r: list(a) for r, a in results_arrays.items()}, "error": list(errors)}
+
+
+def zsf_calc_steady_series(
+    columns: Dict[str, Sequence[float]],
+    solver: str = "picard",
+    max_cycles: int = 0,
+    max_time: float = 0.0,
+    accuracy: str = "exact",
+    **parameters: float,
+) -> Dict[str, List[float]]:
+    """
+    Calculate the salt intrusion for a time series of slowly varying boundary
+    conditions, assuming steady operation during every step. Every step starts
+    from the converged lock salinity of the previous step, which needs far
+    fewer cycles than starting from scratch. See also
+    :c:func:`zsf_calc_steady_series`.
+
+    :param columns: A dictionary of parameter names to sequences of values,
+        one value per step. All sequences should have the same length.
+    :param solver: The solver for the steady state, see :func:`zsf_calc_steady`.
+    :param max_cycles: The maximum number of cycles per step, see :func:`zsf_calc_steady`.
+    :param max_time: The maximum time per step in seconds, see :func:`zsf_calc_steady`.
+    :param accuracy: The accuracy of the transcendental functions, see :func:`zsf_calc_steady`.
+    :param parameters: Any parameters that should be changed versus the
+        default, and that are the same for all steps.
+
+    :returns: A dictionary of result names to lists of values, one value per
+        step, like :func:`zsf_calc_steady_batch`. The ``num_cycles`` entry
+        contains the number of cycles every step needed to converge.
+    """
+    param_t, param_columns_t, param_arrays, n = _zsf_batch_param(columns, parameters)
+    results_columns_t, results_arrays = _zsf_results_columns(n)
+
+    errors = ffi.new("int[]", n)
+    num_cycles = ffi.new("int[]", n)
+
+    options_t = _zsf_options(solver, max_cycles, max_time, 1, accuracy)
+
+    lib.zsf_calc_steady_series(
+        param_t, param_columns_t, 1, results_columns_t, 1, errors, num_cycles, n, options_t
+    )
+
+    return {
+        **{r: list(a) for r, a in results_arrays.items()},
+        "error": list(errors),
+        "num_cycles": list(num_cycles),
+    }
+
+
+def zsf_calibrate(
+    columns: Dict[str, Sequence[float]],
+    observed: Sequence[float],
+    fit: Dict[str, float],
+    bounds: Optional[Dict[str, Tuple[float, float]]] = None,
+    weights: Optional[Sequence[float]] = None,
+    max_iterations: int = 100,
+    num_threads: int = 1,
+    solver: str = "picard",
+    max_cycles: int = 0,
+    max_time: float = 0.0,
+    accuracy: str = "exact",
+    **parameters: float,
+) -> Dict:
+    """
+    Fit parameters like the calibration coefficient and the density current
+    factors to observed salt loads, by minimizing the sum of squared
+    residuals. The observations are evaluated in parallel, and the Jacobian
+    comes from the sensitivities (see :func:`zsf_calc_steady_sensitivities`).
+    See also :c:func:`zsf_calibrate`.
+
+    :param columns: A dictionary of parameter names to sequences of values,
+        one value per observation, like :func:`zsf_calc_steady_batch`.
+    :param observed: The observed salt load to the lake of every observation,
+        see :c:member:`zsf_results_t.salt_load_lake`.
+    :param fit: A dictionary of the names of the parameters to fit to their
+        initial values.
+    :param bounds: A dictionary of parameter names (of ``fit``) to their lower
+        and upper bounds. Parameters without bounds are unbounded.
+    :param weights: The weight of the residual of every observation, e.g. one
+        over its standard deviation. By default all weights are one.
+    :param max_iterations: The maximum number of iterations.
+    :param num_threads: The number of threads, where 0 means one per core.
+    :param solver: The solver for the steady state, see :func:`zsf_calc_steady`.
+    :param max_cycles: The maximum number of cycles per observation, see :func:`zsf_calc_steady`.
+    :param max_time: The maximum time per observation in seconds, see :func:`zsf_calc_steady`.
+    :param accuracy: The accuracy of the transcendental functions, see :func:`zsf_calc_steady`.
+    :param parameters: Any parameters that should be changed versus the
+        default, and that are the same for all observations.
+
+    :returns: A dictionary with the fitted ``values`` and their
+        ``std_errors`` (dictionaries of parameter names to values), the
+        ``residuals`` (modelled minus observed salt loads, NaN for observations
+        that failed) and the ``statistics`` (see
+        :c:struct:`zsf_calibration_stats_t`). Observations that fail at the
+        initial values are left out of the fit.
+
+    :raises ConvergenceError: If the calibration did not converge within
+        ``max_iterations``. The best fit is attached to the exception.
+    """
+    param_t, param_columns_t, param_arrays, n = _zsf_batch_param(columns, parameters)
+
+    if len(observed) != n or (weights is not None and len(weights) != n):
+        raise ValueError("The observations should have the same length as the columns")
+
+    bounds = bounds or {}
+    param_names = set(dir(param_t))
+    for p in list(fit) + list(bounds):
+        if p not in param_names:
+            raise TypeError(f"No such parameter '{p}'")
+        if p not in fit:
+            raise ValueError(f"Bounds of parameter '{p}' that is not fitted")
+
+    fit_t = ffi.new("zsf_calibration_param_t[]", len(fit))
+    for k, (p, v) in enumerate(fit.items()):
+        fit_t[k].param = lib.zsf_param_index(p.encode())
+        fit_t[k].value = v
+        fit_t[k].lower, fit_t[k].upper = bounds.get(p, (-float("inf"), float("inf")))
+
+    observed_t = ffi.new("double[]", list(observed))
+    weights_t = ffi.NULL if weights is None else ffi.new("double[]", list(weights))
+    residuals = ffi.new("double[]", [float("nan")] * n)
+    options_t = _zsf_options(solver, max_cycles, max_time, num_threads, accuracy)
+    stats_t = ffi.new("zsf_calibration_stats_t *")
+
+    err = lib.zsf_calibrate(
+        param_t,
+        param_columns_t,
+        1,
+        observed_t,
+        weights_t,
+        n,
+        fit_t,
+        len(fit),
+        max_iterations,
+        options_t,
+        residuals,
+        stats_t,
+    )
+
+    # Observations that fail are left out, unless all of them do
+    if stats_t.num_observations == 0:
+        raise RuntimeError(_zsf_error_message(err))
+
+    results = {
+        "values": {p: fit_t[k].value for k, p in enumerate(fit)},
+        "std_errors": {p: fit_t[k].std_error for k, p in enumerate(fit)},
+        "residuals": list(residuals),
+        "statistics": _struct_to_dict(stats_t),
+    }
+
+    if not stats_t.converged:
+        raise ConvergenceError(_zsf_error_message(err), results)
+
+    return results
+
+
+def _numpy():
+    # NumPy is only needed for the array interface
+    import numpy as np
+
+    return np
+
+
+def _zsf_struct_dtype(ctype: str):
+    np = _numpy()
+
+    fields = ffi.typeof(ctype).fields
+    assert all(f.type.cname == "double" for _, f in fields)
+
+    return np.dtype(
+        {
+            "names": [k for k, _ in fields],
+            "formats": [np.float64] * len(fields),
+            "offsets": [f.offset for _, f in fields],
+            "itemsize": ffi.sizeof(ctype),
+        }
+    )
+
+
+def zsf_param_dtype():
+    """
+    The NumPy dtype with the same layout as :c:struct:`zsf_param_t`.
+    """
+    return _zsf_struct_dtype("zsf_param_t")
+
+
+def zsf_param_array(n: int, **parameters: float):
+    """
+    Create a structured array for :func:`zsf_calc_steady_array` with the
+    layout of :c:struct:`zsf_param_t`.
+
+    :param n: The number of rows.
+    :param parameters: Any parameters that should be changed versus the
+        default for all rows.
+
+    :returns: A structured array of ``n`` rows of (default) parameters.
+    """
+    np = _numpy()
+
+    param_t = ffi.new("zsf_param_t *")
+    param_names = set(dir(param_t))
+    for p in parameters:
+        if p not in param_names:
+            raise TypeError(f"No such parameter '{p}'")
+
+    lib.zsf_param_default(param_t)
+    for p, v in parameters.items():
+        setattr(param_t, p, v)
+
+    dtype = zsf_param_dtype()
+    params = np.empty(n, dtype=dtype)
+    params[:] = np.frombuffer(ffi.buffer(param_t), dtype=dtype)[0]
+
+    return params
+
+
+def _zsf_results_view(results, offsets):
+    # Columns pointing into the buffer of an array, at the byte offsets of the
+    # results in the order of zsf_results_t
+    results_names = [k for k, _ in ffi.typeof("zsf_results_t").fields]
+    results_columns_t = ffi.new("zsf_results_columns_t *")
+
+    results_address = results.__array_interface__["data"][0]
+    for r, offset in zip(results_names, offsets):
+        setattr(results_columns_t, r, ffi.cast("double *", results_address + offset))
+
+    return results_columns_t
+
+
+def _zsf_results_array(shape):
+    # A structured array of results (NaN) with an additional error field
+    np = _numpy()
+
+    dtype = _zsf_struct_dtype("zsf_results_t")
+    dtype = np.dtype(
+        {
+            "names": [*dtype.names, "error"],
+            "formats": [*[np.float64] * len(dtype.names), np.intc],
+            "offsets": [*[dtype.fields[k][1] for k in dtype.names], dtype.itemsize],
+            "itemsize": dtype.itemsize + 8,
+        }
+    )
+    results = np.empty(shape, dtype=dtype)
+    for r in dtype.names[:-1]:
+        results[r] = np.nan
+
+    results_columns_t = _zsf_results_view(results, [dtype.fields[r][1] for r in dtype.names[:-1]])
+    return results, results_columns_t, dtype.itemsize // 8
+
+
+def zsf_calc_steady_array(
+    params,
+    num_threads: int = 1,
+    solver: str = "picard",
+    max_cycles: int = 0,
+    max_time: float = 0.0,
+    accuracy: str = "exact",
+    as_columns: bool = False,
+    **parameters: float,
+):
+    """
+    Calculate the salt intrusion for the rows of a NumPy structured array,
+    assuming steady operation. Unlike :func:`zsf_calc_steady_batch`, the
+    parameters are read from the buffer of the array and the results are
+    written to a new array without conversion. See also
+    :c:func:`zsf_calc_steady_batch`.
+
+    :param params: A one-dimensional structured array, of which every field
+        is a parameter of type float64. This can be an array created with
+        :func:`zsf_param_array`, but also one with only the parameters that
+        vary. The array is copied if it is not aligned or its stride is not
+        positive.
+    :param num_threads: The number of threads, where 0 means one per core.
+    :param solver: The solver for the steady state, see :func:`zsf_calc_steady`.
+    :param max_cycles: The maximum number of cycles per row, see :func:`zsf_calc_steady`.
+    :param max_time: The maximum time per row in seconds, see :func:`zsf_calc_steady`.
+    :param accuracy: The accuracy of the transcendental functions, see :func:`zsf_calc_steady`.
+    :param as_columns: Whether to return a dictionary of one array per result
+        instead of a structured array.
+    :param parameters: Any parameters that are not fields of ``params``, and
+        should be changed versus the default for all rows.
+
+    :returns: A structured array with the layout of :c:struct:`zsf_results_t`
+        and an additional ``error`` field, or a dictionary of arrays if
+        ``as_columns`` is `True`. The results of rows that did not converge
+        are the best estimate, and those of other failed rows are NaN.
+    """
+    np = _numpy()
+
+    if params.ndim != 1 or params.dtype.names is None:
+        raise TypeError("The parameters should be a one-dimensional structured array")
+
+    param_t = ffi.new("zsf_param_t *")
+
+    # Check input parameters
+    param_names = set(dir(param_t))
+    for p in (*params.dtype.names, *parameters):
+        if p not in param_names:
+            raise TypeError(f"No such parameter '{p}'")
+    for p in params.dtype.names:
+        if params.dtype.fields[p][0] != np.float64:
+            raise TypeError(f"Parameter '{p}' should be of type float64")
+        if p in parameters:
+            raise TypeError(f"Parameter '{p}' is both a field and a keyword argument")
+
+    # Set default and parameter values shared by all rows
+    lib.zsf_param_default(param_t)
+
+    for p, v in parameters.items():
+        setattr(param_t, p, v)
+
+    # All fields share the stride of the array, which has to be a positive
+    # whole number of doubles
+    n = len(params)
+    if not params.flags.aligned or params.strides[0] <= 0 or params.strides[0] % 8 != 0:
+        packed = np.empty(n, dtype=[(p, np.float64) for p in params.dtype.names])
+        for p in params.dtype.names:
+            packed[p] = params[p]
+        params = packed
+
+    params_address = params.__array_interface__["data"][0]
+    param_columns_t = ffi.new("zsf_param_columns_t *")
+    for p in params.dtype.names:
+        offset = params.dtype.fields[p][1]
+        setattr(param_columns_t, p, ffi.cast("double *", params_address + offset))
+
+    # The results are written straight into a structured array, or into the
+    # rows of a two-dimensional array
+    results_names = [k for k, _ in ffi.typeof("zsf_results_t").fields]
+
+    if as_columns:
+        results = np.full((len(results_names), n), np.nan)
+        results_columns_t = _zsf_results_view(
+            results, [i * results.strides[0] for i in range(len(results_names))]
+        )
+        results_stride = 1
+    else:
+        results, results_columns_t, results_stride = _zsf_results_array(n)
+
+    errors = np.zeros(n, dtype=np.intc)
+    errors_t = ffi.cast("int *", errors.__array_interface__["data"][0])
+
+    options_t = _zsf_options(solver, max_cycles, max_time, num_threads, accuracy)
+
+    lib.zsf_calc_steady_batch(
+        param_t,
+        param_columns_t,
+        params.strides[0] // 8,
+        results_columns_t,
+        results_stride,
+        errors_t,
+        n,
+        options_t,
+    )
+
+    if as_columns:
+        return {**dict(zip(results_names, results)), "error": errors}
+    else:
+        results["error"] = errors
+        return results
+
+
+def zsf_calc_steady_chunked(params, executor=None, chunk_size: int = 1024, **kwargs):
+    """
+    Like :func:`zsf_calc_steady_array`, but split into chunks of rows that are
+    submitted to a :mod:`concurrent.futures` executor. The calls to the
+    library do not hold the GIL, so a thread pool that is shared with other
+    work in the same process is enough to use multiple cores.
+
+    :param params: A one-dimensional structured array, see
+        :func:`zsf_calc_steady_array`.
+    :param executor: The executor to submit the chunks to. If `None`, a
+        :class:`~concurrent.futures.ThreadPoolExecutor` is created for the
+        duration of the call.
+    :param chunk_size: The number of rows per chunk.
+    :param kwargs: Any other arguments of :func:`zsf_calc_steady_array`.
+
+    :returns: The same as :func:`zsf_calc_steady_array`.
+    """
+    np = _numpy()
+
+    if executor is None:
+        with ThreadPoolExecutor() as executor:
+            return zsf_calc_steady_chunked(params, executor, chunk_size, **kwargs)
+
+    # The chunks are views, so the parameters are not copied
+    futures = [
+        executor.submit(zsf_calc_steady_array, params[i : i + chunk_size], **kwargs)
+        for i in range(0, len(params), chunk_size)
+    ]
+    chunks = [f.result() for f in futures]
+
+    if not chunks:
+        return zsf_calc_steady_array(params, **kwargs)
+    elif isinstance(chunks[0], dict):
+        return {k: np.concatenate([c[k] for c in chunks]) for k in chunks[0]}
+    else:
+        return np.concatenate(chunks)
+
+
+def zsf_sweep(
+    axes: Dict[str, Tuple[float, float, int]],
+    num_threads: int = 1,
+    solver: str = "picard",
+    max_cycles: int = 0,
+    max_time: float = 0.0,
+    accuracy: str = "exact",
+    **parameters: float,
+):
+    """
+    Calculate the steady state on every point of a grid over a few
+    parameters, e.g. for a design study. Every point starts from the lock
+    salinity of a neighbouring point, which saves most of the cycles of
+    solving the points independently. See also :c:func:`zsf_sweep`.
+
+    :param axes: A dictionary of parameter names to ``(min, max, num_points)``
+        tuples, of at most 8 parameters, like :class:`ZSFSurrogate`.
+    :param num_threads: The number of threads, where 0 means one per core.
+    :param solver: The solver for the steady state, see :func:`zsf_calc_steady`.
+    :param max_cycles: The maximum number of cycles per grid point, see :func:`zsf_calc_steady`.
+    :param max_time: The maximum time per grid point in seconds, see :func:`zsf_calc_steady`.
+    :param accuracy: The accuracy of the transcendental functions, see :func:`zsf_calc_steady`.
+    :param parameters: Any parameters that should be changed versus the
+        default, and that are the same for all grid points.
+
+    :returns: A structured array like that of :func:`zsf_calc_steady_array`,
+        with one dimension per axis in the order of ``axes``.
+    """
+    np = _numpy()
+
+    param_t = ffi.new("zsf_param_t *")
+    lib.zsf_param_default(param_t)
+
+    param_names = set(dir(param_t))
+    for p, v in parameters.items():
+        if p not in param_names:
+            raise TypeError(f"No such parameter '{p}'")
+        setattr(param_t, p, v)
+
+    axes_t = ffi.new("zsf_surrogate_axis_t[]", len(axes))
+    for a, (p, (lo, hi, num_points)) in enumerate(axes.items()):
+        if p not in param_names:
+            raise TypeError(f"No such parameter '{p}'")
+        if p in parameters:
+            raise TypeError(f"Parameter '{p}' is both an axis and fixed")
+        axes_t[a].param = lib.zsf_param_index(p.encode())
+        axes_t[a].min = lo
+        axes_t[a].max = hi
+        axes_t[a].num_points = num_points
+
+    shape = tuple(num_points for _, _, num_points in axes.values())
+    results, results_columns_t, results_stride = _zsf_results_array(shape)
+
+    errors = np.zeros(shape, dtype=np.intc)
+    errors_t = ffi.cast("int *", errors.__array_interface__["data"][0])
+
+    options_t = _zsf_options(solver, max_cycles, max_time, num_threads, accuracy)
+
+    err = lib.zsf_sweep(
+        param_t, axes_t, len(axes), results_columns_t, results_stride, errors_t, ffi.NULL, options_t
+    )
+    # Failed grid points have their error code, invalid axes fail them all
+    if err and not np.any(errors):
+        raise ValueError(_zsf_error_message(err))
+
+    results["error"] = errors
+    return results
 
 
 class ZSFUnsteady:
@@ -74,7 +929,7 @@ class ZSFUnsteady:
     A class to calculate a lock in phase-wise fashion.
     """
 
-    def __init__(self, sal_lock, head_lock, **parameters: float):
+    def __init__(self, sal_lock, head_lock, accuracy: str = "exact", **parameters: float):
 
         self._param_t = ffi.new("zsf_param_t *")
         self._state_t = ffi.new("zsf_phase_state_t *")
@@ -87,6 +942,14 @@ class ZSFUnsteady:
         # Set default values
         lib.zsf_param_default(self._param_t)
 
+        # The context keeps the derived parameters between steps
+        self._ctx = ffi.gc(lib.zsf_context_create(self._param_t), lib.zsf_context_free)
+        if self._ctx == ffi.NULL:
+            raise MemoryError("Could not create zsf context")
+
+        self._accuracy = accuracy
+        lib.zsf_context_set_accuracy(self._ctx, _zsf_accuracy(accuracy))
+
         # Set user parameters
         self._set_parameters(**parameters)
 
@@ -100,6 +963,68 @@ class ZSFUnsteady:
             else:
                 setattr(self._param_t, p, v)
 
+        if parameters:
+            lib.zsf_context_set_param(self._ctx, self._param_t)
+
+    def run_lockages(
+        self,
+        routines: Sequence[int],
+        durations: Sequence[float],
+        columns: Optional[Dict[str, Sequence[float]]] = None,
+    ) -> Dict[str, List[float]]:
+        """
+        Step through many lockage events at once, which is much faster than
+        calling the ``step_*`` methods one event at a time. See also
+        :c:func:`zsf_run_lockages`.
+
+        :param routines: The routine of every event: 1 to 4 for the phases of
+            :meth:`step_phase_1` to :meth:`step_phase_4`, -2 or -4 for
+            :meth:`step_flush_doors_closed` on lake or sea side, and 0 for
+            doing nothing.
+        :param durations: The duration of every event in seconds, i.e. the
+            leveling time, the time the door is open, or the flushing time.
+        :param columns: A dictionary of parameter names to sequences of
+            values, one value per event. Unlike the parameters of the
+            ``step_*`` methods, these changes do not persist.
+
+        :returns: A dictionary of transport names to lists of values, one
+            value per event. See also :c:struct:`zsf_phase_transports_t`.
+
+        :raises RuntimeError: If an event fails. The state is then that
+            before the failing event.
+        """
+        columns = {} if columns is None else columns
+
+        n = len(routines)
+        if len(durations) != n or any(len(v) != n for v in columns.values()):
+            raise ValueError("All sequences should have the same length as routines")
+
+        param_columns_t, param_arrays = _zsf_param_columns(columns, self._param_t_names)
+        routines_t = ffi.new("int[]", list(routines))
+        durations_t = ffi.new("double[]", list(durations))
+        transports_t = ffi.new("zsf_phase_transports_t[]", n)
+        failed_event = ffi.new("int *")
+
+        options_t = _zsf_options(accuracy=self._accuracy)
+
+        err = lib.zsf_run_lockages(
+            self._param_t,
+            param_columns_t,
+            1,
+            routines_t,
+            durations_t,
+            n,
+            self._state_t,
+            transports_t,
+            failed_event,
+            options_t,
+        )
+        if err:
+            raise RuntimeError(f"Event {failed_event[0]}: {_zsf_error_message(err)}")
+
+        names = dir(self._results_t)
+        return {k: [getattr(transports_t[i], k) for i in range(n)] for k in names}
+
     def step_phase_1(self, t_level, **parameters: float) -> Dict[str, float]:
         """
         Level the lock to lake side. See also :c:func:`zsf_step_phase_1` .
@@ -114,7 +1039,7 @@ class ZSFUnsteady:
 
         self._set_parameters(**parameters)
 
-        err = lib.zsf_step_phase_1(self._param_t, t_level, self._state_t, self._results_t)
+        err = lib.zsf_context_step_phase_1(self._ctx, t_level, self._state_t, self._results_t)
         if err:
             raise RuntimeError(_zsf_error_message(err))
 
@@ -136,7 +1061,7 @@ class ZSFUnsteady:
 
         self._set_parameters(**parameters)
 
-        err = lib.zsf_step_phase_2(self._param_t, t_open_lake, self._state_t, self._results_t)
+        err = lib.zsf_context_step_phase_2(self._ctx, t_open_lake, self._state_t, self._results_t)
         if err:
             raise RuntimeError(_zsf_error_message(err))
 
@@ -156,7 +1081,7 @@ class ZSFUnsteady:
 
         self._set_parameters(**parameters)
 
-        err = lib.zsf_step_phase_3(self._param_t, t_level, self._state_t, self._results_t)
+        err = lib.zsf_context_step_phase_3(self._ctx, t_level, self._state_t, self._results_t)
         if err:
             raise RuntimeError(_zsf_error_message(err))
 
@@ -178,7 +1103,7 @@ class ZSFUnsteady:
 
         self._set_parameters(**parameters)
 
-        err = lib.zsf_step_phase_4(self._param_t, t_open_sea, self._state_t, self._results_t)
+        err = lib.zsf_context_step_phase_4(self._ctx, t_open_sea, self._state_t, self._results_t)
         if err:
             raise RuntimeError(_zsf_error_message(err))
 
@@ -201,8 +1126,8 @@ class ZSFUnsteady:
 
         self._set_parameters(**parameters)
 
-        err = lib.zsf_step_flush_doors_closed(
-            self._param_t, t_flushing, self._state_t, self._results_t
+        err = lib.zsf_context_step_flush_doors_closed(
+            self._ctx, t_flushing, self._state_t, self._results_t
         )
         if err:
             raise RuntimeError(_zsf_error_message(err))
@@ -219,3 +1144,571 @@ class ZSFUnsteady:
         """
 
         return _struct_to_dict(self._state_t)
+
+
+class ZSFComplex:
+    """
+    Lock chambers side by side on the same lake and sea, each with its own
+    parameters and operation, like the parallel chambers of a lock complex.
+    All chambers are stepped at once, see also :c:func:`zsf_complex_run`.
+
+    :param chambers: For every chamber, a dictionary of the parameters in
+        which it differs from ``parameters``.
+    :param accuracy: The accuracy of the transcendental functions, see :func:`zsf_calc_steady`.
+    :param parameters: Any parameters that should be changed versus the
+        default for all chambers. The lake and the sea are always shared, and
+        are taken from the first chamber.
+    """
+
+    def __init__(
+        self, chambers: Sequence[Dict[str, float]], accuracy: str = "exact", **parameters: float
+    ):
+        self._num_chambers = len(chambers)
+        self._params_t = ffi.new("zsf_param_t[]", max(self._num_chambers, 1))
+        self._param_t_names = set(dir(self._params_t[0]))
+
+        for j, chamber in enumerate(chambers):
+            lib.zsf_param_default(ffi.addressof(self._params_t, j))
+            for p, v in {**parameters, **chamber}.items():
+                if p not in self._param_t_names:
+                    raise TypeError(f"No such parameter '{p}'")
+                setattr(self._params_t[j], p, v)
+
+        complex_t = ffi.new("zsf_complex_t **")
+        err = lib.zsf_complex_create(self._params_t, self._num_chambers, complex_t)
+        if err:
+            raise ValueError(_zsf_error_message(err))
+        self._complex = ffi.gc(complex_t[0], lib.zsf_complex_free)
+
+        self._accuracy = accuracy
+        self._state_t = ffi.new("zsf_phase_state_t *")
+
+    def set_state(self, chamber: int, sal_lock: float, head_lock: float):
+        """
+        Empty a chamber, at the given salinity and head.
+
+        :param chamber: The index of the chamber.
+        :param sal_lock: The salinity of the chamber.
+        :param head_lock: The head of the chamber.
+        """
+        if not 0 <= chamber < self._num_chambers:
+            raise IndexError(f"No such chamber {chamber}")
+
+        params_t = ffi.addressof(self._params_t, chamber)
+        lib.zsf_initialize_state(params_t, self._state_t, sal_lock, head_lock)
+        lib.zsf_complex_set_state(self._complex, chamber, self._state_t)
+
+    def state(self, chamber: int) -> Dict[str, float]:
+        """
+        Get the state of a chamber, see also :c:struct:`zsf_phase_state_t`.
+
+        :param chamber: The index of the chamber.
+        """
+        if lib.zsf_complex_get_state(self._complex, chamber, self._state_t):
+            raise IndexError(f"No such chamber {chamber}")
+
+        return _struct_to_dict(self._state_t)
+
+    def run(
+        self,
+        routines: Sequence[Sequence[int]],
+        durations: Sequence[Sequence[float]],
+        columns: Optional[Dict[str, Sequence[float]]] = None,
+        num_threads: int = 1,
+        per_chamber: bool = False,
+    ) -> Dict[str, List[float]]:
+        """
+        Step all chambers through a number of time steps.
+
+        :param routines: For every time step, the routine of every chamber,
+            see :meth:`ZSFUnsteady.run_lockages`. Chambers that do nothing in
+            a time step have routine 0.
+        :param durations: For every time step, the duration of the routine of
+            every chamber in seconds.
+        :param columns: A dictionary of parameter names to sequences of
+            values, one value per time step for all chambers, e.g. the heads
+            and salinities of the lake and the sea.
+        :param num_threads: The number of threads to spread the chambers
+            over, where 0 means one per core.
+        :param per_chamber: Whether to also return the transports of every
+            chamber in the ``chambers`` entry, as a list of dictionaries.
+
+        :returns: A dictionary of transport names to lists of values, one
+            value per time step, of all chambers together. See also
+            :c:func:`zsf_complex_run` and :c:struct:`zsf_phase_transports_t`.
+
+        :raises RuntimeError: If a chamber fails. The chambers that did not
+            fail have made all steps.
+        """
+        columns = {} if columns is None else columns
+        num_chambers = self._num_chambers
+
+        n = len(routines)
+        if len(durations) != n or any(len(v) != n for v in columns.values()):
+            raise ValueError("All sequences should have the same length as routines")
+        if any(len(r) != num_chambers for r in routines) or any(
+            len(d) != num_chambers for d in durations
+        ):
+            raise ValueError("Every time step should have a routine and duration per chamber")
+
+        param_columns_t, param_arrays = _zsf_param_columns(columns, self._param_t_names)
+        routines_t = ffi.new("int[]", [r for step in routines for r in step])
+        durations_t = ffi.new("double[]", [d for step in durations for d in step])
+        totals_t = ffi.new("zsf_phase_transports_t[]", n)
+        transports_t = (
+            ffi.new("zsf_phase_transports_t[]", n * num_chambers) if per_chamber else ffi.NULL
+        )
+        failed_steps_t = ffi.new("int[]", num_chambers)
+
+        options_t = _zsf_options(num_threads=num_threads, accuracy=self._accuracy)
+
+        err = lib.zsf_complex_run(
+            self._complex,
+            param_columns_t,
+            1,
+            routines_t,
+            durations_t,
+            n,
+            totals_t,
+            transports_t,
+            failed_steps_t,
+            options_t,
+        )
+        if err:
+            j = next(j for j in range(num_chambers) if failed_steps_t[j] >= 0)
+            raise RuntimeError(f"Chamber {j}, step {failed_steps_t[j]}: {_zsf_error_message(err)}")
+
+        names = dir(totals_t[0])
+        results = {k: [getattr(totals_t[i], k) for i in range(n)] for k in names}
+        if per_chamber:
+            results["chambers"] = [
+                {
+                    k: [getattr(transports_t[i * num_chambers + j], k) for i in range(n)]
+                    for k in names
+                }
+                for j in range(num_chambers)
+            ]
+
+        return results
+
+
+def zsf_simulate_operation(
+    sal_lock: float,
+    head_lock: float,
+    duration: float,
+    traffic: Optional[Dict[str, float]] = None,
+    columns: Optional[Dict[str, Sequence[float]]] = None,
+    interval: float = 3600.0,
+    seed: int = 0,
+    accuracy: str = "exact",
+    **parameters: float,
+) -> Tuple[Dict[str, List[float]], Dict]:
+    """
+    Simulate the operation of a lock with random ship traffic, where every
+    routine the lock performs is stepped like :meth:`ZSFUnsteady.run_lockages`.
+    See also :c:func:`zsf_simulate_operation`.
+
+    :param sal_lock: The initial salinity of the lock.
+    :param head_lock: The initial head of the lock, which also decides on
+        which side the lock starts.
+    :param duration: The simulated time in seconds.
+    :param traffic: Any fields of :c:struct:`zsf_traffic_t` that should be
+        changed versus the default of one ship an hour in both directions.
+    :param columns: A dictionary of parameter names to sequences of values
+        that change over time, typically the heads and salinities of the lake
+        and the sea, where the k-th value holds from ``k * interval`` seconds.
+    :param interval: The time between the values of the columns in seconds.
+    :param seed: The seed of the random arrivals of ships.
+    :param accuracy: The accuracy of the transcendental functions, see :func:`zsf_calc_steady`.
+    :param parameters: Any parameters that should be changed versus the default.
+
+    :returns: The routines of the lock as a dictionary of lists, like
+        ``lockages.csv``: the ``time``, ``duration``, ``routine``,
+        ``num_ships`` and ``ship_volume`` of every routine and its transports;
+        and the statistics of :c:struct:`zsf_operation_stats_t` as a
+        dictionary, with the total transports in ``total``. Ships that do not
+        fit in the lock are turned away, see ``num_ships_turned_away``.
+
+    :raises ValueError: If the traffic is invalid.
+    """
+    columns = {} if columns is None else columns
+    traffic = {} if traffic is None else traffic
+
+    param_t = ffi.new("zsf_param_t *")
+    lib.zsf_param_default(param_t)
+    param_names = set(dir(param_t))
+    for p, v in parameters.items():
+        if p not in param_names:
+            raise TypeError(f"No such parameter '{p}'")
+        setattr(param_t, p, v)
+
+    traffic_t = ffi.new("zsf_traffic_t *")
+    lib.zsf_traffic_default(traffic_t)
+    traffic_names = set(dir(traffic_t))
+    for k, v in traffic.items():
+        if k not in traffic_names:
+            raise TypeError(f"No such traffic field '{k}'")
+        setattr(traffic_t, k, v)
+
+    num_boundaries = len(next(iter(columns.values()))) if columns else 0
+    if any(len(v) != num_boundaries for v in columns.values()):
+        raise ValueError("All columns should have the same length")
+    param_columns_t, param_arrays = _zsf_param_columns(columns, param_names)
+    options_t = _zsf_options(accuracy=accuracy)
+
+    # A guess of the number of routines, which is run again if it is too small
+    num_ships = (traffic_t.arrival_rate_lake + traffic_t.arrival_rate_sea) * duration / 3600.0
+    max_events = int(4 * num_ships) + 64
+    state_t = ffi.new("zsf_phase_state_t *")
+    stats_t = ffi.new("zsf_operation_stats_t *")
+    while True:
+        lib.zsf_initialize_state(param_t, state_t, sal_lock, head_lock)
+        events_t = ffi.new("zsf_operation_event_t[]", max_events)
+        err = lib.zsf_simulate_operation(
+            param_t,
+            param_columns_t,
+            1,
+            num_boundaries,
+            interval,
+            traffic_t,
+            duration,
+            seed,
+            state_t,
+            events_t,
+            max_events,
+            stats_t,
+            options_t,
+        )
+        if err or stats_t.num_events <= max_events:
+            break
+        max_events = stats_t.num_events
+
+    if err:
+        raise ValueError(_zsf_error_message(err))
+
+    n = stats_t.num_events
+    names = ["time", "duration", "routine", "num_ships", "ship_volume"]
+    events = {k: [getattr(events_t[i], k) for i in range(n)] for k in names}
+    for k in dir(stats_t.total):
+        events[k] = [getattr(events_t[i].transports, k) for i in range(n)]
+
+    stats = {k: getattr(stats_t, k) for k in dir(stats_t) if k != "total"}
+    stats["total"] = _struct_to_dict(stats_t.total)
+
+    return events, stats
+
+
+class ZSFSurrogate:
+    """
+    The steady state results on a grid over a few parameters, with the other
+    parameters fixed. Interpolating in the grid is much faster than running
+    the solver, e.g. to answer many what-if questions. See also
+    :c:func:`zsf_surrogate_create`.
+
+    :param axes: A dictionary of parameter names to ``(min, max, num_points)``
+        tuples, of at most 8 parameters. The grid contains every combination
+        of the points of the axes.
+    :param num_checks: The number of points halfway between grid points at
+        which the interpolation error is estimated, see :meth:`max_error`.
+    :param num_threads: The number of threads to calculate the grid with,
+        where 0 means one per core.
+    :param solver: The solver for the steady state, see :func:`zsf_calc_steady`.
+    :param max_cycles: The maximum number of cycles per grid point, see :func:`zsf_calc_steady`.
+    :param max_time: The maximum time per grid point in seconds, see :func:`zsf_calc_steady`.
+    :param accuracy: The accuracy of the transcendental functions, see :func:`zsf_calc_steady`.
+    :param parameters: Any parameters that should be changed versus the
+        default, and that are the same for all grid points.
+    """
+
+    def __init__(
+        self,
+        axes: Dict[str, Tuple[float, float, int]],
+        num_checks: int = 1000,
+        num_threads: int = 1,
+        solver: str = "picard",
+        max_cycles: int = 0,
+        max_time: float = 0.0,
+        accuracy: str = "exact",
+        **parameters: float,
+    ):
+        param_t = ffi.new("zsf_param_t *")
+        lib.zsf_param_default(param_t)
+
+        param_names = set(dir(param_t))
+        for p, v in parameters.items():
+            if p not in param_names:
+                raise TypeError(f"No such parameter '{p}'")
+            setattr(param_t, p, v)
+
+        axes_t = ffi.new("zsf_surrogate_axis_t[]", len(axes))
+        for a, (p, (lo, hi, num_points)) in enumerate(axes.items()):
+            if p not in param_names:
+                raise TypeError(f"No such parameter '{p}'")
+            if p in parameters:
+                raise TypeError(f"Parameter '{p}' is both an axis and fixed")
+            axes_t[a].param = lib.zsf_param_index(p.encode())
+            axes_t[a].min = lo
+            axes_t[a].max = hi
+            axes_t[a].num_points = num_points
+
+        options_t = _zsf_options(solver, max_cycles, max_time, num_threads, accuracy)
+
+        surrogate_t = ffi.new("zsf_surrogate_t **")
+        err = lib.zsf_surrogate_create(
+            param_t, axes_t, len(axes), num_checks, options_t, surrogate_t
+        )
+        self._init(surrogate_t[0], err)
+
+    def _init(self, surrogate, err):
+        if surrogate == ffi.NULL:
+            raise RuntimeError(_zsf_error_message(err))
+
+        # Grid points that failed only matter to the queries that need them
+        self._surrogate = ffi.gc(surrogate, lib.zsf_surrogate_free)
+
+        num_axes = lib.zsf_surrogate_get_axes(self._surrogate, ffi.NULL)
+        self._axes_t = ffi.new("zsf_surrogate_axis_t[]", num_axes)
+        lib.zsf_surrogate_get_axes(self._surrogate, self._axes_t)
+
+        param_t = ffi.new("zsf_param_t *")
+        names = [name for name, _ in ffi.typeof(param_t[0]).fields]
+        self._axis_names = [names[self._axes_t[a].param] for a in range(num_axes)]
+
+        self._x = ffi.new("double[]", num_axes)
+        self._results_t = ffi.new("zsf_results_t *")
+
+    @classmethod
+    def load(cls, path: str) -> "ZSFSurrogate":
+        """
+        Load a surrogate saved with :meth:`save`.
+
+        :param path: The path of the file.
+        """
+        surrogate_t = ffi.new("zsf_surrogate_t **")
+        err = lib.zsf_surrogate_load(os.fsencode(path), surrogate_t)
+
+        self = cls.__new__(cls)
+        self._init(surrogate_t[0], err)
+        return self
+
+    def save(self, path: str):
+        """
+        Save the surrogate to a binary file, to load it with :meth:`load`.
+        The file is only portable between machines with the same byte order.
+
+        :param path: The path of the file.
+        """
+        err = lib.zsf_surrogate_save(self._surrogate, os.fsencode(path))
+        if err:
+            raise RuntimeError(_zsf_error_message(err))
+
+    @property
+    def axes(self) -> Dict[str, Tuple[float, float, int]]:
+        """
+        The axes of the grid, in the same format as the ``axes`` argument.
+        """
+        return {
+            name: (axis.min, axis.max, axis.num_points)
+            for name, axis in zip(self._axis_names, self._axes_t)
+        }
+
+    @property
+    def parameters(self) -> Dict[str, float]:
+        """
+        The parameters that are the same for all grid points. The values of
+        the parameters of the axes are meaningless.
+        """
+        param_t = ffi.new("zsf_param_t *")
+        lib.zsf_surrogate_get_param(self._surrogate, param_t)
+        return _struct_to_dict(param_t)
+
+    def __call__(self, method: str = "linear", **values: float) -> Dict[str, float]:
+        """
+        Interpolate the results, see also :c:func:`zsf_surrogate_interpolate`.
+
+        :param method: Either ``"linear"`` (multilinear) or ``"cubic"``
+            (Catmull-Rom splines).
+        :param values: The value of the parameter of every axis.
+
+        :returns: The interpolated results, see also :c:struct:`zsf_results_t`.
+
+        :raises ValueError: If the point lies outside of the grid, or the
+            interpolation needs a grid point for which the solver failed.
+        """
+        if method not in _INTERPOLATIONS:
+            raise ValueError(f"No such interpolation method '{method}'")
+        if set(values) != set(self._axis_names):
+            raise TypeError(f"Need values of exactly the axes {self._axis_names}")
+
+        for a, name in enumerate(self._axis_names):
+            self._x[a] = values[name]
+
+        err = lib.zsf_surrogate_interpolate(
+            self._surrogate, _INTERPOLATIONS[method], self._x, self._results_t
+        )
+        if err:
+            raise ValueError(_zsf_error_message(err))
+
+        return _struct_to_dict(self._results_t)
+
+    def max_error(self, method: str = "linear") -> Dict[str, float]:
+        """
+        The maximum absolute error of the interpolation over the checks made
+        when the surrogate was created. This is an estimate, not a strict
+        bound, that becomes more reliable with more checks.
+
+        :param method: The interpolation method, see :meth:`__call__`.
+
+        :returns: The maximum error of every result, see also
+            :c:struct:`zsf_results_t`.
+        """
+        if method not in _INTERPOLATIONS:
+            raise ValueError(f"No such interpolation method '{method}'")
+
+        max_error_t = ffi.new("zsf_results_t *")
+        lib.zsf_surrogate_max_error(self._surrogate, _INTERPOLATIONS[method], max_error_t)
+        return _struct_to_dict(max_error_t)
+
+
+def _zsf_distribution(distribution_t, name: str, distribution: Tuple):
+    kind, *values = distribution
+    if kind not in _DISTRIBUTIONS:
+        raise ValueError(f"No such distribution '{kind}'")
+
+    distribution_t.type = _DISTRIBUTIONS[kind]
+    if kind == "uniform" and len(values) == 2:
+        distribution_t.min, distribution_t.max = values
+    elif kind == "triangular" and len(values) == 3:
+        distribution_t.min, distribution_t.center, distribution_t.max = values
+    elif kind == "normal" and len(values) in (2, 4):
+        distribution_t.center, distribution_t.std_dev = values[:2]
+        distribution_t.min, distribution_t.max = values[2:] or (-float("inf"), float("inf"))
+    else:
+        raise ValueError(f"Wrong number of values for the {kind} distribution of '{name}'")
+
+
+class ZSFMonteCarlo:
+    """
+    The distribution of the steady state results for uncertain parameters.
+    The results of every :meth:`run` are accumulated in constant memory,
+    such that runs of millions of samples only take time. The samples are
+    reproducible: they only depend on the seed and their index, and not on the
+    number of threads. See also :c:func:`zsf_monte_carlo_create`.
+
+    :param distributions: A dictionary of parameter names to their
+        distribution, one of ``("uniform", min, max)``,
+        ``("triangular", min, mode, max)``, ``("normal", mean, std_dev)`` or
+        ``("normal", mean, std_dev, min, max)`` for a truncated normal
+        distribution.
+    :param seed: The seed of the random numbers.
+    :param parameters: Any parameters that should be changed versus the
+        default, and that are the same for all samples.
+    """
+
+    def __init__(
+        self,
+        distributions: Dict[str, Tuple],
+        seed: int = 0,
+        **parameters: float,
+    ):
+        param_t = ffi.new("zsf_param_t *")
+        lib.zsf_param_default(param_t)
+
+        param_names = set(dir(param_t))
+        for p, v in parameters.items():
+            if p not in param_names:
+                raise TypeError(f"No such parameter '{p}'")
+            setattr(param_t, p, v)
+
+        distributions_t = ffi.new("zsf_distribution_t[]", len(distributions))
+        for k, (p, distribution) in enumerate(distributions.items()):
+            if p not in param_names:
+                raise TypeError(f"No such parameter '{p}'")
+            if p in parameters:
+                raise TypeError(f"Parameter '{p}' is both uncertain and fixed")
+            distributions_t[k].param = lib.zsf_param_index(p.encode())
+            _zsf_distribution(distributions_t[k], p, distribution)
+
+        monte_carlo_t = ffi.new("zsf_monte_carlo_t **")
+        err = lib.zsf_monte_carlo_create(
+            param_t, distributions_t, len(distributions), seed, monte_carlo_t
+        )
+        if err:
+            raise ValueError(_zsf_error_message(err))
+
+        self._monte_carlo = ffi.gc(monte_carlo_t[0], lib.zsf_monte_carlo_free)
+        self._stats_t = ffi.new("zsf_monte_carlo_stats_t *")
+        self._results_t = ffi.new("zsf_results_t *")
+
+    def run(
+        self,
+        num_samples: int,
+        num_threads: int = 1,
+        solver: str = "picard",
+        max_cycles: int = 0,
+        max_time: float = 0.0,
+        accuracy: str = "exact",
+    ):
+        """
+        Calculate the steady state of the next ``num_samples`` samples, and
+        add their results to the distribution. Samples that fail, e.g.
+        because a ship is too large for the lock or because the solver does
+        not converge, are counted but left out.
+
+        :param num_samples: The number of samples.
+        :param num_threads: The number of threads, where 0 means one per core.
+        :param solver: The solver for the steady state, see :func:`zsf_calc_steady`.
+        :param max_cycles: The maximum number of cycles per sample, see :func:`zsf_calc_steady`.
+        :param max_time: The maximum time per sample in seconds, see :func:`zsf_calc_steady`.
+        :param accuracy: The accuracy of the transcendental functions, see :func:`zsf_calc_steady`.
+        """
+        options_t = _zsf_options(solver, max_cycles, max_time, num_threads, accuracy)
+
+        num_failed = self.statistics()["num_failed"]
+        err = lib.zsf_monte_carlo_run(self._monte_carlo, num_samples, options_t)
+        if err and self.statistics()["num_failed"] == num_failed:
+            raise RuntimeError(_zsf_error_message(err))
+
+    def statistics(self) -> Dict:
+        """
+        The moments and extremes of the results of all samples so far.
+
+        :returns: A dictionary with the number of samples (``num_samples``)
+            and of failed samples (``num_failed``), and the ``mean``,
+            ``std_dev``, ``min`` and ``max`` of every result (see
+            :c:struct:`zsf_results_t`).
+        """
+        lib.zsf_monte_carlo_get_stats(self._monte_carlo, self._stats_t)
+        stats = self._stats_t
+
+        return {
+            "num_samples": stats.num_samples,
+            "num_failed": stats.num_failed,
+            **{k: _struct_to_dict(getattr(stats, k)) for k in ("mean", "std_dev", "min", "max")},
+        }
+
+    def quantile(self, q: float) -> Dict[str, float]:
+        """
+        Estimate a quantile of the results of all samples so far, with a
+        relative error of at most 1%.
+
+        :param q: The quantile, between 0 and 1.
+
+        :returns: The quantile of every result, see :c:struct:`zsf_results_t`.
+        """
+        err = lib.zsf_monte_carlo_quantile(self._monte_carlo, q, self._results_t)
+        if err:
+            raise ValueError(_zsf_error_message(err))
+        return _struct_to_dict(self._results_t)
+
+    def sample(self, index: int) -> Dict[str, float]:
+        """
+        The parameters of a sample, e.g. to reproduce its results.
+
+        :param index: The index of the sample, counting from 0 over all runs.
+
+        :returns: A dictionary of all parameters, like :c:struct:`zsf_param_t`.
+        """
+        param_t = ffi.new("zsf_param_t *")
+        lib.zsf_monte_carlo_get_sample(self._monte_carlo, index, param_t)
+        return _struct_to_dict(param_t)
@@ -0,0 +1,279 @@
+import os
+import threading
+import time
+import unittest
+from concurrent.futures import ThreadPoolExecutor
+
+import numpy as np
+
+from pyzsf import (
+    zsf_calc_steady,
+    zsf_calc_steady_array,
+    zsf_calc_steady_batch,
+    zsf_calc_steady_chunked,
+    zsf_calc_steady_series,
+    zsf_param_array,
+    zsf_param_dtype,
+)
+
+
+class TestSaltLoadBatch(unittest.TestCase):
+    def setUp(self):
+        self.parameters = {
+            "lock_length": 240.0,
+            "lock_width": 12.0,
+            "lock_bottom": -4.0,
+            "num_cycles": 24.0,
+            "door_time_to_open": 300.0,
+            "leveling_time": 300.0,
+            "calibration_coefficient": 1.0,
+            "symmetry_coefficient": 1.0,
+            "ship_volume_sea_to_lake": 0.0,
+            "ship_volume_lake_to_sea": 0.0,
+            "head_sea": 0.0,
+            "salinity_sea": 25.0,
+            "temperature_sea": 15.0,
+            "head_lake": 0.0,
+            "salinity_lake": 5.0,
+            "temperature_lake": 15.0,
+            "flushing_discharge_high_tide": 0.0,
+            "flushing_discharge_low_tide": 0.0,
+            "density_current_factor_sea": 1.0,
+            "density_current_factor_lake": 1.0,
+        }
+
+        # A mix of scenarios that need very different numbers of iterations
+        self.columns = {
+            "head_sea": [0.0, -2.0, 2.0, -2.0, 2.0, 0.0, 0.0, 0.0, 0.0, 1.0, -1.0],
+            "flushing_discharge_low_tide": [0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 2.0, 2.0],
+            "flushing_discharge_high_tide": [0.0, 0.0, 0.0, 0.0, 1.0, 1.0, 0.0, 0.0, 0.0, 2.0, 2.0],
+            "sill_height_lake": [0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.5, 0.5],
+            "density_current_factor_sea": [1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 0.25, 1.0, 0.5, 0.5],
+            "distance_door_bubble_screen_lake": [
+                0.0,
+                0.0,
+                0.0,
+                0.0,
+                0.0,
+                0.0,
+                0.0,
+                0.0,
+                4.0,
+                -4.0,
+                4.0,
+            ],
+        }
+
+    def test_batch_equals_single(self):
+        n = len(self.columns["head_sea"])
+        batch = zsf_calc_steady_batch(self.columns, **self.parameters)
+
+        self.assertEqual(batch["error"], [0] * n)
+
+        for i in range(n):
+            row = {k: v[i] for k, v in self.columns.items()}
+            single = zsf_calc_steady(**dict(self.parameters, **row))
+
+            for k in ("salt_load_lake", "discharge_to_lake", "salinity_to_sea"):
+                self.assertEqual(batch[k][i], single[k], msg=f"row {i}, {k}")
+
+    def test_failing_rows(self):
+        # A ship that is too large for the lock should not abort the batch
+        columns = {"ship_volume_sea_to_lake": [0.0, 1e6, 5000.0]}
+
+        batch = zsf_calc_steady_batch(columns, **self.parameters)
+
+        self.assertEqual(batch["error"][0], 0)
+        self.assertNotEqual(batch["error"][1], 0)
+        self.assertEqual(batch["error"][2], 0)
+
+        self.assertTrue(np.isnan(batch["salt_load_lake"][1]))
+        np.testing.assert_allclose(batch["salt_load_lake"][2], -8.846, rtol=0.01, atol=0.01)
+
+    def test_strides(self):
+        from pyzsf._zsf_cffi import ffi, lib
+
+        head_sea = ffi.new("double[]", [0.5])
+        salt_load_lake = ffi.new("double[]", 3)
+        params = ffi.new("zsf_param_columns_t *", {"head_sea": head_sea})
+        results = ffi.new("zsf_results_columns_t *", {"salt_load_lake": salt_load_lake})
+        errors = ffi.new("int[]", 3)
+
+        # A negative stride would index before the start of the columns
+        for param_stride, results_stride in ((-1, 1), (0, -1)):
+            err = lib.zsf_calc_steady_batch(
+                ffi.NULL, params, param_stride, results, results_stride, errors, 3, ffi.NULL
+            )
+            self.assertEqual(
+                ffi.string(lib.zsf_error_msg(err)).decode(),
+                "Negative stride of the parameter or result columns",
+            )
+
+        # A stride of zero broadcasts the same row of parameters
+        err = lib.zsf_calc_steady_batch(ffi.NULL, params, 0, results, 1, errors, 3, ffi.NULL)
+        self.assertEqual(err, 0)
+        self.assertEqual(list(errors), [0, 0, 0])
+        self.assertEqual(salt_load_lake[0], salt_load_lake[2])
+
+    def test_threads(self):
+        # Many rows, such that every thread gets multiple chunks to work on
+        # (and steal)
+        columns = {k: v * 20 for k, v in self.columns.items()}
+
+        serial = zsf_calc_steady_batch(columns, **self.parameters)
+        threaded = zsf_calc_steady_batch(columns, num_threads=4, **self.parameters)
+
+        self.assertEqual(serial, threaded)
+
+    def test_array_equals_batch(self):
+        n = len(self.columns["head_sea"])
+        batch = zsf_calc_steady_batch(self.columns, **self.parameters)
+
+        params = zsf_param_array(n, **self.parameters)
+        self.assertEqual(params.dtype, zsf_param_dtype())
+        for k, v in self.columns.items():
+            params[k] = v
+
+        results = zsf_calc_steady_array(params)
+        columns = zsf_calc_steady_array(params, as_columns=True)
+
+        for k in ("salt_load_lake", "discharge_to_lake", "salinity_to_sea", "error"):
+            np.testing.assert_array_equal(results[k], batch[k], err_msg=k)
+            np.testing.assert_array_equal(columns[k], batch[k], err_msg=k)
+
+    def test_array_fields(self):
+        # An array of only the varying parameters, and strided views of it,
+        # with the other parameters as keyword arguments
+        n = len(self.columns["head_sea"])
+        dtype = [(k, np.float64) for k in self.columns]
+        params = np.zeros(2 * n, dtype=dtype)
+        for k, v in self.columns.items():
+            params[k][::2] = v
+            params[k][1::2] = v[::-1]
+
+        batch = zsf_calc_steady_batch(self.columns, **self.parameters)
+        base = {k: v for k, v in self.parameters.items() if k not in self.columns}
+
+        results = zsf_calc_steady_array(params[::2], **base)
+        np.testing.assert_array_equal(results["salt_load_lake"], batch["salt_load_lake"])
+
+        # A negative stride, which needs a copy
+        results = zsf_calc_steady_array(params[::-1][1::2], **base)
+        np.testing.assert_array_equal(results["salt_load_lake"], batch["salt_load_lake"][::-1])
+
+        # Parameters that do not exist or are not float64
+        with self.assertRaises(TypeError):
+            zsf_calc_steady_array(np.zeros(n, dtype=[("head_sea", np.float64), ("x", np.float64)]))
+        with self.assertRaises(TypeError):
+            zsf_calc_steady_array(np.zeros(n, dtype=[("head_sea", np.float32)]))
+        with self.assertRaises(TypeError):
+            zsf_calc_steady_array(params, head_sea=1.0)
+
+    def test_array_failing_rows(self):
+        params = zsf_param_array(3, **self.parameters)
+        params["ship_volume_sea_to_lake"] = [0.0, 1e6, 5000.0]
+
+        results = zsf_calc_steady_array(params)
+
+        self.assertEqual(results["error"][0], 0)
+        self.assertNotEqual(results["error"][1], 0)
+        self.assertTrue(np.isnan(results["salt_load_lake"][1]))
+        np.testing.assert_allclose(results["salt_load_lake"][2], -8.846, rtol=0.01, atol=0.01)
+
+    def test_series(self):
+        # Two days of a semi-diurnal tide, every 15 minutes, through a lock
+        # with a poor exchange that needs many cycles to converge
+        t = np.arange(0.0, 48.0, 0.25)
+        columns = {
+            "head_sea": list(1.5 * np.sin(2 * np.pi * t / 12.42)),
+            "salinity_sea": list(25.0 + 3.0 * np.sin(2 * np.pi * t / 12.42 - 1.0)),
+        }
+        parameters = dict(
+            self.parameters,
+            num_cycles=96.0,
+            density_current_factor_sea=0.1,
+            density_current_factor_lake=0.1,
+            rtol=1e-8,
+            atol=1e-10,
+        )
+
+        series = zsf_calc_steady_series(columns, **parameters)
+        batch = zsf_calc_steady_batch(columns, **parameters)
+
+        self.assertEqual(series["error"], [0] * len(t))
+        np.testing.assert_allclose(
+            series["salt_load_lake"], batch["salt_load_lake"], rtol=1e-5, atol=1e-5
+        )
+
+        # A given lock salinity overrides the warm start, where ZSF_NAN means
+        # the usual cold start. Without flushing and bubble screens, both
+        # start at the closed-form steady state.
+        cold_columns = dict(columns, salinity_lock=[-999.0] * len(t))
+        cold = zsf_calc_steady_series(cold_columns, **parameters)
+        self.assertEqual(cold["salt_load_lake"], batch["salt_load_lake"])
+        self.assertEqual(series["num_cycles"], [1] * len(t))
+        self.assertEqual(cold["num_cycles"], [1] * len(t))
+
+        # With flushing, the warm start is closer than the cold start
+        parameters = dict(
+            parameters,
+            num_cycles=24.0,
+            density_current_factor_sea=0.25,
+            density_current_factor_lake=0.25,
+            flushing_discharge_high_tide=0.5,
+            flushing_discharge_low_tide=0.5,
+        )
+        series = zsf_calc_steady_series(columns, **parameters)
+        cold = zsf_calc_steady_series(cold_columns, **parameters)
+        self.assertEqual(series["error"], [0] * len(t))
+        self.assertLess(sum(series["num_cycles"]), sum(cold["num_cycles"]))
+
+    def scenario_array(self, n):
+        params = zsf_param_array(n, **self.parameters)
+        for k, v in self.columns.items():
+            params[k] = np.resize(v, n)
+        return params
+
+    def test_chunked(self):
+        params = self.scenario_array(1000)
+        serial = zsf_calc_steady_array(params)
+
+        with ThreadPoolExecutor(4) as executor:
+            chunked = zsf_calc_steady_chunked(params, executor, chunk_size=64)
+            columns = zsf_calc_steady_chunked(params, executor, chunk_size=64, as_columns=True)
+
+        np.testing.assert_array_equal(chunked, serial)
+        np.testing.assert_array_equal(columns["salt_load_lake"], serial["salt_load_lake"])
+        np.testing.assert_array_equal(zsf_calc_steady_chunked(params[:0]), serial[:0])
+
+    def test_gil_released(self):
+        # While a thread is in the library, other Python threads keep running
+        params = self.scenario_array(40000)
+        params["rtol"] = 1e-12
+        params["atol"] = 1e-14
+
+        thread = threading.Thread(target=zsf_calc_steady_array, args=(params,))
+        count = 0
+        thread.start()
+        while thread.is_alive():
+            count += 1
+            time.sleep(0.001)
+        thread.join()
+
+        self.assertGreater(count, 10)
+
+    @unittest.skipIf((os.cpu_count() or 1) < 2, "Needs multiple cores")
+    def test_chunked_scaling(self):
+        params = self.scenario_array(4000)
+
+        t0 = time.perf_counter()
+        zsf_calc_steady_array(params)
+        t_serial = time.perf_counter() - t0
+
+        with ThreadPoolExecutor(2) as executor:
+            t0 = time.perf_counter()
+            zsf_calc_steady_chunked(params, executor, chunk_size=256)
+            t_threaded = time.perf_counter() - t0
+
+        # Two threads should be clearly faster, with a margin for noisy machines
+        self.assertLess(t_threaded, 0.8 * t_serial)
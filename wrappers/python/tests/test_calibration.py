@@ -0,0 +1,144 @@
+import unittest
+
+import numpy as np
+
+from pyzsf import ConvergenceError, zsf_calc_steady_batch, zsf_calibrate
+
+
+class TestCalibration(unittest.TestCase):
+    def setUp(self):
+        self.parameters = {
+            "lock_length": 240.0,
+            "lock_width": 12.0,
+            "lock_bottom": -4.0,
+            "num_cycles": 24.0,
+            "door_time_to_open": 300.0,
+            "leveling_time": 300.0,
+            "salinity_lake": 5.0,
+            "temperature_sea": 15.0,
+            "temperature_lake": 15.0,
+            "rtol": 1e-8,
+            "atol": 1e-10,
+        }
+
+        # Observations at random tides and sea salinities, with and without ships
+        rng = np.random.default_rng(42)
+        n = 40
+        self.columns = {
+            "head_sea": list(rng.uniform(-1.5, 1.5, n)),
+            "salinity_sea": list(rng.uniform(20.0, 30.0, n)),
+            "ship_volume_sea_to_lake": list(rng.choice([0.0, 2000.0], n)),
+        }
+
+        self.truth = {"calibration_coefficient": 0.8, "density_current_factor_sea": 0.6}
+        batch = zsf_calc_steady_batch(self.columns, **self.truth, **self.parameters)
+        self.observed = batch["salt_load_lake"]
+
+    def test_recovers_coefficients(self):
+        fit = {"calibration_coefficient": 1.0, "density_current_factor_sea": 1.0}
+        bounds = {"density_current_factor_sea": (0.0, 1.0)}
+
+        calibration = zsf_calibrate(self.columns, self.observed, fit, bounds, **self.parameters)
+
+        for p, v in self.truth.items():
+            self.assertAlmostEqual(calibration["values"][p], v, places=5, msg=p)
+
+        statistics = calibration["statistics"]
+        self.assertTrue(statistics["converged"])
+        self.assertEqual(statistics["num_observations"], len(self.observed))
+        self.assertLess(statistics["rms_residual"], 1e-6 * statistics["initial_rms_residual"])
+        np.testing.assert_allclose(calibration["residuals"], 0.0, atol=1e-6)
+
+        # Threads do not change the result
+        threaded = zsf_calibrate(
+            self.columns, self.observed, fit, bounds, num_threads=4, **self.parameters
+        )
+        self.assertEqual(threaded["values"], calibration["values"])
+
+    def test_noisy_observations(self):
+        # The standard errors cover the noise that was added
+        rng = np.random.default_rng(1)
+        sigma = 0.05 * np.std(self.observed)
+        noisy = list(np.array(self.observed) + rng.normal(0.0, sigma, len(self.observed)))
+
+        calibration = zsf_calibrate(
+            self.columns,
+            noisy,
+            {"calibration_coefficient": 1.0},
+            density_current_factor_sea=0.6,
+            **self.parameters,
+        )
+
+        value = calibration["values"]["calibration_coefficient"]
+        std_error = calibration["std_errors"]["calibration_coefficient"]
+        self.assertGreater(std_error, 0.0)
+        self.assertLess(abs(value - 0.8), 4.0 * std_error)
+        np.testing.assert_allclose(
+            calibration["statistics"]["rms_residual"],
+            np.sqrt(np.mean(np.square(calibration["residuals"]))),
+        )
+
+        # Zero weights leave observations out
+        half = len(noisy) // 2
+        weights = [1.0] * half + [0.0] * (len(noisy) - half)
+        weighted = zsf_calibrate(
+            self.columns,
+            noisy,
+            {"calibration_coefficient": 1.0},
+            weights=weights,
+            density_current_factor_sea=0.6,
+            **self.parameters,
+        )
+        subset = zsf_calibrate(
+            {k: v[:half] for k, v in self.columns.items()},
+            noisy[:half],
+            {"calibration_coefficient": 1.0},
+            density_current_factor_sea=0.6,
+            **self.parameters,
+        )
+        self.assertAlmostEqual(
+            weighted["values"]["calibration_coefficient"],
+            subset["values"]["calibration_coefficient"],
+            places=6,
+        )
+
+    def test_failing_observations(self):
+        # A ship that is too large for the lock leaves its observation out
+        columns = {k: v + [v[0]] for k, v in self.columns.items()}
+        columns["ship_volume_sea_to_lake"][-1] = 1e6
+
+        calibration = zsf_calibrate(
+            columns,
+            self.observed + [0.0],
+            {"calibration_coefficient": 1.0},
+            density_current_factor_sea=0.6,
+            **self.parameters,
+        )
+
+        self.assertEqual(calibration["statistics"]["num_failed"], 1)
+        self.assertTrue(np.isnan(calibration["residuals"][-1]))
+        self.assertAlmostEqual(calibration["values"]["calibration_coefficient"], 0.8, places=5)
+
+        with self.assertRaises(RuntimeError):
+            zsf_calibrate(
+                {"ship_volume_sea_to_lake": [1e6]},
+                [0.0],
+                {"calibration_coefficient": 1.0},
+                **self.parameters,
+            )
+
+    def test_max_iterations(self):
+        fit = {"calibration_coefficient": 1.0, "density_current_factor_sea": 1.0}
+
+        with self.assertRaises(ConvergenceError) as cm:
+            zsf_calibrate(self.columns, self.observed, fit, max_iterations=1, **self.parameters)
+
+        # The best fit so far is attached
+        statistics = cm.exception.results["statistics"]
+        self.assertEqual(statistics["num_iterations"], 1)
+        self.assertLess(statistics["rms_residual"], statistics["initial_rms_residual"])
+
+        with self.assertRaises(TypeError):
+            zsf_calibrate(self.columns, self.observed, {"x": 1.0}, **self.parameters)
+        with self.assertRaises(ValueError):
+            zsf_calibrate(self.columns, self.observed[1:], fit, **self.parameters)
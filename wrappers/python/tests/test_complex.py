@@ -0,0 +1,127 @@
+import unittest
+
+import numpy as np
+
+from pyzsf import ZSFComplex, ZSFUnsteady
+
+
+class TestComplex(unittest.TestCase):
+    def setUp(self):
+        self.parameters = {
+            "lock_length": 240.0,
+            "lock_width": 12.0,
+            "lock_bottom": -4.0,
+            "door_time_to_open": 300.0,
+            "leveling_time": 300.0,
+            "salinity_sea": 25.0,
+            "salinity_lake": 5.0,
+            "temperature_sea": 15.0,
+            "temperature_lake": 15.0,
+            "flushing_discharge_high_tide": 1.0,
+            "flushing_discharge_low_tide": 1.0,
+        }
+
+        # A large chamber, a small chamber, and one for small craft
+        self.chambers = [
+            {},
+            {"lock_length": 120.0, "lock_width": 10.0, "ship_volume_sea_to_lake": 500.0},
+            {"lock_length": 60.0, "lock_width": 6.0, "lock_bottom": -3.0},
+        ]
+
+        # Every chamber has its own schedule, and idles in between
+        cycles = [
+            [(1, 300.0), (2, 1800.0), (3, 300.0), (4, 1800.0)],
+            [(1, 300.0), (2, 1200.0), (0, 600.0), (3, 300.0), (4, 1200.0), (0, 600.0)],
+            [(1, 300.0), (2, 600.0), (-2, 600.0), (3, 300.0), (4, 600.0), (-4, 600.0)],
+        ]
+        n = 48
+        self.routines = [[c[i % len(c)][0] for c in cycles] for i in range(n)]
+        self.durations = [[c[i % len(c)][1] for c in cycles] for i in range(n)]
+
+        # The sea level changes when all chambers are between lockages
+        heads = [0.0, 0.5, 1.0, -0.5]
+        self.columns = {
+            "head_sea": [heads[i // 12] for i in range(n)],
+            "salinity_sea": [25.0 + 0.1 * i for i in range(n)],
+        }
+
+    def test_equals_separate_chambers(self):
+        lock_complex = ZSFComplex(self.chambers, **self.parameters)
+        initial = [lock_complex.state(j) for j in range(len(self.chambers))]
+        results = lock_complex.run(self.routines, self.durations, self.columns, per_chamber=True)
+
+        # Every chamber on its own, as if the others were not there
+        separate = []
+        for j, chamber in enumerate(self.chambers):
+            parameters = dict(self.parameters, **chamber)
+            c = ZSFUnsteady(initial[j]["salinity_lock"], initial[j]["head_lock"], **parameters)
+            routines = [r[j] for r in self.routines]
+            durations = [d[j] for d in self.durations]
+            separate.append(c.run_lockages(routines, durations, self.columns))
+
+            self.assertEqual(lock_complex.state(j), c.state)
+            self.assertEqual(results["chambers"][j], separate[-1])
+
+        for k in ("mass_transport_lake", "volume_to_lake", "discharge_from_sea", "volume_to_sea"):
+            total = np.sum([s[k] for s in separate], axis=0)
+            np.testing.assert_allclose(results[k], total, rtol=1e-12)
+
+        # Salinities are weighted by volume
+        mass = np.sum([np.multiply(s["salinity_to_sea"], s["volume_to_sea"]) for s in separate], 0)
+        np.testing.assert_allclose(
+            np.multiply(results["salinity_to_sea"], results["volume_to_sea"]), mass, rtol=1e-12
+        )
+
+        # Idle chambers do not move any water
+        chamber = results["chambers"][1]
+        for i, r in enumerate(self.routines):
+            if r[1] == 0:
+                self.assertEqual(chamber["volume_to_lake"][i], 0.0)
+                self.assertEqual(chamber["mass_transport_sea"][i], 0.0)
+
+    def test_threads(self):
+        one = ZSFComplex(self.chambers, **self.parameters)
+        many = ZSFComplex(self.chambers, **self.parameters)
+
+        a = one.run(self.routines, self.durations, self.columns)
+        b = many.run(self.routines, self.durations, self.columns, num_threads=3)
+        self.assertEqual(a, b)
+        for j in range(len(self.chambers)):
+            self.assertEqual(one.state(j), many.state(j))
+
+    def test_set_state(self):
+        lock_complex = ZSFComplex(self.chambers, **self.parameters)
+        lock_complex.set_state(1, 12.0, 0.5)
+        self.assertEqual(lock_complex.state(1)["salinity_lock"], 12.0)
+        self.assertEqual(lock_complex.state(1)["head_lock"], 0.5)
+        self.assertNotEqual(lock_complex.state(0)["salinity_lock"], 12.0)
+
+    def test_failure(self):
+        lock_complex = ZSFComplex(self.chambers, **self.parameters)
+        routines = [[1, 1, 1], [2, 5, 2], [3, 3, 3]]
+        durations = [[300.0] * 3] * 3
+
+        with self.assertRaisesRegex(RuntimeError, "Chamber 1, step 1: Unknown lockage routine"):
+            lock_complex.run(routines, durations)
+
+        # The other chambers made all steps
+        reference = ZSFComplex(self.chambers, **self.parameters)
+        reference.run([[1, 1, 1], [2, 0, 2], [3, 0, 3]], durations)
+        for j in range(len(self.chambers)):
+            self.assertEqual(lock_complex.state(j), reference.state(j))
+
+    def test_invalid(self):
+        with self.assertRaises(ValueError):
+            ZSFComplex([])
+        with self.assertRaises(TypeError):
+            ZSFComplex([{"x": 1.0}])
+
+        lock_complex = ZSFComplex(self.chambers, **self.parameters)
+        with self.assertRaises(IndexError):
+            lock_complex.state(3)
+        with self.assertRaises(IndexError):
+            lock_complex.set_state(-1, 10.0, 0.0)
+        with self.assertRaises(ValueError):
+            lock_complex.run([[1, 1]], [[300.0, 300.0]])
+        with self.assertRaises(ValueError):
+            lock_complex.run([[1, 1, 1]], [[300.0] * 3, [300.0] * 3])
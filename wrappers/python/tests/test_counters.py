@@ -0,0 +1,60 @@
+import unittest
+
+from pyzsf import zsf_calc_steady, zsf_counters, zsf_reset_counters
+
+
+@unittest.skipIf(zsf_counters() is None, "library built without counters")
+class TestCounters(unittest.TestCase):
+    def setUp(self):
+        self.parameters = {
+            "lock_length": 240.0,
+            "lock_width": 12.0,
+            "lock_bottom": -4.0,
+            "salinity_sea": 25.0,
+            "salinity_lake": 5.0,
+        }
+
+    def count(self, **parameters):
+        zsf_reset_counters()
+        results = zsf_calc_steady(statistics=True, **{**self.parameters, **parameters})
+        return results["statistics"], zsf_counters()
+
+    def test_solve(self):
+        statistics, counters = self.count()
+        self.assertEqual(counters["num_steady_solves"], 1)
+        self.assertEqual(counters["num_unconverged_solves"], 0)
+        self.assertEqual(counters["num_cycles"], statistics["num_cycles"])
+
+        # Every cycle opens the doors once on either side
+        self.assertEqual(counters["num_doors_open_lake"], counters["num_cycles"])
+        self.assertEqual(counters["num_doors_open_sea"], counters["num_cycles"])
+
+        # The average density of the lake and the sea
+        self.assertEqual(counters["num_density_evaluations"], 2)
+        self.assertGreaterEqual(
+            counters["num_density_iterations"], counters["num_density_evaluations"]
+        )
+
+        self.assertEqual(counters["num_bubble_screen_raw_exchange"], 0)
+        self.assertEqual(counters["num_flushing_passthrough"], 0)
+        self.assertEqual(counters["num_exchange_blocked_by_flushing"], 0)
+
+    def test_branches(self):
+        _, counters = self.count(
+            distance_door_bubble_screen_lake=10.0, distance_door_bubble_screen_sea=10.0
+        )
+        self.assertEqual(counters["num_bubble_screen_raw_exchange"], 2 * counters["num_cycles"])
+
+        # So much flushing that the density current cannot enter the lock
+        _, counters = self.count(flushing_discharge_high_tide=50.0, head_sea=0.5)
+        self.assertEqual(counters["num_exchange_blocked_by_flushing"], counters["num_cycles"])
+        self.assertEqual(counters["num_flushing_passthrough"], 2 * counters["num_cycles"])
+
+    def test_reset(self):
+        self.count()
+        zsf_reset_counters()
+        self.assertTrue(all(v == 0 for v in zsf_counters().values()))
+
+
+if __name__ == "__main__":
+    unittest.main()
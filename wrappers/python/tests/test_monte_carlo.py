@@ -0,0 +1,129 @@
+import unittest
+
+import numpy as np
+
+from pyzsf import ZSFMonteCarlo, zsf_calc_steady_batch
+
+
+class TestMonteCarlo(unittest.TestCase):
+    def setUp(self):
+        self.parameters = {
+            "lock_length": 240.0,
+            "lock_width": 12.0,
+            "lock_bottom": -4.0,
+            "door_time_to_open": 300.0,
+            "leveling_time": 300.0,
+            "salinity_lake": 5.0,
+            "temperature_sea": 15.0,
+            "temperature_lake": 15.0,
+        }
+        self.distributions = {
+            "ship_volume_sea_to_lake": ("uniform", 0.0, 4000.0),
+            "ship_volume_lake_to_sea": ("triangular", 0.0, 1000.0, 4000.0),
+            "salinity_sea": ("normal", 25.0, 2.0),
+            "density_current_factor_sea": ("normal", 0.8, 0.2, 0.0, 1.0),
+            "num_cycles": ("uniform", 12.0, 36.0),
+        }
+
+    def test_equals_batch(self):
+        n = 2000
+        monte_carlo = ZSFMonteCarlo(self.distributions, seed=1, **self.parameters)
+        monte_carlo.run(n)
+
+        # The same samples, one by one through the batch
+        samples = [monte_carlo.sample(i) for i in range(n)]
+        columns = {p: [s[p] for s in samples] for p in self.distributions}
+        batch = zsf_calc_steady_batch(columns, **self.parameters)
+        self.assertEqual(batch["error"], [0] * n)
+
+        statistics = monte_carlo.statistics()
+        self.assertEqual(statistics["num_samples"], n)
+        self.assertEqual(statistics["num_failed"], 0)
+
+        for k in ("salt_load_lake", "discharge_to_lake", "salinity_to_sea"):
+            x = np.array(batch[k])
+            np.testing.assert_allclose(statistics["mean"][k], np.mean(x), rtol=1e-10)
+            np.testing.assert_allclose(statistics["std_dev"][k], np.std(x, ddof=1), rtol=1e-10)
+            self.assertEqual(statistics["min"][k], np.min(x))
+            self.assertEqual(statistics["max"][k], np.max(x))
+
+            # The quantiles are the sorted values within the accuracy
+            x = np.sort(x)
+            for q in (0.0, 0.01, 0.25, 0.5, 0.75, 0.99, 1.0):
+                np.testing.assert_allclose(
+                    monte_carlo.quantile(q)[k], x[int(q * (n - 1))], rtol=0.01, err_msg=f"{k} {q}"
+                )
+
+    def test_reproducible(self):
+        # The samples do not depend on the number of threads, or the runs
+        one = ZSFMonteCarlo(self.distributions, seed=7, **self.parameters)
+        one.run(3000)
+
+        many = ZSFMonteCarlo(self.distributions, seed=7, **self.parameters)
+        many.run(1000, num_threads=4)
+        many.run(2000, num_threads=3)
+
+        for q in (0.05, 0.5, 0.95):
+            self.assertEqual(one.quantile(q), many.quantile(q))
+
+        a, b = one.statistics(), many.statistics()
+        self.assertEqual(a["min"], b["min"])
+        self.assertEqual(a["max"], b["max"])
+        for k, v in a["mean"].items():
+            np.testing.assert_allclose(b["mean"][k], v, rtol=1e-12)
+
+        # Another seed gives other samples
+        other = ZSFMonteCarlo(self.distributions, seed=8, **self.parameters)
+        self.assertNotEqual(other.sample(0), one.sample(0))
+        self.assertEqual(many.sample(2999), one.sample(2999))
+
+    def test_distributions(self):
+        monte_carlo = ZSFMonteCarlo(self.distributions, **self.parameters)
+        samples = [monte_carlo.sample(i) for i in range(20000)]
+        values = {p: np.array([s[p] for s in samples]) for p in self.distributions}
+
+        uniform = values["ship_volume_sea_to_lake"]
+        self.assertTrue(np.all((uniform >= 0.0) & (uniform <= 4000.0)))
+        self.assertAlmostEqual(np.mean(uniform), 2000.0, delta=25.0)
+
+        triangular = values["ship_volume_lake_to_sea"]
+        self.assertTrue(np.all((triangular >= 0.0) & (triangular <= 4000.0)))
+        self.assertAlmostEqual(np.mean(triangular), 5000.0 / 3.0, delta=15.0)
+
+        normal = values["salinity_sea"]
+        self.assertAlmostEqual(np.mean(normal), 25.0, delta=0.05)
+        self.assertAlmostEqual(np.std(normal), 2.0, delta=0.05)
+
+        truncated = values["density_current_factor_sea"]
+        self.assertTrue(np.all((truncated >= 0.0) & (truncated <= 1.0)))
+
+        # The other parameters are those of the base
+        self.assertEqual(samples[0]["lock_length"], 240.0)
+
+    def test_failing_samples(self):
+        # Ships that are too large for the lock are counted, but left out
+        distributions = {"ship_volume_sea_to_lake": ("uniform", 0.0, 20000.0)}
+        monte_carlo = ZSFMonteCarlo(distributions, **self.parameters)
+        monte_carlo.run(500)
+
+        statistics = monte_carlo.statistics()
+        self.assertGreater(statistics["num_failed"], 0)
+        self.assertEqual(statistics["num_samples"] + statistics["num_failed"], 500)
+
+    def test_invalid(self):
+        with self.assertRaises(ValueError):
+            ZSFMonteCarlo({"salinity_sea": ("lognormal", 25.0, 2.0)})
+        with self.assertRaises(ValueError):
+            ZSFMonteCarlo({"salinity_sea": ("uniform", 30.0, 20.0)})
+        with self.assertRaises(ValueError):
+            ZSFMonteCarlo({"salinity_sea": ("triangular", 20.0, 30.0)})
+        with self.assertRaises(TypeError):
+            ZSFMonteCarlo({"x": ("uniform", 0.0, 1.0)})
+
+        monte_carlo = ZSFMonteCarlo(self.distributions, **self.parameters)
+        with self.assertRaises(ValueError):
+            monte_carlo.quantile(0.5)
+
+        monte_carlo.run(10)
+        with self.assertRaises(ValueError):
+            monte_carlo.quantile(1.5)
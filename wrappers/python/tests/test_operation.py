@@ -0,0 +1,167 @@
+import unittest
+
+import numpy as np
+
+from pyzsf import ZSFUnsteady, zsf_simulate_operation
+
+
+class TestOperation(unittest.TestCase):
+    def setUp(self):
+        self.parameters = {
+            "lock_length": 240.0,
+            "lock_width": 12.0,
+            "lock_bottom": -4.0,
+            "door_time_to_open": 300.0,
+            "leveling_time": 300.0,
+            "salinity_sea": 25.0,
+            "salinity_lake": 5.0,
+            "temperature_sea": 15.0,
+            "temperature_lake": 15.0,
+        }
+        self.traffic = {
+            "arrival_rate_lake": 0.8,
+            "arrival_rate_sea": 1.2,
+            "ship_volume_min": 200.0,
+            "ship_volume_max": 1500.0,
+            "time_per_ship": 240.0,
+        }
+
+    def assert_sequential(self, events):
+        # Every routine starts after the previous one has ended
+        end = np.add(events["time"], events["duration"])
+        self.assertTrue(np.all(np.array(events["time"][1:]) >= end[:-1] - 1e-6))
+
+    def test_replay(self):
+        duration = 14 * 86400.0
+        events, stats = zsf_simulate_operation(15.0, 0.0, duration, self.traffic, **self.parameters)
+        self.assertEqual(stats["num_events"], len(events["time"]))
+        self.assert_sequential(events)
+
+        # The same routines through the phase kernels one after the other
+        routines = events["routine"]
+        columns = {
+            "ship_volume_lake_to_sea": [
+                v if r == 2 else 0.0 for r, v in zip(routines, events["ship_volume"])
+            ],
+            "ship_volume_sea_to_lake": [
+                v if r == 4 else 0.0 for r, v in zip(routines, events["ship_volume"])
+            ],
+        }
+        replayed = ZSFUnsteady(15.0, 0.0, **self.parameters)
+        transports = replayed.run_lockages(routines, events["duration"], columns)
+
+        for k, v in transports.items():
+            np.testing.assert_allclose(events[k], v, rtol=1e-12, atol=1e-9, err_msg=k)
+            if k.startswith(("volume_", "mass_")):
+                np.testing.assert_allclose(stats["total"][k], np.sum(v), rtol=1e-10)
+
+        total = stats["total"]
+        np.testing.assert_allclose(total["discharge_to_sea"], total["volume_to_sea"] / duration)
+
+        # Every ship that arrived has passed, or is still waiting
+        num_ships = stats["num_ships_lake_to_sea"] + stats["num_ships_sea_to_lake"]
+        self.assertEqual(num_ships, sum(events["num_ships"]))
+        self.assertEqual(stats["num_ships_turned_away"], 0)
+        expected = (0.8 + 1.2) * duration / 3600.0
+        self.assertAlmostEqual(
+            num_ships + stats["num_ships_waiting"], expected, delta=0.1 * expected
+        )
+        self.assertAlmostEqual(stats["num_ships_lake_to_sea"] / num_ships, 0.4, delta=0.05)
+
+        num_levelings = sum(r in (1, 3) for r in routines)
+        self.assertEqual(stats["num_lockages"], num_levelings)
+        self.assertGreater(stats["mean_waiting_time"], 0.0)
+        self.assertGreaterEqual(stats["max_waiting_time"], stats["mean_waiting_time"])
+
+    def test_reproducible(self):
+        a = zsf_simulate_operation(15.0, 0.0, 86400.0, self.traffic, seed=3, **self.parameters)
+        b = zsf_simulate_operation(15.0, 0.0, 86400.0, self.traffic, seed=3, **self.parameters)
+        c = zsf_simulate_operation(15.0, 0.0, 86400.0, self.traffic, seed=4, **self.parameters)
+        self.assertEqual(a, b)
+        self.assertNotEqual(a[0]["time"], c[0]["time"])
+
+    def test_fill_limits(self):
+        # Busy traffic, such that the lockages are full
+        traffic = dict(self.traffic, arrival_rate_lake=6.0, arrival_rate_sea=6.0, max_ships=3)
+        events, _ = zsf_simulate_operation(15.0, 0.0, 86400.0, traffic, **self.parameters)
+        self.assertEqual(max(events["num_ships"]), 3)
+
+        traffic = dict(traffic, max_ships=0, max_ship_volume=2500.0)
+        events, _ = zsf_simulate_operation(15.0, 0.0, 86400.0, traffic, **self.parameters)
+        self.assertLessEqual(max(events["ship_volume"]), 2500.0)
+        self.assertGreater(max(events["num_ships"]), 1)
+
+    def test_tide_window(self):
+        # The lock can only level in the hours with a low sea
+        interval = 3600.0
+        heads = [0.2, 0.5, 1.8, 2.0, 1.5, 0.4]
+        columns = {"head_sea": [heads[k % len(heads)] for k in range(48)]}
+        traffic = dict(self.traffic, max_head_difference=1.0)
+        events, stats = zsf_simulate_operation(
+            15.0, 0.0, 2 * 86400.0, traffic, columns, interval, **self.parameters
+        )
+        self.assert_sequential(events)
+        self.assertGreater(stats["num_lockages"], 0)
+
+        # The lock departs half the time of the doors before it levels
+        for t, r in zip(events["time"], events["routine"]):
+            if r in (1, 3):
+                depart = t - 0.5 * self.parameters["door_time_to_open"]
+                self.assertLessEqual(heads[int(depart // interval) % len(heads)], 1.0)
+
+    def test_turned_away(self):
+        # Ships that only fit in the lock when the sea is high
+        columns = {"head_sea": [1.0, -3.0] * 24}
+        traffic = dict(self.traffic, ship_volume_min=3000.0, ship_volume_max=4000.0)
+        events, stats = zsf_simulate_operation(
+            15.0, 0.0, 86400.0, traffic, columns, 3600.0, **self.parameters
+        )
+        self.assert_sequential(events)
+        self.assertGreater(stats["num_ships_turned_away"], 0)
+        self.assertGreater(stats["num_ships_lake_to_sea"] + stats["num_ships_sea_to_lake"], 0)
+
+        # Ships that never fit do not stop the simulation
+        traffic = {"ship_volume_min": 1e5, "ship_volume_max": 1e5}
+        events, stats = zsf_simulate_operation(15.0, 0.0, 86400.0, traffic, **self.parameters)
+        self.assertGreater(stats["num_ships_turned_away"], 0)
+        self.assertEqual(sum(events["num_ships"]), 0)
+
+    def test_close_doors_when_idle(self):
+        traffic = dict(self.traffic, arrival_rate_lake=0.2, arrival_rate_sea=0.2)
+        events, open_stats = zsf_simulate_operation(
+            15.0, 0.0, 7 * 86400.0, traffic, **self.parameters
+        )
+        self.assertFalse(any(r < 0 for r in events["routine"]))
+
+        traffic["close_doors_when_idle"] = 1
+        events, closed_stats = zsf_simulate_operation(
+            15.0, 0.0, 7 * 86400.0, traffic, **self.parameters
+        )
+        self.assert_sequential(events)
+        self.assertTrue(any(r < 0 for r in events["routine"]))
+
+        # The same ships, but less salt with the doors closed
+        keys = ("num_ships_lake_to_sea", "num_ships_sea_to_lake", "num_ships_waiting")
+        self.assertEqual(sum(open_stats[k] for k in keys), sum(closed_stats[k] for k in keys))
+        self.assertLess(
+            abs(closed_stats["total"]["mass_transport_lake"]),
+            abs(open_stats["total"]["mass_transport_lake"]),
+        )
+
+    def test_invalid(self):
+        with self.assertRaises(ValueError):
+            zsf_simulate_operation(15.0, 0.0, 86400.0, {"arrival_rate_sea": -1.0})
+        with self.assertRaises(ValueError):
+            zsf_simulate_operation(
+                15.0, 0.0, 86400.0, {"ship_volume_min": 10.0, "ship_volume_max": 1.0}
+            )
+        with self.assertRaises(TypeError):
+            zsf_simulate_operation(15.0, 0.0, 86400.0, {"x": 1.0})
+        with self.assertRaises(TypeError):
+            zsf_simulate_operation(15.0, 0.0, 86400.0, x=1.0)
+
+        # Ships larger than the fill limit
+        with self.assertRaisesRegex(ValueError, "Invalid ship traffic"):
+            zsf_simulate_operation(
+                15.0, 0.0, 86400.0, {"ship_volume_max": 3000.0, "max_ship_volume": 2500.0}
+            )
@@ -0,0 +1,263 @@
+import unittest
+
+import numpy as np
+
+from pyzsf import ConvergenceError, zsf_calc_steady, zsf_calc_steady_batch
+
+
+class TestSteadySolver(unittest.TestCase):
+    def setUp(self):
+        self.parameters = {
+            "lock_length": 240.0,
+            "lock_width": 12.0,
+            "lock_bottom": -4.0,
+            "num_cycles": 24.0,
+            "door_time_to_open": 300.0,
+            "leveling_time": 300.0,
+            "calibration_coefficient": 1.0,
+            "symmetry_coefficient": 1.0,
+            "ship_volume_sea_to_lake": 0.0,
+            "ship_volume_lake_to_sea": 0.0,
+            "head_sea": 0.0,
+            "salinity_sea": 25.0,
+            "temperature_sea": 15.0,
+            "head_lake": 0.0,
+            "salinity_lake": 5.0,
+            "temperature_lake": 15.0,
+            "flushing_discharge_high_tide": 0.0,
+            "flushing_discharge_low_tide": 0.0,
+            "density_current_factor_sea": 1.0,
+            "density_current_factor_lake": 1.0,
+            # Start from the average of the lake and the sea instead of the
+            # closed-form steady state, to test the iteration itself
+            "salinity_lock": 15.0,
+        }
+
+        # Scenarios that converge slowly with Picard iteration, because only
+        # a small part of the lock volume is exchanged every cycle
+        self.slow_scenarios = [
+            {"num_cycles": 54.0},
+            {"lock_length": 480.0},
+            {"density_current_factor_sea": 0.25, "density_current_factor_lake": 0.25},
+            {"head_sea": -2.0, "flushing_discharge_low_tide": 1.0},
+        ]
+
+    def test_same_steady_state(self):
+        for scenario in self.slow_scenarios:
+            parameters = dict(self.parameters, rtol=1e-12, atol=1e-14, **scenario)
+
+            picard = zsf_calc_steady(solver="picard", auxiliary_results=True, **parameters)
+            aitken = zsf_calc_steady(solver="aitken", auxiliary_results=True, **parameters)
+
+            for k in ("salt_load_lake", "salt_load_sea", "discharge_to_lake", "salinity_lock_4"):
+                np.testing.assert_allclose(
+                    aitken[k], picard[k], rtol=1e-9, err_msg=f"{scenario}, {k}"
+                )
+
+    def test_fewer_cycles(self):
+        for scenario in self.slow_scenarios:
+            parameters = dict(self.parameters, **scenario)
+
+            picard = zsf_calc_steady(solver="picard", statistics=True, **parameters)
+            aitken = zsf_calc_steady(solver="aitken", statistics=True, **parameters)
+
+            self.assertEqual(
+                picard["statistics"]["num_extrapolations"], 0, msg=f"{scenario}",
+            )
+            self.assertGreater(
+                aitken["statistics"]["num_extrapolations"], 0, msg=f"{scenario}",
+            )
+            self.assertLessEqual(
+                aitken["statistics"]["num_cycles"],
+                picard["statistics"]["num_cycles"],
+                msg=f"{scenario}",
+            )
+
+        # The slowest scenario should benefit a lot
+        parameters = dict(self.parameters, num_cycles=54.0)
+        picard = zsf_calc_steady(solver="picard", statistics=True, **parameters)
+        aitken = zsf_calc_steady(solver="aitken", statistics=True, **parameters)
+        self.assertLess(2 * aitken["statistics"]["num_cycles"], picard["statistics"]["num_cycles"])
+
+    def test_closed_form(self):
+        # Without flushing and bubble screens, the solvers start at the
+        # closed-form steady state, and the first cycle confirms it
+        scenarios = [
+            {},
+            *self.slow_scenarios[:3],
+            {"sill_height_sea": 1.5, "sill_height_lake": 1.0},
+            {"head_sea": 1.5, "ship_volume_sea_to_lake": 1000.0},
+            {"head_sea": -1.5, "ship_volume_lake_to_sea": 1000.0},
+            {"num_cycles": 96.0},
+        ]
+
+        for scenario in scenarios:
+            parameters = dict(self.parameters, **scenario)
+            del parameters["salinity_lock"]
+            reference = zsf_calc_steady(
+                solver="aitken", salinity_lock=15.0, rtol=1e-12, atol=1e-14, **parameters
+            )
+
+            for accuracy in ("exact", "fastest"):
+                results = zsf_calc_steady(statistics=True, accuracy=accuracy, **parameters)
+                self.assertEqual(results["statistics"]["num_cycles"], 1, f"{scenario}")
+
+                if accuracy == "exact":
+                    for k in ("salt_load_lake", "salt_load_sea", "discharge_to_lake"):
+                        np.testing.assert_allclose(
+                            results[k], reference[k], rtol=1e-6, err_msg=f"{scenario}, {k}"
+                        )
+
+        # Otherwise the solvers start at the average of the lake and the sea
+        for scenario in self.slow_scenarios[3:]:
+            parameters = dict(self.parameters, **scenario)
+            reference = zsf_calc_steady(statistics=True, **parameters)
+            del parameters["salinity_lock"]
+            results = zsf_calc_steady(statistics=True, **parameters)
+            self.assertEqual(results, reference)
+
+    def test_batch(self):
+        columns = {"num_cycles": [8.0, 24.0, 54.0]}
+
+        batch = zsf_calc_steady_batch(columns, solver="aitken", **self.parameters)
+
+        for i, num_cycles in enumerate(columns["num_cycles"]):
+            single = zsf_calc_steady(
+                solver="aitken", **dict(self.parameters, num_cycles=num_cycles)
+            )
+            self.assertEqual(batch["salt_load_lake"][i], single["salt_load_lake"])
+
+    def test_unknown_solver(self):
+        with self.assertRaises(ValueError):
+            zsf_calc_steady(solver="newton", **self.parameters)
+
+    def test_accuracy(self):
+        # Scenarios that use tanh (bubble screens) and cbrt (flushing)
+        scenarios = [
+            {},
+            {"distance_door_bubble_screen_lake": 4.0, "distance_door_bubble_screen_sea": -4.0},
+            {"head_sea": -2.0, "flushing_discharge_low_tide": 1.0},
+            {"head_sea": 2.0, "flushing_discharge_high_tide": 1.0},
+        ]
+
+        for scenario in scenarios:
+            parameters = dict(self.parameters, rtol=1e-10, atol=1e-12, **scenario)
+
+            exact = zsf_calc_steady(accuracy="exact", **parameters)
+            fast = zsf_calc_steady(accuracy="fast", **parameters)
+            fastest = zsf_calc_steady(accuracy="fastest", **parameters)
+
+            for k in ("salt_load_lake", "salt_load_sea", "discharge_to_lake"):
+                np.testing.assert_allclose(
+                    fast[k], exact[k], rtol=1e-8, err_msg=f"{scenario}, {k}"
+                )
+                np.testing.assert_allclose(
+                    fastest[k], exact[k], rtol=0.01, err_msg=f"{scenario}, {k}"
+                )
+
+        parameters = dict(self.parameters, flushing_discharge_low_tide=1.0)
+        columns = {"head_sea": [-2.0, 2.0]}
+        batch = zsf_calc_steady_batch(columns, accuracy="fastest", **parameters)
+        for i, head_sea in enumerate(columns["head_sea"]):
+            single = zsf_calc_steady(accuracy="fastest", **dict(parameters, head_sea=head_sea))
+            self.assertEqual(batch["salt_load_lake"][i], single["salt_load_lake"])
+
+        with self.assertRaises(ValueError):
+            zsf_calc_steady(accuracy="approximate", **self.parameters)
+
+    def test_max_cycles(self):
+        parameters = dict(self.parameters, num_cycles=54.0)
+
+        with self.assertRaises(ConvergenceError) as cm:
+            zsf_calc_steady(max_cycles=3, statistics=True, **parameters)
+
+        # The best estimate is not converged, but should not be far off either
+        results = cm.exception.results
+        reference = zsf_calc_steady(**parameters)
+        self.assertLessEqual(results["statistics"]["num_cycles"], 3)
+        self.assertGreater(results["statistics"]["residual"], 0.0)
+        np.testing.assert_allclose(results["salt_load_lake"], reference["salt_load_lake"], rtol=0.2)
+
+        # Enough cycles to converge
+        results = zsf_calc_steady(max_cycles=1000, **parameters)
+        self.assertEqual(results["salt_load_lake"], reference["salt_load_lake"])
+
+    def test_trace(self):
+        parameters = dict(self.parameters, num_cycles=54.0)
+
+        traces = {}
+        for solver in ("picard", "aitken"):
+            results = zsf_calc_steady(
+                solver=solver, trace=1000, statistics=True, auxiliary_results=True, **parameters
+            )
+            trace = traces[solver] = results["trace"]
+            num_cycles = results["statistics"]["num_cycles"]
+            self.assertEqual(trace["cycle"], list(range(1, num_cycles + 1)))
+            self.assertEqual(sum(trace["restarted"]), results["statistics"]["num_extrapolations"])
+
+            # The last cycle is the one of the results
+            for k in range(1, 5):
+                self.assertEqual(
+                    trace[f"salinity_lock_{k}"][-1], results[f"salinity_lock_{k}"], solver
+                )
+            self.assertEqual(trace["residual"][-1], results["statistics"]["residual"])
+
+            # Picard iteration approaches the fixed point monotonically
+            if solver == "picard":
+                self.assertTrue(np.all(np.diff(trace["residual"]) < 0.0))
+
+        # Only the last cycles, in order, when the trace is shorter
+        last = zsf_calc_steady(trace=3, **parameters)["trace"]
+        self.assertEqual(last["cycle"], traces["picard"]["cycle"][-3:])
+        self.assertEqual(last["residual"], traces["picard"]["residual"][-3:])
+
+    def test_trace_not_converged(self):
+        parameters = dict(self.parameters, num_cycles=54.0)
+
+        with self.assertRaises(ConvergenceError) as cm:
+            zsf_calc_steady(
+                solver="aitken", max_cycles=3, trace=1000, statistics=True, **parameters
+            )
+
+        # The third cycle starts from the extrapolation of the first two
+        results = cm.exception.results
+        trace = results["trace"]
+        self.assertEqual(trace["cycle"], [1, 2, 3])
+        self.assertEqual(trace["restarted"], [0, 0, 1])
+        self.assertEqual(trace["residual"][-1], results["statistics"]["residual"])
+
+    def test_max_time(self):
+        parameters = dict(self.parameters, num_cycles=54.0, rtol=1e-12, atol=1e-14)
+
+        with self.assertRaisesRegex(ConvergenceError, "time"):
+            zsf_calc_steady(max_time=1e-9, **parameters)
+
+    def test_zero_tolerance(self):
+        # Rounding errors can keep the salinity jumping between two values,
+        # which should be detected instead of looping forever.
+        for scenario in [{}, *self.slow_scenarios, {"head_sea": -1.0, "num_cycles": 49.0}]:
+            parameters = dict(self.parameters, rtol=0.0, atol=0.0, **scenario)
+            reference = zsf_calc_steady(**dict(parameters, rtol=1e-12, atol=1e-14))
+
+            for solver in ("picard", "aitken"):
+                try:
+                    results = zsf_calc_steady(solver=solver, **parameters)
+                except ConvergenceError as e:
+                    self.assertRegex(str(e), "stagnated|oscillates")
+                    results = e.results
+
+                np.testing.assert_allclose(
+                    results["salt_load_lake"],
+                    reference["salt_load_lake"],
+                    rtol=1e-9,
+                    err_msg=f"{scenario}, {solver}",
+                )
+
+    def test_batch_best_estimate(self):
+        columns = {"num_cycles": [8.0, 54.0]}
+
+        batch = zsf_calc_steady_batch(columns, max_cycles=3, **self.parameters)
+
+        self.assertEqual(batch["error"][0], 0)
+        self.assertNotEqual(batch["error"][1], 0)
+        self.assertFalse(np.isnan(batch["salt_load_lake"][1]))
@@ -2,7 +2,13 @@ import unittest
 
 import numpy as np
 
-from pyzsf import zsf_calc_steady
+from pyzsf import (
+    ConvergenceError,
+    zsf_calc_steady,
+    zsf_calc_steady_inverse,
+    zsf_calc_steady_sensitivities,
+    zsf_cpu_variant,
+)
 
 
 class TestSaltLoadSteady(unittest.TestCase):
@@ -379,3 +385,116 @@ class TestSaltLoadSteady(unittest.TestCase):
         # Check values against known good values
         self.assert_allclose_loose(sl_bubble_distance_sea, -6.467)
         self.assert_allclose_loose(sl_bubble_distance_lake, -6.467)
+
+    def test_cpu_variant(self):
+        self.assertIn(zsf_cpu_variant(), ("avx512f", "avx2", "default"))
+
+    def test_sensitivities(self):
+        params = dict(
+            self.parameters,
+            head_sea=0.5,
+            ship_volume_sea_to_lake=1000.0,
+            flushing_discharge_high_tide=0.5,
+            density_current_factor_sea=0.5,
+            density_current_factor_lake=0.5,
+            rtol=1e-12,
+            atol=1e-13,
+        )
+        wrt = [
+            "calibration_coefficient",
+            "density_current_factor_sea",
+            "flushing_discharge_high_tide",
+            "salinity_sea",
+            "temperature_lake",
+            "ship_volume_sea_to_lake",
+        ]
+
+        results = zsf_calc_steady_sensitivities(wrt, **params)
+        self.assertEqual(results["salt_load_lake"], zsf_calc_steady(**params)["salt_load_lake"])
+
+        # Central differences of full solves
+        for p in wrt:
+            h = 1e-4 * max(abs(params[p]), 1.0)
+            plus = zsf_calc_steady(**dict(params, **{p: params[p] + h}))
+            minus = zsf_calc_steady(**dict(params, **{p: params[p] - h}))
+
+            for k in ("salt_load_lake", "discharge_to_sea", "salinity_to_lake"):
+                np.testing.assert_allclose(
+                    results["sensitivities"][p][k],
+                    (plus[k] - minus[k]) / (2 * h),
+                    rtol=1e-5,
+                    atol=1e-10,
+                    err_msg=f"d {k} / d {p}",
+                )
+
+        # The start of the iteration does not influence the steady state
+        results = zsf_calc_steady_sensitivities(["salinity_lock"], **params)
+        self.assertEqual(results["sensitivities"]["salinity_lock"]["salt_load_lake"], 0.0)
+
+        with self.assertRaises(TypeError):
+            zsf_calc_steady_sensitivities(["no_such_parameter"], **params)
+        with self.assertRaises(ConvergenceError):
+            zsf_calc_steady_sensitivities(wrt, max_cycles=1, **params)
+
+    def test_inverse(self):
+        cases = [
+            ("flushing_discharge_high_tide", (0.0, 20.0), 0.0),
+            ("flushing_discharge_high_tide", (0.0, 20.0), 1.0),
+            ("sill_height_lake", (0.1, 3.5), 0.0),
+            ("distance_door_bubble_screen_lake", (0.0, 50.0), 0.0),
+        ]
+
+        for param, bounds, head_sea in cases:
+            params = dict(self.parameters, head_sea=head_sea)
+            params.pop(param, None)
+
+            # A target between the salt loads at the bounds
+            lower = zsf_calc_steady(**dict(params, **{param: bounds[0]}))["salt_load_lake"]
+            upper = zsf_calc_steady(**dict(params, **{param: bounds[1]}))["salt_load_lake"]
+            target = 0.3 * lower + 0.7 * upper
+
+            results = zsf_calc_steady_inverse(
+                param, bounds, "salt_load_lake", target, statistics=True, **params
+            )
+            self.assertLess(results["statistics"]["num_probes"], 20, msg=param)
+
+            # The salt load of a full solve at the value hits the target
+            value = results["value"]
+            self.assertTrue(bounds[0] < value < bounds[1], msg=param)
+            check = zsf_calc_steady(**dict(params, **{param: value}))
+            self.assert_allclose_tight(check["salt_load_lake"], target)
+            self.assert_allclose_tight(results["salt_load_lake"], target)
+
+            # A tolerance takes fewer probes
+            loose = zsf_calc_steady_inverse(
+                param, bounds, "salt_load_lake", target, tolerance=0.01, statistics=True, **params
+            )
+            self.assertLessEqual(
+                loose["statistics"]["num_probes"], results["statistics"]["num_probes"]
+            )
+            self.assertLessEqual(abs(loose["statistics"]["residual"]), 0.01)
+
+        # A tolerance below the accuracy of the steady state is not reached
+        params = dict(self.parameters)
+        params.pop("flushing_discharge_high_tide")
+        target = zsf_calc_steady(**dict(params, flushing_discharge_high_tide=5.0))["salt_load_lake"]
+        with self.assertRaisesRegex(RuntimeError, "Tolerance not reached"):
+            zsf_calc_steady_inverse(
+                "flushing_discharge_high_tide",
+                (0.0, 20.0),
+                "salt_load_lake",
+                target + 1e-3 / 7.0,
+                tolerance=1e-300,
+                **params,
+            )
+
+        # No value between the bounds hits the target
+        with self.assertRaisesRegex(RuntimeError, "not between"):
+            zsf_calc_steady_inverse("sill_height_lake", (0.1, 3.5), "salt_load_lake", -1e6)
+        with self.assertRaises(TypeError):
+            zsf_calc_steady_inverse("sill_height_lake", (0.1, 3.5), "no_such_result", 0.0)
+
+        # A sill below the bottom of the lock, or above the water level
+        for bounds in ((-1.0, 0.0), (0.1, 5.5)):
+            with self.assertRaisesRegex(RuntimeError, "valid range"):
+                zsf_calc_steady_inverse("sill_height_lake", bounds, "salt_load_lake", 0.0)
@@ -0,0 +1,98 @@
+import os
+import tempfile
+import unittest
+
+import numpy as np
+
+from pyzsf import ZSFSurrogate, zsf_calc_steady
+
+
+class TestSurrogate(unittest.TestCase):
+    def setUp(self):
+        self.parameters = {
+            "lock_length": 240.0,
+            "lock_width": 12.0,
+            "lock_bottom": -4.0,
+            "num_cycles": 24.0,
+            "door_time_to_open": 300.0,
+            "leveling_time": 300.0,
+            "temperature_sea": 15.0,
+            "temperature_lake": 15.0,
+        }
+        self.axes = {
+            "head_sea": (-2.0, 2.0, 9),
+            "salinity_sea": (20.0, 30.0, 6),
+            "salinity_lake": (0.0, 10.0, 6),
+            "ship_volume_sea_to_lake": (0.0, 4000.0, 5),
+        }
+        self.surrogate = ZSFSurrogate(self.axes, num_checks=200, **self.parameters)
+
+    def test_grid_points(self):
+        # Both methods reproduce the grid points, including the last ones
+        for x in [
+            {"head_sea": 0.5, "salinity_sea": 22.0, "salinity_lake": 2.0},
+            {"head_sea": 2.0, "salinity_sea": 30.0, "salinity_lake": 10.0},
+            {"head_sea": -2.0, "salinity_sea": 20.0, "salinity_lake": 0.0},
+        ]:
+            x["ship_volume_sea_to_lake"] = 1000.0
+            exact = zsf_calc_steady(**self.parameters, **x)
+            for method in ("linear", "cubic"):
+                results = self.surrogate(method, **x)
+                self.assertAlmostEqual(results["salt_load_lake"], exact["salt_load_lake"], 10)
+
+    def test_error_bound(self):
+        rng = np.random.default_rng(1)
+        for method in ("linear", "cubic"):
+            max_error = self.surrogate.max_error(method)
+            self.assertGreater(max_error["salt_load_lake"], 0.0)
+
+            # The estimate is not a strict bound, but random points should not
+            # be much worse than those halfway between grid points
+            for _ in range(50):
+                x = {k: rng.uniform(lo, hi) for k, (lo, hi, _) in self.axes.items()}
+                exact = zsf_calc_steady(**self.parameters, **x)
+                results = self.surrogate(method, **x)
+                for k in ("salt_load_lake", "discharge_to_sea"):
+                    self.assertLessEqual(abs(results[k] - exact[k]), 2.0 * max_error[k] + 1e-12)
+
+    def test_save_load(self):
+        x = {"head_sea": 0.3, "salinity_sea": 24.1, "salinity_lake": 3.3}
+        x["ship_volume_sea_to_lake"] = 123.0
+
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "surrogate.zsf")
+            self.surrogate.save(path)
+            loaded = ZSFSurrogate.load(path)
+
+            with open(path, "wb") as f:
+                f.write(b"not a surrogate")
+            with self.assertRaises(RuntimeError):
+                ZSFSurrogate.load(path)
+
+        self.assertEqual(loaded.axes, self.surrogate.axes)
+        self.assertEqual(loaded.parameters, self.surrogate.parameters)
+        self.assertEqual(loaded.max_error("cubic"), self.surrogate.max_error("cubic"))
+        self.assertEqual(loaded("cubic", **x), self.surrogate("cubic", **x))
+
+    def test_invalid(self):
+        x = {k: lo for k, (lo, _, _) in self.axes.items()}
+
+        with self.assertRaises(ValueError):
+            self.surrogate(**dict(x, head_sea=2.5))
+        with self.assertRaises(ValueError):
+            self.surrogate("quadratic", **x)
+        with self.assertRaises(TypeError):
+            self.surrogate(head_sea=0.0)
+        with self.assertRaises(TypeError):
+            ZSFSurrogate({"head_sea": (0.0, 1.0, 2)}, head_sea=0.5)
+        with self.assertRaises(RuntimeError):
+            ZSFSurrogate({"head_sea": (1.0, 0.0, 2)})
+
+    def test_failed_grid_points(self):
+        # Ships that do not fit in the (default) lock only fail the cells next
+        # to them
+        surrogate = ZSFSurrogate({"ship_volume_sea_to_lake": (0.0, 8000.0, 5)})
+
+        surrogate(ship_volume_sea_to_lake=1000.0)
+        with self.assertRaises(ValueError):
+            surrogate(ship_volume_sea_to_lake=7000.0)
@@ -0,0 +1,73 @@
+import unittest
+
+import numpy as np
+
+from pyzsf import zsf_calc_steady_batch, zsf_sweep
+
+
+class TestSweep(unittest.TestCase):
+    def setUp(self):
+        self.parameters = {
+            "lock_length": 240.0,
+            "lock_width": 12.0,
+            "lock_bottom": -4.0,
+            "door_time_to_open": 300.0,
+            "leveling_time": 300.0,
+            "salinity_lake": 5.0,
+            "temperature_sea": 15.0,
+            "temperature_lake": 15.0,
+            "head_sea": 0.5,
+            "rtol": 1e-8,
+            "atol": 1e-10,
+        }
+        self.axes = {
+            "sill_height_lake": (1.0, 3.5, 6),
+            "salinity_sea": (20.0, 30.0, 3),
+            "flushing_discharge_high_tide": (0.0, 5.0, 7),
+            "num_cycles": (12.0, 36.0, 5),
+        }
+
+    def grid(self):
+        values = [np.linspace(lo, hi, n) for lo, hi, n in self.axes.values()]
+        points = np.meshgrid(*values, indexing="ij")
+        return {p: list(x.ravel()) for p, x in zip(self.axes, points)}
+
+    def test_equals_batch(self):
+        results = zsf_sweep(self.axes, **self.parameters)
+        self.assertEqual(results.shape, (6, 3, 7, 5))
+        np.testing.assert_equal(results["error"], 0)
+
+        # The same points solved independently, with the last axis contiguous
+        batch = zsf_calc_steady_batch(self.grid(), **self.parameters)
+        for k in ("salt_load_lake", "discharge_to_sea", "salinity_to_lake"):
+            np.testing.assert_allclose(
+                results[k].ravel(), batch[k], rtol=1e-5, atol=1e-5, err_msg=k
+            )
+
+        # Threads do not change the results beyond the accuracy of the solver
+        threaded = zsf_sweep(self.axes, num_threads=3, **self.parameters)
+        np.testing.assert_allclose(
+            threaded["salt_load_lake"], results["salt_load_lake"], rtol=1e-5, atol=1e-5
+        )
+
+    def test_failing_points(self):
+        # Ships that are too large for the lock fail only their own points
+        axes = {"ship_volume_sea_to_lake": (0.0, 20000.0, 11), "salinity_sea": (20.0, 30.0, 3)}
+        results = zsf_sweep(axes, **self.parameters)
+
+        failed = results["error"] != 0
+        self.assertTrue(np.any(failed))
+        self.assertTrue(np.all(failed[-1]))
+        self.assertFalse(np.any(failed[0]))
+        self.assertTrue(np.all(np.isnan(results["salt_load_lake"][failed])))
+        self.assertFalse(np.any(np.isnan(results["salt_load_lake"][~failed])))
+
+    def test_invalid(self):
+        with self.assertRaises(ValueError):
+            zsf_sweep({"salinity_sea": (30.0, 20.0, 3)})
+        with self.assertRaises(ValueError):
+            zsf_sweep({"salinity_sea": (20.0, 30.0, 1)})
+        with self.assertRaises(TypeError):
+            zsf_sweep({"x": (0.0, 1.0, 3)})
+        with self.assertRaises(TypeError):
+            zsf_sweep({"salinity_sea": (20.0, 30.0, 3)}, salinity_sea=25.0)
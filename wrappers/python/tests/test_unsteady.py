@@ -2,7 +2,7 @@ import unittest
 
 import numpy as np
 
-from pyzsf import ZSFUnsteady
+from pyzsf import ZSFUnsteady, zsf_calc_steady
 
 
 class TestSaltLoadUnsteady(unittest.TestCase):
@@ -62,3 +62,94 @@ class TestSaltLoadUnsteady(unittest.TestCase):
         duration = 1e9
         c.step_flush_doors_closed(duration)
         self.assert_allclose_tight(c.state["salinity_lock"], self.parameters["salinity_lake"])
+
+    def test_flush_doors_closed_accuracy(self):
+        # Flushing with the doors closed is the only user of exp
+        parameters = dict(self.parameters, flushing_discharge_low_tide=1.0)
+
+        for accuracy in ("fast", "fastest"):
+            exact = ZSFUnsteady(15.0, 0.0, **parameters)
+            approx = ZSFUnsteady(15.0, 0.0, accuracy=accuracy, **parameters)
+
+            for duration in (100.0, 1000.0, 10000.0):
+                exact.step_flush_doors_closed(duration)
+                approx.step_flush_doors_closed(duration)
+                np.testing.assert_allclose(
+                    approx.state["salinity_lock"], exact.state["salinity_lock"], rtol=1e-4
+                )
+
+    def test_parameter_changes(self):
+        # Start in steady state with one lake salinity, and then keep cycling
+        # with another. The lock should end up in the steady state of the
+        # latter, which requires the densities to be updated.
+        t_level = self.parameters["leveling_time"]
+        steady_5 = zsf_calc_steady(auxiliary_results=True, **self.parameters)
+        steady_10 = zsf_calc_steady(
+            auxiliary_results=True, **dict(self.parameters, salinity_lake=10.0, rtol=1e-12)
+        )
+
+        c = ZSFUnsteady(steady_5["salinity_lock_4"], 0.0, **self.parameters)
+        c.step_phase_1(t_level, salinity_lake=10.0)
+
+        for i in range(200):
+            c.step_phase_2(steady_10["t_open_lake"])
+            c.step_phase_3(t_level)
+            c.step_phase_4(steady_10["t_open_sea"])
+            c.step_phase_1(t_level)
+
+        self.assert_allclose_tight(c.state["salinity_lock"], steady_10["salinity_lock_1"])
+
+    def test_run_lockages(self):
+        # A varying sea level and salinity, with flushing while the doors are
+        # closed on lake side
+        heads = [0.0, 0.5, 1.0, 0.5, 0.0, -0.5]
+        routines, durations, columns = [], [], {"head_sea": [], "salinity_sea": []}
+        for i in range(30):
+            head_sea = heads[i % len(heads)]
+            salinity_sea = 25.0 + 0.1 * i
+            events = [(1, 300.0), (2, 1800.0), (-2, 600.0), (3, 300.0), (4, 1800.0)]
+            for routine, duration in events:
+                routines.append(routine)
+                durations.append(duration)
+                columns["head_sea"].append(head_sea)
+                columns["salinity_sea"].append(salinity_sea)
+
+        parameters = dict(
+            self.parameters, flushing_discharge_high_tide=1.0, flushing_discharge_low_tide=1.0
+        )
+
+        stepped = ZSFUnsteady(15.0, 0.0, **parameters)
+        expected = []
+        for i, (routine, duration) in enumerate(zip(routines, durations)):
+            row = {k: v[i] for k, v in columns.items()}
+            step = {
+                1: stepped.step_phase_1,
+                2: stepped.step_phase_2,
+                3: stepped.step_phase_3,
+                4: stepped.step_phase_4,
+                -2: stepped.step_flush_doors_closed,
+            }[routine]
+            expected.append(step(duration, **row))
+
+        replayed = ZSFUnsteady(15.0, 0.0, **parameters)
+        transports = replayed.run_lockages(routines, durations, columns)
+
+        self.assertEqual(replayed.state, stepped.state)
+        for i, e in enumerate(expected):
+            self.assertEqual({k: v[i] for k, v in transports.items()}, e)
+
+    def test_run_lockages_failure(self):
+        c = ZSFUnsteady(15.0, 1.0, **self.parameters)
+        state = c.state
+
+        with self.assertRaisesRegex(RuntimeError, "Event 1: Unknown lockage routine"):
+            c.run_lockages([1, 5, 3], [300.0, 300.0, 300.0])
+
+        # Only the first event was performed
+        c_ref = ZSFUnsteady(15.0, 1.0, **self.parameters)
+        c_ref.step_phase_1(300.0)
+        self.assertNotEqual(c.state, state)
+        self.assertEqual(c.state, c_ref.state)
+
+        with self.assertRaises(ValueError):
+            c.run_lockages([1, 2], [300.0])